@@ -65,6 +65,10 @@ typedef struct
 
 static OGLCameraPlacement	gAnaglyphCameraBackup;		// backup of original camera info before offsets applied
 
+static OGLCameraPlacement	gPrevTickCamera;			// camera as of the start of the last fixed-timestep sim tick
+static OGLCameraPlacement	gInterpolationCameraBackup;	// real camera info while we draw with the interpolated one
+static Boolean				gCameraIsInterpolated = false;
+
 const OGLVector3D	up = {0,1,0};
 
 Boolean				gDrawLensFlare = true, gFreezeCameraFromXZ = false, gFreezeCameraFromY = false;
@@ -304,7 +308,7 @@ int				px,py,pw,ph;
 		fx = x / (pw/2) - 1.0f;
 		fy = (ph-y) / (ph/2) - 1.0f;
 				
-		glBegin(GL_QUADS);		
+		OGL_Begin(GL_QUADS);		
 		glTexCoord2f(0,1);	glVertex2f(fx - sx, fy - sy);
 		glTexCoord2f(1,1);	glVertex2f(fx + sx, fy - sy);
 		glTexCoord2f(1,0);	glVertex2f(fx + sx, fy + sy);
@@ -845,6 +849,7 @@ static void MoveStampedeCameraOnSpline(ObjNode *camera)
 {
 const ObjNode		*player = gPlayerInfo.objNode;
 float		distToPlayer, speedToMove;
+float		aheadX, aheadZ;
 OGLPoint3D	from,to;
 int			splineNum = camera->SplineNum;
 
@@ -857,6 +862,12 @@ int			splineNum = camera->SplineNum;
 
 	IncreaseSplineIndex(camera, speedToMove, true);
 	GetObjectCoordOnSpline(camera);
+
+
+		/* TELL THE SUPERTILE BUILDERS WHERE WE'LL BE */
+
+	GetCoordOnSpline2(&(*gSplineList)[splineNum], camera->SplinePlacement, speedToMove * SUPERTILE_PREFETCH_LOOKAHEAD, &aheadX, &aheadZ, false);
+	SetSuperTilePrefetchHint(aheadX, aheadZ);
 	
 	
 	
@@ -944,3 +955,55 @@ float		sep = gAnaglyphEyeSeparation;
 	
 }
 
+
+#pragma mark -
+
+/********************** SAVE CAMERA FOR INTERPOLATION ***************************/
+//
+// Called by NextSimTick before each fixed-timestep sim tick.
+//
+
+void SaveCameraForInterpolation(void)
+{
+	if (gGameViewInfoPtr)
+		gPrevTickCamera = gGameViewInfoPtr->cameraPlacement;
+}
+
+
+/********************** PREP INTERPOLATED CAMERA ***************************/
+//
+// If the frame is to be drawn between two sim ticks, slide the camera back toward
+// where it was before the last tick.  Must be undone with RestoreCameraFromInterpolation.
+//
+
+void PrepInterpolatedCamera(void)
+{
+OGLCameraPlacement	*cam = &gGameViewInfoPtr->cameraPlacement;
+float				a = gSimInterpolation;
+
+	if (a >= 1.0f)
+		return;
+
+	gInterpolationCameraBackup = *cam;
+	gCameraIsInterpolated = true;
+
+	cam->cameraLocation.x = gPrevTickCamera.cameraLocation.x + (cam->cameraLocation.x - gPrevTickCamera.cameraLocation.x) * a;
+	cam->cameraLocation.y = gPrevTickCamera.cameraLocation.y + (cam->cameraLocation.y - gPrevTickCamera.cameraLocation.y) * a;
+	cam->cameraLocation.z = gPrevTickCamera.cameraLocation.z + (cam->cameraLocation.z - gPrevTickCamera.cameraLocation.z) * a;
+
+	cam->pointOfInterest.x = gPrevTickCamera.pointOfInterest.x + (cam->pointOfInterest.x - gPrevTickCamera.pointOfInterest.x) * a;
+	cam->pointOfInterest.y = gPrevTickCamera.pointOfInterest.y + (cam->pointOfInterest.y - gPrevTickCamera.pointOfInterest.y) * a;
+	cam->pointOfInterest.z = gPrevTickCamera.pointOfInterest.z + (cam->pointOfInterest.z - gPrevTickCamera.pointOfInterest.z) * a;
+}
+
+
+/********************** RESTORE CAMERA FROM INTERPOLATION ***************************/
+
+void RestoreCameraFromInterpolation(void)
+{
+	if (gCameraIsInterpolated)
+	{
+		gGameViewInfoPtr->cameraPlacement = gInterpolationCameraBackup;
+		gCameraIsInterpolated = false;
+	}
+}
@@ -0,0 +1,533 @@
+/****************************/
+/*   	  MESH BVH.C        */
+/****************************/
+//
+// Triangle BVH's for the ray & line segment tests against display group
+// meshes in Pick.c.
+//
+// Each BG3D mesh gets one when it's imported. It's built in model space, so
+// it's good for every object that uses the mesh no matter where it is: a
+// query brings its world-space ray or segment into the mesh's space and gets
+// back the triangles in the leaves that it passes thru. The caller still
+// tests those triangles in world space just like it tests all of them
+// without a BVH, so the BVH only decides which triangles to skip.
+//
+// The nodes are stored depth first in one block, with a node's 1st child
+// right after it, so a BVH is freed with the mesh in one go.
+//
+
+/***************/
+/* EXTERNALS   */
+/***************/
+
+#include "game.h"
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+typedef struct
+{
+	float		lo[3];
+	float		hi[3];
+	int32_t		first;										// leaf: 1st entry in triangles[], inner: index of 2nd child
+	int32_t		count;										// # triangles in leaf, 0 if inner
+} MeshBVHNode;
+
+struct MeshBVH
+{
+	int				numNodes;
+	int				numTriangles;
+	MeshBVHNode*	nodes;
+	uint32_t*		triangles;								// triangle #'s, grouped by leaf
+};
+
+static void BuildMeshBVH(MOVertexArrayObject* mo);
+static int BuildMeshBVHNode(int first, int count, int depth);
+static Boolean CalcMeshWorldToLocal(const OGLMatrix4x4* localToWorld, double m[3][3], double* normM, double* normInverse);
+static Boolean DoesRayHitMeshBVHNode(const MeshBVHNode* node, const float origin[3], const float invDir[3], float maxT, float pad);
+static void AddMeshBVHTriangles(const MeshBVH* bvh, const MeshBVHNode* node, int* n);
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+#define	MESHBVH_MIN_TRIANGLES		16							// smaller meshes just test every triangle
+#define	MESHBVH_LEAF_SIZE			4
+#define	MESHBVH_MAX_DEPTH			40							// anything left at this depth goes in one leaf
+#define	MESHBVH_SLOP				1.0e-5f						// box padding, relative to the size of the coords
+
+
+/*********************/
+/*    VARIABLES      */
+/*********************/
+
+MeshBVHStats			gMeshBVHStats;
+Boolean					gVerifyMeshBVH = false;					// test every triangle too, and make sure that the results match
+Boolean					gMeshBVHDisabled = false;				// test every triangle instead
+
+static const MOVertexArrayData*	gBuildMesh;						// the mesh being built for
+static MeshBVHNode*		gBuildNodes;
+static int				gNumBuildNodes;
+static uint32_t*		gBuildTriangles;
+static OGLPoint3D*		gBuildCentroids;
+
+static uint32_t*		gMeshBVHTriangles = NULL;				// what GatherMeshBVHTriangles returns
+static int				gMaxMeshBVHTriangles = 0;
+
+
+#pragma mark -
+
+/********************** BUILD MESH BVHS ***************************/
+//
+// Gives each vertex array mesh in the object (recursing into groups)
+// a BVH, if it's big enough to need one.
+//
+
+void BuildMeshBVHs(MetaObjectPtr object)
+{
+MetaObjectHeader	*objHead = object;
+
+	if (objHead->cookie != MO_COOKIE)
+		DoFatalAlert("BuildMeshBVHs: cookie is invalid!");
+
+	switch(objHead->type)
+	{
+		case	MO_TYPE_GEOMETRY:
+				if (objHead->subType == MO_GEOMETRY_SUBTYPE_VERTEXARRAY)
+					BuildMeshBVH(object);
+				break;
+
+		case	MO_TYPE_GROUP:
+		{
+				const MOGroupData* group = &((MOGroupObject *) object)->objectData;
+
+				for (int i = 0; i < group->numObjectsInGroup; i++)
+					BuildMeshBVHs(group->groupContents[i]);
+				break;
+		}
+	}
+}
+
+
+/********************** DISPOSE MESH BVH ***************************/
+
+void DisposeMeshBVH(MOVertexArrayObject* mo)
+{
+	if (mo->bvh)
+	{
+		SafeDisposePtr((Ptr) mo->bvh);
+		mo->bvh = nil;
+	}
+}
+
+
+/********************** GATHER MESH BVH TRIANGLES ***************************/
+//
+// Returns the #'s of the triangles in the leaves that the world-space ray
+// from origin to origin + dir * maxT passes thru, in no particular order.
+// For a line segment, dir = p2 - p1 and maxT = 1. The mesh is positioned
+// by localToWorld.
+//
+// Returns -1 if the BVH can't be used with this matrix or ray (e.g. it's got
+// a 0 scale, or NaN's), in which case the caller must test every triangle.
+//
+
+int GatherMeshBVHTriangles(const MeshBVH* bvh, const OGLMatrix4x4* localToWorld,
+							const OGLPoint3D* origin, const OGLVector3D* dir, float maxT,
+							const uint32_t** triangles)
+{
+int		stack[MESHBVH_MAX_DEPTH + 2];
+int		sp = 0;
+int		n = 0;
+double	m[3][3], normM, normInverse;
+double	w[3], worldDir[3];
+float	o[3], d[3], invD[3];
+
+	if (!CalcMeshWorldToLocal(localToWorld, m, &normM, &normInverse))
+		return -1;
+
+			/* BRING THE RAY INTO THE MESH'S SPACE */
+			//
+			// Done in doubles since the object may be a long way from the origin.
+			//
+
+	w[0] = (double) origin->x - localToWorld->value[M03];
+	w[1] = (double) origin->y - localToWorld->value[M13];
+	w[2] = (double) origin->z - localToWorld->value[M23];
+
+	worldDir[0] = dir->x;
+	worldDir[1] = dir->y;
+	worldDir[2] = dir->z;
+
+	for (int i = 0; i < 3; i++)
+	{
+		o[i] = (float) (m[i][0] * w[0] + m[i][1] * w[1] + m[i][2] * w[2]);
+		d[i] = (float) (m[i][0] * worldDir[0] + m[i][1] * worldDir[1] + m[i][2] * worldDir[2]);
+
+		if (!isfinite(o[i]) || !isfinite(d[i]))
+			return -1;
+
+		invD[i] = (fabsf(d[i]) < 1e-20f) ? 0.0f : 1.0f / d[i];		// 0 = parallel to that axis
+	}
+
+			/* PAD THE BOXES FOR ROUNDING ERRORS */
+			//
+			// The world-space triangle tests are only good to a float's precision of
+			// the world coords, so the boxes get padded by a little more than that.
+			//
+
+	const MeshBVHNode* root = &bvh->nodes[0];
+	double worldSize = 0;
+	double localSize = 0;
+
+	for (int i = 0; i < 3; i++)
+	{
+		worldSize = GAME_MAX(worldSize, fabs(w[i] + localToWorld->value[M03 + i]));		// the origin
+		worldSize = GAME_MAX(worldSize, fabs(localToWorld->value[M03 + i]));				// the object
+		localSize = GAME_MAX(localSize, fabs(root->lo[i]));
+		localSize = GAME_MAX(localSize, fabs(root->hi[i]));
+	}
+
+	float pad = MESHBVH_SLOP * (float) ((worldSize + localSize * normM) * normInverse);
+
+	if (!isfinite(pad))
+		return -1;
+
+			/* WALK THE TREE */
+
+	gMeshBVHStats.numQueries++;
+
+	stack[sp++] = 0;
+
+	while (sp > 0)
+	{
+		const MeshBVHNode* node = &bvh->nodes[stack[--sp]];
+
+		if (!DoesRayHitMeshBVHNode(node, o, invD, maxT, pad))
+			continue;
+
+		if (node->count > 0)										// leaf
+		{
+			AddMeshBVHTriangles(bvh, node, &n);
+		}
+		else
+		{
+			GAME_ASSERT(sp + 2 <= MESHBVH_MAX_DEPTH + 2);
+			stack[sp++] = node->first;
+			stack[sp++] = (int) (node - bvh->nodes) + 1;
+		}
+	}
+
+	gMeshBVHStats.numTrianglesGathered += n;
+	gMeshBVHStats.numTrianglesInMeshes += bvh->numTriangles;
+
+	*triangles = gMeshBVHTriangles;
+	return n;
+}
+
+
+#pragma mark -
+
+/********************** BUILD MESH BVH ***************************/
+
+static void BuildMeshBVH(MOVertexArrayObject* mo)
+{
+const MOVertexArrayData	*mesh = &mo->objectData;
+int						numTriangles = mesh->numTriangles;
+
+	GAME_ASSERT(mo->bvh == nil);
+
+	if (numTriangles < MESHBVH_MIN_TRIANGLES || !mesh->points || !mesh->triangles)
+		return;
+
+			/* MAKE SURE THE TRIANGLES ARE SANE */
+
+	for (int t = 0; t < numTriangles; t++)
+	{
+		for (int v = 0; v < 3; v++)
+		{
+			GLuint i = mesh->triangles[t].vertexIndices[v];
+
+			if (i >= (GLuint) mesh->numPoints)
+				return;
+
+			const OGLPoint3D* p = &mesh->points[i];
+			if (!isfinite(p->x) || !isfinite(p->y) || !isfinite(p->z))
+				return;
+		}
+	}
+
+			/* BUILD INTO WORST-CASE SIZED BUFFERS */
+
+	gBuildMesh		= mesh;
+	gNumBuildNodes	= 0;
+	gBuildNodes		= (MeshBVHNode*) AllocPtrTagged(sizeof(MeshBVHNode) * (2 * numTriangles - 1), kMemTag_BG3D);
+	gBuildTriangles	= (uint32_t*) AllocPtrTagged(sizeof(uint32_t) * numTriangles, kMemTag_BG3D);
+	gBuildCentroids	= (OGLPoint3D*) AllocPtrTagged(sizeof(OGLPoint3D) * numTriangles, kMemTag_BG3D);
+
+	for (int t = 0; t < numTriangles; t++)
+	{
+		const OGLPoint3D* p0 = &mesh->points[mesh->triangles[t].vertexIndices[0]];
+		const OGLPoint3D* p1 = &mesh->points[mesh->triangles[t].vertexIndices[1]];
+		const OGLPoint3D* p2 = &mesh->points[mesh->triangles[t].vertexIndices[2]];
+
+		gBuildTriangles[t] = t;
+		gBuildCentroids[t].x = (p0->x + p1->x + p2->x) * (1.0f / 3.0f);
+		gBuildCentroids[t].y = (p0->y + p1->y + p2->y) * (1.0f / 3.0f);
+		gBuildCentroids[t].z = (p0->z + p1->z + p2->z) * (1.0f / 3.0f);
+	}
+
+	BuildMeshBVHNode(0, numTriangles, 0);
+
+			/* COPY IT INTO ONE BLOCK THAT'S JUST BIG ENOUGH */
+
+	size_t nodesSize = sizeof(MeshBVHNode) * gNumBuildNodes;
+	size_t trisSize = sizeof(uint32_t) * numTriangles;
+
+	MeshBVH* bvh = (MeshBVH*) AllocPtrTagged(sizeof(MeshBVH) + nodesSize + trisSize, kMemTag_BG3D);
+
+	bvh->numNodes		= gNumBuildNodes;
+	bvh->numTriangles	= numTriangles;
+	bvh->nodes			= (MeshBVHNode*) (bvh + 1);
+	bvh->triangles		= (uint32_t*) ((char*) bvh->nodes + nodesSize);
+
+	SDL_memcpy(bvh->nodes, gBuildNodes, nodesSize);
+	SDL_memcpy(bvh->triangles, gBuildTriangles, trisSize);
+
+	SafeDisposePtr((Ptr) gBuildCentroids);
+	SafeDisposePtr((Ptr) gBuildTriangles);
+	SafeDisposePtr((Ptr) gBuildNodes);
+	gBuildMesh = nil;
+
+	mo->bvh = bvh;
+}
+
+
+/********************** BUILD MESH BVH NODE ***************************/
+//
+// Makes a node for gBuildTriangles[first ... first+count-1], splitting them
+// at the middle of their centroids along the longest axis. Returns the node's index.
+//
+
+static int BuildMeshBVHNode(int first, int count, int depth)
+{
+int				nodeNum = gNumBuildNodes++;
+MeshBVHNode		*node = &gBuildNodes[nodeNum];
+float			cLo[3], cHi[3];
+
+			/* BOUND THE TRIANGLES & THEIR CENTROIDS */
+
+	for (int i = 0; i < 3; i++)
+	{
+		node->lo[i] = cLo[i] = 1e30f;
+		node->hi[i] = cHi[i] = -1e30f;
+	}
+
+	for (int k = first; k < first + count; k++)
+	{
+		uint32_t t = gBuildTriangles[k];
+		const float* c = &gBuildCentroids[t].x;
+
+		for (int v = 0; v < 3; v++)
+		{
+			const float* p = &gBuildMesh->points[gBuildMesh->triangles[t].vertexIndices[v]].x;
+
+			for (int i = 0; i < 3; i++)
+			{
+				node->lo[i] = GAME_MIN(node->lo[i], p[i]);
+				node->hi[i] = GAME_MAX(node->hi[i], p[i]);
+			}
+		}
+
+		for (int i = 0; i < 3; i++)
+		{
+			cLo[i] = GAME_MIN(cLo[i], c[i]);
+			cHi[i] = GAME_MAX(cHi[i], c[i]);
+		}
+	}
+
+			/* SMALL ENOUGH FOR A LEAF? */
+
+	if (count <= MESHBVH_LEAF_SIZE || depth >= MESHBVH_MAX_DEPTH)
+	{
+		node->first = first;
+		node->count = count;
+		return nodeNum;
+	}
+
+			/* SPLIT AT THE MIDDLE OF THE LONGEST AXIS */
+
+	int axis = 0;
+	for (int i = 1; i < 3; i++)
+	{
+		if (cHi[i] - cLo[i] > cHi[axis] - cLo[axis])
+			axis = i;
+	}
+
+	float split = (cLo[axis] + cHi[axis]) * .5f;
+	int lo = first;
+	int hi = first + count - 1;
+
+	while (lo <= hi)
+	{
+		if ((&gBuildCentroids[gBuildTriangles[lo]].x)[axis] < split)
+			lo++;
+		else
+		{
+			uint32_t t = gBuildTriangles[lo];
+			gBuildTriangles[lo] = gBuildTriangles[hi];
+			gBuildTriangles[hi] = t;
+			hi--;
+		}
+	}
+
+	int numLeft = lo - first;
+
+	if (numLeft == 0 || numLeft == count)							// all on one side (all the centroids are the same), so just halve them
+		numLeft = count / 2;
+
+			/* BUILD THE CHILDREN */
+			//
+			// The 1st child goes right after this node.
+			//
+
+	BuildMeshBVHNode(first, numLeft, depth + 1);
+	int second = BuildMeshBVHNode(first + numLeft, count - numLeft, depth + 1);
+
+	node = &gBuildNodes[nodeNum];
+	node->first = second;
+	node->count = 0;
+
+	return nodeNum;
+}
+
+
+#pragma mark -
+
+/********************** CALC MESH WORLD TO LOCAL ***************************/
+//
+// Inverts the rotation/scale part of the mesh's matrix. Also returns the
+// largest row sums of it and its inverse, to size the padding with.
+// Returns false if the matrix is singular or isn't finite.
+//
+
+static Boolean CalcMeshWorldToLocal(const OGLMatrix4x4* localToWorld, double m[3][3], double* normM, double* normInverse)
+{
+double	a[3][3];
+double	det;
+
+	a[0][0] = localToWorld->value[M00];	a[0][1] = localToWorld->value[M01];	a[0][2] = localToWorld->value[M02];
+	a[1][0] = localToWorld->value[M10];	a[1][1] = localToWorld->value[M11];	a[1][2] = localToWorld->value[M12];
+	a[2][0] = localToWorld->value[M20];	a[2][1] = localToWorld->value[M21];	a[2][2] = localToWorld->value[M22];
+
+	m[0][0] = a[1][1] * a[2][2] - a[1][2] * a[2][1];
+	m[0][1] = a[0][2] * a[2][1] - a[0][1] * a[2][2];
+	m[0][2] = a[0][1] * a[1][2] - a[0][2] * a[1][1];
+	m[1][0] = a[1][2] * a[2][0] - a[1][0] * a[2][2];
+	m[1][1] = a[0][0] * a[2][2] - a[0][2] * a[2][0];
+	m[1][2] = a[0][2] * a[1][0] - a[0][0] * a[1][2];
+	m[2][0] = a[1][0] * a[2][1] - a[1][1] * a[2][0];
+	m[2][1] = a[0][1] * a[2][0] - a[0][0] * a[2][1];
+	m[2][2] = a[0][0] * a[1][1] - a[0][1] * a[1][0];
+
+	det = a[0][0] * m[0][0] + a[0][1] * m[1][0] + a[0][2] * m[2][0];
+
+	if (!isfinite(det) || fabs(det) < 1e-30)
+		return false;
+
+	*normM = 0;
+	*normInverse = 0;
+
+	for (int i = 0; i < 3; i++)
+	{
+		double sumA = 0, sumM = 0;
+
+		for (int j = 0; j < 3; j++)
+		{
+			m[i][j] /= det;
+			sumA += fabs(a[i][j]);
+			sumM += fabs(m[i][j]);
+		}
+
+		*normM = GAME_MAX(*normM, sumA);
+		*normInverse = GAME_MAX(*normInverse, sumM);
+	}
+
+	return isfinite(*normInverse) && isfinite(*normM);
+}
+
+
+/********************** DOES RAY HIT MESH BVH NODE ***************************/
+//
+// Slab test against the node's box grown by pad.
+//
+
+static Boolean DoesRayHitMeshBVHNode(const MeshBVHNode* node, const float origin[3], const float invDir[3], float maxT, float pad)
+{
+	float tMin = 0.0f;
+	float tMax = maxT;
+
+	for (int i = 0; i < 3; i++)
+	{
+		float lo = node->lo[i] - pad;
+		float hi = node->hi[i] + pad;
+
+		if (invDir[i] == 0.0f)										// parallel to this slab
+		{
+			if (origin[i] < lo || origin[i] > hi)
+				return false;
+			continue;
+		}
+
+		float t1 = (lo - origin[i]) * invDir[i];
+		float t2 = (hi - origin[i]) * invDir[i];
+
+		if (t1 > t2)
+		{
+			float t = t1;
+			t1 = t2;
+			t2 = t;
+		}
+
+		if (t1 > tMin)
+			tMin = t1;
+		if (t2 < tMax)
+			tMax = t2;
+
+		if (tMin > tMax)
+			return false;
+	}
+
+	return true;
+}
+
+
+/********************** ADD MESH BVH TRIANGLES ***************************/
+
+static void AddMeshBVHTriangles(const MeshBVH* bvh, const MeshBVHNode* node, int* n)
+{
+	if (*n + node->count > gMaxMeshBVHTriangles)
+	{
+		int newMax = gMaxMeshBVHTriangles ? gMaxMeshBVHTriangles : 256;
+
+		while (newMax < *n + node->count)
+			newMax *= 2;
+
+		uint32_t* list = (uint32_t*) AllocPtrTagged(sizeof(uint32_t) * newMax, kMemTag_BG3D);
+
+		if (gMeshBVHTriangles)
+		{
+			SDL_memcpy(list, gMeshBVHTriangles, sizeof(uint32_t) * (*n));
+			SafeDisposePtr((Ptr) gMeshBVHTriangles);
+		}
+
+		gMeshBVHTriangles = list;
+		gMaxMeshBVHTriangles = newMax;
+	}
+
+	SDL_memcpy(&gMeshBVHTriangles[*n], &bvh->triangles[node->first], sizeof(uint32_t) * node->count);
+	*n += node->count;
+}
@@ -187,7 +187,7 @@ int					size;
 
 			/* ALLOC MEMORY FOR META OBJECT */
 			
-	mo = AllocPtr(size);	
+	mo = AllocPtrTagged(size, kMemTag_MetaObjects);	
 	if (mo == nil)
 		DoFatalAlert("AllocateEmptyMetaObject: AllocPtr failed!");
 
@@ -278,6 +278,7 @@ static void SetMetaObjectToVertexArrayGeometry(MOVertexArrayObject *geoObj, cons
 			/* INIT THE DATA */
 
 	geoObj->objectData = *data;									// copy from input data		
+	geoObj->bvh = nil;											// BG3D import builds this later
 
 		/* INCREASE MATERIAL REFERENCE COUNTS */
 
@@ -881,7 +882,7 @@ go_here:
 			SetColor4f(1,1,0,1);
 			for (i = 0; i < data->numPoints; i++)
 			{
-				glBegin(GL_LINES);
+				OGL_Begin(GL_LINES);
 		
 				glVertex3fv((GLfloat *)&data->points[i]);
 				glVertex3f(data->points[i].x + data->normals[i].x * 20.0f,
@@ -914,6 +915,7 @@ go_here:
 //	glUnlockArraysEXT();
 
 	gPolysThisFrame += data->numTriangles;					// inc poly counter
+	gDrawCallsThisFrame++;
 	
 	
 			/* CLEANUP */
@@ -1128,7 +1130,7 @@ float			cellWidth, cellHeight;
 	//MO_DrawMaterial(picData->materials[i++]);		// submit material #0
 	MO_DrawMaterial(picData->material);		// submit material #0
 
-	glBegin(GL_QUADS);				
+	OGL_Begin(GL_QUADS);				
 	glTexCoord2f(0,1);	glVertex3f(x, y + cellHeight,z);
 	glTexCoord2f(1,1);	glVertex3f(x + cellWidth, y + cellHeight,z);
 	glTexCoord2f(1,0);	glVertex3f(x + cellWidth, y,z);
@@ -1191,7 +1193,7 @@ OGLPoint2D			p[4];
 	
 			/* DRAW IT */
 			
-	glBegin(GL_QUADS);
+	OGL_Begin(GL_QUADS);
 	glTexCoord2f(0,0);	glVertex2f(p[0].x + x, p[0].y + y);
 	glTexCoord2f(1,0);	glVertex2f(p[1].x + x, p[1].y + y);
 	glTexCoord2f(1,1);	glVertex2f(p[2].x + x, p[2].y + y);
@@ -1262,6 +1264,7 @@ MOVertexArrayObject	*vObj;
 						case	MO_GEOMETRY_SUBTYPE_VERTEXARRAY:
 								vObj = obj;
 								MO_DeleteObjectInfo_Geometry_VertexArray(&vObj->objectData);
+								DisposeMeshBVH(vObj);
 								break;
 								
 						default:
@@ -1513,7 +1516,7 @@ int	i,n,s;
 	
 	if (inData->points)
 	{
-		outData->points = AllocPtr(s);
+		outData->points = AllocPtrTagged(s, kMemTag_MetaObjects);
 		if (outData->points == nil)
 			DoFatalAlert("MO_DuplicateVertexArrayData: AllocPtr failed!");
 		BlockMove(inData->points, outData->points, s);
@@ -1528,7 +1531,7 @@ int	i,n,s;
 	
 	if (inData->normals)
 	{
-		outData->normals = AllocPtr(s);
+		outData->normals = AllocPtrTagged(s, kMemTag_MetaObjects);
 		if (outData->normals == nil)
 			DoFatalAlert("MO_DuplicateVertexArrayData: AllocPtr failed!");
 		BlockMove(inData->normals, outData->normals, s);
@@ -1543,7 +1546,7 @@ int	i,n,s;
 	
 	if (inData->uvs[0])
 	{
-		outData->uvs[0] = AllocPtr(s);
+		outData->uvs[0] = AllocPtrTagged(s, kMemTag_MetaObjects);
 		if (outData->uvs[0] == nil)
 			DoFatalAlert("MO_DuplicateVertexArrayData: AllocPtr failed!");
 		BlockMove(inData->uvs[0], outData->uvs[0], s);
@@ -1558,7 +1561,7 @@ int	i,n,s;
 	
 	if (inData->colorsByte)
 	{
-		outData->colorsByte = AllocPtr(s);
+		outData->colorsByte = AllocPtrTagged(s, kMemTag_MetaObjects);
 		if (outData->colorsByte == nil)
 			DoFatalAlert("MO_DuplicateVertexArrayData: AllocPtr failed!");
 		BlockMove(inData->colorsByte, outData->colorsByte, s);
@@ -1573,7 +1576,7 @@ int	i,n,s;
 	
 	if (inData->colorsFloat)
 	{
-		outData->colorsFloat = AllocPtr(s);
+		outData->colorsFloat = AllocPtrTagged(s, kMemTag_MetaObjects);
 		if (outData->colorsFloat == nil)
 			DoFatalAlert("MO_DuplicateVertexArrayData: AllocPtr failed!");
 		BlockMove(inData->colorsFloat, outData->colorsFloat, s);
@@ -1589,7 +1592,7 @@ int	i,n,s;
 	
 	if (inData->triangles)
 	{
-		outData->triangles = AllocPtr(s);
+		outData->triangles = AllocPtrTagged(s, kMemTag_MetaObjects);
 		if (outData->triangles == nil)
 			DoFatalAlert("MO_DuplicateVertexArrayData: AllocPtr failed!");
 		BlockMove(inData->triangles, outData->triangles, s);
@@ -2,14 +2,26 @@
 #include <SDL3/SDL_opengl.h>
 
 #include "game.h"
+#include "ogl_functions.h"
 
-#ifndef __EMSCRIPTEN__
+#ifdef __EMSCRIPTEN__
+
+Boolean gOGLHaveBufferObjects = true;						// core in WebGL
+
+#else
 // On Emscripten/WebGL, glActiveTexture and glClientActiveTexture are available
 // as core or LEGACY_GL_EMULATION functions -- no proc-address lookup needed.
 // See ogl_functions.h for the Emscripten macro definitions.
 
 PFNGLACTIVETEXTUREARBPROC			procptr_glActiveTextureARB			= NULL;
 PFNGLCLIENTACTIVETEXTUREARBPROC		procptr_glClientActiveTextureARB	= NULL;
+PFNGLGENBUFFERSARBPROC				procptr_glGenBuffersARB				= NULL;
+PFNGLDELETEBUFFERSARBPROC			procptr_glDeleteBuffersARB			= NULL;
+PFNGLBINDBUFFERARBPROC				procptr_glBindBufferARB				= NULL;
+PFNGLBUFFERDATAARBPROC				procptr_glBufferDataARB				= NULL;
+PFNGLBUFFERSUBDATAARBPROC			procptr_glBufferSubDataARB			= NULL;
+
+Boolean gOGLHaveBufferObjects = false;
 
 void OGL_InitFunctions(void)
 {
@@ -18,6 +30,23 @@ void OGL_InitFunctions(void)
 
 	GAME_ASSERT(procptr_glActiveTextureARB);
 	GAME_ASSERT(procptr_glClientActiveTextureARB);
+
+			/* BUFFER OBJECTS ARE OPTIONAL */
+			//
+			// Without them, the terrain just keeps drawing from client-side arrays.
+			//
+
+	if (SDL_GL_ExtensionSupported("GL_ARB_vertex_buffer_object"))
+	{
+		procptr_glGenBuffersARB			= (PFNGLGENBUFFERSARBPROC) SDL_GL_GetProcAddress("glGenBuffersARB");
+		procptr_glDeleteBuffersARB		= (PFNGLDELETEBUFFERSARBPROC) SDL_GL_GetProcAddress("glDeleteBuffersARB");
+		procptr_glBindBufferARB			= (PFNGLBINDBUFFERARBPROC) SDL_GL_GetProcAddress("glBindBufferARB");
+		procptr_glBufferDataARB			= (PFNGLBUFFERDATAARBPROC) SDL_GL_GetProcAddress("glBufferDataARB");
+		procptr_glBufferSubDataARB		= (PFNGLBUFFERSUBDATAARBPROC) SDL_GL_GetProcAddress("glBufferSubDataARB");
+	}
+
+	gOGLHaveBufferObjects = procptr_glGenBuffersARB && procptr_glDeleteBuffersARB && procptr_glBindBufferARB
+							&& procptr_glBufferDataARB && procptr_glBufferSubDataARB;
 }
 
 #endif /* !__EMSCRIPTEN__ */
@@ -29,6 +29,7 @@ static void OGL_SetStyles(OGLSetupInputType *setupDefPtr);
 static void OGL_CreateLights(OGLLightDefType *lightDefPtr);
 static void OGL_InitFont(void);
 static void OGL_FreeFont(void);
+static void OGL_RestoreCap(GLenum cap, GLboolean wasEnabled, Boolean countToggles);
 
 static void	ConvertTextureToColorAnaglyph(void *imageMemory, short width, short height, GLint srcFormat, GLint dataType);
 static void	ConvertTextureToGrey(void *imageMemory, short width, short height, GLint srcFormat, GLint dataType);
@@ -89,6 +90,12 @@ int			gStateStackIndex = 0;
 int			gPolysThisFrame;
 int			gVRAMUsedThisFrame = 0;
 
+int			gDrawCallsThisFrame;						// glDrawElements calls
+int			gTextureBindsThisFrame;						// OGL_Texture_SetOpenGLTexture calls
+int			gStatePopsThisFrame;						// OGL_PopState calls...
+int			gStateTogglesThisFrame;						// ...and the capabilities they actually changed (see OGL_PopState)
+int			gImmediateBlocksThisFrame;					// glBegin/glEnd blocks
+
 Boolean		gMyState_Lighting;
 
 		/* PICKING */
@@ -495,9 +502,13 @@ void OGL_DrawScene(void (*drawRoutine)(void))
 
 	SDL_GL_MakeCurrent(gSDLWindow, gAGLContext);			// make context active
 
+	PROF_BEGIN(kProf_DrawScene);
+
 
 			/* INIT SOME STUFF */
 
+	PrepInterpolatedCamera();								// if drawing between two sim ticks
+
 	if (gGamePrefs.anaglyph)
 	{
 		gAnaglyphPass = 0;
@@ -513,6 +524,11 @@ void OGL_DrawScene(void (*drawRoutine)(void))
 			
 			
 	gPolysThisFrame 	= 0;										// init poly counter
+	gDrawCallsThisFrame = 0;										// init GL call counters
+	gTextureBindsThisFrame = 0;
+	gStatePopsThisFrame = 0;
+	gStateTogglesThisFrame = 0;
+	gImmediateBlocksThisFrame = 0;
 	gMostRecentMaterial = nil;
 	gGlobalMaterialFlags = 0;		
 	gGlobalTransparency = 1.0f;	
@@ -612,6 +628,9 @@ do_anaglyph:
 			glPolygonMode(GL_FRONT_AND_BACK ,GL_FILL);
 	}
 
+	if (GetNewKeyState(SDL_SCANCODE_F9))					// toggle profiler overlay
+		Prof_ToggleOverlay();
+
 	if ((GetKeyState(SDL_SCANCODE_LCTRL) || GetKeyState(SDL_SCANCODE_RCTRL)) && GetNewKeyState(SDL_SCANCODE_F11))	// Anisotropy
 	{
 		gDoAnisotropy = !gDoAnisotropy;	
@@ -640,6 +659,26 @@ do_anaglyph:
 		OGL_DrawInt(gPolysThisFrame, 100,y);
 		y += 15;
 
+		OGL_DrawString("draws:", 20,y);
+		OGL_DrawInt(gDrawCallsThisFrame, 100,y);
+		y += 15;
+
+		OGL_DrawString("tex binds:", 20,y);
+		OGL_DrawInt(gTextureBindsThisFrame, 100,y);
+		y += 15;
+
+		OGL_DrawString("pops:", 20,y);
+		OGL_DrawInt(gStatePopsThisFrame, 100,y);
+		y += 15;
+
+		OGL_DrawString("toggles:", 20,y);
+		OGL_DrawInt(gStateTogglesThisFrame, 100,y);
+		y += 15;
+
+		OGL_DrawString("glBegins:", 20,y);
+		OGL_DrawInt(gImmediateBlocksThisFrame, 100,y);
+		y += 15;
+
 
 #if 1							// show supertile status grid
 		{
@@ -668,6 +707,34 @@ do_anaglyph:
 		OGL_DrawInt((int) GetTerrainY(gPlayerInfo.coord.x, gPlayerInfo.coord.z), 100,y);
 		y += 15;
 
+				/* SUPERTILE CACHE: HIT % & BUILDS PER SECOND, OVER THE LAST SECOND */
+
+		{
+			static Uint64				lastSampleTime = 0;
+			static SuperTileCacheStats	lastSample;
+			static int					hitPercent = 0, buildsPerSecond = 0;
+			Uint64						now = SDL_GetTicks();
+
+			if (now - lastSampleTime >= 1000)
+			{
+				uint32_t	hits	= gSuperTileCacheStats.numHits - lastSample.numHits;
+				uint32_t	builds	= gSuperTileCacheStats.numBuilds - lastSample.numBuilds;
+
+				hitPercent		= (hits + builds) ? (int) (100 * hits / (hits + builds)) : 0;
+				buildsPerSecond	= lastSampleTime ? (int) (builds * 1000 / (now - lastSampleTime)) : 0;
+				lastSample		= gSuperTileCacheStats;
+				lastSampleTime	= now;
+			}
+
+			OGL_DrawString("st cache %:", 20,y);
+			OGL_DrawInt(hitPercent, 100,y);
+			y += 15;
+
+			OGL_DrawString("st builds/s:", 20,y);
+			OGL_DrawInt(buildsPerSecond, 100,y);
+			y += 15;
+		}
+
 		OGL_DrawString("vram kb:", 20,y);
 		OGL_DrawInt(gVRAMUsedThisFrame/1024, 100,y);
 		y += 15;
@@ -690,11 +757,42 @@ do_anaglyph:
 		OGL_DrawInt(gNumWaterDrawn, 100,y);
 		y += 15;
 
+		OGL_DrawString("load ms:", 20,y);
+		OGL_DrawInt((int) gLastLoadTimeMS, 100,y);
+		y += 15;
+
 		OGL_DrawString("pointers:", 20,y);
 		OGL_DrawInt(gNumPointers, 100,y);
+		y += 15;
+
+				/* MEMORY BY TAG: LIVE KB, PEAK KB, ALLOCS LAST FRAME */
+
+		for (int tag = 0; tag < NUM_MEMORY_TAGS; tag++)
+		{
+			const MemoryTagStats* stats = &gMemoryTagStats[tag];
+
+			if (stats->totalAllocs == 0)
+				continue;
+
+			OGL_DrawString(GetMemoryTagName(tag), 20,y);
+			OGL_DrawInt((int) (stats->liveBytes / 1024), 100,y);
+			OGL_DrawInt((int) (stats->peakBytes / 1024), 150,y);
+			OGL_DrawInt(stats->allocsLastFrame, 200,y);
+			y += 15;
+		}
+
+		OGL_DrawString("objnodes:", 20,y);
+		OGL_DrawInt(gObjNodePoolStats.numLive, 100,y);
+		OGL_DrawInt(gObjNodePoolStats.peakLive, 150,y);
+		OGL_DrawInt(gObjNodePoolStats.capacity, 200,y);
 		y += 15;
 	}
 
+	if (gProfilerOverlay)
+		Prof_DrawOverlay();
+
+	PROF_END(kProf_DrawScene);
+
 
             /**************/
 			/* END RENDER */
@@ -703,7 +801,12 @@ do_anaglyph:
            	
            /* SWAP THE BUFFS */
 
+	PROF_BEGIN(kProf_SwapWindow);
 	SDL_GL_SwapWindow(gSDLWindow);					// end render loop
+	PROF_END(kProf_SwapWindow);
+
+	Prof_EndFrame();
+	EndFrameMemoryTagStats();
 
 #ifdef __EMSCRIPTEN__
 	emscripten_sleep(0);							// yield to browser (required for ASYNCIFY)
@@ -713,7 +816,8 @@ do_anaglyph:
 	if (gGamePrefs.anaglyph)
 		RestoreCamerasFromAnaglyph();
 
-
+	RestoreCameraFromInterpolation();
+	gSimInterpolation = 1.0f;						// only the frame drawn right after the sim ticks is interpolated
 }
 
 
@@ -750,6 +854,8 @@ GLuint OGL_TextureMap_Load(void *imageMemory, int width, int height,
 							GLint srcFormat,  GLint destFormat, GLint dataType)
 {	
 GLuint	textureName;
+
+	LoadTime_Begin(kLoad_TextureMapLoad);
 								
 	if (gGamePrefs.anaglyph)
 	{
@@ -838,6 +944,8 @@ GLuint	textureName;
 
 	OGL_Texture_SetOpenGLTexture(textureName);
 
+	LoadTime_End(kLoad_TextureMapLoad);
+
 	return(textureName);
 }
 
@@ -1172,6 +1280,8 @@ void OGL_Texture_SetOpenGLTexture(GLuint textureName)
 	glBindTexture(GL_TEXTURE_2D, textureName);		
 	if (OGL_CheckError())
 		DoFatalAlert("OGL_Texture_SetOpenGLTexture: glBindTexture failed!");
+
+	gTextureBindsThisFrame++;
 	
 //	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);	// disable mipmaps & turn on filtering
 //	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -1447,6 +1557,25 @@ int	i;
 }
 
 
+/********************* RESTORE CAP **************************/
+//
+// Sets a capability back the way OGL_PushState found it, always, like
+// OGL_PopState used to.  If countToggles is set, it also asks GL whether
+// that's actually a change and counts it in gStateTogglesThisFrame.
+//
+
+static void OGL_RestoreCap(GLenum cap, GLboolean wasEnabled, Boolean countToggles)
+{
+	if (countToggles && (!glIsEnabled(cap) != !wasEnabled))
+		gStateTogglesThisFrame++;
+
+	if (wasEnabled)
+		glEnable(cap);
+	else
+		glDisable(cap);
+}
+
+
 /********************* POP STATE **************************/
 
 void OGL_PopState(void)
@@ -1467,42 +1596,35 @@ int		i;
 	if (i < 0)
 		DoFatalAlert("OGL_PopState: stack underflow!");
 
-	if (gStateStack_Lighting[i])
-		OGL_EnableLighting();
-	else
-		OGL_DisableLighting();
-
-
-	if (gStateStack_CullFace[i])
-		glEnable(GL_CULL_FACE);
-	else
-		glDisable(GL_CULL_FACE);
-
+	gStatePopsThisFrame++;
 
-	if (gStateStack_DepthTest[i])
-		glEnable(GL_DEPTH_TEST);
-	else
-		glDisable(GL_DEPTH_TEST);
+			/* RESTORE THE CAPABILITIES */
+			//
+			// Counting the toggles takes a glIsEnabled per capability, so that's
+			// only done while someone's looking at the counters.  Lighting has
+			// its own copy of the state, so that one's always counted.
+			//
 
-	if (gStateStack_Normalize[i])
-		glEnable(GL_NORMALIZE);
-	else
-		glDisable(GL_NORMALIZE);
+#if BENCHMARK
+	const Boolean countToggles = true;									// the bench logs them every frame
+#else
+	const Boolean countToggles = (gDebugMode > 0);						// the F8 stats are up
+#endif
 
-	if (gStateStack_Texture2D[i])
-		glEnable(GL_TEXTURE_2D);
-	else
-		glDisable(GL_TEXTURE_2D);
+	if (gStateStack_Lighting[i] != gMyState_Lighting)
+		gStateTogglesThisFrame++;
 
-	if (gStateStack_Blend[i])
-		glEnable(GL_BLEND);
+	if (gStateStack_Lighting[i])
+		OGL_EnableLighting();
 	else
-		glDisable(GL_BLEND);
+		OGL_DisableLighting();
 
-	if (gStateStack_Fog[i])
-		glEnable(GL_FOG);
-	else
-		glDisable(GL_FOG);
+	OGL_RestoreCap(GL_CULL_FACE, gStateStack_CullFace[i], countToggles);
+	OGL_RestoreCap(GL_DEPTH_TEST, gStateStack_DepthTest[i], countToggles);
+	OGL_RestoreCap(GL_NORMALIZE, gStateStack_Normalize[i], countToggles);
+	OGL_RestoreCap(GL_TEXTURE_2D, gStateStack_Texture2D[i], countToggles);
+	OGL_RestoreCap(GL_BLEND, gStateStack_Blend[i], countToggles);
+	OGL_RestoreCap(GL_FOG, gStateStack_Fog[i], countToggles);
 
 	glDepthMask(gStateStack_DepthMask[i]);
 	glBlendFunc(gStateStack_BlendSrc[i], gStateStack_BlendDst[i]);
@@ -18,6 +18,9 @@
 
 static Boolean OGL_RayGetHitInfo_DisplayGroup(OGLRay *ray, ObjNode *theNode, OGLPoint3D *worldHitCoord);
 static Boolean	OGL_DoesRayIntersectMesh(OGLRay *ray, MOVertexArrayData *mesh, OGLPoint3D *intersectionPt, float *distToIntersection);
+static Boolean	OGL_DoesRayIntersectModelMesh(OGLRay *ray, const ObjNodeWorldData *worldData, int meshNum, OGLPoint3D *intersectionPt, float *distToIntersection);
+static Boolean	RayTestModelMeshTriangles(const OGLRay *ray, const MOVertexArrayData *mesh, const OGLMatrix4x4 *localToWorld,
+										const uint32_t *triangles, int numTriangles, OGLPoint3D *intersectionPt, float *distToIntersection);
 
 static void OGLTriangle_3D2DComponentProjectionPoints(const OGLVector3D *triangleNormal,	const OGLPoint3D *point3D, const OGLPoint3D	*triPoints,
 													 OGLPoint2D *point2D, OGLPoint2D *verts2D);
@@ -38,19 +41,32 @@ static Boolean ObjectIsInFrontOfRay(ObjNode *theNode, OGLRay *ray);
 static Boolean OGL_DoesRayIntersectSphere(OGLRay *ray, OGLPoint3D *sphereCenter, float sphereRadius, OGLPoint3D *intersectPt);
 
 static Boolean	OGL_DoesLineSegIntersectMesh(MOVertexArrayData *mesh, OGLPoint3D *intersectionPt, float *distToIntersection);
-static Boolean	OGL_DoesLineSegIntersectMesh2(OGLPlaneEquation *planeEQ, MOVertexArrayData *mesh, OGLPoint3D *intersectionPt, float *distToIntersection);
+static Boolean	OGL_DoesLineSegIntersectModelMesh(const ObjNodeWorldData *worldData, int meshNum, OGLPoint3D *intersectionPt, float *distToIntersection);
+static Boolean	LineSegTestModelMeshTriangles(const MOVertexArrayData *mesh, const OGLMatrix4x4 *localToWorld,
+											const uint32_t *triangles, int numTriangles, OGLPoint3D *intersectionPt, float *distToIntersection);
+static void GetModelMeshWorldTriangle(const MOVertexArrayData *mesh, const OGLMatrix4x4 *localToWorld, int t, OGLPoint3D triPts[3]);
 static Boolean OGL_LineSegGetHitInfo_DisplayGroup(OGLPoint3D *p1, OGLPoint3D *p2, ObjNode *theNode, OGLPoint3D *worldHitCoord, float *distToHit);
 static void MO_LineSegTestMatrix(const MOMatrixObject *matObj);
 static void MO_LineSegTestGeometry_VertexArray(MOVertexArrayData *data);
 static void MO_LineSegTestGroup(const MOGroupObject *object);
 static void MO_LineSegTestObject(const MetaObjectPtr object);
 static Boolean	OGL_LineSegIntersectsTriangle(OGLPoint3D *trianglePoints, OGLPoint3D *intersectPt, float *distFromP1ToPlane);
-static Boolean	OGL_LineSegIntersectsTriangle2(OGLPlaneEquation *planeEQ, OGLPoint3D *trianglePoints, OGLPoint3D *intersectPt, float *distFromP1ToPlane);
 static Boolean OGL_DoesLineSegIntersectTrianglePlane(OGLPoint3D	triWorldPoints[], float *distFromP1ToPlane);
-static Boolean OGL_DoesLineSegIntersectTrianglePlane2(OGLPlaneEquation *planeEQ, float *distFromP1ToPlane);
 
 static Boolean OGL_PickAndGetHitInfo_Skeleton(OGLRay *ray, ObjNode *theNode, OGLPoint3D *worldHitCoord);
 
+static ObjNode *OGL_DoRayCollision_Scan(OGLRay *ray, OGLPoint3D *worldHitCoord, uint32_t statusFilter, uint32_t cTypes);
+static ObjNode *OGL_DoRayCollision_Tree(OGLRay *ray, OGLPoint3D *worldHitCoord, uint32_t statusFilter, uint32_t cTypes);
+static ObjNode *OGL_DoRayCollision_Verify(OGLRay *ray, OGLPoint3D *worldHitCoord, uint32_t statusFilter, uint32_t cTypes);
+static void RayTestObject(OGLRay *ray, ObjNode *thisNodePtr, uint32_t statusFilter, uint32_t cTypes,
+						ObjNode **bestObj, float *bestDist, OGLPoint3D *worldHitCoord);
+
+static ObjNode *OGL_DoLineSegmentCollision_Scan(OGLPoint3D *p1, OGLPoint3D *p2, OGLPoint3D *worldHitCoord, uint32_t cTypes);
+static ObjNode *OGL_DoLineSegmentCollision_Tree(OGLPoint3D *p1, OGLPoint3D *p2, OGLPoint3D *worldHitCoord, uint32_t cTypes);
+static ObjNode *OGL_DoLineSegmentCollision_Verify(OGLPoint3D *p1, OGLPoint3D *p2, OGLPoint3D *worldHitCoord, uint32_t cTypes);
+static void LineSegTestObject(OGLPoint3D *p1, OGLPoint3D *p2, ObjNode *thisNodePtr, uint32_t cTypes,
+							ObjNode **bestObj, float *bestDist, OGLPoint3D *worldHitCoord);
+
 /****************************/
 /*    CONSTANTS             */
 /****************************/
@@ -81,73 +97,50 @@ static OGLVector3D	gBestTriangleNormal;
 //			worldHitCoord = world-space coords of the pick intersection
 //			ray->distance = distance from ray origin to the intersection point
 //
+// The objects to test come from the ray tree (see RayTree.c) in object list order,
+// so we pick the same object as if we'd scanned the whole object list.
+// With gVerifyRayTree, we do both and make sure of it.
+//
 
 ObjNode *OGL_DoRayCollision(OGLRay *ray, OGLPoint3D *worldHitCoord, uint32_t statusFilter, uint32_t cTypes)
 {
+ObjNode		*bestObj;
+
+	PROF_BEGIN(kProf_OGL_DoRayCollision);
+
+	if (gVerifyRayTree)
+		bestObj = OGL_DoRayCollision_Verify(ray, worldHitCoord, statusFilter, cTypes);
+	else
+	if (gRayTreeDisabled)
+		bestObj = OGL_DoRayCollision_Scan(ray, worldHitCoord, statusFilter, cTypes);
+	else
+		bestObj = OGL_DoRayCollision_Tree(ray, worldHitCoord, statusFilter, cTypes);
+
+	PROF_END(kProf_OGL_DoRayCollision);
+	return(bestObj);
+}
+
+
+/**************** OGL: DO RAY COLLISION: SCAN ************************/
+//
+// Brute force: tests every object in the list up to SLOT_OF_DUMB.
+//
+
+static ObjNode *OGL_DoRayCollision_Scan(OGLRay *ray, OGLPoint3D *worldHitCoord, uint32_t statusFilter, uint32_t cTypes)
+{
 ObjNode		*thisNodePtr;
 ObjNode		*bestObj = nil;
 float		bestDist = 100000000;
-OGLPoint3D	hitPt;
 
 	thisNodePtr = gFirstNodePtr;
 	
 	do
 	{
-				/* VERIFY NODE */
-			
 		if (thisNodePtr->Slot >= SLOT_OF_DUMB)								// stop here
 			break;
-			
-		if (thisNodePtr->StatusBits & statusFilter)	//(STATUS_BIT_ISCULLED | STATUS_BIT_HIDDEN))		// only check on visible objects
-			goto next;				
-		if (thisNodePtr->CType == INVALID_NODE_FLAG)									// make sure the node is even valid
-			goto next;
-						
-		if (thisNodePtr->CType & cTypes)							// only if pickable
-		{
-					/* IF THE PICK RAY HITS THE OBJECT'S BOUNDING SPHERE THEN SEE IF WE HIT THE GEOMETRY */
-				
-			if (OGL_DoesRayIntersectSphere(ray, &thisNodePtr->Coord, thisNodePtr->BoundingSphereRadius, nil))					
-			{
-			
-						/* NOW PARSE THE OBJNODE AND DO RAY-TRIANGLE TESTS TO SEE WHERE WE HIT */
-
-				switch(thisNodePtr->Genre)
-				{		
-					case	SKELETON_GENRE:		
-							if (OGL_PickAndGetHitInfo_Skeleton(ray, thisNodePtr, &hitPt))		// does ray intersect skeleton?
-							{
-								if (ray->distance < bestDist)								// is this the best hit so far?
-								{
-									bestDist = ray->distance;
-									bestObj = thisNodePtr;
-									*worldHitCoord = hitPt;
-								}
-							}
-							break;
-
-					case	DISPLAY_GROUP_GENRE:		
-							if (OGL_RayGetHitInfo_DisplayGroup(ray, thisNodePtr, &hitPt))	// does ray hit display group geometry?
-							{
-								if (ray->distance < bestDist)								// is this the best hit so far?
-								{
-									bestDist = ray->distance;
-									bestObj = thisNodePtr;
-									*worldHitCoord = hitPt;
-								}
-							}
-							break;
-							
-					case	CUSTOM_GENRE:													// ignore this or do custom handling
-							break;
-							
-					default:
-							DoFatalAlert("OGL_DoRayCollision: unsupported genre");
-				}
-			}		
-		}
 
-next:
+		RayTestObject(ray, thisNodePtr, statusFilter, cTypes, &bestObj, &bestDist, worldHitCoord);
+
 		thisNodePtr = thisNodePtr->NextNode;														// next node
 	}
 	while (thisNodePtr != nil);
@@ -158,6 +151,120 @@ next:
 }
 
 
+/**************** OGL: DO RAY COLLISION: TREE ************************/
+//
+// Only tests the objects whose leaves in the ray tree the ray passes thru.
+//
+
+static ObjNode *OGL_DoRayCollision_Tree(OGLRay *ray, OGLPoint3D *worldHitCoord, uint32_t statusFilter, uint32_t cTypes)
+{
+ObjNode		**candidates;
+int			numCandidates;
+ObjNode		*bestObj = nil;
+float		bestDist = 100000000;
+
+	numCandidates = GatherRayTreeCandidates(&ray->origin, &ray->direction, RAYTREE_INFINITE_RAY,
+											cTypes, statusFilter, &candidates);
+
+	for (int i = 0; i < numCandidates; i++)
+		RayTestObject(ray, candidates[i], statusFilter, cTypes, &bestObj, &bestDist, worldHitCoord);
+
+	ray->distance = bestDist;								// return the best distance in the ray
+
+	return(bestObj);
+}
+
+
+/**************** OGL: DO RAY COLLISION: VERIFY ************************/
+//
+// Runs the query both ways and stops if they don't agree.
+//
+
+static ObjNode *OGL_DoRayCollision_Verify(OGLRay *ray, OGLPoint3D *worldHitCoord, uint32_t statusFilter, uint32_t cTypes)
+{
+OGLRay		scanRay = *ray;
+OGLPoint3D	scanHitCoord = *worldHitCoord;
+ObjNode		*scanObj, *treeObj;
+
+	scanObj = OGL_DoRayCollision_Scan(&scanRay, &scanHitCoord, statusFilter, cTypes);
+	treeObj = OGL_DoRayCollision_Tree(ray, worldHitCoord, statusFilter, cTypes);
+
+	if (scanObj != treeObj
+		|| scanRay.distance != ray->distance
+		|| (treeObj && SDL_memcmp(&scanHitCoord, worldHitCoord, sizeof(OGLPoint3D)) != 0))
+	{
+		DoFatalAlert("OGL_DoRayCollision: ray tree picked %p (dist %g), scan picked %p (dist %g)",
+					(void*) treeObj, ray->distance, (void*) scanObj, scanRay.distance);
+	}
+
+	gRayTreeStats.numVerified++;
+	return(treeObj);
+}
+
+
+/**************** RAY TEST OBJECT ************************/
+//
+// Tests one object against the pick ray, and if it's a closer hit than
+// bestDist then it becomes bestObj.
+//
+
+static void RayTestObject(OGLRay *ray, ObjNode *thisNodePtr, uint32_t statusFilter, uint32_t cTypes,
+						ObjNode **bestObj, float *bestDist, OGLPoint3D *worldHitCoord)
+{
+OGLPoint3D	hitPt;
+
+			/* VERIFY NODE */
+
+	if (thisNodePtr->StatusBits & statusFilter)	//(STATUS_BIT_ISCULLED | STATUS_BIT_HIDDEN))		// only check on visible objects
+		return;				
+	if (thisNodePtr->CType == INVALID_NODE_FLAG)									// make sure the node is even valid
+		return;
+					
+	if (!(thisNodePtr->CType & cTypes))							// only if pickable
+		return;
+
+			/* IF THE PICK RAY HITS THE OBJECT'S BOUNDING SPHERE THEN SEE IF WE HIT THE GEOMETRY */
+				
+	if (!OGL_DoesRayIntersectSphere(ray, &thisNodePtr->Coord, thisNodePtr->BoundingSphereRadius, nil))					
+		return;
+
+			/* NOW PARSE THE OBJNODE AND DO RAY-TRIANGLE TESTS TO SEE WHERE WE HIT */
+
+	switch(thisNodePtr->Genre)
+	{		
+		case	SKELETON_GENRE:		
+				if (OGL_PickAndGetHitInfo_Skeleton(ray, thisNodePtr, &hitPt))		// does ray intersect skeleton?
+				{
+					if (ray->distance < *bestDist)								// is this the best hit so far?
+					{
+						*bestDist = ray->distance;
+						*bestObj = thisNodePtr;
+						*worldHitCoord = hitPt;
+					}
+				}
+				break;
+
+		case	DISPLAY_GROUP_GENRE:		
+				if (OGL_RayGetHitInfo_DisplayGroup(ray, thisNodePtr, &hitPt))	// does ray hit display group geometry?
+				{
+					if (ray->distance < *bestDist)								// is this the best hit so far?
+					{
+						*bestDist = ray->distance;
+						*bestObj = thisNodePtr;
+						*worldHitCoord = hitPt;
+					}
+				}
+				break;
+				
+		case	CUSTOM_GENRE:													// ignore this or do custom handling
+				break;
+				
+		default:
+				DoFatalAlert("OGL_DoRayCollision: unsupported genre");
+	}
+}
+
+
 /**************************** OBJECT IS IN FRONT OF RAY ****************************/
 
 static Boolean ObjectIsInFrontOfRay(ObjNode *theNode, OGLRay *ray)
@@ -572,6 +679,110 @@ float		bestDist = 10000000;
 }
 
 
+/******************* OGL:  DOES RAY INTERSECT MODEL MESH ***************************/
+//
+// Same as above, but for one of a display group's meshes, which are in model space.
+// If the mesh has a BVH, only the triangles in the BVH leaves that the ray passes thru
+// get tested (see MeshBVH.c), otherwise they all do. With gVerifyMeshBVH, we do both
+// and make sure that they agree.
+//
+
+static Boolean	OGL_DoesRayIntersectModelMesh(OGLRay *ray, const ObjNodeWorldData *worldData, int meshNum, OGLPoint3D *intersectionPt, float *distToIntersection)
+{
+const MOVertexArrayObject	*mo = worldData->meshes[meshNum];
+const OGLMatrix4x4			*localToWorld = &worldData->localToWorld[meshNum];
+const uint32_t				*triangles = nil;
+int							numTriangles = -1;
+Boolean						gotHit;
+
+	if (mo->bvh && !gMeshBVHDisabled)
+		numTriangles = GatherMeshBVHTriangles(mo->bvh, localToWorld, &ray->origin, &ray->direction, RAYTREE_INFINITE_RAY, &triangles);
+
+	gotHit = RayTestModelMeshTriangles(ray, &mo->objectData, localToWorld, triangles, numTriangles, intersectionPt, distToIntersection);
+
+			/* CHECK AGAINST TESTING EVERY TRIANGLE */
+
+	if (gVerifyMeshBVH && numTriangles >= 0)
+	{
+		OGLPoint3D	allPt = *intersectionPt;
+		float		allDist;
+		Boolean		allHit = RayTestModelMeshTriangles(ray, &mo->objectData, localToWorld, nil, -1, &allPt, &allDist);
+
+		if (allHit != gotHit
+			|| SDL_memcmp(&allDist, distToIntersection, sizeof(float)) != 0
+			|| SDL_memcmp(&allPt, intersectionPt, sizeof(OGLPoint3D)) != 0)
+		{
+			DoFatalAlert("OGL_DoesRayIntersectModelMesh: BVH got %d (dist %g), all triangles got %d (dist %g)",
+						gotHit, *distToIntersection, allHit, allDist);
+		}
+
+		gMeshBVHStats.numVerified++;
+	}
+
+	return(gotHit);
+}
+
+
+/******************* RAY TEST MODEL MESH TRIANGLES ***************************/
+//
+// Tests the given triangles of the mesh (or all of them if triangles is nil),
+// brought into world space, against the ray, the same way as OGL_DoesRayIntersectMesh.
+// Equally close hits go to the lowest numbered triangle, as if they'd been tested in order.
+//
+
+static Boolean	RayTestModelMeshTriangles(const OGLRay *ray, const MOVertexArrayData *mesh, const OGLMatrix4x4 *localToWorld,
+										const uint32_t *triangles, int numTriangles, OGLPoint3D *intersectionPt, float *distToIntersection)
+{
+OGLRay		testRay = *ray;											// the triangle tests write the distance into the ray
+OGLPoint3D	triPts[3];
+OGLPoint3D	thisCoord;
+Boolean		gotHit = false;
+float		bestDist = 10000000;
+int			bestTriangle = -1;
+
+	if (!triangles)
+		numTriangles = mesh->numTriangles;
+
+	for (int k = 0; k < numTriangles; k++)
+	{
+		int t = triangles ? (int) triangles[k] : k;
+
+		GetModelMeshWorldTriangle(mesh, localToWorld, t, triPts);
+
+				/* DOES OUR RAY HIT IT? */
+				
+		if (OGL_RayIntersectsTriangle(&triPts[0], &testRay, &thisCoord))
+		{
+			if (testRay.distance < bestDist
+				|| (bestTriangle >= 0 && testRay.distance == bestDist && t < bestTriangle))
+			{
+				bestDist = testRay.distance;
+				bestTriangle = t;
+				*intersectionPt = thisCoord;
+			}
+			gotHit = true;
+		}
+	}
+		
+	*distToIntersection = bestDist;
+	return(gotHit);
+}
+
+
+/******************* GET MODEL MESH WORLD TRIANGLE ***************************/
+
+static void GetModelMeshWorldTriangle(const MOVertexArrayData *mesh, const OGLMatrix4x4 *localToWorld, int t, OGLPoint3D triPts[3])
+{
+OGLPoint3D	localPts[3];
+
+	localPts[0] = mesh->points[mesh->triangles[t].vertexIndices[0]];
+	localPts[1] = mesh->points[mesh->triangles[t].vertexIndices[1]];
+	localPts[2] = mesh->points[mesh->triangles[t].vertexIndices[2]];
+
+	OGLPoint3D_TransformArray(localPts, localToWorld, triPts, 3);
+}
+
+
 #pragma mark -
 
 /*************** OGL: GET WORLD RAY AT SCREEN POINT *********************/
@@ -807,7 +1018,7 @@ float 	xComp, yComp, zComp;
 /******************** OGL: PICK AND GET HIT INFO: DISPLAY GROUP *********************/
 //
 // Called from above when we know we've picked a Display Group genre objNode.
-// Now we just need to traverse the Base Group, transform the data to world-space, and and see if our pick ray hits anything.
+// Now we just need to go thru the meshes in the Base Group and see if our pick ray hits anything.
 // Then we keep track of the closest hit coord and that's what we'll return.
 //
 
@@ -815,26 +1026,26 @@ static Boolean OGL_RayGetHitInfo_DisplayGroup(OGLRay *ray, ObjNode *theNode, OGL
 {
 int	i;
 float	distToHit;
+const ObjNodeWorldData	*worldData;
 
 	gPickRay 		= *ray;	
 	gClosestHitDist = 10000000;
 	gGotAHit 		= false;
 
 
-		/* MAKE SURE WE HAVE WORLD-SPACE DATA FOR THIS OBJNODE */
+		/* GET WHERE THIS OBJNODE'S MESHES ARE */
 			
-	if (!theNode->HasWorldPoints)
-		CalcDisplayGroupWorldPoints(theNode);
+	worldData = GetDisplayGroupWorldData(theNode);
 
 
 
-			/* SCAN THRU OBJNODE'S WORLD-SPACE DATA FOR A HIT */
+			/* SCAN THRU OBJNODE'S MESHES FOR A HIT */
 			
-	for (i = 0; i < MAX_OBJECTS_IN_GROUP; i++)
+	for (i = 0; i < worldData->numMeshes; i++)
 	{
-		if (theNode->WorldMeshes[i].points)														// does this mesh exist?
+		if (worldData->meshes[i]->objectData.points)									// does this mesh exist?
 		{
-			if (OGL_DoesRayIntersectMesh(ray, &theNode->WorldMeshes[i], worldHitCoord, &distToHit))// does the ray hit this mesh?
+			if (OGL_DoesRayIntersectModelMesh(ray, worldData, i, worldHitCoord, &distToHit))	// does the ray hit this mesh?
 			{
 				if (distToHit < gClosestHitDist)												// is this the closest hit so far?
 				{
@@ -1010,99 +1221,175 @@ OGLPoint3D		hitPt;
 //			worldHitCoord = world-space coords of the pick intersection
 //			ray->distance = distance from ray origin to the intersection point
 //
+// Like OGL_DoRayCollision, the objects to test come from the ray tree.
+//
 
 ObjNode *OGL_DoLineSegmentCollision(OGLPoint3D *p1, OGLPoint3D *p2, OGLPoint3D *worldHitCoord, OGLVector3D *worldHitFaceNormal, uint32_t cTypes)
 {
+ObjNode		*bestObj;
+
+	if (gVerifyRayTree)
+		bestObj = OGL_DoLineSegmentCollision_Verify(p1, p2, worldHitCoord, cTypes);
+	else
+	if (gRayTreeDisabled)
+		bestObj = OGL_DoLineSegmentCollision_Scan(p1, p2, worldHitCoord, cTypes);
+	else
+		bestObj = OGL_DoLineSegmentCollision_Tree(p1, p2, worldHitCoord, cTypes);
+
+	if (bestObj)
+		*worldHitFaceNormal = gBestTriangleNormal;
+
+	return(bestObj);
+}
+
+
+/**************** OGL: DO LINE SEGMENT COLLISION: SCAN ************************/
+
+static ObjNode *OGL_DoLineSegmentCollision_Scan(OGLPoint3D *p1, OGLPoint3D *p2, OGLPoint3D *worldHitCoord, uint32_t cTypes)
+{
 ObjNode		*thisNodePtr;
 ObjNode		*bestObj = nil;
 float		bestDist = 100000000;
-OGLPoint3D	hitPt;
-
-
 
 	thisNodePtr = gFirstNodePtr;
 	
 	do
 	{
-				/* VERIFY NODE */
-	
 		if (thisNodePtr->Slot >= SLOT_OF_DUMB)								// stop here
 			break;
-			
-		if (thisNodePtr->CType == INVALID_NODE_FLAG)						// make sure the node is even valid
-			goto next;
 
-		if (thisNodePtr->StatusBits & STATUS_BIT_HIDDEN)					// skip it if hidden
-			goto next;
-						
-		if (thisNodePtr->CType & cTypes)									// only if pickable
-		{		
-		
-					/* IF THE LINE SEG HITS THE OBJECT'S BOUNDING SPHERE THEN SEE IF WE HIT THE GEOMETRY */
-				
-			if (OGL_DoesLineSegmentIntersectSphere(p1, p2, nil, &thisNodePtr->Coord, thisNodePtr->BoundingSphereRadius, nil))					
-			{
-				float	hitDist;
-							
-						/* NOW PARSE THE OBJNODE AND DO TRIANGLE TESTS TO SEE WHERE WE HIT */
+		LineSegTestObject(p1, p2, thisNodePtr, cTypes, &bestObj, &bestDist, worldHitCoord);
 
-				switch(thisNodePtr->Genre)
-				{
-					case	SKELETON_GENRE:		
-							if (OGL_LineSegGetHitInfo_Skeleton(p1, p2, thisNodePtr, &hitPt, &hitDist))		// does ray intersect skeleton?
-							{
-								if (hitDist < bestDist)								// is this the best hit so far?
-								{
-									bestDist = hitDist;
-									bestObj = thisNodePtr;
-									*worldHitCoord = hitPt;
-								}
-							}
-							break;
-				
-					case	DISPLAY_GROUP_GENRE:		
-							if (OGL_LineSegGetHitInfo_DisplayGroup(p1, p2, thisNodePtr, &hitPt, &hitDist))	// does line seg hit display group geometry?
-							{
-								if (hitDist < bestDist)						// is this the best hit so far?
-								{
-									bestDist = hitDist;
-									bestObj = thisNodePtr;
-									*worldHitCoord = hitPt;
-								}
-							}
-							break;
-							
-					case	CUSTOM_GENRE:									// ignore this or do custom handling
-							break;
-							
-					default:
-							DoFatalAlert("OGL_DoLineSegmentCollision: unsupported genre");
-				}
-			}		
-		}
-
-next:
 		thisNodePtr = thisNodePtr->NextNode;								// next node
 	}
 	while (thisNodePtr != nil);
 
-	if (bestObj)
-		*worldHitFaceNormal = gBestTriangleNormal;
+	return(bestObj);
+}
+
+
+/**************** OGL: DO LINE SEGMENT COLLISION: TREE ************************/
+
+static ObjNode *OGL_DoLineSegmentCollision_Tree(OGLPoint3D *p1, OGLPoint3D *p2, OGLPoint3D *worldHitCoord, uint32_t cTypes)
+{
+ObjNode		**candidates;
+int			numCandidates;
+ObjNode		*bestObj = nil;
+float		bestDist = 100000000;
+OGLVector3D	segment;
+
+	OGLPoint3D_Subtract(p2, p1, &segment);
+
+	numCandidates = GatherRayTreeCandidates(p1, &segment, 1.0f, cTypes, STATUS_BIT_HIDDEN, &candidates);
+
+	for (int i = 0; i < numCandidates; i++)
+		LineSegTestObject(p1, p2, candidates[i], cTypes, &bestObj, &bestDist, worldHitCoord);
 
 	return(bestObj);
 }
 
 
+/**************** OGL: DO LINE SEGMENT COLLISION: VERIFY ************************/
+
+static ObjNode *OGL_DoLineSegmentCollision_Verify(OGLPoint3D *p1, OGLPoint3D *p2, OGLPoint3D *worldHitCoord, uint32_t cTypes)
+{
+OGLPoint3D	scanHitCoord = *worldHitCoord;
+OGLVector3D	scanNormal;
+ObjNode		*scanObj, *treeObj;
+
+	scanObj = OGL_DoLineSegmentCollision_Scan(p1, p2, &scanHitCoord, cTypes);
+	scanNormal = gBestTriangleNormal;
+
+	treeObj = OGL_DoLineSegmentCollision_Tree(p1, p2, worldHitCoord, cTypes);
+
+	if (scanObj != treeObj
+		|| (treeObj && SDL_memcmp(&scanHitCoord, worldHitCoord, sizeof(OGLPoint3D)) != 0)
+		|| (treeObj && SDL_memcmp(&scanNormal, &gBestTriangleNormal, sizeof(OGLVector3D)) != 0))
+	{
+		DoFatalAlert("OGL_DoLineSegmentCollision: ray tree hit %p, scan hit %p", (void*) treeObj, (void*) scanObj);
+	}
+
+	gRayTreeStats.numVerified++;
+	return(treeObj);
+}
+
+
+/**************** LINE SEG TEST OBJECT ************************/
+//
+// Tests one object against the line segment, and if it's a closer hit than
+// bestDist then it becomes bestObj.
+//
+
+static void LineSegTestObject(OGLPoint3D *p1, OGLPoint3D *p2, ObjNode *thisNodePtr, uint32_t cTypes,
+							ObjNode **bestObj, float *bestDist, OGLPoint3D *worldHitCoord)
+{
+OGLPoint3D	hitPt;
+float		hitDist;
+
+			/* VERIFY NODE */
+
+	if (thisNodePtr->CType == INVALID_NODE_FLAG)						// make sure the node is even valid
+		return;
+
+	if (thisNodePtr->StatusBits & STATUS_BIT_HIDDEN)					// skip it if hidden
+		return;
+					
+	if (!(thisNodePtr->CType & cTypes))									// only if pickable
+		return;
+
+			/* IF THE LINE SEG HITS THE OBJECT'S BOUNDING SPHERE THEN SEE IF WE HIT THE GEOMETRY */
+				
+	if (!OGL_DoesLineSegmentIntersectSphere(p1, p2, nil, &thisNodePtr->Coord, thisNodePtr->BoundingSphereRadius, nil))					
+		return;
+
+			/* NOW PARSE THE OBJNODE AND DO TRIANGLE TESTS TO SEE WHERE WE HIT */
+
+	switch(thisNodePtr->Genre)
+	{
+		case	SKELETON_GENRE:		
+				if (OGL_LineSegGetHitInfo_Skeleton(p1, p2, thisNodePtr, &hitPt, &hitDist))		// does ray intersect skeleton?
+				{
+					if (hitDist < *bestDist)								// is this the best hit so far?
+					{
+						*bestDist = hitDist;
+						*bestObj = thisNodePtr;
+						*worldHitCoord = hitPt;
+					}
+				}
+				break;
+	
+		case	DISPLAY_GROUP_GENRE:		
+				if (OGL_LineSegGetHitInfo_DisplayGroup(p1, p2, thisNodePtr, &hitPt, &hitDist))	// does line seg hit display group geometry?
+				{
+					if (hitDist < *bestDist)						// is this the best hit so far?
+					{
+						*bestDist = hitDist;
+						*bestObj = thisNodePtr;
+						*worldHitCoord = hitPt;
+					}
+				}
+				break;
+				
+		case	CUSTOM_GENRE:									// ignore this or do custom handling
+				break;
+				
+		default:
+				DoFatalAlert("OGL_DoLineSegmentCollision: unsupported genre");
+	}
+}
+
+
 /******************** OGL: PICK AND GET HIT INFO: DISPLAY GROUP *********************/
 //
 // Called from above when we know we've picked a Display Group genre objNode.
-// Now we just need to traverse the Base Group, transform the data to world-space, and and see if our pick ray hits anything.
+// Now we just need to go thru the meshes in the Base Group and see if our line segment hits anything.
 // Then we keep track of the closest hit coord and that's what we'll return.
 //
 
 static Boolean OGL_LineSegGetHitInfo_DisplayGroup(OGLPoint3D *p1, OGLPoint3D *p2, ObjNode *theNode, OGLPoint3D *worldHitCoord, float *distToHit)
 {
 int		i;
+const ObjNodeWorldData	*worldData;
 
 		/* CREATE A GLOBAL RAY */
 		
@@ -1118,21 +1405,20 @@ int		i;
 	gGotAHit 		= false;
 	
 	
-		/* MAKE SURE WE HAVE WORLD-SPACE DATA FOR THIS OBJNODE */
+		/* GET WHERE THIS OBJNODE'S MESHES ARE */
 			
-	if (!theNode->HasWorldPoints)
-		CalcDisplayGroupWorldPoints(theNode);
+	worldData = GetDisplayGroupWorldData(theNode);
 
 	
 #if 1
 
-			/* SCAN THRU OBJNODE'S WORLD-SPACE DATA FOR A HIT */
+			/* SCAN THRU OBJNODE'S MESHES FOR A HIT */
 			
-	for (i = 0; i < MAX_OBJECTS_IN_GROUP; i++)
+	for (i = 0; i < worldData->numMeshes; i++)
 	{
-		if (theNode->WorldMeshes[i].points)														// does this mesh exist?
+		if (worldData->meshes[i]->objectData.points)									// does this mesh exist?
 		{
-			if (OGL_DoesLineSegIntersectMesh2(theNode->WorldPlaneEQs[i], &theNode->WorldMeshes[i], worldHitCoord, distToHit))// does the line segment hit this mesh?
+			if (OGL_DoesLineSegIntersectModelMesh(worldData, i, worldHitCoord, distToHit))	// does the line segment hit this mesh?
 			{
 				if (*distToHit < gClosestHitDist)												// is this the closest hit so far?
 				{
@@ -1362,54 +1648,105 @@ float		distFromP1ToPlane;
 }
 
 
-/******************* OGL:  DOES LINE SEGMENT INTERSECT MESH 2***************************/
+/******************* OGL:  DOES LINE SEGMENT INTERSECT MODEL MESH ***************************/
 //
-// Same as above, but also takes an PlaneEQ array
+// Same as above, but for one of a display group's meshes, which are in model space.
+// If the mesh has a BVH, only the triangles in the BVH leaves that the segment passes thru
+// get tested (see MeshBVH.c), otherwise they all do. With gVerifyMeshBVH, we do both
+// and make sure that they agree.
 //
 
+static Boolean	OGL_DoesLineSegIntersectModelMesh(const ObjNodeWorldData *worldData, int meshNum, OGLPoint3D *intersectionPt, float *distToIntersection)
+{
+const MOVertexArrayObject	*mo = worldData->meshes[meshNum];
+const OGLMatrix4x4			*localToWorld = &worldData->localToWorld[meshNum];
+const uint32_t				*triangles = nil;
+int							numTriangles = -1;
+Boolean						gotHit;
+
+	if (mo->bvh && !gMeshBVHDisabled)
+	{
+		OGLVector3D	segment;
+
+		OGLPoint3D_Subtract(&gP2, &gP1, &segment);
+		numTriangles = GatherMeshBVHTriangles(mo->bvh, localToWorld, &gP1, &segment, 1.0f, &triangles);
+	}
+
+	gotHit = LineSegTestModelMeshTriangles(&mo->objectData, localToWorld, triangles, numTriangles, intersectionPt, distToIntersection);
+
+			/* CHECK AGAINST TESTING EVERY TRIANGLE */
+
+	if (gVerifyMeshBVH && numTriangles >= 0)
+	{
+		OGLVector3D	normal = gBestTriangleNormal;
+		OGLPoint3D	allPt = *intersectionPt;
+		float		allDist;
+		Boolean		allHit = LineSegTestModelMeshTriangles(&mo->objectData, localToWorld, nil, -1, &allPt, &allDist);
+
+		if (allHit != gotHit
+			|| SDL_memcmp(&allDist, distToIntersection, sizeof(float)) != 0
+			|| SDL_memcmp(&allPt, intersectionPt, sizeof(OGLPoint3D)) != 0
+			|| SDL_memcmp(&normal, &gBestTriangleNormal, sizeof(OGLVector3D)) != 0)
+		{
+			DoFatalAlert("OGL_DoesLineSegIntersectModelMesh: BVH got %d (dist %g), all triangles got %d (dist %g)",
+						gotHit, *distToIntersection, allHit, allDist);
+		}
+
+		gMeshBVHStats.numVerified++;
+	}
+
+	return(gotHit);
+}
+
 
-static Boolean	OGL_DoesLineSegIntersectMesh2(OGLPlaneEquation *planeEQ, MOVertexArrayData *mesh, OGLPoint3D *intersectionPt, float *distToIntersection)
+/******************* LINE SEG TEST MODEL MESH TRIANGLES ***************************/
+//
+// Tests the given triangles of the mesh (or all of them if triangles is nil),
+// brought into world space, against the global segment, the same way as
+// OGL_DoesLineSegIntersectMesh. Equally close hits go to the lowest numbered
+// triangle, as if they'd been tested in order.
+//
+
+static Boolean	LineSegTestModelMeshTriangles(const MOVertexArrayData *mesh, const OGLMatrix4x4 *localToWorld,
+											const uint32_t *triangles, int numTriangles, OGLPoint3D *intersectionPt, float *distToIntersection)
 {
-int			numTriangles = mesh->numTriangles;
-int			t,i;
 OGLPoint3D	triPts[3];
 OGLPoint3D	thisCoord;
+OGLVector3D	bestNormal;
 Boolean		gotHit = false;
 float		bestDist = 10000000;
 float		distFromP1ToPlane;
+int			bestTriangle = -1;
 
-			/***************************/
-			/* SCAN THRU ALL TRIANGLES */
-			/***************************/
-			
-	for (t = 0; t < numTriangles; t++)
+	if (!triangles)
+		numTriangles = mesh->numTriangles;
+
+	for (int k = 0; k < numTriangles; k++)
 	{
-				/* GET TRIANGLE POINTS */
-				
-		i = mesh->triangles[t].vertexIndices[0];
-		triPts[0] = mesh->points[i];
-		
-		i = mesh->triangles[t].vertexIndices[1];
-		triPts[1] = mesh->points[i];
-		
-		i = mesh->triangles[t].vertexIndices[2];
-		triPts[2] = mesh->points[i];
+		int t = triangles ? (int) triangles[k] : k;
 
-				/* DOES OUR RAY HIT IT? */
+		GetModelMeshWorldTriangle(mesh, localToWorld, t, triPts);
+
+				/* DOES OUR SEGMENT HIT IT? */
 				
-		if (OGL_LineSegIntersectsTriangle2(&planeEQ[t], &triPts[0], &thisCoord, &distFromP1ToPlane))
+		if (OGL_LineSegIntersectsTriangle(&triPts[0], &thisCoord, &distFromP1ToPlane))
 		{
-			if (distFromP1ToPlane < bestDist)							// is this hit closer than any previous hit?
+			if (distFromP1ToPlane < bestDist
+				|| (bestTriangle >= 0 && distFromP1ToPlane == bestDist && t < bestTriangle))
 			{
 				bestDist = distFromP1ToPlane;
-				gBestTriangleNormal = planeEQ[t].normal;				// keep the best face normal that we've hit
-				*intersectionPt = thisCoord;							// pass back this intersection point since it's the best so far
+				bestTriangle = t;
+				bestNormal = gRecentPlaneEq.normal;
+				*intersectionPt = thisCoord;
 			}
 			gotHit = true;
 		}
 	}
+
+	if (bestTriangle >= 0)
+		gBestTriangleNormal = bestNormal;							// keep the best face normal that we've hit
 		
-	*distToIntersection = bestDist;									// pass back the best distance that we found (if any)
+	*distToIntersection = bestDist;
 	return(gotHit);
 }
 
@@ -1441,36 +1778,6 @@ static Boolean	OGL_LineSegIntersectsTriangle(OGLPoint3D *trianglePoints, OGLPoin
 }
 
 
-/******************** OGL: LINE SEGMENT INTERSECTS TRIANGLE 2************************/
-//
-// This version is passed the plane EQ
-//
-
-static Boolean	OGL_LineSegIntersectsTriangle2(OGLPlaneEquation *planeEQ, OGLPoint3D *trianglePoints, OGLPoint3D *intersectPt, float *distFromP1ToPlane)
-{
-	 
-	 			/* SEE IF RAY INTERSECTS THE TRIANGLE'S PLANE */
-	 			
-	if (OGL_DoesLineSegIntersectTrianglePlane2(planeEQ, distFromP1ToPlane))
-	{
-					/* CALC INTERSECTION POINT ON PLANE */
-					
-		intersectPt->x = gP1.x + gPickRay.direction.x * *distFromP1ToPlane;
-		intersectPt->y = gP1.y + gPickRay.direction.y * *distFromP1ToPlane;
-		intersectPt->z = gP1.z + gPickRay.direction.z * *distFromP1ToPlane;
-
-
-				/* IS THE INTERSECTION PT INSIDE THE TRIANGLE? */
-					
-		if (OGLPoint3D_InsideTriangle3D(intersectPt, trianglePoints, &gRecentPlaneEq.normal))
-			return (true);
-	}
-
-	return (false);
-
-}
-
-
 
 //******************** OGL: DOES LINE SEGMENT INTERSECT TRIANGLE PLANE ***********************/
 //
@@ -1527,61 +1834,6 @@ float	nx, ny, nz, oneOverDotD;
 	return (true);
 }
 
-//******************** OGL: DOES LINE SEGMENT INTERSECT TRIANGLE PLANE 2 ***********************/
-//
-// Returns true if the global line data intersects the plane of the triangle.
-//
-// NOTE:  this only works for DIRECTIONAL line segments!!!  Line segments which go from P1 to P2.
-//		Line segments which intersect from P2 to P1 will not return a valid hit.
-//
-
-static Boolean OGL_DoesLineSegIntersectTrianglePlane2(OGLPlaneEquation *planeEQ, float *distFromP1ToPlane)
-{
-float	nDotD, nDotO,t;
-float	nx, ny, nz, oneOverDotD;
-
-	gRecentPlaneEq = *planeEQ;										// keep global copy for later use
-	
-	nx = planeEQ->normal.x;
-	ny = planeEQ->normal.y;
-	nz = planeEQ->normal.z;
-
-
-			/* IS PARALLEL TO OR BEHIND PLANE? */
-				
-	nDotD = EmVector3D_Member_Dot(nx, ny, nz, gPickRay.direction);		// calc dot between normal and the line ray
-	if (nDotD >= EPS)													// if ray is pointing away from plane then bail since we're not interested in rays hitting the triangle from behind
-		return (false);
-
-	oneOverDotD = -1.0f / nDotD;										// let's calculate the -1/d since we use it twice
-
-			/* SEE IF RAY FROM P1 HITS IT */
-			
-	nDotO = EmVector3D_Member_Dot(nx, ny, nz, gP1);
-	t = (planeEQ->constant + nDotO) * oneOverDotD;
-	if (t < 0.0f)
-		return(false);		
-
-	*distFromP1ToPlane = t;
-
-
-		/* IF P2 ALSO HITS THEN BOTH PTS ARE ON SAME SIDE OF PLANE, THUS NO INTERSECT */
-		//
-		// We know that the vector from p1 intersects the plane, but if the same vector from p2
-		// also hits the plane then both endpoints were in front of the plane.  The line segment
-		// can only be intersecting the plane if each endpoint is on opposite sides.
-		//
-			
-	nDotO = EmVector3D_Member_Dot(nx, ny, nz, gP2);
-	t = (planeEQ->constant + nDotO) * oneOverDotD;
-	if (t >= 0.0f)
-		return(false);
-
-
-	return (true);
-}
-
-
 
 
 
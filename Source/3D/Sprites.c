@@ -179,6 +179,8 @@ MOMaterialData	matData;
 		return;
 	}
 
+	LoadTime_Begin(kLoad_LoadSpriteGroup);
+
 	gNumSpritesInGroupList[groupNum] = kSpriteCollections[groupNum].numSprites;
 
 		/* ALLOCATE MEMORY FOR SPRITE RECORDS */
@@ -233,6 +235,8 @@ MOMaterialData	matData;
 		if (gSpriteGroupList[groupNum][i].materialObject == nil)
 			DoFatalAlert("LoadSpriteFile: MO_CreateNewObjectOfType failed");
 	}
+
+	LoadTime_End(kLoad_LoadSpriteGroup);
 }
 
 
@@ -413,7 +417,7 @@ void DrawSprite(int	group, int type, float x, float y, float scale, float rot, u
 
 			/* DRAW IT */
 			
-	glBegin(GL_QUADS);
+	OGL_Begin(GL_QUADS);
 	glTexCoord2f(0,1);	glVertex2f(x, y);
 	glTexCoord2f(1,1);	glVertex2f(x+scale, y);
 	glTexCoord2f(1,0);	glVertex2f(x+scale, y+scale);
@@ -489,6 +493,10 @@ float				scale,x;
 
 	newObj->NumStringSprites = 0;											// no sprites in there yet
 
+	size_t maxSprites = SDL_strlen(cstr);									// 1 sprite per letter at most
+	GAME_ASSERT_MESSAGE(maxSprites <= 255, "String is too long!");			// NumStringSprites is a Byte
+	newObj->StringCharacters = (MOSpriteObject **)AllocPtrTagged(sizeof(MOSpriteObject*) * SDL_max(maxSprites, 1), kMemTag_ObjNodes);
+
 
 			/* ADJUST FOR CENTERING */
 			
@@ -533,7 +541,7 @@ float				scale,x;
 
 				/* ATTACH META OBJECT TO OBJNODE */
 		
-		GAME_ASSERT_MESSAGE(newObj->NumStringSprites < sizeof(newObj->StringCharacters) / sizeof(newObj->StringCharacters[0]), "String is too long!");
+		GAME_ASSERT(newObj->NumStringSprites < maxSprites);
 
 		newObj->StringCharacters[newObj->NumStringSprites++] = spriteMO;
 
@@ -95,6 +95,8 @@ MetaObjectHeader	*header;
 MOGroupObject		*group;
 MOGroupData			*data;
 
+	LoadTime_Begin(kLoad_ImportBG3D);
+
 			/* INIT SOME VARIABLES */
 
 	gBG3D_CurrentMaterialObj 	= nil;
@@ -118,6 +120,21 @@ MOGroupData			*data;
 	FSClose(refNum);
 	
 
+		/****************************************/
+		/* BUILD THE TRIANGLE BVH'S FOR PICKING */
+		/****************************************/
+		//
+		// Skeletons are skinned, so their meshes get tested in world space instead.
+		//
+
+	if (groupNum < MODEL_GROUP_SKELETONBASE)
+	{
+		LoadTime_Begin(kLoad_BuildMeshBVHs);
+		BuildMeshBVHs(gBG3D_CurrentContainer->root);
+		LoadTime_End(kLoad_BuildMeshBVHs);
+	}
+
+
 		/*********************************************/
 		/* PRELOAD ALL TEXTURE MATERIALS INTO OPENGL */
 		/*********************************************/
@@ -160,6 +177,8 @@ MOGroupData			*data;
 	}
 	
 	gNumObjectsInBG3DGroupList[groupNum] = data->numObjectsInGroup;
+
+	LoadTime_End(kLoad_ImportBG3D);
 }
 
 
@@ -404,7 +423,7 @@ MOMaterialData	*data;
 						
 	count = textureHeader.bufferSize;			// get size of buffer to load
 	
-	texturePixels = AllocPtr(count);			// alloc memory for buffer
+	texturePixels = AllocPtrTagged(count, kMemTag_BG3D);			// alloc memory for buffer
 	if (texturePixels == nil)
 		DoFatalAlert("ReadMaterialTextureMap: AllocPtr failed");
 
@@ -585,7 +604,7 @@ OGLPoint3D			*pointList;
 	numPoints = data->numPoints;									// get # points to expect to read
 			
 	count = sizeof(OGLPoint3D) * numPoints;							// calc size of data to read
-	pointList = AllocPtr(count);									// alloc buffer to hold points
+	pointList = AllocPtrTagged(count, kMemTag_BG3D);									// alloc buffer to hold points
 	if (pointList == nil)
 		DoFatalAlert("ReadVertexArray: AllocPtr failed!");
 	
@@ -609,7 +628,7 @@ OGLVector3D			*normalList;
 	numPoints = data->numPoints;									// get # normals to expect to read
 			
 	count = sizeof(OGLVector3D) * numPoints;						// calc size of data to read
-	normalList = AllocPtr(count);									// alloc buffer to hold normals
+	normalList = AllocPtrTagged(count, kMemTag_BG3D);									// alloc buffer to hold normals
 	if (normalList == nil)
 		DoFatalAlert("ReadNormalArray: AllocPtr failed!");
 	
@@ -633,7 +652,7 @@ OGLTextureCoord		*uvList;
 	numPoints = data->numPoints;									// get # uv's to expect to read
 
 	count = sizeof(OGLTextureCoord) * numPoints;					// calc size of data to read
-	uvList = AllocPtr(count);										// alloc buffer to hold uv's
+	uvList = AllocPtrTagged(count, kMemTag_BG3D);										// alloc buffer to hold uv's
 	if (uvList == nil)
 		DoFatalAlert("ReadUVArray: AllocPtr failed!");
 	
@@ -658,7 +677,7 @@ OGLColorRGBA		*colorsF;
 	numPoints = data->numPoints;									// get # colors to expect to read
 
 	count = sizeof(OGLColorRGBA_Byte) * numPoints;					// calc size of data to read
-	colorList = AllocPtr(count);									// alloc buffer to hold data
+	colorList = AllocPtrTagged(count, kMemTag_BG3D);									// alloc buffer to hold data
 	if (colorList == nil)
 		DoFatalAlert("ReadVertexColorArray: AllocPtr failed!");
 	
@@ -672,7 +691,7 @@ OGLColorRGBA		*colorsF;
 		// it is faster to render with Bytes if no lighting, but faster with floats if doing lights
 		//
 			
-	colorsF = AllocPtr(sizeof(OGLColorRGBA) * numPoints);		
+	colorsF = AllocPtrTagged(sizeof(OGLColorRGBA) * numPoints, kMemTag_BG3D);		
 	if (colorsF == nil)
 		DoFatalAlert("ReadVertexColorArray: AllocPtr failed!");
 	
@@ -702,7 +721,7 @@ MOTriangleIndecies	*triList;
 	numTriangles = data->numTriangles;								// get # triangles expect to read
 
 	count = sizeof(MOTriangleIndecies) * numTriangles;				// calc size of data to read
-	triList = AllocPtr(count);										// alloc buffer to hold data
+	triList = AllocPtrTagged(count, kMemTag_BG3D);										// alloc buffer to hold data
 	if (triList == nil)
 		DoFatalAlert("ReadTriangleArray: AllocPtr failed!");
 	
@@ -744,7 +763,7 @@ static void InitBG3DContainer(void)
 {
 MOGroupObject	*rootGroup;
 
-	gBG3D_CurrentContainer = AllocPtr(sizeof(BG3DFileContainer));
+	gBG3D_CurrentContainer = AllocPtrTagged(sizeof(BG3DFileContainer), kMemTag_BG3D);
 	if (gBG3D_CurrentContainer == nil)
 		DoFatalAlert("InitBG3DContainer: AllocPtr failed!");
 
@@ -810,7 +829,7 @@ void				*pixels;
 			else				
 			if ((matData->pixelSrcFormat == GL_RGB) && (matData->pixelDstFormat == GL_RGB5_A1))	// see if convert 24 to 16-bit
 			{
-				uint16_t	*buff = (uint16_t *)AllocPtr(w*h*2);				// alloc buff for 16-bit texture
+				uint16_t	*buff = (uint16_t *)AllocPtrTagged(w*h*2, kMemTag_BG3D);				// alloc buff for 16-bit texture
 							
 				ConvertTexture24To16(pixels, buff, w, h);
 				matData->textureName[0] = OGL_TextureMap_Load( buff, w, h, GL_BGRA, GL_RGBA, GL_UNSIGNED_SHORT_1_5_5_5_REV); // load 16 as 16
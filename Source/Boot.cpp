@@ -85,6 +85,82 @@ static void Boot(int argc, char** argv)
 	SDL_SetLogPriorities(SDL_LOG_PRIORITY_INFO);
 #endif
 
+#if BENCHMARK
+	if (!Bench_ParseCommandLine(argc, argv))
+	{
+		throw std::runtime_error("Usage: BillyFrontierBench [--frames N] [--tickrate HZ] [--seed N] [--area N]... [--replay FILE] [--trace FILE] [--loadreport FILE] [--load-all] [--churn N] [--raycast N] [--verify-collision]");
+	}
+
+	// Run headless unless the caller picked specific drivers via SDL_VIDEO_DRIVER/SDL_AUDIO_DRIVER
+	SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+	SDL_SetHint(SDL_HINT_AUDIO_DRIVER, "dummy");
+#endif
+
+#if !BENCHMARK
+	bool recordInput = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		// Check every CollisionDetect & ray query against the brute force scan (slow)
+		if (0 == SDL_strcmp(argv[i], "--verify-collision"))
+		{
+			gVerifyCollisionGrid = true;
+			gVerifyRayTree = true;
+			gVerifyMeshBVH = true;
+			gVerifyFenceGrid = true;
+			gVerifyWaterTiles = true;
+			gVerifyTerrainPlanes = true;
+			gVerifySuperTilePrefetch = true;
+			gVerifySuperTileCache = true;
+			gVerifySuperTileBuffers = true;
+		}
+	}
+
+	for (int i = 1; i + 1 < argc; i++)
+	{
+		// Optional fixed-timestep sim, decoupled from the render rate
+		if (0 == SDL_strcmp(argv[i], "--simrate"))
+		{
+			gSimTickRate = SDL_max(0.0f, (float) SDL_atof(argv[++i]));
+		}
+		// Jump straight into an area
+		else if (0 == SDL_strcmp(argv[i], "--level"))
+		{
+			gDirectLaunchLevel = SDL_atoi(argv[++i]);
+		}
+		// Record the input of the --level area, or play a recording back
+		else if (0 == SDL_strcmp(argv[i], "--record"))
+		{
+			if (!Replay_OpenForRecording(argv[++i]))
+				throw std::runtime_error("Couldn't create the --record file.");
+			recordInput = true;
+		}
+		else if (0 == SDL_strcmp(argv[i], "--replay"))
+		{
+			if (!Replay_OpenForPlayback(argv[++i]))
+				throw std::runtime_error("Couldn't read the --replay file.");
+			gDirectLaunchLevel = Replay_GetPlaybackArea();
+		}
+		// Dump profiler zones to a Chrome trace_event JSON file
+		else if (0 == SDL_strcmp(argv[i], "--trace"))
+		{
+			if (!Prof_StartTrace(argv[++i]))
+				throw std::runtime_error("Couldn't create the --trace file.");
+		}
+		// Append each load-time report to a JSON lines file
+		else if (0 == SDL_strcmp(argv[i], "--loadreport"))
+		{
+			if (!LoadTime_OpenReportFile(argv[++i]))
+				throw std::runtime_error("Couldn't open the --loadreport file.");
+		}
+	}
+
+	if (recordInput && gDirectLaunchLevel < 0)
+	{
+		throw std::runtime_error("--record needs --level N.");
+	}
+#endif
+
 	// Start our "machine"
 	Pomme::Init();
 
@@ -97,7 +173,7 @@ static void Boot(int argc, char** argv)
 
 #ifdef __EMSCRIPTEN__
 	// Parse URL hash parameters for level editor integration.
-	// Supported params: #level=N  and  #terrain=/path/to/file.ter
+	// Supported params: #level=N, #terrain=/path/to/file.ter and #simrate=HZ
 	// Example: billyfrontier.html#level=1&terrain=/Data/Terrain/custom.ter
 	char hashBuf[512] = {0};
 	int hashLen = EM_ASM_INT({
@@ -132,6 +208,10 @@ static void Boot(int argc, char** argv)
 				{
 					SDL_strlcpy(gDirectTerrainPath, val, sizeof(gDirectTerrainPath));
 				}
+				else if (SDL_strcmp(key, "simrate") == 0)
+				{
+					gSimTickRate = SDL_max(0.0f, (float) SDL_atof(val));
+				}
 			}
 			pair = SDL_strtok_r(nullptr, "&", &saveptr);
 		}
@@ -164,10 +244,15 @@ retryVideo:
 		SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, 1 << gCurrentAntialiasingLevel);
 	}
 
+	SDL_WindowFlags windowFlags = SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | SDL_WINDOW_HIGH_PIXEL_DENSITY;
+#if BENCHMARK
+	windowFlags |= SDL_WINDOW_HIDDEN;
+#endif
+
 	gSDLWindow = SDL_CreateWindow(
 			GAME_FULL_NAME " " GAME_VERSION,
 			640, 480,
-			SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | SDL_WINDOW_HIGH_PIXEL_DENSITY);
+			windowFlags);
 
 	if (!gSDLWindow)
 	{
@@ -200,6 +285,9 @@ static void Shutdown()
 	// Always restore the user's mouse acceleration before exiting.
 	// SetMacLinearMouse(false);
 
+	Prof_StopTrace();
+	LoadTime_CloseReportFile();
+
 	Pomme::Shutdown();
 
 	if (gSDLWindow)
@@ -18,6 +18,7 @@
 
 static void DeleteParticleGroup(long groupNum);
 static void MoveParticleGroups(ObjNode *theNode);
+static void CollideParticleWithTerrain(ParticleGroupType *pg, int p, uint32_t flags, float terrainY, const OGLVector3D *normal);
 
 static void DrawParticleGroup(ObjNode *theNode);
 static void MoveBlobDroplet(ObjNode *theNode);
@@ -45,6 +46,10 @@ ParticleGroupType	*gParticleGroups[MAX_PARTICLE_GROUPS];
 
 static float	gGravitoidDistBuffer[MAX_PARTICLES][MAX_PARTICLES];
 
+static Byte			gGroundCheckParticles[MAX_PARTICLES];			// particles in a group waiting on their terrain lookup
+static float		gGroundCheckX[MAX_PARTICLES], gGroundCheckZ[MAX_PARTICLES], gGroundCheckY[MAX_PARTICLES];
+static OGLVector3D	gGroundCheckNormals[MAX_PARTICLES];
+
 NewParticleGroupDefType	gNewParticleGroupDef;
 
 short			gNumActiveParticleGroups = 0;
@@ -194,7 +199,7 @@ MOTriangleIndecies		*t;
 		{
 				/* ALLOCATE NEW GROUP */
 				
-			gParticleGroups[i] = (ParticleGroupType *)AllocPtr(sizeof(ParticleGroupType));
+			gParticleGroups[i] = (ParticleGroupType *)AllocPtrTagged(sizeof(ParticleGroupType), kMemTag_Particles);
 			if (gParticleGroups[i] == nil)
 				return(-1);									// out of memory
 
@@ -228,12 +233,12 @@ MOTriangleIndecies		*t;
 
 			vertexArrayData.numPoints 		= 0;
 			vertexArrayData.numTriangles 	= 0;
-			vertexArrayData.points 			= (OGLPoint3D *)AllocPtr(sizeof(OGLPoint3D) * MAX_PARTICLES * 4);
+			vertexArrayData.points 			= (OGLPoint3D *)AllocPtrTagged(sizeof(OGLPoint3D) * MAX_PARTICLES * 4, kMemTag_Particles);
 			vertexArrayData.normals 		= nil;
-			vertexArrayData.uvs[0]	 		= (OGLTextureCoord *)AllocPtr(sizeof(OGLTextureCoord) * MAX_PARTICLES * 4);
-			vertexArrayData.colorsByte 		= (OGLColorRGBA_Byte *)AllocPtr(sizeof(OGLColorRGBA_Byte) * MAX_PARTICLES * 4);
+			vertexArrayData.uvs[0]	 		= (OGLTextureCoord *)AllocPtrTagged(sizeof(OGLTextureCoord) * MAX_PARTICLES * 4, kMemTag_Particles);
+			vertexArrayData.colorsByte 		= (OGLColorRGBA_Byte *)AllocPtrTagged(sizeof(OGLColorRGBA_Byte) * MAX_PARTICLES * 4, kMemTag_Particles);
 			vertexArrayData.colorsFloat		= nil;
-			vertexArrayData.triangles		= (MOTriangleIndecies *)AllocPtr(sizeof(MOTriangleIndecies) * MAX_PARTICLES * 2);
+			vertexArrayData.triangles		= (MOTriangleIndecies *)AllocPtrTagged(sizeof(MOTriangleIndecies) * MAX_PARTICLES * 2, kMemTag_Particles);
 						
 	
 					/* INIT UV ARRAYS */
@@ -344,6 +349,9 @@ float		y,baseScale,oneOverBaseScaleSquared,gravity;
 float		decayRate,magnetism,fadeRate;
 OGLPoint3D	*coord;
 OGLVector3D	*delta;
+int			numGroundChecks;
+
+	PROF_BEGIN(kProf_MoveParticleGroups);
 
 	(void) theNode;
 
@@ -360,6 +368,7 @@ OGLVector3D	*delta;
 			flags 		= gParticleGroups[i]->flags;
 			
 			n = 0;															// init counter
+			numGroundChecks = 0;
 			for (p = 0; p < MAX_PARTICLES; p++)
 			{
 				if (!gParticleGroups[i]->isUsed[p])							// make sure this particle is used
@@ -478,43 +487,27 @@ OGLVector3D	*delta;
 				/*****************/
 				/* SEE IF BOUNCE */
 				/*****************/
+				//
+				// Gravitoids pull on each other, so later particles need to see
+				// this one's bounce right away. Everything else gets queued up
+				// and looked up in one batch after the loop.
+				//
 
 				if (!(flags & PARTICLE_FLAGS_DONTCHECKGROUND))
 				{
-					y = GetTerrainY(coord->x, coord->z)+10.0f;					// get terrain coord at particle x/z
-					
-					if (flags & PARTICLE_FLAGS_BOUNCE)
+					if (gParticleGroups[i]->type == PARTICLE_TYPE_GRAVITOIDS)
 					{
-						if (delta->y < 0.0f)									// if moving down, see if hit floor
-						{
-							if (coord->y < y)
-							{
-								coord->y = y;
-								delta->y *= -.4f;
-								
-								delta->x += gRecentTerrainNormal.x * 300.0f;	// reflect off of surface
-								delta->z += gRecentTerrainNormal.z * 300.0f;
-								
-								if (flags & PARTICLE_FLAGS_DISPERSEIFBOUNCE)	// see if disperse on impact
-								{
-									delta->y *= .4f;
-									delta->x *= 5.0f;
-									delta->z *= 5.0f;								
-								}
-							}
-						}
-					}
-
-					/***************/
-					/* SEE IF GONE */
-					/***************/
+						OGLVector3D	normal;
 
+						GetTerrainYBatch(1, &coord->x, &coord->z, &y, &normal);
+						CollideParticleWithTerrain(gParticleGroups[i], p, flags, y, &normal);
+					}
 					else
-					{				
-						if (coord->y < y)									// if hit floor then nuke particle
-						{
-							gParticleGroups[i]->isUsed[p] = false;				
-						}
+					{
+						gGroundCheckParticles[numGroundChecks] = p;
+						gGroundCheckX[numGroundChecks] = coord->x;
+						gGroundCheckZ[numGroundChecks] = coord->z;
+						numGroundChecks++;
 					}
 				}					
 					
@@ -531,6 +524,18 @@ OGLVector3D	*delta;
 				if (gParticleGroups[i]->alpha[p] <= 0.0f)					// see if gone
 					gParticleGroups[i]->isUsed[p] = false;				
 					
+			}
+
+				/* DO THE QUEUED GROUND CHECKS */
+
+			if (numGroundChecks > 0)
+			{
+				OGLVector3D	*normals = (flags & PARTICLE_FLAGS_BOUNCE) ? gGroundCheckNormals : nil;	// only bounces need the normal
+
+				GetTerrainYBatch(numGroundChecks, gGroundCheckX, gGroundCheckZ, gGroundCheckY, normals);
+
+				for (j = 0; j < numGroundChecks; j++)
+					CollideParticleWithTerrain(gParticleGroups[i], gGroundCheckParticles[j], flags, gGroundCheckY[j], normals ? &normals[j] : nil);
 			}
 			
 				/* SEE IF GROUP WAS EMPTY, THEN DELETE */
@@ -541,6 +546,56 @@ OGLVector3D	*delta;
 			}
 		}
 	}
+
+	PROF_END(kProf_MoveParticleGroups);
+}
+
+
+/**************** COLLIDE PARTICLE WITH TERRAIN *********************/
+//
+// Bounces or kills particle p depending on the group's flags.
+// normal is only needed for bouncing groups.
+//
+
+static void CollideParticleWithTerrain(ParticleGroupType *pg, int p, uint32_t flags, float terrainY, const OGLVector3D *normal)
+{
+OGLPoint3D	*coord = &pg->coord[p];
+OGLVector3D	*delta = &pg->delta[p];
+float		y = terrainY + 10.0f;
+
+	if (flags & PARTICLE_FLAGS_BOUNCE)
+	{
+		if (delta->y < 0.0f)									// if moving down, see if hit floor
+		{
+			if (coord->y < y)
+			{
+				coord->y = y;
+				delta->y *= -.4f;
+				
+				delta->x += normal->x * 300.0f;					// reflect off of surface
+				delta->z += normal->z * 300.0f;
+				
+				if (flags & PARTICLE_FLAGS_DISPERSEIFBOUNCE)	// see if disperse on impact
+				{
+					delta->y *= .4f;
+					delta->x *= 5.0f;
+					delta->z *= 5.0f;								
+				}
+			}
+		}
+	}
+
+		/***************/
+		/* SEE IF GONE */
+		/***************/
+
+	else
+	{				
+		if (coord->y < y)										// if hit floor then nuke particle
+		{
+			pg->isUsed[p] = false;				
+		}
+	}
 }
 
 
@@ -555,6 +610,8 @@ OGLPoint3D		v[4],*camCoords,*coord;
 static const OGLVector3D up = {0,1,0};
 OGLBoundingBox	bbox;
 
+	PROF_BEGIN(kProf_DrawParticleGroup);
+
 	(void) theNode;
 
 	v[0].z = 												// init z's to 0
@@ -716,6 +773,8 @@ OGLBoundingBox	bbox;
 				
 	OGL_PopState();
 	SetColor4f(1,1,1,1);										// reset this
+
+	PROF_END(kProf_DrawParticleGroup);
 }
 
 
@@ -1845,7 +1904,7 @@ OGLPoint3D	verts[4];
 
 			/* DRAW QUAD */
 
-	glBegin(GL_QUADS);
+	OGL_Begin(GL_QUADS);
 	glTexCoord2f(0.00f, 0.00f);		glVertex3fv(&verts[0].x);
 	glTexCoord2f(0.99f, 0.00f);		glVertex3fv(&verts[1].x);
 	glTexCoord2f(0.99f, 0.99f);		glVertex3fv(&verts[2].x);
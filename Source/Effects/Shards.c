@@ -57,6 +57,9 @@ static 	long		gShardDensity;
 static 	OGLMatrix4x4	gWorkMatrix;
 static 	ObjNode		*gShardSrcObj;
 
+static	short		gMovedShards[MAX_SHARDS];						// shards moved this frame & their terrain lookups
+static	float		gMovedShardX[MAX_SHARDS], gMovedShardZ[MAX_SHARDS], gMovedShardTerrainY[MAX_SHARDS];
+
 /************************* INIT SHARD SYSTEM ***************************/
 
 void InitShardSystem(void)
@@ -358,7 +361,8 @@ OGLPoint3D			origin;
 
 void MoveShards(ObjNode *theNode)
 {
-float	ty,y,fps,x,z;
+float	fps;
+int		numMoved = 0;
 
 	(void) theNode;
 
@@ -390,15 +394,28 @@ float	ty,y,fps,x,z;
 		else
 			gShards[i].coordDelta.y -= fps * 300.0f;		// gravity
 			
-		x = (gShards[i].coord.x += gShards[i].coordDelta.x * fps);	
-		y = (gShards[i].coord.y += gShards[i].coordDelta.y * fps);	
-		z = (gShards[i].coord.z += gShards[i].coordDelta.z * fps);	
-		
-		
+		gShards[i].coord.x += gShards[i].coordDelta.x * fps;
+		gShards[i].coord.y += gShards[i].coordDelta.y * fps;
+		gShards[i].coord.z += gShards[i].coordDelta.z * fps;
+
+		gMovedShards[numMoved] = i;
+		gMovedShardX[numMoved] = gShards[i].coord.x;
+		gMovedShardZ[numMoved] = gShards[i].coord.z;
+		numMoved++;
+	}
+
+				/* GET TERRAIN HEIGHTS FOR ALL OF THEM AT ONCE */
+
+	GetTerrainYBatch(numMoved, gMovedShardX, gMovedShardZ, gMovedShardTerrainY, nil);
+
+	for (int j = 0; j < numMoved; j++)
+	{
+		int		i = gMovedShards[j];
+		float	ty = gMovedShardTerrainY[j];
+
 					/* SEE IF BOUNCE */
 					
-		ty = GetTerrainY(x,z);								// get terrain height here
-		if (y <= ty)
+		if (gShards[i].coord.y <= ty)
 		{
 			if (gShards[i].mode & SHARD_MODE_BOUNCE)
 			{
@@ -473,7 +490,7 @@ long	i;
 
 					/* DRAW THE TRIANGLE */
 
-			glBegin(GL_TRIANGLES);
+			OGL_Begin(GL_TRIANGLES);
 			glTexCoord2f(gShards[i].uvs[0].u, gShards[i].uvs[0].v);	glVertex3f(gShards[i].points[0].x, gShards[i].points[0].y, gShards[i].points[0].z);
 			glTexCoord2f(gShards[i].uvs[1].u, gShards[i].uvs[1].v);	glVertex3f(gShards[i].points[1].x, gShards[i].points[1].y, gShards[i].points[1].z);
 			glTexCoord2f(gShards[i].uvs[2].u, gShards[i].uvs[2].v);	glVertex3f(gShards[i].points[2].x, gShards[i].points[2].y, gShards[i].points[2].z);
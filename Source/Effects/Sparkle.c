@@ -234,7 +234,7 @@ static OGLPoint3D		frame[4] =
 		else
 			SetColor4fv(gSparkles[i].color);
 
-		glBegin(GL_QUADS);
+		OGL_Begin(GL_QUADS);
 		glTexCoord2f(0,0);	glVertex3fv(&tc[0].x);
 		glTexCoord2f(1,0);	glVertex3fv(&tc[1].x);
 		glTexCoord2f(1,1);	glVertex3fv(&tc[2].x);
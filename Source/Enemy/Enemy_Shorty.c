@@ -196,11 +196,10 @@ OGLMatrix4x4	m,mst,rm,m2;
 		FindJointFullMatrix(enemy, SHORTY_JOINT_RIGHTHAND, &m);					
 		
 	CalcGunMatrixFromJointMatrix(gun, &m, &gun->BaseTransformMatrix);		
-	SetObjectTransformMatrix(gun);
-
 	gun->Coord.x = gun->BaseTransformMatrix.value[M03];				// extract coord from matrix
 	gun->Coord.y = gun->BaseTransformMatrix.value[M13];
 	gun->Coord.z = gun->BaseTransformMatrix.value[M23];
+	SetObjectTransformMatrix(gun);
 
 
 			/**************/
@@ -214,11 +213,10 @@ OGLMatrix4x4	m,mst,rm,m2;
 	FindJointFullMatrix(enemy, SHORTY_JOINT_HEAD, &m);					
 	
 	OGLMatrix4x4_Multiply(&m2, &m, &hat->BaseTransformMatrix);
-	SetObjectTransformMatrix(hat);
-
 	hat->Coord.x = hat->BaseTransformMatrix.value[M03];					// extract coord from matrix
 	hat->Coord.y = hat->BaseTransformMatrix.value[M13];
 	hat->Coord.z = hat->BaseTransformMatrix.value[M23];
+	SetObjectTransformMatrix(hat);
 
 
 	
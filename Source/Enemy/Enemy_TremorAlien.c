@@ -658,11 +658,10 @@ OGLMatrix4x4	m;
 		FindJointFullMatrix(enemy, TREMORALIEN_JOINT_RIGHTHAND, &m);					
 			
 		CalcGunMatrixFromJointMatrix(toma, &m, &toma->BaseTransformMatrix);		
-		SetObjectTransformMatrix(toma);
-
 		toma->Coord.x = toma->BaseTransformMatrix.value[M03];				// extract coord from matrix
 		toma->Coord.y = toma->BaseTransformMatrix.value[M13];
 		toma->Coord.z = toma->BaseTransformMatrix.value[M23];
+		SetObjectTransformMatrix(toma);
 	}
 	
 }
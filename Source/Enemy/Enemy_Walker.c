@@ -304,10 +304,10 @@ OGLMatrix4x4		m, tm;
 	OGLMatrix4x4_SetTranslate(&tm, leftOff.x, leftOff.y, leftOff.z);
 	FindJointFullMatrix(walker, WALKER_JOINT_BODY, &m);	
 	OGLMatrix4x4_Multiply(&tm, &m, &leftPod->BaseTransformMatrix);
-	SetObjectTransformMatrix(leftPod);
 	leftPod->Coord.x = leftPod->BaseTransformMatrix.value[M03];			// extract coords
 	leftPod->Coord.y = leftPod->BaseTransformMatrix.value[M13];
 	leftPod->Coord.z = leftPod->BaseTransformMatrix.value[M23];
+	SetObjectTransformMatrix(leftPod);
 
 
 			/* ALIGN RIGHT POD */
@@ -315,10 +315,10 @@ OGLMatrix4x4		m, tm;
 	OGLMatrix4x4_SetTranslate(&tm, rightOff.x, rightOff.y, rightOff.z);
 	FindJointFullMatrix(walker, WALKER_JOINT_BODY, &m);	
 	OGLMatrix4x4_Multiply(&tm, &m, &rtPod->BaseTransformMatrix);
-	SetObjectTransformMatrix(rtPod);
 	rtPod->Coord.x = rtPod->BaseTransformMatrix.value[M03];			// extract coords
 	rtPod->Coord.y = rtPod->BaseTransformMatrix.value[M13];
 	rtPod->Coord.z = rtPod->BaseTransformMatrix.value[M23];
+	SetObjectTransformMatrix(rtPod);
 
 
 }
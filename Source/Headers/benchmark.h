@@ -0,0 +1,23 @@
+//
+// benchmark.h
+//
+// Only compiled into the BillyFrontierBench target (BENCHMARK=1).
+//
+
+#pragma once
+
+#if BENCHMARK
+
+#define	BENCH_MAX_AREAS			32
+#define	BENCH_DEFAULT_FRAMES	1000
+#define	BENCH_DEFAULT_TICKRATE	60
+#define	BENCH_DEFAULT_SEED		0x42696c6c		// 'Bill'
+
+extern	int			gBenchmarkFrames;
+extern	float		gBenchmarkTickRate;
+
+Boolean Bench_ParseCommandLine(int argc, char** argv);
+void RunBenchmark(void);
+Boolean Bench_EndFrame(void);
+
+#endif
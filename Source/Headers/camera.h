@@ -22,3 +22,7 @@ void InitCamera_TargetPractice(void);
 void PrepAnaglyphCameras(void);
 void RestoreCamerasFromAnaglyph(void);
 void CalcAnaglyphCameraOffset(short pass);
+
+void SaveCameraForInterpolation(void);
+void PrepInterpolatedCamera(void);
+void RestoreCameraFromInterpolation(void);
@@ -31,6 +31,44 @@ typedef struct CollisionRec CollisionRec;
 
 void CollisionDetect(ObjNode *baseNode, uint32_t CType, short startNumCollisions);
 
+typedef struct
+{
+	uint32_t	numQueries;
+	uint32_t	numCandidates;						// total over all queries
+	uint32_t	numFallbacks;						// queries that were too big for the grid, so scanned the object list
+	uint32_t	numRefiles;							// objects moved to different cells
+	uint32_t	numVerified;						// queries checked against the brute force scan
+} CollisionGridStats;
+
+extern	CollisionGridStats	gCollisionGridStats;
+extern	Boolean				gVerifyCollisionGrid;
+
+void UpdateCollisionGridNode(ObjNode* node);
+void RemoveCollisionGridNode(ObjNode* node);
+int GatherCollisionGridCandidates(const CollisionBoxType* box, ObjNode*** candidates);
+Boolean IsCollisionGridCandidateBefore(const ObjNode* a, const ObjNode* b);
+
+typedef struct
+{
+	uint32_t	numQueries;
+	uint32_t	numCandidates;						// total over all queries
+	uint32_t	numNodesVisited;					// tree nodes looked at, total over all queries
+	uint32_t	numReinserts;						// leaves that moved
+	uint32_t	numVerified;						// queries checked against the brute force scan
+} RayTreeStats;
+
+#define	RAYTREE_INFINITE_RAY		1.0e30f					// maxT for GatherRayTreeCandidates when it's a ray, not a segment
+
+extern	RayTreeStats		gRayTreeStats;
+extern	Boolean				gVerifyRayTree;
+extern	Boolean				gRayTreeDisabled;
+
+void UpdateRayTreeNode(ObjNode* node);
+void RemoveRayTreeNode(ObjNode* node);
+int GetRayTreeNumLeaves(void);
+int GatherRayTreeCandidates(const OGLPoint3D* origin, const OGLVector3D* dir, float maxT,
+							uint32_t cTypes, uint32_t statusFilter, ObjNode*** candidates);
+
 Byte HandleCollisions(ObjNode *theNode, uint32_t cType, float deltaBounce);
 extern	Boolean IsPointInPoly2D( float,  float ,  Byte ,  OGLPoint2D *);
 extern	Boolean IsPointInTriangle(float pt_x, float pt_y, float x0, float y0, float x1, float y1, float x2, float y2);
@@ -24,6 +24,14 @@ typedef struct
 	OGLVector2D		*sectionNormals;	// for each section/span, this is the perpendicular normal vector
 }FenceDefType;
 
+typedef struct
+{
+	uint32_t	numQueries;
+	uint32_t	numSectionsTested;					// total over all queries
+	uint32_t	numFallbacks;						// queries that the grid couldn't take, so scanned every fence
+	uint32_t	numVerified;						// queries checked against the scan
+}FenceGridStats;
+
 
 //============================================
 
@@ -31,8 +39,12 @@ void PrimeFences(void);
 Boolean DoFenceCollision(ObjNode *theNode);
 void DisposeFences(void);
 Boolean SeeIfLineSegmentHitsFence(const OGLPoint3D *endPoint1, const OGLPoint3D *endPoint2, OGLPoint3D *intersect, Boolean *overTop, float *fenceTopY);
+int GetFenceGridNumSections(void);
 
 extern Boolean gFenceCollisionDisabled;
+extern FenceGridStats gFenceGridStats;
+extern Boolean gFenceGridDisabled;
+extern Boolean gVerifyFenceGrid;
 
 
 #endif
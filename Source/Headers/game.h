@@ -35,6 +35,7 @@
 #include "camera.h"
 #include "collision.h"
 #include "input.h"
+#include "replay.h"
 #include "file.h"
 #include "fences.h"
 #include "splineitems.h"
@@ -46,6 +47,9 @@
 #include "pick.h"
 #include "3dmath.h"
 #include "infobar.h"
+#include "profiler.h"
+#include "loadtime.h"
+#include "benchmark.h"
 
 extern BG3DFileContainer *gBG3DContainerList[MAX_BG3D_GROUPS];
 extern Boolean gAllowAudioKeys;
@@ -118,7 +122,7 @@ extern SparkleType gSparkles[MAX_SPARKLES];
 extern SplineDefType **gSplineList;
 extern SpriteType *gSpriteGroupList[MAX_SPRITE_GROUPS];
 extern SuperTileItemIndexType **gSuperTileItemIndexGrid;
-extern SuperTileMemoryType gSuperTileMemoryList[MAX_SUPERTILES];
+extern SuperTileMemoryType gSuperTileMemoryList[NUM_SUPERTILE_BLOCKS];
 extern SuperTileStatus **gSuperTileStatusGrid;
 extern TerrainItemEntryType **gMasterItemList;
 extern WaterDefType **gWaterListHandle;
@@ -144,6 +148,8 @@ extern float gLevelCompletedCoolDownTimer;
 extern float gMapToUnitValue;
 extern float gObjectGroupBSphereList[MAX_BG3D_GROUPS][MAX_OBJECTS_IN_GROUP];
 extern float gPlayerBottomOff;
+extern float gSimInterpolation;
+extern float gSimTickRate;
 extern float gTargetMaxSpeed;
 extern float gTargetPracticeTimer;
 extern float gTerrainPolygonSize;
@@ -153,11 +159,13 @@ extern float gTimeSinceLastEnemyShot;
 extern int gCurrentAntialiasingLevel;
 extern int gCurrentArea;
 extern int gCurrentMenuItem;
+extern int gDrawCallsThisFrame;
 extern int gDuelKeyBufferIndex;
 extern int gDuelKeySequenceLength;
 extern int gDuelReflex;
 extern int gGameWindowHeight;
 extern int gGameWindowWidth;
+extern int gImmediateBlocksThisFrame;
 extern int gNumEnemies;
 extern int gNumLineMarkers;
 extern int gNumObjectNodes;
@@ -170,11 +178,14 @@ extern int gNumUniqueSuperTiles;
 extern int gNumWorldCalcsThisFrame;
 extern int gPepperCount;
 extern int gPolysThisFrame;
+extern int gStatePopsThisFrame;
+extern int gStateTogglesThisFrame;
 extern int gStopPointNum;
 extern int gSuperTileActiveRange;
 extern int gTerrainTileDepth;
 extern int gTerrainTileWidth;
 extern int gTerrainUnitWidth, gTerrainUnitDepth;
+extern int gTextureBindsThisFrame;
 extern int gVRAMUsedThisFrame;
 extern int32_t gNumSpritesInGroupList[MAX_SPRITE_GROUPS];
 extern float gMouseDeltaX;
@@ -80,10 +80,35 @@ enum
 	NUM_CONTROL_NEEDS,
 };
 
+		/* INPUT SNAPSHOT */
+		//
+		// One frame's worth of gameplay input.
+		// An override proc can supply these instead of the real devices (see SetInputOverride),
+		// and a recorder proc gets one after the real devices were read (see SetInputRecorder).
+		//
+
+typedef struct
+{
+	uint32_t		needBits;				// bit N is set if need N is held down
+	uint32_t		newNeedBits;			// bit N is set if need N was just pressed (only if exactNeedEdges)
+	Boolean			exactNeedEdges;			// if false, new presses are inferred from needBits
+	OGLPoint2D		mouseCoord;				// logical mouse coord, as returned by GetLogicalMouseCoord
+	float			mouseDeltaX;
+	float			mouseDeltaY;
+	int32_t			scrollWheelDelta;
+	uint32_t		mouseButtonBits;		// bit N is set if SDL mouse button N is held down
+	OGLVector2D		analogSteering;			// player 1 thumbstick, as returned by GetAnalogSteering
+	float			framesPerSecond;		// if > 0, replaces gFramesPerSecond for this tick
+} InputSnapshot;
+
+typedef void (*InputOverrideProc)(InputSnapshot* snapshot);
+typedef void (*InputRecorderProc)(const InputSnapshot* snapshot);
+
 //============================================================================================
 
 void InitInput(void);
 void ReadKeyboard(void);
+void ReadKeyboard_NoSimTick(void);
 
 OGLPoint2D GetLogicalMouseCoord(void);
 void GetMousePixelCoord(float *x, float *y);
@@ -95,7 +120,11 @@ Boolean GetClickState(int mouseButton);
 Boolean GetNewClickState(int mouseButton);
 Boolean GetNeedState(int need);
 Boolean GetNewNeedState(int need);
+OGLVector2D GetAnalogSteering(int playerID);
 Boolean IsCheatKeyComboDown(void);
 Boolean UserWantsOut(void);
 
 void InvalidateAllInputs(void);
+
+void SetInputOverride(InputOverrideProc proc);
+void SetInputRecorder(InputRecorderProc proc);
@@ -0,0 +1,36 @@
+//
+// loadtime.h
+//
+
+#pragma once
+
+		/* LOAD STEPS */
+		//
+		// Keep in sync with kLoadStepNames in LoadTime.c
+		//
+
+enum
+{
+	kLoad_ImportBG3D,
+	kLoad_BuildMeshBVHs,
+	kLoad_LoadSkeletonFile,
+	kLoad_PrimeBoneData,
+	kLoad_LoadPlayfield,
+	kLoad_ReadPlayfieldFile,
+	kLoad_ItemShadowCasting,
+	kLoad_LoadSoundBank,
+	kLoad_LoadSpriteGroup,
+	kLoad_TextureMapLoad,
+	NUM_LOAD_STEPS
+};
+
+#define	LOADTIME_BOOT	(-1)						// pass as the area for the report covering the startup loads
+
+extern	float		gLastLoadTimeMS;
+
+void LoadTime_BeginReport(int area);
+void LoadTime_EndReport(void);
+void LoadTime_Begin(int step);
+void LoadTime_End(int step);
+Boolean LoadTime_OpenReportFile(const char* path);
+void LoadTime_CloseReportFile(void);
@@ -59,6 +59,7 @@ extern	void ToolBoxInit(void);
 void InitDefaultPrefs(void);
 void StartLevelCompletion(float coolDownTimer);
 void DefaultDrawCallback(void);
+void PlayArea(int area);
 
 void MarkLevelWon(int level);
 void MarkDuelWon(int duel);
@@ -141,10 +141,13 @@ typedef struct
 
 }MOVertexArrayData;
 		
+typedef struct MeshBVH MeshBVH;							// see MeshBVH.c
+
 typedef struct
 {
 	MetaObjectHeader	objectHeader;
 	MOVertexArrayData	objectData;
+	MeshBVH				*bvh;								// triangle BVH for the ray tests, or nil
 }MOVertexArrayObject;
 
 
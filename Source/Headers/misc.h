@@ -2,6 +2,37 @@
 // misc.h
 //
 
+		/* MEMORY TAGS */
+		//
+		// Every AllocPtr block is tagged with the subsystem that owns it,
+		// so we can tell which one is responsible for the peak.
+		//
+
+enum
+{
+	kMemTag_Misc,
+	kMemTag_Terrain,
+	kMemTag_Skeleton,
+	kMemTag_BG3D,
+	kMemTag_Particles,
+	kMemTag_MetaObjects,
+	kMemTag_Sound,
+	kMemTag_ObjNodes,
+	NUM_MEMORY_TAGS
+};
+
+typedef struct
+{
+	long		liveBytes;
+	long		peakBytes;
+	int			numLive;						// # of live blocks
+	int			allocsThisFrame;
+	int			allocsLastFrame;
+	uint32_t	totalAllocs;
+} MemoryTagStats;
+
+extern	MemoryTagStats	gMemoryTagStats[NUM_MEMORY_TAGS];
+
 void	DoAlert(const char* format, ...);
 POMME_NORETURN void DoFatalAlert(const char* format, ...);
 void	Wait(long);
@@ -11,11 +42,18 @@ uint32_t MyRandomLong(void);
 Handle	AllocHandle(long size);
 void *AllocPtr(long size);
 void *AllocPtrClear(long size);
+void *AllocPtrTagged(long size, int tag);
+void *AllocPtrClearTagged(long size, int tag);
 void *ReallocPtr(void* initialPtr, long newSize);
 void SafeDisposePtr(void *ptr);
+void TrackExternalMemory(int tag, long deltaBytes);
+const char* GetMemoryTagName(int tag);
+void EndFrameMemoryTagStats(void);
+void ResetMemoryTagPeaks(void);
 float RandomFloat(void);
 uint16_t	RandomRange(uint16_t min, uint16_t max);
 void CalcFramesPerSecond(void);
+Boolean NextSimTick(void);
 Boolean IsPowerOf2(int num);
 float RandomFloat2(void);
 void MyFlushEvents(void);
@@ -68,9 +68,11 @@ extern	void InitObjectManager(void);
 extern	ObjNode	*MakeNewObject(NewObjectDefinitionType *newObjDef);
 extern	void MoveObjects(void);
 void DrawObjects(void);
+void SaveObjectCoordsForInterpolation(void);
 
 extern	void DeleteAllObjects(void);
 extern	void DeleteObject(ObjNode	*theNode);
+void FlushObjectDeleteQueue(void);
 void DetachObject(ObjNode *theNode, Boolean subrecurse);
 extern	void GetObjectInfo(ObjNode *theNode);
 extern	void UpdateObject(ObjNode *theNode);
@@ -114,7 +116,54 @@ void AddCollisionBoxToObject(ObjNode *theNode, float top, float bottom, float le
 							 float right, float front, float back);
 void DoObjectFriction(ObjNode *theNode, float friction);
 
-void CalcDisplayGroupWorldPoints(ObjNode *theNode);
+const ObjNodeWorldData *GetDisplayGroupWorldData(ObjNode *theNode);
+void DisposeObjectWorldData(ObjNode *theNode);
 
 
 ObjNode* MakeBackgroundPictureObject(const char* path);
+
+
+//===================
+
+typedef struct
+{
+	int			numLive;
+	int			peakLive;
+	int			numSlabs;
+	int			capacity;					// # nodes in all slabs
+	uint32_t	numAllocs;
+	uint32_t	numOverflowAllocs;			// allocs that went to the heap because the pool was full
+	uint32_t	numStaleRefs;				// GetLiveObjNode calls that caught a recycled node
+} ObjNodePoolStats;
+
+extern	ObjNodePoolStats	gObjNodePoolStats;
+
+ObjNode* AllocObjNode(void);
+void FreeObjNode(ObjNode* node);
+ObjNode* GetLiveObjNode(ObjNode* node, uint32_t generation);
+
+
+//===================
+
+		/* HOT OBJECT DATA FOR CULLING (see ObjNodeHot.c) */
+
+typedef struct
+{
+	int				count;					// # entries in use, packed at the front
+	int				capacity;
+	ObjNode			**node;					// back pointer to each entry's ObjNode
+	OGLMatrix4x4	*localToWorld;			// BaseTransformMatrix, or just the translation for skeletons
+	OGLBoundingBox	*bBox;
+	OGLVector2D		*coordXZ;				// for autofade
+	Byte			*isOut;					// set by CullTestAllObjects if the bbox is outside the frustum
+	float			*fadeDist;				// set by CullTestAllObjects if the level has autofade
+} ObjNodeHotTable;
+
+extern	ObjNodeHotTable		gObjNodeHot;
+
+void AddObjNodeHotEntry(ObjNode* node);
+void RemoveObjNodeHotEntry(ObjNode* node);
+void UpdateObjNodeHotEntry(ObjNode* node);
+#if _DEBUG
+void VerifyObjNodeHotEntry(ObjNode* node);
+#endif
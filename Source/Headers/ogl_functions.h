@@ -7,13 +7,41 @@
 // emulated functions -- no ARB proc-address lookup needed at runtime.
 #define glActiveTextureARB					glActiveTexture
 #define glClientActiveTextureARB			glClientActiveTexture
+
+// Buffer objects are core in WebGL too.
+GLAPI void APIENTRY glGenBuffers(GLsizei n, GLuint *buffers);
+GLAPI void APIENTRY glDeleteBuffers(GLsizei n, const GLuint *buffers);
+GLAPI void APIENTRY glBindBuffer(GLenum target, GLuint buffer);
+GLAPI void APIENTRY glBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage);
+GLAPI void APIENTRY glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data);
+
+#define glGenBuffersARB						glGenBuffers
+#define glDeleteBuffersARB					glDeleteBuffers
+#define glBindBufferARB						glBindBuffer
+#define glBufferDataARB						glBufferData
+#define glBufferSubDataARB					glBufferSubData
+
 static inline void OGL_InitFunctions(void) {}
 #else
 extern PFNGLACTIVETEXTUREARBPROC			procptr_glActiveTextureARB;
 extern PFNGLCLIENTACTIVETEXTUREARBPROC		procptr_glClientActiveTextureARB;
+extern PFNGLGENBUFFERSARBPROC				procptr_glGenBuffersARB;
+extern PFNGLDELETEBUFFERSARBPROC			procptr_glDeleteBuffersARB;
+extern PFNGLBINDBUFFERARBPROC				procptr_glBindBufferARB;
+extern PFNGLBUFFERDATAARBPROC				procptr_glBufferDataARB;
+extern PFNGLBUFFERSUBDATAARBPROC			procptr_glBufferSubDataARB;
 
 #define glActiveTextureARB					procptr_glActiveTextureARB
 #define glClientActiveTextureARB			procptr_glClientActiveTextureARB
+#define glGenBuffersARB						procptr_glGenBuffersARB
+#define glDeleteBuffersARB					procptr_glDeleteBuffersARB
+#define glBindBufferARB						procptr_glBindBufferARB
+#define glBufferDataARB						procptr_glBufferDataARB
+#define glBufferSubDataARB					procptr_glBufferSubDataARB
 
 void OGL_InitFunctions(void);
 #endif
+
+// True if the buffer object functions above can be used. They're optional
+// (ARB_vertex_buffer_object), so check this before calling them.
+extern Boolean gOGLHaveBufferObjects;
@@ -37,6 +37,17 @@
 	}																			\
 }
 
+		/* IMMEDIATE-MODE BLOCKS */
+		//
+		// Use this instead of glBegin so the block shows up in gImmediateBlocksThisFrame.
+		//
+
+#define	OGL_Begin(mode)															\
+{																				\
+	gImmediateBlocksThisFrame++;												\
+	glBegin(mode);																\
+}
+
 #define OGLIsZero(a) (((a) >= -EPS) && ((a) <= EPS))
 
 
@@ -16,3 +16,24 @@ Boolean	OGL_RayIntersectsTriangle(OGLPoint3D *trianglePoints, OGLRay *ray, OGLPo
 ObjNode *OGL_DoLineSegmentCollision(OGLPoint3D *p1, OGLPoint3D *p2, OGLPoint3D *worldHitCoord, OGLVector3D *worldHitFaceNormal, uint32_t cTypes);
 
 Boolean OGL_DoesRayIntersectTrianglePlane(const OGLPoint3D	triWorldPoints[], OGLRay *ray, OGLPlaneEquation	*planeEquation);
+
+
+		/* MESH BVH */
+
+typedef struct
+{
+	uint32_t	numQueries;
+	uint32_t	numTrianglesGathered;				// total over all queries
+	uint32_t	numTrianglesInMeshes;				// what a test of every triangle would have done
+	uint32_t	numVerified;						// mesh tests checked against testing every triangle
+} MeshBVHStats;
+
+extern	MeshBVHStats		gMeshBVHStats;
+extern	Boolean				gVerifyMeshBVH;
+extern	Boolean				gMeshBVHDisabled;
+
+void BuildMeshBVHs(MetaObjectPtr object);
+void DisposeMeshBVH(MOVertexArrayObject* mo);
+int GatherMeshBVHTriangles(const MeshBVH* bvh, const OGLMatrix4x4* localToWorld,
+							const OGLPoint3D* origin, const OGLVector3D* dir, float maxT,
+							const uint32_t** triangles);
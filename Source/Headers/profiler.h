@@ -0,0 +1,48 @@
+//
+// profiler.h
+//
+
+#pragma once
+
+		/* PROFILER ZONES */
+		//
+		// Keep in sync with kProfZoneNames in Profiler.c
+		//
+
+enum
+{
+	kProf_DrawScene,
+	kProf_SwapWindow,
+	kProf_MoveObjects,
+	kProf_CullTestAllObjects,
+	kProf_DrawObjects,
+	kProf_DrawTerrain,
+	kProf_BuildTerrainSuperTile,
+	kProf_UpdateSkinnedGeometry,
+	kProf_MoveParticleGroups,
+	kProf_DrawParticleGroup,
+	kProf_CollisionDetect,
+	kProf_OGL_DoRayCollision,
+	NUM_PROF_ZONES
+};
+
+		/* SCOPED TIMERS */
+		//
+		// Every PROF_BEGIN must be matched by a PROF_END of the same zone
+		// on the way out of the scope, including early returns.
+		// They cost a single branch while the profiler is idle.
+		//
+
+#define	PROF_BEGIN(zone)	do { if (gProfilerActive) Prof_BeginZone(zone); } while (0)
+#define	PROF_END(zone)		do { if (gProfilerActive) Prof_EndZone(zone); } while (0)
+
+extern	Boolean		gProfilerActive;
+extern	Boolean		gProfilerOverlay;
+
+void Prof_BeginZone(int zone);
+void Prof_EndZone(int zone);
+void Prof_EndFrame(void);
+void Prof_ToggleOverlay(void);
+void Prof_DrawOverlay(void);
+Boolean Prof_StartTrace(const char* path);
+void Prof_StopTrace(void);
@@ -0,0 +1,14 @@
+//
+// replay.h
+//
+
+#pragma once
+
+#define	REPLAY_FILE_VERSION		1
+
+Boolean Replay_OpenForRecording(const char* path);
+Boolean Replay_OpenForPlayback(const char* path);
+Boolean Replay_BeginArea(int area);
+void Replay_EndArea(void);
+int Replay_GetPlaybackArea(void);
+uint32_t Replay_GetPlaybackNumTicks(void);
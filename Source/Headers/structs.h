@@ -245,6 +245,21 @@ typedef struct
 			/*  OBJECT RECORD STRUCTURE */
 			/****************************/
 
+		// Where each of a display group's meshes is in the world, for picking & line-of-sight tests.
+		// The meshes stay in model space, and the tests bring the ray into each mesh's space.
+		// Only a few objects ever need these, so they're allocated on demand
+		// rather than bloating every ObjNode, and then kept until the object goes away.
+
+typedef struct
+{
+	Boolean				isValid;
+	OGLMatrix4x4		baseTransform;								// the object's BaseTransformMatrix when this was worked out
+	int					numMeshes;									// # entries in use
+	MOVertexArrayObject	*meshes[MAX_OBJECTS_IN_GROUP];				// each mesh in the model (the BaseGroup holds the references)
+	OGLMatrix4x4		localToWorld[MAX_OBJECTS_IN_GROUP];			// each mesh's model-to-world matrix
+}ObjNodeWorldData;
+
+
 
 struct ObjNode
 {
@@ -256,6 +271,8 @@ struct ObjNode
 	struct ObjNode	*ShadowNode;		// ptr to node's shadow (if any)
 	struct ObjNode	*MPlatform;			// current moving platform
 
+	uint32_t		PoolGeneration;		// bumped on alloc & free, odd while live (see ObjNodePool.c)
+
 	uint16_t			Slot;				// sort value
 	Byte			Genre;				// obj genre
 	int				Type;				// obj type
@@ -265,6 +282,8 @@ struct ObjNode
 	int				What;				// what
 	Byte			Side;				// left or right
 	uint32_t			StatusBits;			// various status bits
+	int				HotIndex;			// index into gObjNodeHot, or -1
+	uint32_t		AttachSeq;			// when it was last attached, which orders nodes within a slot
 	
 			/* MOVE/DRAW CALLBACKS */
 			
@@ -300,6 +319,12 @@ struct ObjNode
 	CollisionBoxType	CollisionBoxes[MAX_COLLISION_BOXES];					// Array of collision rectangles
 	float				LeftOff,RightOff,FrontOff,BackOff,TopOff,BottomOff;		// box offsets (only used by simple objects with 1 collision box)	
 
+	int					CollisionGridEntry;										// 1st of this node's entries in the collision grid, 0 if none (see CollisionGrid.c)
+	int32_t				CollisionGridRect[4];									// grid cells covered by the boxes when last filed
+	Boolean				CollisionGridOversize;
+	uint32_t			CollisionGridStamp;										// last query that picked this node up
+	int					RayTreeLeaf;											// this node's leaf in the ray tree, 0 if none (see RayTree.c)
+
 	float				BoundingSphereRadius;
 	struct ObjNode 		*CurrentTriggerObj;										// set when trigger occurs
 
@@ -311,9 +336,7 @@ struct ObjNode
 		
 	float				ForceLookAtDist;
 	
-	Boolean				HasWorldPoints;								// true if we have the world-space coords of the model's vertices
-	MOVertexArrayData	WorldMeshes[MAX_OBJECTS_IN_GROUP];			// for each mesh in the model, a copy of the master mesh but with new vertex arrays that contain world-space coords
-	OGLPlaneEquation		*WorldPlaneEQs[MAX_OBJECTS_IN_GROUP];	// for each mesh, an array of plane equations for each triangle
+	ObjNodeWorldData	*WorldData;									// where the meshes are in the world (nil until first needed)
 	
 	
 			/* SPECS */
@@ -375,7 +398,7 @@ struct ObjNode
 	MOSpriteObject		*SpriteMO;				// ref to sprite meta object for sprite genre.
 	
 	Byte				NumStringSprites;		// # sprites to build string (NOT SAME AS LENGTH OF STRING B/C SPACES ET.AL.)
-	MOSpriteObject		*StringCharacters[64];	// sprites for each character
+	MOSpriteObject		**StringCharacters;		// sprites for each character (allocated by MakeFontStringObject)
 
 	float				AnaglyphZ;
 
@@ -27,7 +27,8 @@ enum
 enum
 {
 	SUPERTILE_MODE_FREE,
-	SUPERTILE_MODE_USED
+	SUPERTILE_MODE_USED,
+	SUPERTILE_MODE_CACHED									// scrolled off, but kept built in case we come back
 };
 
 #define	DEFAULT_TERRAIN_SCALE		125.0f											// size of a polygon
@@ -53,6 +54,9 @@ enum
 #define	MAX_SUPERTILES			((MAX_SUPERTILE_ACTIVE_RANGE*2 * MAX_SUPERTILE_ACTIVE_RANGE*2)*2)	// the final *2 is because the old supertiles are not deleted until
 																											// after new ones are created, thus we need some extas - worst case
 																											// scenario is twice as many.
+
+#define	MAX_CACHED_SUPERTILES	128								// extra blocks so that there's always room to keep some supertiles built after they scroll off
+#define	NUM_SUPERTILE_BLOCKS	(MAX_SUPERTILES + MAX_CACHED_SUPERTILES)
 	
 #define	MAX_TERRAIN_WIDTH		400
 #define	MAX_TERRAIN_DEPTH		400
@@ -72,6 +76,8 @@ struct SuperTileMemoryType
 	Boolean				culledLastDraw;							// true if this supertile was culled the last time it was drawn
 	Byte				hiccupTimer;							// # frames to skip for use
 	Byte				mode;									// free, used, etc.
+	Boolean				dontCache;								// deformations have touched it, so rebuild it next time
+	uint32_t			cacheStamp;								// when it was cached, to evict the oldest first
 	float				x,z,y;									// world coords
 	long				left,back;								// integer coords of back/left corner
 	int				tileRow,tileCol;						// tile row/col of the start of this supertile
@@ -116,12 +122,14 @@ typedef	struct
 	uint16_t	supertileIndex;
 	Byte		statusFlags;
 	Boolean		playerHereFlag;
+	Byte		lod;									// detail level it's drawn at this frame, see SuperTileLOD.c
 }SuperTileStatus;
 
 enum									// statusFlags
 {
 	SUPERTILE_IS_DEFINED			=	1,
-	SUPERTILE_IS_USED_THIS_FRAME	=	(1<<1)
+	SUPERTILE_IS_USED_THIS_FRAME	=	(1<<1),
+	SUPERTILE_IS_CACHED				=	(1<<2)							// supertileIndex is still built, but in SUPERTILE_MODE_CACHED
 };
 
 
@@ -162,6 +170,69 @@ typedef struct
 }LineMarkerDefType;
 
 
+		/* TILE PLANE TABLE */
+		//
+		// The plane of each of a tile's 2 triangles, as y = y + dydx*xi + dydz*zi
+		// where xi/zi are the offsets into the tile. The normal is
+		// (-dydx, 1, -dydz) * normalY.
+		//
+
+typedef struct
+{
+	float	dydx, dydz;						// slope of the triangle
+	float	y;								// height of its plane at the tile's far left corner
+	float	normalY;						// 1 / length of (-dydx, 1, -dydz)
+}TerrainTrianglePlane;
+
+typedef struct
+{
+	TerrainTrianglePlane	tri[2];			// left & right triangles, as GetTerrainY picks them
+}TerrainTilePlanes;
+
+
+		/* SUPERTILE BUILDERS */
+
+#define	SUPERTILE_PREFETCH_LOOKAHEAD	.6f			// seconds ahead of the camera to build supertiles
+
+typedef struct
+{
+	uint32_t	numBuiltOnMainThread;				// BuildTerrainSuperTile had to build it itself
+	uint32_t	numPrefetchHits;					// ...or swapped in one the builders made
+	uint32_t	numWaits;							// ...after waiting for a builder to finish it
+	uint32_t	numPrefetched;						// built by the builders
+	uint32_t	numDiscarded;						// built by the builders but never used
+}SuperTileBuildStats;
+
+typedef struct
+{
+	uint32_t	numHits;							// scrolled back on while still cached
+	uint32_t	numBuilds;							// had to be built (or taken from the builders)
+	uint32_t	numEvicted;							// oldest cached one reused for another
+	uint32_t	numInvalidated;						// thrown out because a deformation touched it
+}SuperTileCacheStats;
+
+typedef struct
+{
+	uint32_t	numFullUploads;						// whole supertiles sent to the GPU after being built
+	uint32_t	numPartialUploads;					// ranges of points or normals resent after a deformation
+	uint32_t	numBytesUploaded;
+	uint32_t	numDraws;							// supertiles drawn from the buffers
+}SuperTileBufferStats;
+
+
+		/* SUPERTILE LEVELS OF DETAIL */
+
+#define	NUM_SUPERTILE_LODS			3								// 8x8, 4x4 & 2x2 quads
+#define	NUM_SUPERTILE_LOD_VARIANTS	(2*2*2*2 + 3*3*3*3)				// each side of a coarse level can be stitched to any finer one
+#define	SUPERTILE_LOD_PIXEL_ERROR	1.0f							// how far off a coarse level may be on screen
+
+typedef struct
+{
+	uint32_t	numDrawn[NUM_SUPERTILE_LODS];
+	uint32_t	numTriangles;						// drawn in all of them
+}SuperTileLODStats;
+
+
 //=====================================================================
 
 
@@ -173,6 +244,7 @@ void DisposeTerrain(void);
 void GetSuperTileInfo(int x, int z, int *superCol, int *superRow, int *tileCol, int *tileRow);
 void InitTerrainManager(void);
 float	GetTerrainY(float x, float z);
+void	GetTerrainYBatch(int n, const float *x, const float *z, float *y, OGLVector3D *normals);
 float	GetMinTerrainY(float x, float z, short group, short type, float scale);
 void InitCurrentScrollSettings(void);
 
@@ -189,7 +261,40 @@ void DoPlayerTerrainUpdate(float x, float y);
 void CalcTileNormals(long row, long col, OGLVector3D *n1, OGLVector3D *n2);
 void CalcTileNormals_NotNormalized(long row, long col, OGLVector3D *n1, OGLVector3D *n2);
 void CalculateSplitModeMatrix(void);
+void BuildTerrainPlaneTable(void);
+void UpdateTerrainPlaneTable(int startRow, int startCol, int endRow, int endCol);
+void DisposeTerrainPlaneTable(void);
 void CalculateSupertileVertexNormals(MOVertexArrayData	*meshData, long	startRow, long startCol);
+void LightSuperTileVertices(const OGLVector3D *vertexNormals, OGLColorRGBA_Byte *vertexColorList,
+							int startRow, int startCol, const OGLLightDefType *lights);
+void BuildSuperTileGeometry(int startCol, int startRow, MOVertexArrayData *meshData, const OGLLightDefType *lights, float *minY, float *maxY);
+void BuildSuperTileTriangles(int startCol, int startRow, MOTriangleIndecies *triangleList);
+
+void InitSuperTileBuilders(void);
+void ShutdownSuperTileBuilders(void);
+void CreateSuperTilePrefetchSlots(void);
+void DisposeSuperTilePrefetchSlots(void);
+void CancelSuperTilePrefetches(void);
+void SetSuperTilePrefetchHint(float x, float z);
+void PrefetchSuperTiles(float x, float z);
+Boolean AdoptPrefetchedSuperTile(int superCol, int superRow, MOVertexArrayData *meshData, float *minY, float *maxY);
+void GetSuperTileBuildStats(SuperTileBuildStats *stats);
+void ResetSuperTileBuildStats(void);
+void VerifySuperTileGeometry(int superCol, int superRow, const MOVertexArrayData *meshData, float minY, float maxY, const char *where);
+
+void CreateSuperTileBuffers(void);
+void DisposeSuperTileBuffers(void);
+void UploadSuperTileBuffers(int superTileNum);
+void UpdateSuperTileBuffers(int superTileNum, int firstPoint, int lastPoint, int firstNormal, int lastNormal);
+Boolean DrawSuperTileFromBuffers(int superTileNum, int lodVariant);
+void FinishSuperTileBufferDraws(void);
+
+void InitSuperTileLODs(void);
+void CreateSuperTileLODErrors(void);
+void DisposeSuperTileLODErrors(void);
+void ChooseSuperTileLODs(void);
+int GetSuperTileLODVariant(int superRow, int superCol);
+MOTriangleIndecies *GetSuperTileLODTriangles(int variant, int *numTriangles);
 
 short NewSuperTileDeformation(DeformationType *data);
 void DeleteTerrainDeformation(short	i);
@@ -197,3 +302,18 @@ void UpdateDeformationCoords(short defNum, float x, float z);
 
 void DoItemShadowCasting(void);
 Boolean SeeIfCrossedLineMarker(OGLPoint3D *from, OGLPoint3D *to, int *whichLine);
+
+extern TerrainTilePlanes *gTerrainTilePlanes;
+extern Boolean gTerrainPlaneTableDisabled;
+extern Boolean gVerifyTerrainPlanes;
+extern Boolean gVerifySuperTilePrefetch;
+extern SuperTileCacheStats gSuperTileCacheStats;
+extern Boolean gVerifySuperTileCache;
+extern const Boolean gSuperTileSIMDAvailable;
+extern Boolean gSuperTileSIMDDisabled;
+extern SuperTileBufferStats gSuperTileBufferStats;
+extern int gNumSuperTileIndexPatterns;
+extern Boolean gSuperTileBuffersDisabled;
+extern Boolean gVerifySuperTileBuffers;
+extern SuperTileLODStats gSuperTileLODStats;
+extern Boolean gSuperTileLODDisabled;
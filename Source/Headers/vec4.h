@@ -0,0 +1,83 @@
+//
+// vec4.h
+//
+// A few 4-wide float ops on top of SSE2, NEON or wasm SIMD128, for the
+// loops that do the same math on lots of points (the supertile vertex
+// passes, GetTerrainYBatch). VEC4_SIMD is 1 if we have them.
+//
+// Build with -DVEC4_SIMD=0 to leave all the 4-wide code out.
+//
+
+#pragma once
+
+#ifndef VEC4_SIMD
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define	VEC4_SIMD	1
+	#elif defined(__ARM_NEON)
+		#define	VEC4_SIMD	1
+	#elif defined(__wasm_simd128__)
+		#define	VEC4_SIMD	1
+	#else
+		#define	VEC4_SIMD	0
+	#endif
+#endif
+
+#if VEC4_SIMD
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#include <emmintrin.h>
+
+		typedef __m128	Vec4;
+		typedef __m128	Mask4;
+
+		#define	Vec4_Load(p)				_mm_loadu_ps(p)
+		#define	Vec4_Store(p, v)			_mm_storeu_ps(p, v)
+		#define	Vec4_Set1(f)				_mm_set1_ps(f)
+		#define	Vec4_Add(a, b)				_mm_add_ps(a, b)
+		#define	Vec4_Sub(a, b)				_mm_sub_ps(a, b)
+		#define	Vec4_Mul(a, b)				_mm_mul_ps(a, b)
+		#define	Vec4_Abs(v)					_mm_andnot_ps(_mm_set1_ps(-0.0f), v)
+		#define	Vec4_Greater(a, b)			_mm_cmpgt_ps(a, b)
+		#define	Vec4_LessEqual(a, b)		_mm_cmple_ps(a, b)
+		#define	Vec4_Select(m, a, b)		_mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b))
+		#define	Mask4_And(a, b)				_mm_and_ps(a, b)
+		#define	Mask4_Select(m, a, b)		_mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b))
+	#elif defined(__ARM_NEON)
+		#include <arm_neon.h>
+
+		typedef float32x4_t	Vec4;
+		typedef uint32x4_t	Mask4;
+
+		#define	Vec4_Load(p)				vld1q_f32(p)
+		#define	Vec4_Store(p, v)			vst1q_f32(p, v)
+		#define	Vec4_Set1(f)				vdupq_n_f32(f)
+		#define	Vec4_Add(a, b)				vaddq_f32(a, b)
+		#define	Vec4_Sub(a, b)				vsubq_f32(a, b)
+		#define	Vec4_Mul(a, b)				vmulq_f32(a, b)
+		#define	Vec4_Abs(v)					vabsq_f32(v)
+		#define	Vec4_Greater(a, b)			vcgtq_f32(a, b)
+		#define	Vec4_LessEqual(a, b)		vcleq_f32(a, b)
+		#define	Vec4_Select(m, a, b)		vbslq_f32(m, a, b)
+		#define	Mask4_And(a, b)				vandq_u32(a, b)
+		#define	Mask4_Select(m, a, b)		vbslq_u32(m, a, b)
+	#elif defined(__wasm_simd128__)
+		#include <wasm_simd128.h>
+
+		typedef v128_t	Vec4;
+		typedef v128_t	Mask4;
+
+		#define	Vec4_Load(p)				wasm_v128_load(p)
+		#define	Vec4_Store(p, v)			wasm_v128_store(p, v)
+		#define	Vec4_Set1(f)				wasm_f32x4_splat(f)
+		#define	Vec4_Add(a, b)				wasm_f32x4_add(a, b)
+		#define	Vec4_Sub(a, b)				wasm_f32x4_sub(a, b)
+		#define	Vec4_Mul(a, b)				wasm_f32x4_mul(a, b)
+		#define	Vec4_Abs(v)					wasm_f32x4_abs(v)
+		#define	Vec4_Greater(a, b)			wasm_f32x4_gt(a, b)
+		#define	Vec4_LessEqual(a, b)		wasm_f32x4_le(a, b)
+		#define	Vec4_Select(m, a, b)		wasm_v128_bitselect(a, b, m)
+		#define	Mask4_And(a, b)				wasm_v128_and(a, b)
+		#define	Mask4_Select(m, a, b)		wasm_v128_bitselect(a, b, m)
+	#else
+		#error "VEC4_SIMD is set, but there's no Vec4 for this CPU"
+	#endif
+#endif
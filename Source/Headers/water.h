@@ -50,3 +50,5 @@ Boolean DoWaterCollisionDetect(ObjNode *theNode, float x, float y, float z, int
 Boolean IsXZOverWater(float x, float z);
 Boolean GetWaterY(float x, float z, float *y);
 
+extern Boolean gVerifyWaterTiles;
+
@@ -389,11 +389,10 @@ OGLMatrix4x4	m,mst,rm,m2;
 		FindJointFullMatrix(player, PLAYER_JOINT_LEFTHAND, &m);					
 	
 	CalcGunMatrixFromJointMatrix(leftGun, &m, &leftGun->BaseTransformMatrix);		
-	SetObjectTransformMatrix(leftGun);
-
 	leftGun->Coord.x = leftGun->BaseTransformMatrix.value[M03];					// extract coord from matrix
 	leftGun->Coord.y = leftGun->BaseTransformMatrix.value[M13];
 	leftGun->Coord.z = leftGun->BaseTransformMatrix.value[M23];
+	SetObjectTransformMatrix(leftGun);
 
 
 			/********************/
@@ -406,11 +405,10 @@ OGLMatrix4x4	m,mst,rm,m2;
 		FindJointFullMatrix(player, PLAYER_JOINT_RIGHTHAND, &m);					
 		
 	CalcGunMatrixFromJointMatrix(rightGun, &m, &rightGun->BaseTransformMatrix);		
-	SetObjectTransformMatrix(rightGun);
-
 	rightGun->Coord.x = rightGun->BaseTransformMatrix.value[M03];				// extract coord from matrix
 	rightGun->Coord.y = rightGun->BaseTransformMatrix.value[M13];
 	rightGun->Coord.z = rightGun->BaseTransformMatrix.value[M23];
+	SetObjectTransformMatrix(rightGun);
 
 
 			/**************/
@@ -424,11 +422,10 @@ OGLMatrix4x4	m,mst,rm,m2;
 	FindJointFullMatrix(player, PLAYER_JOINT_HEAD, &m);					
 	
 	OGLMatrix4x4_Multiply(&m2, &m, &hat->BaseTransformMatrix);
-	SetObjectTransformMatrix(hat);
-
 	hat->Coord.x = hat->BaseTransformMatrix.value[M03];					// extract coord from matrix
 	hat->Coord.y = hat->BaseTransformMatrix.value[M13];
 	hat->Coord.z = hat->BaseTransformMatrix.value[M23];
+	SetObjectTransformMatrix(hat);
 
 
 	
@@ -230,7 +230,7 @@ float				aspect;
 
 			/* DRAW IT */
 			
-	glBegin(GL_QUADS);
+	OGL_Begin(GL_QUADS);
 	glTexCoord2f(0,0);	glVertex2f(x, 		y);
 	glTexCoord2f(1,0);	glVertex2f(x+size, 	y);
 	glTexCoord2f(1,1);	glVertex2f(x+size,  y+(size*aspect));
@@ -258,7 +258,7 @@ float				aspect;
 
 			/* DRAW IT */
 			
-	glBegin(GL_QUADS);
+	OGL_Begin(GL_QUADS);
 	glTexCoord2f(0,0);	glVertex2f(x, 					y);
 	glTexCoord2f(1,0);	glVertex2f(x+(size*aspect), 	y);
 	glTexCoord2f(1,1);	glVertex2f(x+(size*aspect),		y+size);
@@ -289,7 +289,7 @@ float				aspect;
 
 			/* DRAW IT */
 			
-	glBegin(GL_QUADS);
+	OGL_Begin(GL_QUADS);
 	glTexCoord2f(0,0);	glVertex2f(x, 		y);
 	glTexCoord2f(1,0);	glVertex2f(x+size, 	y);
 	glTexCoord2f(1,1);	glVertex2f(x+size,  y+(size*aspect));
@@ -317,7 +317,7 @@ float				aspect;
 
 			/* DRAW IT */
 			
-	glBegin(GL_QUADS);
+	OGL_Begin(GL_QUADS);
 	glTexCoord2f(0,0);	glVertex2f(x, 		y);
 	glTexCoord2f(1,0);	glVertex2f(x+size, 	y);
 	glTexCoord2f(1,1);	glVertex2f(x+size,  y+(size*aspect));
@@ -352,7 +352,7 @@ float				aspect;
 
 			/* DRAW IT */
 			
-	glBegin(GL_QUADS);
+	OGL_Begin(GL_QUADS);
 	glTexCoord2f(0,0);	glVertex2f(x, 		y);
 	glTexCoord2f(1,0);	glVertex2f(x+size, 	y);
 	glTexCoord2f(1,1);	glVertex2f(x+size,  y+(size*aspect));
@@ -394,7 +394,7 @@ OGLMatrix3x3		m;
 
 			/* DRAW IT */
 			
-	glBegin(GL_QUADS);
+	OGL_Begin(GL_QUADS);
 	glTexCoord2f(0,0);	glVertex2f(p[0].x + x, p[0].y + y);
 	glTexCoord2f(1,0);	glVertex2f(p[1].x + x, p[1].y + y);
 	glTexCoord2f(1,1);	glVertex2f(p[2].x + x, p[2].y + y);
@@ -419,7 +419,7 @@ float				aspect;
 
 			/* DRAW IT */
 			
-	glBegin(GL_QUADS);
+	OGL_Begin(GL_QUADS);
 	glTexCoord2f(0,0);	glVertex2f(x, 			y);
 	glTexCoord2f(1,0);	glVertex2f(x+scaleX, 	y);
 	glTexCoord2f(1,1);	glVertex2f(x+scaleX, 	y+(scaleY*aspect));
@@ -714,7 +714,7 @@ float	y		= offset.y + 33.5;
 
 	glColor3f(1,0,0);
 	
-	glBegin(GL_QUADS);
+	OGL_Begin(GL_QUADS);
 	
 	glVertex2f(x, y);
 	glVertex2f(x-7, y);
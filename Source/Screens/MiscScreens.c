@@ -207,7 +207,7 @@ static void DrawDarkenPane(ObjNode *theNode)
 	SetColor4fv(theNode->ColorFilter);
 	glEnable(GL_BLEND);
 
-	glBegin(GL_QUADS);				
+	OGL_Begin(GL_QUADS);				
 	glVertex3f(-1000,-1000,DARKEN_PANE_Z);
 	glVertex3f(1000,-1000,DARKEN_PANE_Z);
 	glVertex3f(1000,1000,DARKEN_PANE_Z);
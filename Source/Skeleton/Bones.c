@@ -255,6 +255,8 @@ SkeletonObjDataType	*currentSkelObjData;
 	if (gCurrentSkelObjData == nil)
 		return;
 	
+	PROF_BEGIN(kProf_UpdateSkinnedGeometry);
+
 	gCurrentSkeleton = currentSkelObjData->skeletonDefinition;
 	if (gCurrentSkeleton == nil)
 		DoFatalAlert("UpdateSkinnedGeometry: gCurrentSkeleton is invalid!");
@@ -292,8 +294,10 @@ SkeletonObjDataType	*currentSkelObjData;
 	gBBox->max.z -= theNode->Coord.z;
 	
 	gBBox->isEmpty = false;
-	
 
+	UpdateObjNodeHotEntry(theNode);														// culling needs the new bbox
+
+	PROF_END(kProf_UpdateSkinnedGeometry);
 }
 
 
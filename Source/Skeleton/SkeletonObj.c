@@ -62,7 +62,11 @@ short	i,numDecomp;
 		DoFatalAlert("LoadASkeleton: MAX_SKELETON_TYPES exceeded!");
 		
 	if (gLoadedSkeletonsList[num] == nil)					// check if already loaded
+	{
+		LoadTime_Begin(kLoad_LoadSkeletonFile);
 		gLoadedSkeletonsList[num] = LoadSkeletonFile(num);
+		LoadTime_End(kLoad_LoadSkeletonFile);
+	}
 				
 
 		/* MAKE LOCAL COPY OF DECOMPOSED TRIMESH */
@@ -185,7 +189,7 @@ long	numAnims,numJoints;
 				/* ALLOC ANIM EVENTS LISTS */
 				/***************************/
 
-	skeleton->NumAnimEvents = (Byte *)AllocPtr(sizeof(Byte)*numAnims);		// array which holds # events for each anim
+	skeleton->NumAnimEvents = (Byte *)AllocPtrTagged(sizeof(Byte)*numAnims, kMemTag_Skeleton);		// array which holds # events for each anim
 	if (skeleton->NumAnimEvents == nil)
 		DoFatalAlert("Not enough memory to alloc NumAnimEvents");
 
@@ -193,18 +197,18 @@ long	numAnims,numJoints;
 	
 			/* ALLOC BONE INFO */
 			
-	skeleton->Bones = (BoneDefinitionType *)AllocPtr(sizeof(BoneDefinitionType)*numJoints);	
+	skeleton->Bones = (BoneDefinitionType *)AllocPtrTagged(sizeof(BoneDefinitionType)*numJoints, kMemTag_Skeleton);	
 	if (skeleton->Bones == nil)
 		DoFatalAlert("Not enough memory to alloc Bones");
 
 
 		/* ALLOC DECOMPOSED DATA */
 			
-	skeleton->decomposedPointList = (DecomposedPointType *)AllocPtr(sizeof(DecomposedPointType)*MAX_DECOMPOSED_POINTS);		
+	skeleton->decomposedPointList = (DecomposedPointType *)AllocPtrTagged(sizeof(DecomposedPointType)*MAX_DECOMPOSED_POINTS, kMemTag_Skeleton);		
 	if (skeleton->decomposedPointList == nil)
 		DoFatalAlert("Not enough memory to alloc decomposedPointList");
 
-	skeleton->decomposedNormalsList = (OGLVector3D *)AllocPtr(sizeof(OGLVector3D)*MAX_DECOMPOSED_NORMALS);		
+	skeleton->decomposedNormalsList = (OGLVector3D *)AllocPtrTagged(sizeof(OGLVector3D)*MAX_DECOMPOSED_NORMALS, kMemTag_Skeleton);		
 	if (skeleton->decomposedNormalsList == nil)
 		DoFatalAlert("Not enough memory to alloc decomposedNormalsList");
 			
@@ -302,7 +306,7 @@ int					i;
 
 			/* ALLOC MEMORY FOR NEW SKELETON OBJECT DATA STRUCTURE */
 			
-	skeletonData = (SkeletonObjDataType *)AllocPtrClear(sizeof(SkeletonObjDataType));
+	skeletonData = (SkeletonObjDataType *)AllocPtrClearTagged(sizeof(SkeletonObjDataType), kMemTag_Skeleton);
 	if (skeletonData == nil)
 		DoFatalAlert("MakeNewSkeletonBaseData: Cannot alloc new SkeletonObjDataType");
 
@@ -80,6 +80,7 @@ Boolean	gDoneFaceOff;
 
 #define	TargetCoord	SpecialPt[0]
 #define TargetObj	SpecialObjPtr[0]
+#define	TargetObjGeneration	Special[0]
 
 int		gDuelKeySequenceLength, gDuelKeyBufferIndex;
 Byte	gDuelKeySequence[MAX_DUEL_KEY_SEQUENCE_LENGTH];
@@ -136,10 +137,19 @@ void PlayDuel(Byte difficulty)
 
 	while(true)
 	{
-				/* MOVE, UPDATE, & DRAW */
-				
-		ReadKeyboard();								
-		MoveEverything_Duel();
+				/* MOVE & UPDATE */
+
+		while (NextSimTick())
+		{
+			ReadKeyboard();
+			MoveEverything_Duel();
+
+			if (GetNewNeedState(kNeed_UIPause))							// see if paused
+				DoPaused();
+		}
+
+				/* DRAW */
+
 		KeepTerrainAlive();
 		OGL_DrawScene(DefaultDrawCallback);
 
@@ -153,12 +163,14 @@ void PlayDuel(Byte difficulty)
 			break;
 		}
 		
-		if (GetNewNeedState(kNeed_UIPause))								// see if paused
-			DoPaused();
-			
 		CalcFramesPerSecond();		
 
 		gGameFrameNum++;
+
+#if BENCHMARK
+		if (Bench_EndFrame())										// benchmark has played enough frames
+			break;
+#endif
 		
 				
 				/* SEE IF LEVEL IS COMPLETED */
@@ -861,6 +873,7 @@ float	speed;
 
 	newObj->TargetCoord = *bulletTargetCoord;					// remember where it impacts (if applicable)
 	newObj->TargetObj = bulletTargetObj;				// remember who we're shooting
+	newObj->TargetObjGeneration = bulletTargetObj ? bulletTargetObj->PoolGeneration : 0;
 
 			/* GIVE IT A SHADOW */
 			
@@ -944,35 +957,36 @@ int			anim;
 			DoBulletImpact(&theNode->TargetCoord, &splatVec, 1.0);
 		
 		
-			enemy = (ObjNode *)theNode->TargetObj;				// who are we shooting?
-			
-			
-					/* WHICH DEATH ANIM TO DO */
-					
-			switch(enemy->Kind)
+			enemy = GetLiveObjNode(theNode->TargetObj, (uint32_t) theNode->TargetObjGeneration);	// who are we shooting?
+			if (enemy)															// (nil if it's been deleted since we fired)
 			{
-				case	ENEMY_KIND_BANDITO:
-						anim = BANDITO_ANIM_GOTSHOT2;
-						break;
+						/* WHICH DEATH ANIM TO DO */
 
-				case	ENEMY_KIND_RYGAR:
-						anim = RYGAR_ANIM_SHOTINCHEST;
-						break;
+				switch(enemy->Kind)
+				{
+					case	ENEMY_KIND_BANDITO:
+							anim = BANDITO_ANIM_GOTSHOT2;
+							break;
 
-				case	ENEMY_KIND_SHORTY:
-						anim = RYGAR_ANIM_SHOTINCHEST;
-						break;
+					case	ENEMY_KIND_RYGAR:
+							anim = RYGAR_ANIM_SHOTINCHEST;
+							break;
 
-				default:
-						GAME_ASSERT_MESSAGE(false, "Unsupported enemy kind");
-			}
-			
-			MorphToSkeletonAnim(enemy->Skeleton, anim, 1);
-			enemy->Skeleton->AnimSpeed = TIME_DILATION;
+					case	ENEMY_KIND_SHORTY:
+							anim = RYGAR_ANIM_SHOTINCHEST;
+							break;
 
-			PlayEffect3D(EFFECT_BULLETHIT, &exitWoundPt);
+					default:
+							GAME_ASSERT_MESSAGE(false, "Unsupported enemy kind");
+				}
+
+				MorphToSkeletonAnim(enemy->Skeleton, anim, 1);
+				enemy->Skeleton->AnimSpeed = TIME_DILATION;
 
-			gScore += POINTS_DUEL_BANDIT;
+				PlayEffect3D(EFFECT_BULLETHIT, &exitWoundPt);
+
+				gScore += POINTS_DUEL_BANDIT;
+			}
 		
 		
 			DeleteObject(theNode);
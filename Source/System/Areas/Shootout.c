@@ -99,14 +99,23 @@ void PlayShootout(void)
 
 	while(true)
 	{
-				/* MOVE, UPDATE, & DRAW */
-				
-		ReadKeyboard();								
-		MoveEverything_Shootout();
+				/* MOVE & UPDATE */
+
+		while (NextSimTick())
+		{
+			ReadKeyboard();
+			MoveEverything_Shootout();
+
+			gTimeSinceLastEnemyShot += gFramesPerSecondFrac;
+
+			if (GetNewNeedState(kNeed_UIPause))								// see if paused
+				DoPaused();
+		}
+
+				/* DRAW */
+
 		KeepTerrainAlive();
 		OGL_DrawScene(DefaultDrawCallback);
-
-		gTimeSinceLastEnemyShot += gFramesPerSecondFrac;
 		
 								
 				/* MISC STUFF */
@@ -115,13 +124,14 @@ void PlayShootout(void)
 		if (IsCheatKeyComboDown())											// see if cheat to next stop-point		
 			gShootoutCanProceedToNextStopPoint = true;
 
-		
-		if (GetNewNeedState(kNeed_UIPause))									// see if paused
-			DoPaused();
-			
 		CalcFramesPerSecond();		
 		
 		gGameFrameNum++;
+
+#if BENCHMARK
+		if (Bench_EndFrame())										// benchmark has played enough frames
+			break;
+#endif
 		
 				
 				/* SEE IF LEVEL IS COMPLETED */
@@ -87,22 +87,33 @@ void PlayStampede(void)
 
 	while(true)
 	{
-				/* MOVE, UPDATE, & DRAW */
-				
-		ReadKeyboard();								
-		MoveEverything_Stampede();
+				/* MOVE & UPDATE */
+
+		while (NextSimTick())
+		{
+			ReadKeyboard();
+			MoveEverything_Stampede();
+
+			if (GetNewNeedState(kNeed_UIPause))							// see if paused
+				DoPaused();
+		}
+
+				/* DRAW */
+
 		KeepTerrainAlive();
 		OGL_DrawScene(DefaultDrawCallback);
 
 								
 				/* MISC STUFF */
 		
-		if (GetNewKeyState(SDL_SCANCODE_ESCAPE))						// see if paused
-			DoPaused();
-			
 		CalcFramesPerSecond();		
 				
 		gGameFrameNum++;
+
+#if BENCHMARK
+		if (Bench_EndFrame())										// benchmark has played enough frames
+			break;
+#endif
 		
 				
 				/* SEE IF LEVEL IS COMPLETED */
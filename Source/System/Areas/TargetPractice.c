@@ -85,21 +85,32 @@ void PlayTargetPractice(void)
 
 	while(true)
 	{
-				/* MOVE, UPDATE, & DRAW */
-				
-		ReadKeyboard();								
-		MoveEverything_TargetPractice();
+				/* MOVE & UPDATE */
+
+		while (NextSimTick())
+		{
+			ReadKeyboard();
+			MoveEverything_TargetPractice();
+
+			if (GetNewNeedState(kNeed_UIPause))							// see if paused
+				DoPaused();
+		}
+
+				/* DRAW */
+
 		OGL_DrawScene(DefaultDrawCallback);
 
 								
 				/* MISC STUFF */
 		
-		if (GetNewKeyState(SDL_SCANCODE_ESCAPE))						// see if paused
-			DoPaused();
-			
 		CalcFramesPerSecond();		
 
 		gGameFrameNum++;
+
+#if BENCHMARK
+		if (Bench_EndFrame())										// benchmark has played enough frames
+			break;
+#endif
 		
 				
 				/* SEE IF LEVEL IS COMPLETED */
@@ -0,0 +1,1559 @@
+/****************************/
+/*        BENCHMARK.C       */
+/****************************/
+//
+// Headless benchmark harness for the BillyFrontierBench target.
+//
+// Each requested area is played through the regular direct-launch path for
+// a fixed number of frames. The sim runs at a fixed timestep with a fixed
+// RNG seed, and a scripted "bot" supplies the input -- or, with --replay,
+// a recording made with the game's --record switch. When an area is done,
+// we log the per-frame wall-clock timing percentiles and the average GL
+// call counts per frame.
+//
+
+#if BENCHMARK
+
+/***************/
+/* EXTERNALS   */
+/***************/
+
+#include "game.h"
+#include <stdlib.h>
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+static void Bench_ScriptedInput(InputSnapshot* snapshot);
+static void Bench_BeginArea(int area);
+static void Bench_ReportArea(int area);
+static void Bench_TimeObjectListWalk(void);
+static void Bench_TimeRayQueries(int numQueries);
+static void Bench_RayQueries_Scan(int kind, const void* input, int numQueries, void* results);
+static void Bench_RayQueries_Tree(int kind, const void* input, int numQueries, void* results);
+static void Bench_RayQueries(int kind, const void* input, int numQueries, void* results);
+static Boolean Bench_IsRayHit(const void* result);
+static uintptr_t Bench_RayQuery(int kind, const OGLPoint3D* p1, const OGLPoint3D* p2);
+static void Bench_TimeFenceQueries(int numQueries);
+static void Bench_FenceQueries_Scan(int kind, const void* input, int numQueries, void* results);
+static void Bench_FenceQueries_Grid(int kind, const void* input, int numQueries, void* results);
+static void Bench_FenceQueries(int kind, const void* input, int numQueries, void* results);
+static Boolean Bench_IsFenceHit(const void* result);
+static void Bench_TimeTerrainQueries(int numQueries);
+static void Bench_TerrainQueries_PlaneEq(int kind, const void* input, int numQueries, void* results);
+static void Bench_TerrainQueries_Table(int kind, const void* input, int numQueries, void* results);
+static void Bench_TerrainQueries(int kind, const void* input, int numQueries, void* results);
+static Boolean Bench_CompareTerrainResults(int kind, const void* input, int i, const void* scanResult, const void* fastResult);
+static void Bench_TimeSuperTileKernels(void);
+static void Bench_SuperTileKernels_Scalar(int kind, const void* input, int numSuperTiles, void* results);
+static void Bench_SuperTileKernels_SIMD(int kind, const void* input, int numSuperTiles, void* results);
+static void Bench_SuperTileKernels(int kind, const void* input, int numSuperTiles, void* results);
+static void Bench_ObjectChurn(int numNodes);
+static ObjNode* Bench_MakeChurnNode(int slot);
+static void Bench_VerifyObjectList(const char* when);
+static int Bench_CompareFloats(const void* a, const void* b);
+
+
+/*********************/
+/*    VARIABLES      */
+/*********************/
+
+int				gBenchmarkFrames	= BENCH_DEFAULT_FRAMES;		// # frames to play in each area
+float			gBenchmarkTickRate	= BENCH_DEFAULT_TICKRATE;	// fixed sim rate fed to CalcFramesPerSecond
+
+static uint32_t	gBenchmarkSeed		= BENCH_DEFAULT_SEED;
+
+static int		gBenchmarkAreas[BENCH_MAX_AREAS];
+static int		gBenchmarkNumAreas	= 0;
+
+static float*	gFrameTimes			= NULL;						// ms per frame in current area
+static int		gNumFrameTimes		= 0;
+static int		gFramesPlayed		= 0;
+static Uint64	gLastFrameStamp		= 0;
+
+static struct
+{
+	double		polys;
+	double		drawCalls;
+	double		textureBinds;
+	double		statePops;
+	double		stateToggles;
+	double		immediateBlocks;
+	int			maxDrawCalls;
+} gGLCounterTotals;													// sum of the per-frame counters in current area
+
+static double	gMemoryTagAllocTotals[NUM_MEMORY_TAGS];				// sum of the per-frame allocation counts in current area
+
+static double	gObjectWalkTicks = 0;									// time spent walking the object list in current area
+static double	gObjectWalkNodes = 0;									// # nodes visited
+
+		/* SCAN VS. FAST PATH QUERIES */
+		//
+		// --raycast & --terrain time each kind of query the old way and then the new
+		// way on the same inputs, and make sure that both ways got the same results.
+		// Each test just lists its kinds of query in a BenchQuerySet; Bench_TimeQueries
+		// & Bench_ReportQueries do the rest.
+		//
+
+typedef void	(*BenchQueryFunc)(int kind, const void* input, int numQueries, void* results);
+typedef Boolean	(*BenchCompareFunc)(int kind, const void* input, int i, const void* scanResult, const void* fastResult);
+
+typedef struct
+{
+	const char*			name;
+	BenchQueryFunc		scan;										// the old way
+	BenchQueryFunc		fast;										// ...and the new way, timed against it
+	BenchCompareFunc	compare;									// true if they agree, nil to compare the bytes
+	size_t				resultSize;									// bytes per query
+	Boolean				(*isHit)(const void* result);				// nil if the query doesn't hit things
+} BenchQueryKind;
+
+typedef struct
+{
+	Uint64		scanTicks;
+	Uint64		fastTicks;
+	int			numQueries;
+	int			numHits;
+} BenchQueryTimes;
+
+typedef struct
+{
+	const char*				label;
+	const char*				scanName;								// what the report calls the two ways
+	const char*				fastName;
+	const char*				unit;									// what one query is
+	const BenchQueryKind*	kinds;
+	int						numKinds;
+	BenchQueryTimes*		times;									// numKinds of them, from the end of the current area
+} BenchQuerySet;
+
+static void Bench_TimeQueries(const BenchQuerySet* set, const void* input, int numQueries);
+static void Bench_ReportQueries(int area, const BenchQuerySet* set);
+
+typedef struct
+{
+	OGLPoint3D*		p1;
+	OGLPoint3D*		p2;
+	float*			radius;											// fence probes only
+} BenchSegmentInput;
+
+typedef struct
+{
+	Boolean		hit;
+	Boolean		overTop;
+	OGLPoint3D	intersect;											// or where the probe ended up
+	float		fenceTopY;
+} BenchFenceResult;
+
+typedef struct
+{
+	float*		x;
+	float*		z;
+} BenchTerrainInput;
+
+typedef struct
+{
+	int*					row;									// in supertiles
+	int*					col;
+	OGLPoint3D*				points;									// NUM_VERTICES_IN_SUPERTILE per supertile
+	MOTriangleIndecies*		triangles;								// NUM_TRIS_IN_SUPERTILE per supertile
+	OGLVector3D*			normals;								// the scalar vertex normals, to light
+	const OGLLightDefType*	lights;
+} BenchSuperTileInput;
+
+#define	RAYCAST_NUM_KINDS			3
+#define	FENCEQUERY_NUM_KINDS		2
+#define	TERRAINQUERY_NUM_KINDS		3
+#define	SUPERTILEKERNEL_NUM_KINDS	2
+
+static const BenchQueryKind kRayQueryKinds[RAYCAST_NUM_KINDS] =
+{
+	{ "OGL_DoRayCollision",				Bench_RayQueries_Scan,		Bench_RayQueries_Tree,		nil,	sizeof(uintptr_t),	Bench_IsRayHit },
+	{ "OGL_DoLineSegmentCollision",		Bench_RayQueries_Scan,		Bench_RayQueries_Tree,		nil,	sizeof(uintptr_t),	Bench_IsRayHit },
+	{ "SeeIfLineSegmentHitsAnything",	Bench_RayQueries_Scan,		Bench_RayQueries_Tree,		nil,	sizeof(uintptr_t),	Bench_IsRayHit },
+};
+
+static const BenchQueryKind kFenceQueryKinds[FENCEQUERY_NUM_KINDS] =
+{
+	{ "SeeIfLineSegmentHitsFence",		Bench_FenceQueries_Scan,	Bench_FenceQueries_Grid,	nil,	sizeof(BenchFenceResult),	Bench_IsFenceHit },
+	{ "DoFenceCollision",				Bench_FenceQueries_Scan,	Bench_FenceQueries_Grid,	nil,	sizeof(BenchFenceResult),	Bench_IsFenceHit },
+};
+
+static const BenchQueryKind kTerrainQueryKinds[TERRAINQUERY_NUM_KINDS] =
+{
+	{ "GetTerrainY",					Bench_TerrainQueries_PlaneEq,	Bench_TerrainQueries_Table,	Bench_CompareTerrainResults,	sizeof(float),			nil },
+	{ "GetTerrainYBatch",				Bench_TerrainQueries_PlaneEq,	Bench_TerrainQueries_Table,	Bench_CompareTerrainResults,	sizeof(float),			nil },
+	{ "CalcTileNormals",				Bench_TerrainQueries_PlaneEq,	Bench_TerrainQueries_Table,	Bench_CompareTerrainResults,	sizeof(OGLVector3D) * 2,	nil },
+};
+
+static const BenchQueryKind kSuperTileKernelKinds[SUPERTILEKERNEL_NUM_KINDS] =
+{
+	{ "CalculateSupertileVertexNormals",	Bench_SuperTileKernels_Scalar,	Bench_SuperTileKernels_SIMD,	nil,	sizeof(OGLVector3D) * NUM_VERTICES_IN_SUPERTILE,		nil },
+	{ "LightSuperTileVertices",				Bench_SuperTileKernels_Scalar,	Bench_SuperTileKernels_SIMD,	nil,	sizeof(OGLColorRGBA_Byte) * NUM_VERTICES_IN_SUPERTILE,	nil },
+};
+
+static BenchQueryTimes	gRayQueryTimes[RAYCAST_NUM_KINDS];
+static BenchQueryTimes	gFenceQueryTimes[FENCEQUERY_NUM_KINDS];
+static BenchQueryTimes	gTerrainQueryTimes[TERRAINQUERY_NUM_KINDS];
+static BenchQueryTimes	gSuperTileKernelTimes[SUPERTILEKERNEL_NUM_KINDS];
+
+static const BenchQuerySet kRayQuerySet			= { "raycast",   "scan",     "tree",  "queries",    kRayQueryKinds,        RAYCAST_NUM_KINDS,         gRayQueryTimes };
+static const BenchQuerySet kFenceQuerySet		= { "fences",    "scan",     "grid",  "queries",    kFenceQueryKinds,      FENCEQUERY_NUM_KINDS,      gFenceQueryTimes };
+static const BenchQuerySet kTerrainQuerySet		= { "terrain",   "plane eq", "table", "queries",    kTerrainQueryKinds,    TERRAINQUERY_NUM_KINDS,    gTerrainQueryTimes };
+static const BenchQuerySet kSuperTileKernelSet	= { "supertile", "scalar",   "simd",  "supertiles", kSuperTileKernelKinds, SUPERTILEKERNEL_NUM_KINDS, gSuperTileKernelTimes };
+
+static const BenchQuerySet* const kBenchQuerySets[] =
+{
+	&kRayQuerySet,
+	&kFenceQuerySet,
+	&kTerrainQuerySet,
+	&kSuperTileKernelSet,
+};
+
+#define	NUM_BENCH_QUERY_SETS	(int) (sizeof(kBenchQuerySets) / sizeof(kBenchQuerySets[0]))
+
+static Boolean	gBenchmarkLoadAll	= false;
+static int		gBenchmarkChurnNodes = 0;						// --churn
+static int		gBenchmarkRayQueries = 0;						// --raycast
+static int		gBenchmarkTerrainQueries = 0;					// --terrain
+static long		gChurnSeq = 0;
+
+#define	ChurnSeq	Special[0]									// order in which a churn node was (re)attached
+#define	ChurnTag	Special[1]
+#define	CHURN_TAG	0x6368726e
+
+
+/******************* BENCH: PARSE COMMAND LINE ***********************/
+//
+// Supported switches:
+//		--frames N		# of frames to play in each area
+//		--tickrate N	fixed sim rate in Hz
+//		--seed N		RNG seed, reset before each area
+//		--area N		area to play (see AREA_* enum); may be repeated
+//		--replay FILE	play back an input recording instead (its area, until it runs out)
+//		--trace FILE	dump the profiler zones to a Chrome trace_event JSON file
+//		--loadreport FILE	append each area's load-time report to FILE as JSON lines
+//		--load-all		just load every area back to back (1 frame each) for the load-time reports
+//		--churn N		spawn, re-attach & delete N objects at a time to time the object list (no areas unless --area is given)
+//		--raycast N		at the end of each area, time N of each kind of ray query with the ray tree & mesh BVH's, and with the scans
+//		--terrain N		at the end of each area, time N terrain height & normal queries with the plane table, and with plane equations; and the supertile normal & lighting kernels, scalar and SIMD
+//		--verify-collision	check every CollisionDetect & ray query against the brute force scans, prefetched & cached supertiles against fresh builds, and the supertile buffers against their arrays
+//
+// Returns false if the command line is bad.
+//
+
+Boolean Bench_ParseCommandLine(int argc, char** argv)
+{
+	Boolean framesGiven = false;
+	Boolean replay = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		const char* val = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+		if (0 == SDL_strcmp(arg, "--load-all"))						// switches without a value
+		{
+			gBenchmarkLoadAll = true;
+			continue;
+		}
+
+		if (0 == SDL_strcmp(arg, "--verify-collision"))
+		{
+			gVerifyCollisionGrid = true;
+			gVerifyRayTree = true;
+			gVerifyMeshBVH = true;
+			gVerifyFenceGrid = true;
+			gVerifyWaterTiles = true;
+			gVerifyTerrainPlanes = true;
+			gVerifySuperTilePrefetch = true;
+			gVerifySuperTileCache = true;
+			gVerifySuperTileBuffers = true;
+			continue;
+		}
+
+		if (!val)
+		{
+			SDL_Log("Bench: missing value after %s", arg);
+			return false;
+		}
+
+		if (0 == SDL_strcmp(arg, "--frames"))
+		{
+			gBenchmarkFrames = SDL_atoi(val);
+			framesGiven = true;
+		}
+		else
+		if (0 == SDL_strcmp(arg, "--tickrate"))
+			gBenchmarkTickRate = (float) SDL_atof(val);
+		else
+		if (0 == SDL_strcmp(arg, "--seed"))
+			gBenchmarkSeed = (uint32_t) SDL_strtoul(val, NULL, 0);
+		else
+		if (0 == SDL_strcmp(arg, "--area"))
+		{
+			if (gBenchmarkNumAreas >= BENCH_MAX_AREAS)
+			{
+				SDL_Log("Bench: too many areas");
+				return false;
+			}
+			gBenchmarkAreas[gBenchmarkNumAreas++] = SDL_atoi(val);
+		}
+		else
+		if (0 == SDL_strcmp(arg, "--replay"))
+		{
+			if (replay || !Replay_OpenForPlayback(val))
+				return false;
+			replay = true;
+		}
+		else
+		if (0 == SDL_strcmp(arg, "--trace"))
+		{
+			if (!Prof_StartTrace(val))
+				return false;
+		}
+		else
+		if (0 == SDL_strcmp(arg, "--loadreport"))
+		{
+			if (!LoadTime_OpenReportFile(val))
+				return false;
+		}
+		else
+		if (0 == SDL_strcmp(arg, "--churn"))
+		{
+			gBenchmarkChurnNodes = SDL_atoi(val);
+			if (gBenchmarkChurnNodes <= 0)
+			{
+				SDL_Log("Bench: --churn must be > 0");
+				return false;
+			}
+		}
+		else
+		if (0 == SDL_strcmp(arg, "--raycast"))
+		{
+			gBenchmarkRayQueries = SDL_atoi(val);
+			if (gBenchmarkRayQueries <= 0)
+			{
+				SDL_Log("Bench: --raycast must be > 0");
+				return false;
+			}
+		}
+		else
+		if (0 == SDL_strcmp(arg, "--terrain"))
+		{
+			gBenchmarkTerrainQueries = SDL_atoi(val);
+			if (gBenchmarkTerrainQueries <= 0)
+			{
+				SDL_Log("Bench: --terrain must be > 0");
+				return false;
+			}
+		}
+		else
+		{
+			SDL_Log("Bench: unknown switch %s", arg);
+			return false;
+		}
+
+		i++;															// skip value
+	}
+
+	if (gBenchmarkFrames <= 0 || gBenchmarkTickRate < MIN_FPS)
+	{
+		SDL_Log("Bench: --frames must be > 0 and --tickrate must be >= %d", MIN_FPS);
+		return false;
+	}
+
+			/* LOAD-ALL: EVERY AREA, 1 FRAME EACH */
+
+	if (gBenchmarkLoadAll)
+	{
+		if (replay)
+		{
+			SDL_Log("Bench: --load-all and --replay can't be combined");
+			return false;
+		}
+
+		if (gBenchmarkNumAreas == 0)
+		{
+			for (int area = AREA_TOWN_DUEL1; area <= AREA_TARGETPRACTICE2; area++)
+				gBenchmarkAreas[gBenchmarkNumAreas++] = area;
+		}
+
+		if (!framesGiven)
+			gBenchmarkFrames = 1;
+	}
+
+			/* REPLAY: PLAY THE RECORDED AREA TO THE END */
+
+	if (replay)
+	{
+		if (gBenchmarkNumAreas != 0)
+		{
+			SDL_Log("Bench: --area and --replay can't be combined");
+			return false;
+		}
+
+		gBenchmarkAreas[gBenchmarkNumAreas++] = Replay_GetPlaybackArea();
+
+		if (!framesGiven && Replay_GetPlaybackNumTicks() != 0)
+			gBenchmarkFrames = Replay_GetPlaybackNumTicks();		// 1 tick per frame in the bench, so this is enough
+	}
+
+			/* DEFAULT: ONE OF EACH AREA TYPE */
+
+	if (gBenchmarkNumAreas == 0 && gBenchmarkChurnNodes == 0)
+	{
+		gBenchmarkAreas[gBenchmarkNumAreas++] = AREA_TOWN_SHOOTOUT;
+		gBenchmarkAreas[gBenchmarkNumAreas++] = AREA_TOWN_STAMPEDE;
+		gBenchmarkAreas[gBenchmarkNumAreas++] = AREA_TOWN_DUEL1;
+		gBenchmarkAreas[gBenchmarkNumAreas++] = AREA_TARGETPRACTICE1;
+	}
+
+	return true;
+}
+
+
+/*********************** RUN BENCHMARK ***************************/
+//
+// Called by GameMain instead of the title screens.
+//
+
+void RunBenchmark(void)
+{
+	SDL_GL_SetSwapInterval(0);									// don't let vsync mask the frame times
+
+	gFrameTimes = AllocPtrClear(sizeof(float) * gBenchmarkFrames);
+
+	SDL_Log("Bench: %d frames/area @ %.0f Hz, seed 0x%08x",
+			gBenchmarkFrames, gBenchmarkTickRate, gBenchmarkSeed);
+
+	if (gBenchmarkChurnNodes > 0)
+		Bench_ObjectChurn(gBenchmarkChurnNodes);
+
+	double	totalLoadMs = 0;
+	float	maxLoadMs = 0;
+	int		numLoaded = 0;
+
+	for (int i = 0; i < gBenchmarkNumAreas; i++)
+	{
+		int area = gBenchmarkAreas[i];
+
+		if (area < AREA_TOWN_DUEL1 || area > AREA_TARGETPRACTICE2)
+		{
+			SDL_Log("Bench: skipping bad area %d", area);
+			continue;
+		}
+
+		Bench_BeginArea(area);
+
+		Boolean replay = Replay_BeginArea(area);					// takes over the input & RNG seed if --replay was given
+		if (!replay)
+			SetInputOverride(Bench_ScriptedInput);
+
+		PlayArea(area);
+
+		if (replay)
+			Replay_EndArea();
+		else
+			SetInputOverride(NULL);
+
+		totalLoadMs += gLastLoadTimeMS;								// Load*Art's report was logged as the area started
+		maxLoadMs = GAME_MAX(maxLoadMs, gLastLoadTimeMS);
+		numLoaded++;
+
+		if (!gBenchmarkLoadAll)
+			Bench_ReportArea(area);
+	}
+
+	if (numLoaded > 0)
+	{
+		SDL_Log("Bench: load time: %d areas, total %.1f ms, mean %.1f ms, max %.1f ms",
+				numLoaded, totalLoadMs, totalLoadMs / numLoaded, maxLoadMs);
+	}
+
+	LoadTime_CloseReportFile();
+
+	SafeDisposePtr(gFrameTimes);
+	gFrameTimes = NULL;
+}
+
+
+/********************** BENCH: BEGIN AREA ***********************/
+
+static void Bench_BeginArea(int area)
+{
+	InitPlayerInfo_Game();
+	gCurrentArea = area;								// so that the input script knows where we are from the first frame
+
+	SetMyRandomSeed(gBenchmarkSeed);
+
+	gNumFrameTimes = 0;
+	gFramesPlayed = 0;
+	gLastFrameStamp = 0;
+	SDL_zero(gGLCounterTotals);
+	SDL_zero(gMemoryTagAllocTotals);
+	gObjectWalkTicks = 0;
+	gObjectWalkNodes = 0;
+	SDL_zero(gCollisionGridStats);
+	SDL_zero(gRayTreeStats);
+	SDL_zero(gMeshBVHStats);
+	SDL_zero(gFenceGridStats);
+	for (int i = 0; i < NUM_BENCH_QUERY_SETS; i++)
+		SDL_memset(kBenchQuerySets[i]->times, 0, sizeof(BenchQueryTimes) * kBenchQuerySets[i]->numKinds);
+	ResetSuperTileBuildStats();
+	SDL_zero(gSuperTileCacheStats);
+	SDL_zero(gSuperTileBufferStats);
+	SDL_zero(gSuperTileLODStats);
+
+	ResetMemoryTagPeaks();								// so that the peaks include this area's load
+	gObjNodePoolStats.peakLive = gObjNodePoolStats.numLive;
+}
+
+
+/********************** BENCH: END FRAME ***********************/
+//
+// Called by the area main loops right after gGameFrameNum++.
+// Returns true once the area has played enough frames.
+//
+
+Boolean Bench_EndFrame(void)
+{
+	Uint64 now = SDL_GetPerformanceCounter();
+
+	if (gLastFrameStamp != 0)									// 1st frame also includes the tail end of the level setup, so don't time it
+	{
+		GAME_ASSERT(gNumFrameTimes < gBenchmarkFrames);
+		gFrameTimes[gNumFrameTimes++] = (float) ((now - gLastFrameStamp) * 1000.0 / SDL_GetPerformanceFrequency());
+
+		gGLCounterTotals.polys				+= gPolysThisFrame;				// OGL_DrawScene just ran, so these are this frame's
+		gGLCounterTotals.drawCalls			+= gDrawCallsThisFrame;
+		gGLCounterTotals.textureBinds		+= gTextureBindsThisFrame;
+		gGLCounterTotals.statePops			+= gStatePopsThisFrame;
+		gGLCounterTotals.stateToggles		+= gStateTogglesThisFrame;
+		gGLCounterTotals.immediateBlocks	+= gImmediateBlocksThisFrame;
+		gGLCounterTotals.maxDrawCalls		= GAME_MAX(gGLCounterTotals.maxDrawCalls, gDrawCallsThisFrame);
+
+		for (int tag = 0; tag < NUM_MEMORY_TAGS; tag++)
+			gMemoryTagAllocTotals[tag] += gMemoryTagStats[tag].allocsLastFrame;
+
+		Bench_TimeObjectListWalk();
+		now = SDL_GetPerformanceCounter();						// don't count the walk in the next frame's time
+	}
+
+	gLastFrameStamp = now;
+
+	gFramesPlayed++;
+
+	if (gFramesPlayed >= gBenchmarkFrames && gBenchmarkRayQueries > 0)
+	{
+		Bench_TimeRayQueries(gBenchmarkRayQueries);				// while the area's objects are still around
+		Bench_TimeFenceQueries(gBenchmarkRayQueries);
+	}
+
+	if (gFramesPlayed >= gBenchmarkFrames && gBenchmarkTerrainQueries > 0)
+	{
+		Bench_TimeTerrainQueries(gBenchmarkTerrainQueries);
+		Bench_TimeSuperTileKernels();
+	}
+
+	return gFramesPlayed >= gBenchmarkFrames;
+}
+
+
+/********************** BENCH: REPORT AREA ***********************/
+
+static void Bench_ReportArea(int area)
+{
+	int n = gNumFrameTimes;
+
+	if (n == 0)
+	{
+		SDL_Log("Bench: area %2d: no frames timed", area);
+		return;
+	}
+
+	qsort(gFrameTimes, n, sizeof(float), Bench_CompareFloats);
+
+	double total = 0;
+	for (int i = 0; i < n; i++)
+		total += gFrameTimes[i];
+
+#define PCT(p) gFrameTimes[GAME_MIN(n - 1, (int) ((p) * n / 100))]
+
+	SDL_Log("Bench: area %2d: %5d frames%s  mean %7.3f  p50 %7.3f  p90 %7.3f  p95 %7.3f  p99 %7.3f  max %7.3f (ms)",
+			area,
+			gFramesPlayed,
+			gFramesPlayed < gBenchmarkFrames ? " (ended early)" : "",
+			total / n,
+			PCT(50), PCT(90), PCT(95), PCT(99),
+			gFrameTimes[n - 1]);
+
+#undef PCT
+
+	SDL_Log("Bench: area %2d: per frame: tris %.0f  draws %.1f (max %d)  tex binds %.1f  state pops %.1f  toggles %.1f  glBegins %.1f",
+			area,
+			gGLCounterTotals.polys / n,
+			gGLCounterTotals.drawCalls / n,
+			gGLCounterTotals.maxDrawCalls,
+			gGLCounterTotals.textureBinds / n,
+			gGLCounterTotals.statePops / n,
+			gGLCounterTotals.stateToggles / n,
+			gGLCounterTotals.immediateBlocks / n);
+
+	for (int tag = 0; tag < NUM_MEMORY_TAGS; tag++)
+	{
+		const MemoryTagStats* stats = &gMemoryTagStats[tag];
+
+		if (stats->peakBytes == 0 && gMemoryTagAllocTotals[tag] == 0)
+			continue;
+
+		SDL_Log("Bench: area %2d: mem %-9s peak %7ld KB  live at exit %7ld KB  allocs/frame %.2f",
+				area,
+				GetMemoryTagName(tag),
+				stats->peakBytes / 1024,
+				stats->liveBytes / 1024,
+				gMemoryTagAllocTotals[tag] / n);
+	}
+
+	SDL_Log("Bench: area %2d: object list walk: %.2f ns/node, %.0f nodes/frame, sizeof(ObjNode) %d bytes",
+			area,
+			gObjectWalkNodes > 0 ? gObjectWalkTicks * 1e9 / SDL_GetPerformanceFrequency() / gObjectWalkNodes : 0.0,
+			gObjectWalkNodes / n,
+			(int) sizeof(ObjNode));
+
+	const CollisionGridStats* grid = &gCollisionGridStats;
+
+	SDL_Log("Bench: area %2d: collision grid: %.1f queries/frame  %.1f candidates/query  %u fallbacks  %.1f refiles/frame%s",
+			area,
+			(double) grid->numQueries / n,
+			grid->numQueries ? (double) grid->numCandidates / grid->numQueries : 0.0,
+			grid->numFallbacks,
+			(double) grid->numRefiles / n,
+			gVerifyCollisionGrid ? "  (verified against scan)" : "");
+
+	const RayTreeStats* tree = &gRayTreeStats;
+
+	SDL_Log("Bench: area %2d: ray tree: %.1f queries/frame  %.1f candidates/query  %.1f nodes visited/query  %.1f reinserts/frame  %d leaves%s",
+			area,
+			(double) tree->numQueries / n,
+			tree->numQueries ? (double) tree->numCandidates / tree->numQueries : 0.0,
+			tree->numQueries ? (double) tree->numNodesVisited / tree->numQueries : 0.0,
+			(double) tree->numReinserts / n,
+			GetRayTreeNumLeaves(),
+			gVerifyRayTree ? "  (verified against scan)" : "");
+
+	const MeshBVHStats* meshBVH = &gMeshBVHStats;
+
+	SDL_Log("Bench: area %2d: mesh bvh: %.1f queries/frame  %.1f of %.1f triangles tested/query%s",
+			area,
+			(double) meshBVH->numQueries / n,
+			meshBVH->numQueries ? (double) meshBVH->numTrianglesGathered / meshBVH->numQueries : 0.0,
+			meshBVH->numQueries ? (double) meshBVH->numTrianglesInMeshes / meshBVH->numQueries : 0.0,
+			gVerifyMeshBVH ? "  (verified against all triangles)" : "");
+
+	const FenceGridStats* fenceGrid = &gFenceGridStats;
+
+	SDL_Log("Bench: area %2d: fence grid: %.1f queries/frame  %.1f of %d sections tested/query  %u fallbacks%s",
+			area,
+			(double) fenceGrid->numQueries / n,
+			fenceGrid->numQueries ? (double) fenceGrid->numSectionsTested / fenceGrid->numQueries : 0.0,
+			GetFenceGridNumSections(),
+			fenceGrid->numFallbacks,
+			gVerifyFenceGrid ? "  (verified against scan)" : "");
+
+	for (int i = 0; i < NUM_BENCH_QUERY_SETS; i++)
+		Bench_ReportQueries(area, kBenchQuerySets[i]);
+
+	if (gBenchmarkTerrainQueries > 0 && gTerrainTilePlanes)
+	{
+		SDL_Log("Bench: area %2d: terrain plane table: %dx%d tiles, %.1f KB (a 400x400 map would take %.1f KB, its heights %.1f KB)",
+				area,
+				gTerrainTileWidth, gTerrainTileDepth,
+				sizeof(TerrainTilePlanes) * gTerrainTileWidth * gTerrainTileDepth / 1024.0,
+				sizeof(TerrainTilePlanes) * 400 * 400 / 1024.0,
+				sizeof(float) * 401 * 401 / 1024.0);
+	}
+
+	SuperTileBuildStats buildStats;
+	GetSuperTileBuildStats(&buildStats);
+
+	SDL_Log("Bench: area %2d: supertiles: %u built on main thread, %u prefetched (%u adopted, %u waited on, %u discarded)%s",
+			area,
+			buildStats.numBuiltOnMainThread,
+			buildStats.numPrefetched,
+			buildStats.numPrefetchHits,
+			buildStats.numWaits,
+			buildStats.numDiscarded,
+			gVerifySuperTilePrefetch ? "  (verified against main thread)" : "");
+
+	SDL_Log("Bench: area %2d: supertile cache: %u hits, %u builds (%.1f%% hits, %.1f builds per game second), %u evicted, %u invalidated by deformations%s",
+			area,
+			gSuperTileCacheStats.numHits,
+			gSuperTileCacheStats.numBuilds,
+			100.0 * gSuperTileCacheStats.numHits / GAME_MAX(gSuperTileCacheStats.numHits + gSuperTileCacheStats.numBuilds, 1u),
+			gSuperTileCacheStats.numBuilds * gBenchmarkTickRate / GAME_MAX(gFramesPlayed, 1),
+			gSuperTileCacheStats.numEvicted,
+			gSuperTileCacheStats.numInvalidated,
+			gVerifySuperTileCache ? "  (verified against fresh builds)" : "");
+
+	if (gNumSuperTileIndexPatterns > 0)
+	{
+		const size_t clientArrayBytes = NUM_VERTICES_IN_SUPERTILE * (sizeof(OGLPoint3D) + sizeof(OGLVector3D) + sizeof(OGLTextureCoord) + sizeof(OGLColorRGBA_Byte))
+										+ NUM_TRIS_IN_SUPERTILE * sizeof(MOTriangleIndecies);
+
+		SDL_Log("Bench: area %2d: supertile buffers: %d index layouts for %dx%d supertiles, %u full uploads, %u partial, %.1f KB sent per frame (client arrays would be %.1f KB)%s",
+				area,
+				gNumSuperTileIndexPatterns,
+				gNumSuperTilesWide, gNumSuperTilesDeep,
+				gSuperTileBufferStats.numFullUploads,
+				gSuperTileBufferStats.numPartialUploads,
+				gSuperTileBufferStats.numBytesUploaded / 1024.0 / GAME_MAX(gFramesPlayed, 1),
+				(double) clientArrayBytes * gSuperTileBufferStats.numDraws / 1024.0 / GAME_MAX(gFramesPlayed, 1),
+				gVerifySuperTileBuffers ? "  (verified against the arrays)" : "");
+	}
+	else
+	{
+		SDL_Log("Bench: area %2d: supertile buffers: not in use", area);
+	}
+
+	{
+		uint32_t numSuperTilesDrawn = gSuperTileLODStats.numDrawn[0] + gSuperTileLODStats.numDrawn[1] + gSuperTileLODStats.numDrawn[2];
+
+		SDL_Log("Bench: area %2d: terrain lod: %u / %u / %u supertiles drawn at 8x8 / 4x4 / 2x2 quads, %.0f triangles per frame (%.1f%% of full detail)",
+				area,
+				gSuperTileLODStats.numDrawn[0],
+				gSuperTileLODStats.numDrawn[1],
+				gSuperTileLODStats.numDrawn[2],
+				(double) gSuperTileLODStats.numTriangles / GAME_MAX(gFramesPlayed, 1),
+				100.0 * gSuperTileLODStats.numTriangles / GAME_MAX(numSuperTilesDrawn * NUM_TRIS_IN_SUPERTILE, 1u));
+	}
+
+	SDL_Log("Bench: area %2d: objnode pool: peak %d  capacity %d (%d slabs)  overflow allocs %u  stale refs %u",
+			area,
+			gObjNodePoolStats.peakLive,
+			gObjNodePoolStats.capacity,
+			gObjNodePoolStats.numSlabs,
+			gObjNodePoolStats.numOverflowAllocs,
+			gObjNodePoolStats.numStaleRefs);
+}
+
+
+/********************** BENCH: TIME OBJECT LIST WALK ***********************/
+//
+// Follows NextNode through the whole object list touching the fields that
+// MoveObjects & CullTestAllObjects look at first, which shows how much the
+// size of ObjNode costs the hot loops in cache misses.
+//
+
+static void Bench_TimeObjectListWalk(void)
+{
+	static volatile uint32_t sink;
+	uint32_t	bits = 0;
+	int			numNodes = 0;
+
+	Uint64 start = SDL_GetPerformanceCounter();
+
+	for (ObjNode* node = gFirstNodePtr; node != nil; node = node->NextNode)
+	{
+		bits ^= node->StatusBits ^ (uint32_t) node->Coord.x;
+		numNodes++;
+	}
+
+	gObjectWalkTicks += SDL_GetPerformanceCounter() - start;
+	gObjectWalkNodes += numNodes;
+	sink = bits;
+}
+
+
+/********************** BENCH: TIME QUERIES ***********************/
+//
+// Runs numQueries of each kind of query in the set, first the old way and
+// then the new way, adds up the times, and stops if the two ways don't
+// agree on every single query.
+//
+
+static void Bench_TimeQueries(const BenchQuerySet* set, const void* input, int numQueries)
+{
+	for (int kind = 0; kind < set->numKinds; kind++)
+	{
+		const BenchQueryKind*	query = &set->kinds[kind];
+		BenchQueryTimes*		times = &set->times[kind];
+		Byte*					results[2];
+
+		results[0] = (Byte*) AllocPtrClear(query->resultSize * numQueries);		// cleared so that struct padding compares the same
+		results[1] = (Byte*) AllocPtrClear(query->resultSize * numQueries);
+
+				/* TIME THE OLD WAY, THEN THE NEW ONE */
+
+		Uint64 start = SDL_GetPerformanceCounter();
+		query->scan(kind, input, numQueries, results[0]);
+		Uint64 mid = SDL_GetPerformanceCounter();
+		query->fast(kind, input, numQueries, results[1]);
+		Uint64 end = SDL_GetPerformanceCounter();
+
+		times->scanTicks += mid - start;
+		times->fastTicks += end - mid;
+		times->numQueries += numQueries;
+
+				/* THEY MUST AGREE */
+
+		for (int i = 0; i < numQueries; i++)
+		{
+			const Byte* scan = results[0] + i * query->resultSize;
+			const Byte* fast = results[1] + i * query->resultSize;
+			Boolean same;
+
+			if (query->compare)
+				same = query->compare(kind, input, i, scan, fast);
+			else
+				same = (0 == SDL_memcmp(scan, fast, query->resultSize));
+
+			if (!same)
+				DoFatalAlert("Bench: %s #%d: %s and %s disagree", query->name, i, set->fastName, set->scanName);
+
+			if (query->isHit && query->isHit(fast))
+				times->numHits++;
+		}
+
+		SafeDisposePtr((Ptr) results[1]);
+		SafeDisposePtr((Ptr) results[0]);
+	}
+}
+
+
+/********************** BENCH: REPORT QUERIES ***********************/
+
+static void Bench_ReportQueries(int area, const BenchQuerySet* set)
+{
+	const double freq = (double) SDL_GetPerformanceFrequency();
+
+	for (int kind = 0; kind < set->numKinds; kind++)
+	{
+		const BenchQueryTimes* times = &set->times[kind];
+		char hits[32] = "";
+
+		if (times->numQueries == 0)										// this test didn't run
+			continue;
+
+		Uint64 scanTicks = GAME_MAX(times->scanTicks, 1);
+		Uint64 fastTicks = GAME_MAX(times->fastTicks, 1);
+
+		if (set->kinds[kind].isHit)
+			SDL_snprintf(hits, sizeof(hits), ", %d hits", times->numHits);
+
+		SDL_Log("Bench: area %2d: %-9s %-32s %d %s%s: %s %9.0f/s  %s %9.0f/s  (%.1fx)",
+				area,
+				set->label,
+				set->kinds[kind].name,
+				times->numQueries,
+				set->unit,
+				hits,
+				set->scanName, times->numQueries * freq / scanTicks,
+				set->fastName, times->numQueries * freq / fastTicks,
+				(double) scanTicks / fastTicks);
+	}
+}
+
+
+/********************** BENCH: TIME RAY QUERIES ***********************/
+//
+// Fires numQueries random rays & line segments of each kind thru the scene
+// around the player, first with the brute force scans (of the object list and
+// of every triangle in a mesh) and then with the ray tree & the mesh BVH's,
+// and makes sure that they both hit the same things.
+//
+
+static void Bench_TimeRayQueries(int numQueries)
+{
+BenchSegmentInput	input;
+RayTreeStats		savedStats = gRayTreeStats;						// don't count these in the area's per-frame stats
+MeshBVHStats		savedMeshStats = gMeshBVHStats;
+Boolean				savedDisabled = gRayTreeDisabled;
+Boolean				savedMeshDisabled = gMeshBVHDisabled;
+Boolean				savedVerify = gVerifyRayTree;
+Boolean				savedMeshVerify = gVerifyMeshBVH;
+
+	input.p1		= (OGLPoint3D*) AllocPtr(sizeof(OGLPoint3D) * numQueries);
+	input.p2		= (OGLPoint3D*) AllocPtr(sizeof(OGLPoint3D) * numQueries);
+	input.radius	= nil;
+
+			/* FROM AROUND THE PLAYER, ROUGHLY LEVEL, OUT TO SHOOTING RANGE */
+
+	for (int i = 0; i < numQueries; i++)
+	{
+		OGLVector3D	dir;
+		float		length = 200.0f + RandomFloat() * 3800.0f;
+
+		input.p1[i].x = gPlayerInfo.coord.x + RandomFloat2() * 500.0f;
+		input.p1[i].y = gPlayerInfo.coord.y + 50.0f + RandomFloat() * 150.0f;
+		input.p1[i].z = gPlayerInfo.coord.z + RandomFloat2() * 500.0f;
+
+		dir.x = RandomFloat2();
+		dir.y = RandomFloat2() * .2f;
+		dir.z = RandomFloat2();
+		FastNormalizeVector(dir.x, dir.y, dir.z, &dir);
+
+		input.p2[i].x = input.p1[i].x + dir.x * length;
+		input.p2[i].y = input.p1[i].y + dir.y * length;
+		input.p2[i].z = input.p1[i].z + dir.z * length;
+	}
+
+	gVerifyRayTree = false;
+	gVerifyMeshBVH = false;
+
+	Bench_TimeQueries(&kRayQuerySet, &input, numQueries);
+
+	gRayTreeDisabled = savedDisabled;
+	gMeshBVHDisabled = savedMeshDisabled;
+	gVerifyRayTree = savedVerify;
+	gVerifyMeshBVH = savedMeshVerify;
+	gRayTreeStats = savedStats;
+	gMeshBVHStats = savedMeshStats;
+
+	SafeDisposePtr((Ptr) input.p2);
+	SafeDisposePtr((Ptr) input.p1);
+}
+
+
+/********************** BENCH: RAY QUERIES ***********************/
+
+static void Bench_RayQueries_Scan(int kind, const void* input, int numQueries, void* results)
+{
+	gRayTreeDisabled = true;
+	gMeshBVHDisabled = true;
+	Bench_RayQueries(kind, input, numQueries, results);
+}
+
+static void Bench_RayQueries_Tree(int kind, const void* input, int numQueries, void* results)
+{
+	gRayTreeDisabled = false;
+	gMeshBVHDisabled = false;
+	Bench_RayQueries(kind, input, numQueries, results);
+}
+
+static void Bench_RayQueries(int kind, const void* input, int numQueries, void* results)
+{
+const BenchSegmentInput*	in = (const BenchSegmentInput*) input;
+uintptr_t*					out = (uintptr_t*) results;
+
+	for (int i = 0; i < numQueries; i++)
+		out[i] = Bench_RayQuery(kind, &in->p1[i], &in->p2[i]);
+}
+
+static Boolean Bench_IsRayHit(const void* result)
+{
+	return *(const uintptr_t*) result != 0;
+}
+
+
+/********************** BENCH: RAY QUERY ***********************/
+//
+// Returns what the query hit (the ObjNode, or 1 for a plain yes), or 0.
+//
+
+static uintptr_t Bench_RayQuery(int kind, const OGLPoint3D* p1, const OGLPoint3D* p2)
+{
+OGLPoint3D	a = *p1, b = *p2;
+OGLPoint3D	hitCoord;
+OGLVector3D	hitNormal;
+OGLRay		ray;
+
+	switch (kind)
+	{
+		case	0:											// crosshair pick
+				ray.origin = a;
+				OGLPoint3D_Subtract(&b, &a, &ray.direction);
+				OGLVector3D_Normalize(&ray.direction, &ray.direction);
+				return (uintptr_t) OGL_DoRayCollision(&ray, &hitCoord, STATUS_BIT_HIDDEN | STATUS_BIT_ISCULLED, CTYPE_PICKABLE);
+
+		case	1:											// bullet
+				return (uintptr_t) OGL_DoLineSegmentCollision(&a, &b, &hitCoord, &hitNormal, CTYPE_PICKABLE | CTYPE_BUILDING);
+
+		case	2:											// line of sight
+				return (uintptr_t) SeeIfLineSegmentHitsAnything(&a, &b, nil, CTYPE_BLOCKRAYS | CTYPE_MISC | CTYPE_ENEMY);
+
+		default:
+				DoFatalAlert("Bench_RayQuery: bad kind %d", kind);
+				return 0;
+	}
+}
+
+
+/********************** BENCH: TIME FENCE QUERIES ***********************/
+//
+// Fires numQueries random line segments at the fences, and moves a probe
+// object numQueries times near them, first with the old scans of every fence
+// and then with the fence grid, and makes sure that they come out exactly the same.
+//
+
+static void Bench_TimeFenceQueries(int numQueries)
+{
+BenchSegmentInput	input;
+FenceGridStats		savedStats = gFenceGridStats;			// don't count these in the area's per-frame stats
+Boolean				savedDisabled = gFenceGridDisabled;
+Boolean				savedVerify = gVerifyFenceGrid;
+OGLPoint3D			savedCoord = gCoord;
+
+	if (gNumFences == 0)
+		return;
+
+	input.p1		= (OGLPoint3D*) AllocPtr(sizeof(OGLPoint3D) * numQueries);
+	input.p2		= (OGLPoint3D*) AllocPtr(sizeof(OGLPoint3D) * numQueries);
+	input.radius	= (float*) AllocPtr(sizeof(float) * numQueries);
+
+			/* FROM AROUND A RANDOM NUB, OUT TO SHOOTING RANGE */
+
+	for (int i = 0; i < numQueries; i++)
+	{
+		const FenceDefType*	fence = &gFenceList[MyRandomLong() % gNumFences];
+		const OGLPoint3D*	nub = &fence->nubList[MyRandomLong() % fence->numNubs];
+		float				length = 200.0f + RandomFloat() * 3800.0f;
+		float				angle = RandomFloat() * PI2;
+
+		input.p1[i].x = nub->x + RandomFloat2() * 800.0f;
+		input.p1[i].y = nub->y + RandomFloat() * 400.0f;
+		input.p1[i].z = nub->z + RandomFloat2() * 800.0f;
+
+		input.p2[i].x = input.p1[i].x + cosf(angle) * length;
+		input.p2[i].y = input.p1[i].y + RandomFloat2() * 200.0f;
+		input.p2[i].z = input.p1[i].z + sinf(angle) * length;
+
+		input.radius[i] = 20.0f + RandomFloat() * 200.0f;
+	}
+
+	gVerifyFenceGrid = false;
+
+	Bench_TimeQueries(&kFenceQuerySet, &input, numQueries);
+
+	gFenceGridDisabled = savedDisabled;
+	gVerifyFenceGrid = savedVerify;
+	gFenceGridStats = savedStats;
+	gCoord = savedCoord;
+
+	SafeDisposePtr((Ptr) input.radius);
+	SafeDisposePtr((Ptr) input.p2);
+	SafeDisposePtr((Ptr) input.p1);
+}
+
+
+/********************** BENCH: FENCE QUERIES ***********************/
+
+static void Bench_FenceQueries_Scan(int kind, const void* input, int numQueries, void* results)
+{
+	gFenceGridDisabled = true;
+	Bench_FenceQueries(kind, input, numQueries, results);
+}
+
+static void Bench_FenceQueries_Grid(int kind, const void* input, int numQueries, void* results)
+{
+	gFenceGridDisabled = false;
+	Bench_FenceQueries(kind, input, numQueries, results);
+}
+
+static void Bench_FenceQueries(int kind, const void* input, int numQueries, void* results)
+{
+static ObjNode				probe;									// DoFenceCollision only looks at its OldCoord & radius
+const BenchSegmentInput*	in = (const BenchSegmentInput*) input;
+BenchFenceResult*			out = (BenchFenceResult*) results;
+
+	for (int i = 0; i < numQueries; i++)
+	{
+		if (kind == 0)
+		{
+			out[i].hit = SeeIfLineSegmentHitsFence(&in->p1[i], &in->p2[i], &out[i].intersect, &out[i].overTop, &out[i].fenceTopY);
+		}
+		else
+		{
+			probe.OldCoord = in->p1[i];								// a step of up to 30 units towards p2
+			probe.BoundingSphereRadius = in->radius[i];
+			gCoord.x = in->p1[i].x + (in->p2[i].x - in->p1[i].x) * (30.0f / 4000.0f);
+			gCoord.y = in->p1[i].y;
+			gCoord.z = in->p1[i].z + (in->p2[i].z - in->p1[i].z) * (30.0f / 4000.0f);
+
+			out[i].hit = DoFenceCollision(&probe);
+			out[i].intersect = gCoord;
+		}
+	}
+}
+
+static Boolean Bench_IsFenceHit(const void* result)
+{
+	return ((const BenchFenceResult*) result)->hit;
+}
+
+
+/********************** BENCH: TIME TERRAIN QUERIES ***********************/
+//
+// Asks for the terrain height (one at a time, then in one batch) and the
+// tile normals at numQueries random spots on the map, first with a plane
+// equation built for every query and then with the plane table.
+// The heights have to agree to within float rounding.
+//
+
+static void Bench_TimeTerrainQueries(int numQueries)
+{
+BenchTerrainInput	input;
+Boolean				savedDisabled = gTerrainPlaneTableDisabled;
+Boolean				savedVerify = gVerifyTerrainPlanes;
+OGLVector3D			savedNormal = gRecentTerrainNormal;
+
+	if (!gMapYCoords || !gTerrainTilePlanes)
+		return;
+
+	input.x = (float*) AllocPtr(sizeof(float) * numQueries);
+	input.z = (float*) AllocPtr(sizeof(float) * numQueries);
+
+	for (int i = 0; i < numQueries; i++)
+	{
+		input.x[i] = RandomFloat() * gTerrainUnitWidth;
+		input.z[i] = RandomFloat() * gTerrainUnitDepth;
+	}
+
+	gVerifyTerrainPlanes = false;
+
+	Bench_TimeQueries(&kTerrainQuerySet, &input, numQueries);
+
+	gTerrainPlaneTableDisabled = savedDisabled;
+	gVerifyTerrainPlanes = savedVerify;
+	gRecentTerrainNormal = savedNormal;
+
+	SafeDisposePtr((Ptr) input.z);
+	SafeDisposePtr((Ptr) input.x);
+}
+
+
+/********************** BENCH: TERRAIN QUERIES ***********************/
+
+static void Bench_TerrainQueries_PlaneEq(int kind, const void* input, int numQueries, void* results)
+{
+	gTerrainPlaneTableDisabled = true;
+	Bench_TerrainQueries(kind, input, numQueries, results);
+}
+
+static void Bench_TerrainQueries_Table(int kind, const void* input, int numQueries, void* results)
+{
+	gTerrainPlaneTableDisabled = false;
+	Bench_TerrainQueries(kind, input, numQueries, results);
+}
+
+static void Bench_TerrainQueries(int kind, const void* input, int numQueries, void* results)
+{
+const BenchTerrainInput*	in = (const BenchTerrainInput*) input;
+float*						y = (float*) results;
+OGLVector3D*				normals = (OGLVector3D*) results;
+
+	switch (kind)
+	{
+		case	0:
+				for (int i = 0; i < numQueries; i++)
+					y[i] = GetTerrainY(in->x[i], in->z[i]);
+				break;
+
+		case	1:
+				GetTerrainYBatch(numQueries, in->x, in->z, y, nil);
+				break;
+
+		case	2:
+				for (int i = 0; i < numQueries; i++)
+				{
+					CalcTileNormals((long) (in->z[i] / gTerrainPolygonSize), (long) (in->x[i] / gTerrainPolygonSize),
+									&normals[i*2], &normals[i*2+1]);
+				}
+				break;
+	}
+}
+
+static Boolean Bench_CompareTerrainResults(int kind, const void* input, int i, const void* scanResult, const void* fastResult)
+{
+const BenchTerrainInput*	in = (const BenchTerrainInput*) input;
+
+	if (kind == 2)
+	{
+		const OGLVector3D* a = (const OGLVector3D*) scanResult;
+		const OGLVector3D* b = (const OGLVector3D*) fastResult;
+
+		for (int j = 0; j < 2; j++)
+		{
+			if (fabsf(b[j].x - a[j].x) > 0.001f
+				|| fabsf(b[j].y - a[j].y) > 0.001f
+				|| fabsf(b[j].z - a[j].z) > 0.001f)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+	else
+	{
+		float a = *(const float*) scanResult;
+		float b = *(const float*) fastResult;
+		float tolerance = 0.01f + 1e-5f * (fabsf(in->x[i]) + fabsf(in->z[i]) + fabsf(a));
+
+		if (fabsf(b - a) > tolerance)
+		{
+			SDL_Log("Bench: terrain height at (%f, %f): table got %f, plane equation got %f", in->x[i], in->z[i], b, a);
+			return false;
+		}
+		return true;
+	}
+}
+
+
+/********************** BENCH: TIME SUPERTILE KERNELS ***********************/
+//
+// Builds every supertile on the map, then times its vertex normal & lighting
+// passes with the scalar loops and with the 4-wide ones. Both have to give
+// the very same normals & vertex colors.
+//
+
+static void Bench_TimeSuperTileKernels(void)
+{
+static OGLColorRGBA_Byte	colors[NUM_VERTICES_IN_SUPERTILE];
+BenchSuperTileInput			input;
+Boolean						savedDisabled = gSuperTileSIMDDisabled;
+int							numSuperTiles = 0;
+
+	if (!gSuperTileSIMDAvailable || !gSuperTileTextureGrid)
+		return;
+
+	CancelSuperTilePrefetches();										// so that the builders aren't using the kernels while we flip the switch
+
+	for (int row = 0; row < gNumSuperTilesDeep; row++)
+		for (int col = 0; col < gNumSuperTilesWide; col++)
+			if (gSuperTileTextureGrid[row][col] != -1)
+				numSuperTiles++;
+
+	if (numSuperTiles == 0)
+		return;
+
+	input.row		= (int*) AllocPtr(sizeof(int) * numSuperTiles);
+	input.col		= (int*) AllocPtr(sizeof(int) * numSuperTiles);
+	input.points	= (OGLPoint3D*) AllocPtr(sizeof(OGLPoint3D) * NUM_VERTICES_IN_SUPERTILE * numSuperTiles);
+	input.triangles	= (MOTriangleIndecies*) AllocPtr(sizeof(MOTriangleIndecies) * NUM_TRIS_IN_SUPERTILE * numSuperTiles);
+	input.normals	= (OGLVector3D*) AllocPtr(sizeof(OGLVector3D) * NUM_VERTICES_IN_SUPERTILE * numSuperTiles);
+	input.lights	= &gGameViewInfoPtr->lightList;
+
+			/* BUILD THEM ALL FOR THE POINTS, TRIANGLES & NORMALS */
+
+	gSuperTileSIMDDisabled = true;
+
+	for (int row = 0, i = 0; row < gNumSuperTilesDeep; row++)
+	{
+		for (int col = 0; col < gNumSuperTilesWide; col++)
+		{
+			MOVertexArrayData	mesh;
+			float				minY, maxY;
+
+			if (gSuperTileTextureGrid[row][col] == -1)
+				continue;
+
+			SDL_zero(mesh);
+			mesh.numPoints		= NUM_VERTICES_IN_SUPERTILE;
+			mesh.numTriangles	= NUM_TRIS_IN_SUPERTILE;
+			mesh.points			= &input.points[i * NUM_VERTICES_IN_SUPERTILE];
+			mesh.triangles		= &input.triangles[i * NUM_TRIS_IN_SUPERTILE];
+			mesh.normals		= &input.normals[i * NUM_VERTICES_IN_SUPERTILE];
+			mesh.colorsByte		= colors;
+
+			BuildSuperTileGeometry(col * SUPERTILE_SIZE, row * SUPERTILE_SIZE, &mesh, input.lights, &minY, &maxY);
+
+			input.row[i] = row;
+			input.col[i] = col;
+			i++;
+		}
+	}
+
+	Bench_TimeQueries(&kSuperTileKernelSet, &input, numSuperTiles);
+
+	gSuperTileSIMDDisabled = savedDisabled;
+
+	SafeDisposePtr((Ptr) input.normals);
+	SafeDisposePtr((Ptr) input.triangles);
+	SafeDisposePtr((Ptr) input.points);
+	SafeDisposePtr((Ptr) input.col);
+	SafeDisposePtr((Ptr) input.row);
+}
+
+
+/********************** BENCH: SUPERTILE KERNELS ***********************/
+
+static void Bench_SuperTileKernels_Scalar(int kind, const void* input, int numSuperTiles, void* results)
+{
+	gSuperTileSIMDDisabled = true;
+	Bench_SuperTileKernels(kind, input, numSuperTiles, results);
+}
+
+static void Bench_SuperTileKernels_SIMD(int kind, const void* input, int numSuperTiles, void* results)
+{
+	gSuperTileSIMDDisabled = false;
+	Bench_SuperTileKernels(kind, input, numSuperTiles, results);
+}
+
+static void Bench_SuperTileKernels(int kind, const void* input, int numSuperTiles, void* results)
+{
+const BenchSuperTileInput*	in = (const BenchSuperTileInput*) input;
+
+	for (int i = 0; i < numSuperTiles; i++)
+	{
+		int startRow = in->row[i] * SUPERTILE_SIZE;
+		int startCol = in->col[i] * SUPERTILE_SIZE;
+
+		if (kind == 0)
+		{
+			MOVertexArrayData	mesh;
+
+			SDL_zero(mesh);
+			mesh.numPoints		= NUM_VERTICES_IN_SUPERTILE;
+			mesh.numTriangles	= NUM_TRIS_IN_SUPERTILE;
+			mesh.points			= &in->points[i * NUM_VERTICES_IN_SUPERTILE];
+			mesh.triangles		= &in->triangles[i * NUM_TRIS_IN_SUPERTILE];
+			mesh.normals		= (OGLVector3D*) results + i * NUM_VERTICES_IN_SUPERTILE;
+
+			CalculateSupertileVertexNormals(&mesh, startRow, startCol);
+		}
+		else
+		{
+			LightSuperTileVertices(&in->normals[i * NUM_VERTICES_IN_SUPERTILE], (OGLColorRGBA_Byte*) results + i * NUM_VERTICES_IN_SUPERTILE,
+									startRow, startCol, in->lights);
+		}
+	}
+}
+
+
+#pragma mark -
+
+/********************** BENCH: OBJECT CHURN ***********************/
+//
+// Times what bursts of bullets, debris & sprites do to the object list:
+// spawn numNodes objects with a mix of slots on top of a level-sized list,
+// detach & re-attach half of them, then delete them all in random order.
+// The list's order is checked after each step.
+//
+
+#define	CHURN_BACKGROUND_NODES	400
+#define	CHURN_ROUNDS			10
+
+static void Bench_ObjectChurn(int numNodes)
+{
+static const short kBurstSlots[] =
+{
+	PLAYER_SLOT + 1, ENEMY_SLOT + 1, SLOT_OF_DUMB, SLOT_OF_DUMB + 1,
+	PARTICLE_SLOT, PARTICLE_SLOT - 1, SPRITE_SLOT, SPRITE_SLOT + 1,
+};
+const int	numBurstSlots = sizeof(kBurstSlots) / sizeof(kBurstSlots[0]);
+ObjNode**	background;
+ObjNode**	nodes;
+Uint64		spawnTicks = 0, reattachTicks = 0, deleteTicks = 0;
+
+	SetMyRandomSeed(gBenchmarkSeed);
+
+	background	= (ObjNode**) AllocPtrClear(sizeof(ObjNode*) * CHURN_BACKGROUND_NODES);
+	nodes		= (ObjNode**) AllocPtrClear(sizeof(ObjNode*) * numNodes);
+
+			/* SCENERY, ENEMIES, ETC. SPREAD OVER THE SLOTS */
+
+	for (int i = 0; i < CHURN_BACKGROUND_NODES; i++)
+		background[i] = Bench_MakeChurnNode(RandomRange(TERRAIN_SLOT, SPRITE_SLOT + 10));
+
+	Bench_VerifyObjectList("background");
+
+	for (int round = 0; round < CHURN_ROUNDS; round++)
+	{
+				/* SPAWN */
+
+		Uint64 start = SDL_GetPerformanceCounter();
+
+		for (int i = 0; i < numNodes; i++)
+		{
+			int slot = (i & 3) == 3
+					? RandomRange(TERRAIN_SLOT, SPRITE_SLOT + 10)
+					: kBurstSlots[MyRandomLong() % numBurstSlots];
+			nodes[i] = Bench_MakeChurnNode(slot);
+		}
+
+		spawnTicks += SDL_GetPerformanceCounter() - start;
+		Bench_VerifyObjectList("spawn");
+
+				/* DETACH & RE-ATTACH HALF OF THEM */
+
+		start = SDL_GetPerformanceCounter();
+
+		for (int i = 0; i < numNodes; i += 2)
+			DetachObject(nodes[i], false);
+
+		for (int i = 0; i < numNodes; i += 2)
+		{
+			AttachObject(nodes[i], false);
+			nodes[i]->ChurnSeq = ++gChurnSeq;						// it's the last of its slot now
+		}
+
+		reattachTicks += SDL_GetPerformanceCounter() - start;
+		Bench_VerifyObjectList("re-attach");
+
+				/* DELETE IN RANDOM ORDER */
+
+		for (int i = numNodes - 1; i > 0; i--)
+		{
+			int j = MyRandomLong() % (i + 1);
+			ObjNode* temp = nodes[i];
+			nodes[i] = nodes[j];
+			nodes[j] = temp;
+		}
+
+		start = SDL_GetPerformanceCounter();
+
+		for (int i = 0; i < numNodes; i++)
+			DeleteObject(nodes[i]);
+		FlushObjectDeleteQueue();
+
+		deleteTicks += SDL_GetPerformanceCounter() - start;
+		Bench_VerifyObjectList("delete");
+	}
+
+	for (int i = 0; i < CHURN_BACKGROUND_NODES; i++)
+		DeleteObject(background[i]);
+	FlushObjectDeleteQueue();
+
+	SafeDisposePtr((Ptr) nodes);
+	SafeDisposePtr((Ptr) background);
+
+	const double nsPerOp = 1e9 / SDL_GetPerformanceFrequency() / ((double) numNodes * CHURN_ROUNDS);
+
+	SDL_Log("Bench: churn: %d x %d objects on top of %d: spawn %.1f ns  re-attach %.1f ns  delete %.1f ns (per object)",
+			CHURN_ROUNDS, numNodes, CHURN_BACKGROUND_NODES,
+			spawnTicks * nsPerOp,
+			reattachTicks * nsPerOp * 2,						// only half were re-attached
+			deleteTicks * nsPerOp);
+}
+
+
+/********************** BENCH: MAKE CHURN NODE ***********************/
+
+static ObjNode* Bench_MakeChurnNode(int slot)
+{
+	NewObjectDefinitionType def =
+	{
+		.genre		= CUSTOM_GENRE,
+		.slot		= slot,
+		.flags		= STATUS_BIT_HIDDEN | STATUS_BIT_NOMOVE,
+		.scale		= 1,
+	};
+
+	ObjNode* node = MakeNewObject(&def);
+	node->ChurnTag = CHURN_TAG;
+	node->ChurnSeq = ++gChurnSeq;
+	return node;
+}
+
+
+/********************** BENCH: VERIFY OBJECT LIST ***********************/
+//
+// The list must be sorted by slot, with nodes of the same slot in the order
+// that they were attached, and the links must agree both ways.
+//
+
+static void Bench_VerifyObjectList(const char* when)
+{
+	ObjNode* prev = nil;
+
+	for (ObjNode* node = gFirstNodePtr; node; prev = node, node = node->NextNode)
+	{
+		if (node->PrevNode != prev)
+			DoFatalAlert("Bench: churn: broken PrevNode link after %s", when);
+
+		if (!prev)
+			continue;
+
+		if (prev->Slot > node->Slot)
+			DoFatalAlert("Bench: churn: slot %d before slot %d after %s", prev->Slot, node->Slot, when);
+
+		if (prev->Slot == node->Slot
+			&& prev->ChurnTag == CHURN_TAG && node->ChurnTag == CHURN_TAG
+			&& prev->ChurnSeq > node->ChurnSeq)
+		{
+			DoFatalAlert("Bench: churn: slot %d out of attach order after %s", node->Slot, when);
+		}
+	}
+}
+
+
+static int Bench_CompareFloats(const void* a, const void* b)
+{
+	float fa = *(const float*) a;
+	float fb = *(const float*) b;
+	return (fa > fb) - (fa < fb);
+}
+
+
+#pragma mark -
+
+/******************** BENCH: SCRIPTED INPUT *************************/
+//
+// Input override proc that plays the current area like a (very) simple bot.
+// It only depends on the frame # and on game state, so runs are repeatable.
+//
+
+static void Bench_ScriptedInput(InputSnapshot* snapshot)
+{
+	uint32_t	frame = gGameFrameNum;
+	float		t = frame / gBenchmarkTickRate;
+
+			/* SWEEP CROSSHAIRS AROUND THE SCREEN */
+
+	snapshot->mouseCoord.x = g2DLogicalWidth * (0.5f + 0.35f * sinf(t * 1.3f));
+	snapshot->mouseCoord.y = g2DLogicalHeight * (0.5f + 0.30f * sinf(t * 2.1f));
+
+	switch(gCurrentArea)
+	{
+		case	AREA_TOWN_SHOOTOUT:
+		case	AREA_SWAMP_SHOOTOUT:
+				if ((frame % 20) == 0)										// fire a few times per second
+					snapshot->needBits |= 1u << kNeed_Shoot;
+				if ((frame % 120) == 60)									// move on when allowed to
+					snapshot->needBits |= 1u << kNeed_Continue;
+				if (((frame / 90) % 4) == 1)								// turn around a bit
+					snapshot->needBits |= 1u << kNeed_UILeft;
+				break;
+
+		case	AREA_TOWN_STAMPEDE:
+		case	AREA_SWAMP_STAMPEDE:
+				switch ((frame / 45) % 4)									// weave
+				{
+					case 0:	snapshot->needBits |= 1u << kNeed_Left;		break;
+					case 2:	snapshot->needBits |= 1u << kNeed_Right;	break;
+				}
+				if ((frame % 100) == 0)
+					snapshot->needBits |= 1u << kNeed_Jump;
+				break;
+
+		case	AREA_TOWN_DUEL1:
+		case	AREA_TOWN_DUEL2:
+		case	AREA_TOWN_DUEL3:
+		case	AREA_SWAMP_DUEL1:
+		case	AREA_SWAMP_DUEL2:
+		case	AREA_SWAMP_DUEL3:
+		{
+			static const Byte duelKeyToNeed[4] = { kNeed_UIUp, kNeed_UIRight, kNeed_UIDown, kNeed_UILeft };
+
+			if ((gDuelKeySequenceMode == DUEL_KEY_SEQUENCE_MODE_PROCESS)	// type the key sequence on every other frame
+				&& (gDuelKeyBufferIndex < gDuelKeySequenceLength)
+				&& (frame & 1))
+			{
+				snapshot->needBits |= 1u << duelKeyToNeed[gDuelKeySequence[gDuelKeyBufferIndex] & 3];
+			}
+			if ((frame % 20) == 0)
+				snapshot->needBits |= 1u << kNeed_Shoot;
+			break;
+		}
+
+		case	AREA_TARGETPRACTICE1:
+		case	AREA_TARGETPRACTICE2:
+				if ((frame % 8) == 0)
+					snapshot->needBits |= 1u << kNeed_Shoot;
+				break;
+	}
+}
+
+#endif // BENCHMARK
@@ -16,6 +16,12 @@
 /****************************/
 
 static void AllocateCollisionTriangleMemory(ObjNode *theNode, long numTriangles);
+static void CollisionDetect_Scan(ObjNode *baseNode, uint32_t CType);
+static Boolean CollisionDetect_Grid(ObjNode *baseNode, uint32_t CType);
+static void CollisionDetect_Verify(ObjNode *baseNode, uint32_t CType, short startNumCollisions);
+static void CollideWithObject(ObjNode *baseNode, ObjNode *thisNode, uint32_t CType);
+static Boolean IsLineSegmentTarget(const ObjNode *thisNode, const ObjNode *except, uint32_t ctype);
+static Boolean DoesLineSegmentHitCrossBeam(const OGLPoint3D *endPoint1, const OGLPoint3D *endPoint2, const ObjNode *thisNode);
 
 static Boolean RayIntersectTriangle(OGLPoint3D *origin, OGLVector3D *dir,
                    			OGLPoint3D *v0, OGLPoint3D *v1, OGLPoint3D *v2,
@@ -49,241 +55,349 @@ Boolean			gSolidTriggerKeepDelta;
 //
 // INPUT: startNumCollisions = value to start gNumCollisions at should we need to keep existing data in collision list
 //
+// The targets come from the collision grid (see CollisionGrid.c) in the same
+// order as the object list, so the collision list is the same as if we'd
+// scanned the whole object list. With gVerifyCollisionGrid, we do both and
+// make sure of it.
+//
 
 void CollisionDetect(ObjNode *baseNode, uint32_t CType, short startNumCollisions)
 {
-ObjNode 	*thisNode;
-long		sideBits,cBits,cType;
-short		numBaseBoxes,targetNumBoxes,target;
-CollisionBoxType *baseBoxList;
-CollisionBoxType *targetBoxList;
-float		leftSide,rightSide,frontSide,backSide,bottomSide,topSide;
-
 	gNumCollisions = startNumCollisions;								// clear list
 
 			/* GET BASE BOX INFO */
 			
-	numBaseBoxes = baseNode->NumCollisionBoxes;
-	if (numBaseBoxes == 0)
+	if (baseNode->NumCollisionBoxes == 0)
 		return;
-	baseBoxList = baseNode->CollisionBoxes;
-
-	leftSide 		= baseBoxList->left;
-	rightSide 		= baseBoxList->right;
-	frontSide 		= baseBoxList->front;
-	backSide 		= baseBoxList->back;
-	bottomSide 		= baseBoxList->bottom;
-	topSide 		= baseBoxList->top;
-	
-	
-			/****************************/		
-			/* SCAN AGAINST ALL OBJECTS */
-			/****************************/		
-		
+
+	PROF_BEGIN(kProf_CollisionDetect);
+
+	if (gVerifyCollisionGrid)
+		CollisionDetect_Verify(baseNode, CType, startNumCollisions);
+	else
+	if (!CollisionDetect_Grid(baseNode, CType))
+		CollisionDetect_Scan(baseNode, CType);
+
+	if (gNumCollisions > MAX_COLLISIONS)											// see if overflowed (memory corruption ensued)
+		DoFatalAlert("CollisionDetect: gNumCollisions > MAX_COLLISIONS");
+
+	PROF_END(kProf_CollisionDetect);
+}
+
+
+/******************* COLLISION DETECT: SCAN *********************/
+//
+// Brute force: tests the base box against every object in the list up to SLOT_OF_DUMB.
+//
+
+static void CollisionDetect_Scan(ObjNode *baseNode, uint32_t CType)
+{
+ObjNode 	*thisNode;
+
 	thisNode = gFirstNodePtr;									// start on 1st node
 
 	do
 	{
-		cType = thisNode->CType;	
-		if (cType == INVALID_NODE_FLAG)							// see if something went wrong
+		if (thisNode->CType == INVALID_NODE_FLAG)				// see if something went wrong
 			break;
 	
 		if (thisNode->Slot >= SLOT_OF_DUMB)						// see if reach end of usable list
 			break;
+
+		CollideWithObject(baseNode, thisNode, CType);
+
+		thisNode = thisNode->NextNode;							// next target node
+	}while(thisNode != nil);
+}
+
+
+/******************* COLLISION DETECT: GRID *********************/
+//
+// Only tests the objects in the grid cells that the base box overlaps.
+// Returns false if the base box is too big for that, and we need to scan instead.
+//
+
+static Boolean CollisionDetect_Grid(ObjNode *baseNode, uint32_t CType)
+{
+ObjNode		**candidates;
+int			numCandidates;
+
+	numCandidates = GatherCollisionGridCandidates(&baseNode->CollisionBoxes[0], &candidates);
+	if (numCandidates < 0)
+		return(false);
+
+	for (int i = 0; i < numCandidates; i++)
+	{
+		ObjNode* thisNode = candidates[i];
+
+		if (thisNode->StatusBits & STATUS_BIT_DETACHED)			// not in the object list, so the scan wouldn't see it
+			continue;
+
+		CollideWithObject(baseNode, thisNode, CType);
+	}
+
+	return(true);
+}
+
+
+/******************* COLLISION DETECT: VERIFY *********************/
+//
+// Does the brute force scan, then the grid, and dies if they don't agree.
+//
+
+static void CollisionDetect_Verify(ObjNode *baseNode, uint32_t CType, short startNumCollisions)
+{
+static CollisionRec	scanList[MAX_COLLISIONS];
+short		numScan;
+Byte		scanSides, oldTotalSides = gTotalSides;
+
+	CollisionDetect_Scan(baseNode, CType);
+
+	numScan = gNumCollisions;
+	if (numScan > MAX_COLLISIONS)
+		DoFatalAlert("CollisionDetect: gNumCollisions > MAX_COLLISIONS");
+
+	SDL_memcpy(scanList, gCollisionList, sizeof(CollisionRec) * numScan);
+	scanSides = gTotalSides;
+
+	gNumCollisions = startNumCollisions;						// do it again with the grid
+	gTotalSides = oldTotalSides;
+
+	if (!CollisionDetect_Grid(baseNode, CType))
+		return;													// scan's results are still in the list
+
+	if (gNumCollisions != numScan || gTotalSides != scanSides)
+	{
+		DoFatalAlert("CollisionDetect: grid found %d collisions (sides 0x%x), scan found %d (sides 0x%x)",
+					gNumCollisions, gTotalSides, numScan, scanSides);
+	}
+
+	for (int i = startNumCollisions; i < numScan; i++)
+	{
+		const CollisionRec* a = &gCollisionList[i];
+		const CollisionRec* b = &scanList[i];
+
+		if (a->baseBox != b->baseBox || a->targetBox != b->targetBox || a->sides != b->sides
+			|| a->type != b->type || a->objectPtr != b->objectPtr)
+		{
+			DoFatalAlert("CollisionDetect: grid and scan differ at collision #%d", i);
+		}
+	}
+
+	gCollisionGridStats.numVerified++;
+}
+
+
+/******************* COLLIDE WITH OBJECT *********************/
+//
+// Tests the base node's 1st box against each of thisNode's boxes, and adds any
+// hits to gCollisionList.
+//
+
+static void CollideWithObject(ObjNode *baseNode, ObjNode *thisNode, uint32_t CType)
+{
+long		sideBits,cBits,cType;
+short		targetNumBoxes,target;
+const CollisionBoxType *baseBox = &baseNode->CollisionBoxes[0];
+CollisionBoxType *targetBoxList;
+float		leftSide,rightSide,frontSide,backSide,bottomSide,topSide;
+
+	cType = thisNode->CType;	
 		
-		if (!(cType & CType))									// see if we want to check this Type
-			goto next;
+	if (!(cType & CType))									// see if we want to check this Type
+		return;
 
-		if (thisNode->StatusBits & STATUS_BIT_NOCOLLISION)		// don't collide against these
-			goto next;		
-					
-		if (thisNode == baseNode)								// dont collide against itself
-			goto next;
+	if (thisNode->StatusBits & STATUS_BIT_NOCOLLISION)		// don't collide against these
+		return;		
+				
+	if (thisNode == baseNode)								// dont collide against itself
+		return;
+
+	if (baseNode->ChainNode == thisNode)					// don't collide against its own chained object
+		return;
+
+	leftSide 		= baseBox->left;
+	rightSide 		= baseBox->right;
+	frontSide 		= baseBox->front;
+	backSide 		= baseBox->back;
+	bottomSide 		= baseBox->bottom;
+	topSide 		= baseBox->top;
+
+			/******************************/		
+			/* NOW DO COLLISION BOX CHECK */
+			/******************************/		
+				
+	targetNumBoxes = thisNode->NumCollisionBoxes;			// see if target has any boxes
+	if (targetNumBoxes)
+	{
+		targetBoxList = thisNode->CollisionBoxes;
 	
-		if (baseNode->ChainNode == thisNode)					// don't collide against its own chained object
-			goto next;
+	
+			/******************************************/
+			/* CHECK BASE BOX AGAINST EACH TARGET BOX */
+			/*******************************************/
 			
-				/******************************/		
-				/* NOW DO COLLISION BOX CHECK */
-				/******************************/		
-					
-		targetNumBoxes = thisNode->NumCollisionBoxes;			// see if target has any boxes
-		if (targetNumBoxes)
+		for (target = 0; target < targetNumBoxes; target++)
 		{
-			targetBoxList = thisNode->CollisionBoxes;
-		
+					/* DO RECTANGLE INTERSECTION */
 		
-				/******************************************/
-				/* CHECK BASE BOX AGAINST EACH TARGET BOX */
-				/*******************************************/
+			if (rightSide < targetBoxList[target].left)
+				continue;
 				
-			for (target = 0; target < targetNumBoxes; target++)
-			{
-						/* DO RECTANGLE INTERSECTION */
-			
-				if (rightSide < targetBoxList[target].left)
-					continue;
-					
-				if (leftSide > targetBoxList[target].right)
-					continue;
-					
-				if (frontSide < targetBoxList[target].back)
-					continue;
-					
-				if (backSide > targetBoxList[target].front)
-					continue;
-					
-				if (bottomSide > targetBoxList[target].top)
-					continue;
+			if (leftSide > targetBoxList[target].right)
+				continue;
+				
+			if (frontSide < targetBoxList[target].back)
+				continue;
+				
+			if (backSide > targetBoxList[target].front)
+				continue;
+				
+			if (bottomSide > targetBoxList[target].top)
+				continue;
 
-				if (topSide < targetBoxList[target].bottom)
-					continue;
-					
-									
-						/* THERE HAS BEEN A COLLISION SO CHECK WHICH SIDE PASSED THRU */
-			
-				sideBits = 0;
-				cBits = thisNode->CBits;					// get collision info bits
-								
-				if (!(cBits & CBITS_ALLSOLID))				// if not a solid, then add it without side info
-					goto got_sides;
+			if (topSide < targetBoxList[target].bottom)
+				continue;
 				
+								
+					/* THERE HAS BEEN A COLLISION SO CHECK WHICH SIDE PASSED THRU */
+		
+			sideBits = 0;
+			cBits = thisNode->CBits;					// get collision info bits
 							
-								/* CHECK FRONT COLLISION */
+			if (!(cBits & CBITS_ALLSOLID))				// if not a solid, then add it without side info
+				goto got_sides;
 			
-				if (cBits & SIDE_BITS_BACK)											// see if target has solid back
+						
+							/* CHECK FRONT COLLISION */
+		
+			if (cBits & SIDE_BITS_BACK)											// see if target has solid back
+			{
+				if (baseBox->oldFront < targetBoxList[target].oldBack)		// get old & see if already was in target (if so, skip)
 				{
-					if (baseBoxList->oldFront < targetBoxList[target].oldBack)		// get old & see if already was in target (if so, skip)
+					if ((baseBox->front >= targetBoxList[target].back) &&	// see if currently in target
+						(baseBox->front <= targetBoxList[target].front))
 					{
-						if ((baseBoxList->front >= targetBoxList[target].back) &&	// see if currently in target
-							(baseBoxList->front <= targetBoxList[target].front))
-						{
-							sideBits = SIDE_BITS_FRONT;
-						}
+						sideBits = SIDE_BITS_FRONT;
 					}
 				}
-				
-								/* CHECK BACK COLLISION */
+			}
 			
-				if (cBits & SIDE_BITS_FRONT)										// see if target has solid front
+							/* CHECK BACK COLLISION */
+		
+			if (cBits & SIDE_BITS_FRONT)										// see if target has solid front
+			{
+				if (baseBox->oldBack > targetBoxList[target].oldFront)		// get old & see if already was in target	
 				{
-					if (baseBoxList->oldBack > targetBoxList[target].oldFront)		// get old & see if already was in target	
+					if ((baseBox->back <= targetBoxList[target].front) &&	// see if currently in target
+						(baseBox->back >= targetBoxList[target].back))
 					{
-						if ((baseBoxList->back <= targetBoxList[target].front) &&	// see if currently in target
-							(baseBoxList->back >= targetBoxList[target].back))
-						{
-							sideBits = SIDE_BITS_BACK;
-						}
+						sideBits = SIDE_BITS_BACK;
 					}
 				}
+			}
 
+	
+							/* CHECK RIGHT COLLISION */
 		
-								/* CHECK RIGHT COLLISION */
-			
-			
-				if (cBits & SIDE_BITS_LEFT)											// see if target has solid left
+		
+			if (cBits & SIDE_BITS_LEFT)											// see if target has solid left
+			{
+				if (baseBox->oldRight < targetBoxList[target].oldLeft)		// get old & see if already was in target	
 				{
-					if (baseBoxList->oldRight < targetBoxList[target].oldLeft)		// get old & see if already was in target	
+					if ((baseBox->right >= targetBoxList[target].left) &&	// see if currently in target
+						(baseBox->right <= targetBoxList[target].right))
 					{
-						if ((baseBoxList->right >= targetBoxList[target].left) &&	// see if currently in target
-							(baseBoxList->right <= targetBoxList[target].right))
-						{
-							sideBits |= SIDE_BITS_RIGHT;
-						}
+						sideBits |= SIDE_BITS_RIGHT;
 					}
 				}
-				
+			}
+			
 
-							/* CHECK COLLISION ON LEFT */
+						/* CHECK COLLISION ON LEFT */
 
-				if (cBits & SIDE_BITS_RIGHT)										// see if target has solid right
+			if (cBits & SIDE_BITS_RIGHT)										// see if target has solid right
+			{
+				if (baseBox->oldLeft > targetBoxList[target].oldRight)		// get old & see if already was in target	
 				{
-					if (baseBoxList->oldLeft > targetBoxList[target].oldRight)		// get old & see if already was in target	
+					if ((baseBox->left <= targetBoxList[target].right) &&	// see if currently in target
+						(baseBox->left >= targetBoxList[target].left))
 					{
-						if ((baseBoxList->left <= targetBoxList[target].right) &&	// see if currently in target
-							(baseBoxList->left >= targetBoxList[target].left))
-						{
-							sideBits |= SIDE_BITS_LEFT;
-						}
+						sideBits |= SIDE_BITS_LEFT;
 					}
-				}	
+				}
+			}	
 
-								/* CHECK TOP COLLISION */
-			
-				if (cBits & SIDE_BITS_BOTTOM)										// see if target has solid bottom
-				{				
-					if (baseBoxList->oldTop < targetBoxList[target].oldBottom)		// get old & see if already was in target	
+							/* CHECK TOP COLLISION */
+		
+			if (cBits & SIDE_BITS_BOTTOM)										// see if target has solid bottom
+			{				
+				if (baseBox->oldTop < targetBoxList[target].oldBottom)		// get old & see if already was in target	
+				{
+					if ((baseBox->top >= targetBoxList[target].bottom) &&	// see if currently in target
+						(baseBox->top <= targetBoxList[target].top))
 					{
-						if ((baseBoxList->top >= targetBoxList[target].bottom) &&	// see if currently in target
-							(baseBoxList->top <= targetBoxList[target].top))
-						{
-							sideBits |= SIDE_BITS_TOP;
-						}
+						sideBits |= SIDE_BITS_TOP;
 					}
 				}
+			}
 
-							/* CHECK COLLISION ON BOTTOM */
+						/* CHECK COLLISION ON BOTTOM */
 
-				
-				if (cBits & SIDE_BITS_TOP)											// see if target has solid top
+			
+			if (cBits & SIDE_BITS_TOP)											// see if target has solid top
+			{
+				if (baseBox->oldBottom > targetBoxList[target].oldTop)		// get old & see if already was in target	
 				{
-					if (baseBoxList->oldBottom > targetBoxList[target].oldTop)		// get old & see if already was in target	
+					if ((baseBox->bottom <= targetBoxList[target].top) &&	// see if currently in target
+						(baseBox->bottom >= targetBoxList[target].bottom))
 					{
-						if ((baseBoxList->bottom <= targetBoxList[target].top) &&	// see if currently in target
-							(baseBoxList->bottom >= targetBoxList[target].bottom))
-						{
-							sideBits |= SIDE_BITS_BOTTOM;
-						}
+						sideBits |= SIDE_BITS_BOTTOM;
 					}
-				}	
+				}
+			}	
 
-					/*********************************************/
-					/* SEE IF ANYTHING TO ADD OR IF IMPENETRABLE */
-					/*********************************************/
-				
-				if (!sideBits)														// if 0 then no new sides passed thru this time
+				/*********************************************/
+				/* SEE IF ANYTHING TO ADD OR IF IMPENETRABLE */
+				/*********************************************/
+			
+			if (!sideBits)														// if 0 then no new sides passed thru this time
+			{
+				if (cBits & CBITS_IMPENETRABLE)									// if its impenetrable, add to list regardless of sides
 				{
-					if (cBits & CBITS_IMPENETRABLE)									// if its impenetrable, add to list regardless of sides
-					{
-						if (gCoord.x < thisNode->Coord.x)							// try to assume some side info based on which side we're on relative to the target
-							sideBits |= SIDE_BITS_RIGHT;
-						else
-							sideBits |= SIDE_BITS_LEFT;
+					if (gCoord.x < thisNode->Coord.x)							// try to assume some side info based on which side we're on relative to the target
+						sideBits |= SIDE_BITS_RIGHT;
+					else
+						sideBits |= SIDE_BITS_LEFT;
 
-						if (gCoord.z < thisNode->Coord.z)
-							sideBits |= SIDE_BITS_FRONT;
-						else
-							sideBits |= SIDE_BITS_BACK;
+					if (gCoord.z < thisNode->Coord.z)
+						sideBits |= SIDE_BITS_FRONT;
+					else
+						sideBits |= SIDE_BITS_BACK;
 
 //						if (gCoord.y > thisNode->Coord.y)
 //							sideBits |= SIDE_BITS_BOTTOM;
-							 
-						goto got_sides;				
-					}
-											 							 
-					if (cBits & CBITS_ALWAYSTRIGGER)								// also always add if always trigger
-						goto got_sides;	
-				
-					continue;
+						 
+					goto got_sides;				
 				}
+										 							 
+				if (cBits & CBITS_ALWAYSTRIGGER)								// also always add if always trigger
+					goto got_sides;	
+			
+				continue;
+			}
 
-						/* ADD TO COLLISION LIST */
+					/* ADD TO COLLISION LIST */
 got_sides:
-				gCollisionList[gNumCollisions].baseBox 		= 0;
-				gCollisionList[gNumCollisions].targetBox 	= target;
-				gCollisionList[gNumCollisions].sides 		= sideBits;
-				gCollisionList[gNumCollisions].type 		= COLLISION_TYPE_OBJ;
-				gCollisionList[gNumCollisions].objectPtr 	= thisNode;
-				gNumCollisions++;	
-				gTotalSides |= sideBits;											// remember total of this
-			}
+			gCollisionList[gNumCollisions].baseBox 		= 0;
+			gCollisionList[gNumCollisions].targetBox 	= target;
+			gCollisionList[gNumCollisions].sides 		= sideBits;
+			gCollisionList[gNumCollisions].type 		= COLLISION_TYPE_OBJ;
+			gCollisionList[gNumCollisions].objectPtr 	= thisNode;
+			gNumCollisions++;	
+			gTotalSides |= sideBits;											// remember total of this
 		}
-next:	
-		thisNode = thisNode->NextNode;												// next target node
-	}while(thisNode != nil);
-
-	if (gNumCollisions > MAX_COLLISIONS)											// see if overflowed (memory corruption ensued)
-		DoFatalAlert("CollisionDetect: gNumCollisions > MAX_COLLISIONS");
+	}
 }
 
 
@@ -1532,14 +1646,18 @@ static Boolean RayIntersectTriangle(OGLPoint3D *origin, OGLVector3D *dir,
 
 
 /******************** SEE IF LINE SEGMENT HITS ANYTHING **************************/
+//
+// The objects to test come from the ray tree (see RayTree.c). With gVerifyRayTree,
+// we also scan the whole object list and make sure that we get the same answer.
+//
 
 Boolean SeeIfLineSegmentHitsAnything(const OGLPoint3D *endPoint1, const OGLPoint3D *endPoint2, const ObjNode *except, uint32_t ctype)
 {
-ObjNode	*thisNode;
-OGLPoint2D	p1,p2,crossBeamP1,crossBeamP2;
-short			targetNumBoxes;
-CollisionBoxType *targetBoxList;
-float	ix,iz,iy;
+ObjNode		*thisNode;
+ObjNode		**candidates;
+int			numCandidates;
+OGLVector3D	segment;
+Boolean		hit = false, scanHit = false;
 
 			/* SEE IF HIT FENCE */
 			
@@ -1552,75 +1670,130 @@ float	ix,iz,iy;
 			/***************************/
 			/* SEE IF HIT ANY OBJNODES */
 			/***************************/
-			
-	p1.x = endPoint1->x;	p1.y = endPoint1->z;				// get x/z of segment endpoints
-	p2.x = endPoint2->x;	p2.y = endPoint2->z;
-			
-			
-	thisNode = gFirstNodePtr;									// start on 1st node
 
-	do
+	if (gRayTreeDisabled || gVerifyRayTree)
 	{
-		if (thisNode->Slot >= SLOT_OF_DUMB)						// see if reach end of usable list
+		thisNode = gFirstNodePtr;									// start on 1st node
+
+		do
+		{
+			if (thisNode->Slot >= SLOT_OF_DUMB)						// see if reach end of usable list
+				break;
+
+			if (IsLineSegmentTarget(thisNode, except, ctype)
+				&& DoesLineSegmentHitCrossBeam(endPoint1, endPoint2, thisNode))
+			{
+				scanHit = true;
+				break;
+			}
+
+			thisNode = thisNode->NextNode;							// next target node
+		}while(thisNode != nil);
+
+		if (gRayTreeDisabled)
+			return(scanHit);
+	}
+
+	OGLPoint3D_Subtract(endPoint2, endPoint1, &segment);
+	numCandidates = GatherRayTreeCandidates(endPoint1, &segment, 1.0f, ctype, STATUS_BIT_NOCOLLISION, &candidates);
+
+	for (int i = 0; i < numCandidates; i++)
+	{
+		if (IsLineSegmentTarget(candidates[i], except, ctype)
+			&& DoesLineSegmentHitCrossBeam(endPoint1, endPoint2, candidates[i]))
+		{
+			hit = true;
 			break;
+		}
+	}
 
-		if (thisNode == except)									// see if skip this one
-			goto next;
-			
-		if (!(thisNode->CType & ctype))							// see if we want to check this Type
-			goto next;
+	if (gVerifyRayTree)
+	{
+		if (hit != scanHit)
+			DoFatalAlert("SeeIfLineSegmentHitsAnything: ray tree says %d, scan says %d", hit, scanHit);
+		gRayTreeStats.numVerified++;
+	}
 
-		if (thisNode->StatusBits & STATUS_BIT_NOCOLLISION)		// don't collide against these
-			goto next;
+	return(hit);
+}
+
+
+/******************** IS LINE SEGMENT TARGET **************************/
+//
+// Is this an object that SeeIfLineSegmentHitsAnything wants to look at?
+//
+
+static Boolean IsLineSegmentTarget(const ObjNode *thisNode, const ObjNode *except, uint32_t ctype)
+{
+	if (thisNode == except)									// see if skip this one
+		return(false);
 		
-		if (!thisNode->CBits)									// see if this obj doesn't need collisioning
-			goto next;
+	if (!(thisNode->CType & ctype))							// see if we want to check this Type
+		return(false);
 
+	if (thisNode->StatusBits & STATUS_BIT_NOCOLLISION)		// don't collide against these
+		return(false);
 	
-				/* GET BOX INFO FOR THIS NODE */
-					
-		targetNumBoxes = thisNode->NumCollisionBoxes;			// if target has no boxes, then skip
-		if (targetNumBoxes == 0)
-			goto next;
-		targetBoxList = thisNode->CollisionBoxes;
+	if (!thisNode->CBits)									// see if this obj doesn't need collisioning
+		return(false);
 
+	return(true);
+}
 
-				/* CREATE SEGMENT FROM CROSSBEAM */
-				
-		crossBeamP1.x = targetBoxList[0].left;
-		crossBeamP1.y = targetBoxList[0].back;
 
-		crossBeamP2.x = targetBoxList[0].right;
-		crossBeamP2.y = targetBoxList[0].front;
+/******************** DOES LINE SEGMENT HIT CROSSBEAM **************************/
+//
+// Tests the segment against the diagonal of the object's 1st collision box.
+//
 
+static Boolean DoesLineSegmentHitCrossBeam(const OGLPoint3D *endPoint1, const OGLPoint3D *endPoint2, const ObjNode *thisNode)
+{
+OGLPoint2D	p1,p2,crossBeamP1,crossBeamP2;
+short			targetNumBoxes;
+const CollisionBoxType *targetBoxList;
+float	ix,iz,iy;
 
-			/* SEE IF INPUT SEGMENT INTERSECTS THE CROSSBEAM SEGMENT */
+			/* GET BOX INFO FOR THIS NODE */
 				
-		if (IntersectLineSegments(p1.x, p1.y, p2.x, p2.y,
-			                     crossBeamP1.x, crossBeamP1.y, crossBeamP2.x, crossBeamP2.y,
-	                             &ix, &iz))
-	  	{
-			float	dy = endPoint2->y - endPoint1->y;			// get dy of line segment
+	targetNumBoxes = thisNode->NumCollisionBoxes;			// if target has no boxes, then skip
+	if (targetNumBoxes == 0)
+		return(false);
+	targetBoxList = thisNode->CollisionBoxes;
 
-			float	d1 = CalcDistance(p1.x, p1.y, p2.x, p2.y);
-			float	d2 = CalcDistance(p1.x, p1.y, ix, iz);
-					
-			float	ratio = d2/d1;
+	p1.x = endPoint1->x;	p1.y = endPoint1->z;				// get x/z of segment endpoints
+	p2.x = endPoint2->x;	p2.y = endPoint2->z;
 
-			iy = endPoint1->y + (dy * ratio);					// calc intersect y coord
 
-			if ((iy <= targetBoxList[0].top) &&					// if below top & above bottom, then HIT
-				(iy >= targetBoxList[0].bottom))
-			{
-				return(true);			
-			}
-	  	}
-	                             
-		
-next:	
-		thisNode = thisNode->NextNode;							// next target node
-	}while(thisNode != nil);
+			/* CREATE SEGMENT FROM CROSSBEAM */
+			
+	crossBeamP1.x = targetBoxList[0].left;
+	crossBeamP1.y = targetBoxList[0].back;
+
+	crossBeamP2.x = targetBoxList[0].right;
+	crossBeamP2.y = targetBoxList[0].front;
+
 
+		/* SEE IF INPUT SEGMENT INTERSECTS THE CROSSBEAM SEGMENT */
+			
+	if (IntersectLineSegments(p1.x, p1.y, p2.x, p2.y,
+		                     crossBeamP1.x, crossBeamP1.y, crossBeamP2.x, crossBeamP2.y,
+                             &ix, &iz))
+  	{
+		float	dy = endPoint2->y - endPoint1->y;			// get dy of line segment
+
+		float	d1 = CalcDistance(p1.x, p1.y, p2.x, p2.y);
+		float	d2 = CalcDistance(p1.x, p1.y, ix, iz);
+				
+		float	ratio = d2/d1;
+
+		iy = endPoint1->y + (dy * ratio);					// calc intersect y coord
+
+		if ((iy <= targetBoxList[0].top) &&					// if below top & above bottom, then HIT
+			(iy >= targetBoxList[0].bottom))
+		{
+			return(true);			
+		}
+  	}
 
 	return(false);
 }
@@ -1723,80 +1896,63 @@ int		i;
 
 
 /******************** SEE IF LINE SEGMENT HITS WHAT **************************/
+//
+// Returns the first object in the object list with the given What whose
+// crossbeam the segment hits. The objects to test come from the ray tree.
+//
 
 ObjNode *SeeIfLineSegmentHitsWhat(const OGLPoint3D *endPoint1, const OGLPoint3D *endPoint2, int what)
 {
-ObjNode	*thisNode;
-OGLPoint2D	p1,p2,crossBeamP1,crossBeamP2;
-short			targetNumBoxes;
-CollisionBoxType *targetBoxList;
-float	ix,iz,iy;
-
-			/***************************/
-			/* SEE IF HIT ANY OBJNODES */
-			/***************************/
-			
-	p1.x = endPoint1->x;	p1.y = endPoint1->z;				// get x/z of segment endpoints
-	p2.x = endPoint2->x;	p2.y = endPoint2->z;
-			
-			
-	thisNode = gFirstNodePtr;									// start on 1st node
-
-	do
-	{			
-		if (thisNode->Slot >= SLOT_OF_DUMB)						// see if reach end of usable list
-			break;
-
-		if (thisNode->What != what)								// see if we want to check this What
-			goto next;
-
-	
-				/* GET BOX INFO FOR THIS NODE */
-					
-		targetNumBoxes = thisNode->NumCollisionBoxes;			// if target has no boxes, then skip
-		if (targetNumBoxes == 0)
-			goto next;
-		targetBoxList = thisNode->CollisionBoxes;
-
+ObjNode		*thisNode;
+ObjNode		**candidates;
+int			numCandidates;
+OGLVector3D	segment;
+ObjNode		*hitNode = nil, *scanHitNode = nil;
 
-				/* CREATE SEGMENT FROM CROSSBEAM */
-				
-		crossBeamP1.x = targetBoxList[0].left;
-		crossBeamP1.y = targetBoxList[0].back;
+	if (gRayTreeDisabled || gVerifyRayTree)
+	{
+		thisNode = gFirstNodePtr;									// start on 1st node
 
-		crossBeamP2.x = targetBoxList[0].right;
-		crossBeamP2.y = targetBoxList[0].front;
+		do
+		{			
+			if (thisNode->Slot >= SLOT_OF_DUMB)						// see if reach end of usable list
+				break;
 
+			if (thisNode->What == what											// see if we want to check this What
+				&& DoesLineSegmentHitCrossBeam(endPoint1, endPoint2, thisNode))
+			{
+				scanHitNode = thisNode;
+				break;
+			}
 
-			/* SEE IF INPUT SEGMENT INTERSECTS THE CROSSBEAM SEGMENT */
-				
-		if (IntersectLineSegments(p1.x, p1.y, p2.x, p2.y,
-			                     crossBeamP1.x, crossBeamP1.y, crossBeamP2.x, crossBeamP2.y,
-	                             &ix, &iz))
-	  	{
-			float	dy = endPoint2->y - endPoint1->y;			// get dy of line segment
+			thisNode = thisNode->NextNode;							// next target node
+		}while(thisNode != nil);
 
-			float	d1 = CalcDistance(p1.x, p1.y, p2.x, p2.y);
-			float	d2 = CalcDistance(p1.x, p1.y, ix, iz);
-					
-			float	ratio = d2/d1;
+		if (gRayTreeDisabled)
+			return(scanHitNode);
+	}
 
-			iy = endPoint1->y + (dy * ratio);					// calc intersect y coord
+	OGLPoint3D_Subtract(endPoint2, endPoint1, &segment);
+	numCandidates = GatherRayTreeCandidates(endPoint1, &segment, 1.0f, 0, 0, &candidates);
 
-			if ((iy <= targetBoxList[0].top) &&					// if below top & above bottom, then HIT
-				(iy >= targetBoxList[0].bottom))
-			{
-				return(thisNode);			
-			}
-	  	}
-	                             
-		
-next:	
-		thisNode = thisNode->NextNode;							// next target node
-	}while(thisNode != nil);
+	for (int i = 0; i < numCandidates; i++)
+	{
+		if (candidates[i]->What == what
+			&& DoesLineSegmentHitCrossBeam(endPoint1, endPoint2, candidates[i]))
+		{
+			hitNode = candidates[i];
+			break;
+		}
+	}
 
+	if (gVerifyRayTree)
+	{
+		if (hitNode != scanHitNode)
+			DoFatalAlert("SeeIfLineSegmentHitsWhat: ray tree hit %p, scan hit %p", (void*) hitNode, (void*) scanHitNode);
+		gRayTreeStats.numVerified++;
+	}
 
-	return(nil);
+	return(hitNode);
 }
 
 
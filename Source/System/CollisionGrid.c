@@ -0,0 +1,386 @@
+/****************************/
+/*   	COLLISION GRID.C    */
+/****************************/
+//
+// Broadphase for CollisionDetect.
+//
+// Every object with collision boxes (and a slot below SLOT_OF_DUMB) is
+// registered in the x/z cells of a uniform world-space grid that its boxes
+// overlap. The grid is hashed, so it works for any terrain size, or none.
+// CollisionDetect then only needs to look at the objects in the cells
+// that its base box overlaps, instead of at the whole object list.
+//
+// An object's cells are updated whenever its boxes are recalculated, i.e.
+// by AddCollisionBoxToObject, CalcObjectBoxFromNode, CalcObjectBoxFromGlobal
+// and KeepOldCollisionBoxes, which are the only places that write them.
+//
+// Objects whose boxes span a lot of cells, or aren't finite, go into an
+// "oversize" list that's always checked.
+//
+// The candidates are returned in object list order, i.e. by slot and then
+// by the order in which they were attached, so that the collision list
+// comes out exactly like the brute force scan's.
+//
+
+/***************/
+/* EXTERNALS   */
+/***************/
+
+#include "game.h"
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+static Boolean CalcCollisionGridRect(const CollisionBoxType* boxes, int numBoxes, int32_t rect[4]);
+static void InsertCollisionGridEntry(ObjNode* node, int list, int32_t cx, int32_t cz);
+static int AllocCollisionGridEntry(void);
+static int HashCollisionGridCell(int32_t cx, int32_t cz);
+static void AddCollisionGridCandidate(ObjNode* node, int* n);
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+#define	CGRID_CELL_SIZE			512.0f
+#define	CGRID_NUM_BUCKETS		1024						// must be power of 2
+#define	CGRID_OVERSIZE_LIST		CGRID_NUM_BUCKETS			// index of the extra list head for the oversize objects
+#define	CGRID_MAX_NODE_CELLS	16							// objects that span more cells than this go in the oversize list
+#define	CGRID_MAX_QUERY_CELLS	64							// queries that span more cells than this use the brute force scan
+#define	CGRID_MAX_COORD			1.0e8f						// boxes must be within this to be gridded
+
+#define	CGRID_INITIAL_ENTRIES	512
+
+
+/*********************/
+/*    VARIABLES      */
+/*********************/
+
+typedef struct
+{
+	ObjNode*	node;
+	int			prev,next;									// in the bucket's list (0 = none)
+	int			nextOfNode;									// node's next entry (0 = none)
+	int			list;										// which bucket, or CGRID_OVERSIZE_LIST
+	int32_t		cx,cz;
+} CollisionGridEntry;
+
+CollisionGridStats			gCollisionGridStats;
+Boolean						gVerifyCollisionGrid = false;	// compare every CollisionDetect against the brute force scan
+
+static CollisionGridEntry*	gGridEntries = NULL;			// entry 0 is never used, so that 0 can mean "none"
+static int					gNumGridEntries = 0;
+static int					gFirstFreeGridEntry = 0;		// linked thru next
+
+static int					gGridListHead[CGRID_NUM_BUCKETS + 1];
+
+static ObjNode**			gGridCandidates = NULL;
+static int					gMaxGridCandidates = 0;
+static uint32_t				gGridQueryStamp = 0;
+
+
+#pragma mark -
+
+/********************** UPDATE COLLISION GRID NODE ***************************/
+//
+// Re-files the node in the cells that its boxes overlap now.
+//
+
+void UpdateCollisionGridNode(ObjNode* node)
+{
+int32_t		rect[4];
+Boolean		oversize;
+int			numCells;
+
+	if (node->Slot >= SLOT_OF_DUMB || node->NumCollisionBoxes == 0)		// CollisionDetect never looks at these
+	{
+		RemoveCollisionGridNode(node);
+		return;
+	}
+
+	oversize = !CalcCollisionGridRect(node->CollisionBoxes, node->NumCollisionBoxes, rect);
+
+	if (!oversize)
+	{
+		numCells = (rect[2] - rect[0] + 1) * (rect[3] - rect[1] + 1);
+		oversize = numCells > CGRID_MAX_NODE_CELLS;
+	}
+
+			/* SEE IF STILL IN THE SAME CELLS */
+
+	if (node->CollisionGridEntry)
+	{
+		if (oversize && node->CollisionGridOversize)
+			return;
+
+		if (!oversize && !node->CollisionGridOversize
+			&& SDL_memcmp(rect, node->CollisionGridRect, sizeof(rect)) == 0)
+		{
+			return;
+		}
+
+		RemoveCollisionGridNode(node);
+	}
+
+			/* FILE IT */
+
+	gCollisionGridStats.numRefiles++;
+
+	node->CollisionGridOversize = oversize;
+	SDL_memcpy(node->CollisionGridRect, rect, sizeof(rect));
+
+	if (oversize)
+	{
+		InsertCollisionGridEntry(node, CGRID_OVERSIZE_LIST, 0, 0);
+		return;
+	}
+
+	for (int32_t cz = rect[1]; cz <= rect[3]; cz++)
+		for (int32_t cx = rect[0]; cx <= rect[2]; cx++)
+			InsertCollisionGridEntry(node, HashCollisionGridCell(cx, cz), cx, cz);
+}
+
+
+/********************** REMOVE COLLISION GRID NODE ***************************/
+
+void RemoveCollisionGridNode(ObjNode* node)
+{
+	int i = node->CollisionGridEntry;
+
+	while (i)
+	{
+		CollisionGridEntry* e = &gGridEntries[i];
+		int nextOfNode = e->nextOfNode;
+
+		if (e->prev)											// unlink from its list
+			gGridEntries[e->prev].next = e->next;
+		else
+			gGridListHead[e->list] = e->next;
+
+		if (e->next)
+			gGridEntries[e->next].prev = e->prev;
+
+		e->node = NULL;											// put on free list
+		e->next = gFirstFreeGridEntry;
+		gFirstFreeGridEntry = i;
+
+		i = nextOfNode;
+	}
+
+	node->CollisionGridEntry = 0;
+}
+
+
+/********************** GATHER COLLISION GRID CANDIDATES ***************************/
+//
+// Gets every gridded object whose cells overlap the given box, sorted in
+// object list order.
+//
+// Returns -1 if the box is too big (or not finite) for the grid to be any
+// help, in which case the caller should scan the object list instead.
+//
+
+int GatherCollisionGridCandidates(const CollisionBoxType* box, ObjNode*** candidates)
+{
+int32_t		rect[4];
+int			n = 0;
+
+	if (!CalcCollisionGridRect(box, 1, rect)
+		|| (rect[2] - rect[0] + 1) * (rect[3] - rect[1] + 1) > CGRID_MAX_QUERY_CELLS)
+	{
+		gCollisionGridStats.numFallbacks++;
+		return -1;
+	}
+
+	gGridQueryStamp++;
+	gCollisionGridStats.numQueries++;
+
+	for (int i = gGridListHead[CGRID_OVERSIZE_LIST]; i; i = gGridEntries[i].next)
+		AddCollisionGridCandidate(gGridEntries[i].node, &n);
+
+	for (int32_t cz = rect[1]; cz <= rect[3]; cz++)
+	{
+		for (int32_t cx = rect[0]; cx <= rect[2]; cx++)
+		{
+			for (int i = gGridListHead[HashCollisionGridCell(cx, cz)]; i; i = gGridEntries[i].next)
+			{
+				if (gGridEntries[i].cx == cx && gGridEntries[i].cz == cz)		// skip other cells in the same bucket
+					AddCollisionGridCandidate(gGridEntries[i].node, &n);
+			}
+		}
+	}
+
+	gCollisionGridStats.numCandidates += n;
+
+	*candidates = gGridCandidates;
+	return n;
+}
+
+
+/********************** ADD COLLISION GRID CANDIDATE ***************************/
+//
+// Inserts it in object list order, unless we already got it from another cell.
+//
+
+static void AddCollisionGridCandidate(ObjNode* node, int* n)
+{
+	if (node->CollisionGridStamp == gGridQueryStamp)
+		return;
+	node->CollisionGridStamp = gGridQueryStamp;
+
+	if (*n >= gMaxGridCandidates)
+	{
+		int			newMax = gMaxGridCandidates ? gMaxGridCandidates * 2 : 256;
+		ObjNode**	newList = (ObjNode**) AllocPtrTagged(sizeof(ObjNode*) * newMax, kMemTag_ObjNodes);
+
+		if (gGridCandidates)
+		{
+			SDL_memcpy(newList, gGridCandidates, sizeof(ObjNode*) * (*n));
+			SafeDisposePtr((Ptr) gGridCandidates);
+		}
+		gGridCandidates = newList;
+		gMaxGridCandidates = newMax;
+	}
+
+	int j = (*n)++;
+	while (j > 0 && IsCollisionGridCandidateBefore(node, gGridCandidates[j - 1]))
+	{
+		gGridCandidates[j] = gGridCandidates[j - 1];
+		j--;
+	}
+	gGridCandidates[j] = node;
+}
+
+
+#pragma mark -
+
+/********************** CALC COLLISION GRID RECT ***************************/
+//
+// Gets the range of cells covered by the union of the boxes: minX, minZ, maxX, maxZ.
+// Returns false if the boxes aren't within CGRID_MAX_COORD (or are NaN).
+//
+// Inside-out boxes (left > right) can still "overlap" in CollisionDetect's
+// test, so each box covers the cells between its sides either way around.
+//
+
+static Boolean CalcCollisionGridRect(const CollisionBoxType* boxes, int numBoxes, int32_t rect[4])
+{
+float	minX = 0, maxX = 0, minZ = 0, maxZ = 0;
+
+	for (int i = 0; i < numBoxes; i++)
+	{
+		const CollisionBoxType* b = &boxes[i];
+
+		if (!(b->left	> -CGRID_MAX_COORD && b->left	< CGRID_MAX_COORD)		// also catches NaN, which the brute force scan treats as overlapping everything
+			|| !(b->right	> -CGRID_MAX_COORD && b->right	< CGRID_MAX_COORD)
+			|| !(b->back	> -CGRID_MAX_COORD && b->back	< CGRID_MAX_COORD)
+			|| !(b->front	> -CGRID_MAX_COORD && b->front	< CGRID_MAX_COORD))
+		{
+			return false;
+		}
+
+		float x0 = GAME_MIN(b->left, b->right);
+		float x1 = GAME_MAX(b->left, b->right);
+		float z0 = GAME_MIN(b->back, b->front);
+		float z1 = GAME_MAX(b->back, b->front);
+
+		if (i == 0)
+		{
+			minX = x0;	maxX = x1;
+			minZ = z0;	maxZ = z1;
+		}
+		else
+		{
+			minX = GAME_MIN(minX, x0);	maxX = GAME_MAX(maxX, x1);
+			minZ = GAME_MIN(minZ, z0);	maxZ = GAME_MAX(maxZ, z1);
+		}
+	}
+
+	rect[0] = (int32_t) floorf(minX * (1.0f / CGRID_CELL_SIZE));
+	rect[1] = (int32_t) floorf(minZ * (1.0f / CGRID_CELL_SIZE));
+	rect[2] = (int32_t) floorf(maxX * (1.0f / CGRID_CELL_SIZE));
+	rect[3] = (int32_t) floorf(maxZ * (1.0f / CGRID_CELL_SIZE));
+
+	return true;
+}
+
+
+/********************** INSERT COLLISION GRID ENTRY ***************************/
+
+static void InsertCollisionGridEntry(ObjNode* node, int list, int32_t cx, int32_t cz)
+{
+	int i = AllocCollisionGridEntry();
+	CollisionGridEntry* e = &gGridEntries[i];
+
+	e->node			= node;
+	e->list			= list;
+	e->cx			= cx;
+	e->cz			= cz;
+
+	e->prev			= 0;
+	e->next			= gGridListHead[list];
+	if (e->next)
+		gGridEntries[e->next].prev = i;
+	gGridListHead[list] = i;
+
+	e->nextOfNode	= node->CollisionGridEntry;
+	node->CollisionGridEntry = i;
+}
+
+
+/********************** ALLOC COLLISION GRID ENTRY ***************************/
+
+static int AllocCollisionGridEntry(void)
+{
+	if (!gFirstFreeGridEntry)
+	{
+		int						oldNum = gNumGridEntries;
+		int						newNum = oldNum ? oldNum * 2 : CGRID_INITIAL_ENTRIES;
+		CollisionGridEntry*		newEntries = (CollisionGridEntry*) AllocPtrClearTagged(sizeof(CollisionGridEntry) * newNum, kMemTag_ObjNodes);
+
+		if (gGridEntries)
+		{
+			SDL_memcpy(newEntries, gGridEntries, sizeof(CollisionGridEntry) * oldNum);
+			SafeDisposePtr((Ptr) gGridEntries);
+		}
+
+		gGridEntries = newEntries;
+		gNumGridEntries = newNum;
+
+		for (int i = newNum - 1; i >= GAME_MAX(oldNum, 1); i--)		// entry 0 is never used
+		{
+			gGridEntries[i].next = gFirstFreeGridEntry;
+			gFirstFreeGridEntry = i;
+		}
+	}
+
+	int i = gFirstFreeGridEntry;
+	gFirstFreeGridEntry = gGridEntries[i].next;
+	return i;
+}
+
+
+/********************** HASH COLLISION GRID CELL ***************************/
+
+static int HashCollisionGridCell(int32_t cx, int32_t cz)
+{
+	uint32_t h = ((uint32_t) cx * 73856093u) ^ ((uint32_t) cz * 19349663u);
+	return (int) (h & (CGRID_NUM_BUCKETS - 1));
+}
+
+
+/********************** IS COLLISION GRID CANDIDATE BEFORE ***************************/
+//
+// The object list is sorted by slot, and objects with the same slot are in the
+// order that they were attached.  The ray tree sorts its candidates with this too.
+//
+
+Boolean IsCollisionGridCandidateBefore(const ObjNode* a, const ObjNode* b)
+{
+	if (a->Slot != b->Slot)
+		return a->Slot < b->Slot;
+
+	return a->AttachSeq < b->AttachSeq;
+}
@@ -145,7 +145,7 @@ char		path[64];
 
 			/* ALLOC MEMORY FOR SKELETON INFO STRUCTURE */
 
-	skeleton = (SkeletonDefType *)AllocPtr(sizeof(SkeletonDefType));
+	skeleton = (SkeletonDefType *)AllocPtrTagged(sizeof(SkeletonDefType), kMemTag_Skeleton);
 	if (skeleton == nil)
 		DoFatalAlert("Cannot alloc SkeletonInfoType");
 
@@ -153,7 +153,10 @@ char		path[64];
 			/* READ SKELETON RESOURCES */
 
 	ReadDataFromSkeletonFile(skeleton, &bg3dSpec, skeletonType);
+
+	LoadTime_Begin(kLoad_PrimeBoneData);
 	PrimeBoneData(skeleton);
+	LoadTime_End(kLoad_PrimeBoneData);
 	
 			/* CLOSE REZ FILE */
 			
@@ -256,11 +259,11 @@ SkeletonFile_AnimHeader_Type	*animHeaderPtr;
 
 			/* ALLOC THE POINT & NORMALS SUB-ARRAYS */
 
-		skeleton->Bones[i].pointList = (uint16_t *)AllocPtr(sizeof(uint16_t) * (int)skeleton->Bones[i].numPointsAttachedToBone);
+		skeleton->Bones[i].pointList = (uint16_t *)AllocPtrTagged(sizeof(uint16_t) * (int)skeleton->Bones[i].numPointsAttachedToBone, kMemTag_Skeleton);
 		if (skeleton->Bones[i].pointList == nil)
 			DoFatalAlert("ReadDataFromSkeletonFile: AllocPtr/pointList failed!");
 
-		skeleton->Bones[i].normalList = (uint16_t *)AllocPtr(sizeof(uint16_t) * (int)skeleton->Bones[i].numNormalsAttachedToBone);
+		skeleton->Bones[i].normalList = (uint16_t *)AllocPtrTagged(sizeof(uint16_t) * (int)skeleton->Bones[i].numNormalsAttachedToBone, kMemTag_Skeleton);
 		if (skeleton->Bones[i].normalList == nil)
 			DoFatalAlert("ReadDataFromSkeletonFile: AllocPtr/normalList failed!");
 
@@ -588,16 +591,23 @@ void LoadPlayfield(FSSpec *specPtr)
 {
 	
 	gDisableHiccupTimer = true;
+
+	LoadTime_Begin(kLoad_LoadPlayfield);
 	
 			/* READ PLAYFIELD RESOURCES */
 						
+	LoadTime_Begin(kLoad_ReadPlayfieldFile);
 	ReadDataFromPlayfieldFile(specPtr);
+	LoadTime_End(kLoad_ReadPlayfieldFile);
 		
 		
 				/* DO ADDITIONAL SETUP */
 	
 	CreateSuperTileMemoryList();				// allocate memory for the supertile geometry
 	CalculateSplitModeMatrix();					// precalc the tile split mode matrix
+	BuildTerrainPlaneTable();					// and the planes of every tile's triangles
+	CreateSuperTileLODErrors();					// and how far off each supertile's coarser levels are
+	CreateSuperTileBuffers();					// and the GPU buffers to draw the supertiles from
 	InitSuperTileGrid();						// init the supertile state grid
 		
 	BuildTerrainItemList();						// build list of items & find player start coords
@@ -605,7 +615,11 @@ void LoadPlayfield(FSSpec *specPtr)
 
 			/* CAST ITEM SHADOWS */
 			
+	LoadTime_Begin(kLoad_ItemShadowCasting);
 	DoItemShadowCasting();
+	LoadTime_End(kLoad_ItemShadowCasting);
+
+	LoadTime_End(kLoad_LoadPlayfield);
 }
 
 
@@ -858,7 +872,7 @@ Ptr						tempBuffer16 = nil;
 	{	
 		FileFenceDefType *inData;
 
-		gFenceList = (FenceDefType *)AllocPtr(sizeof(FenceDefType) * gNumFences);	// alloc new ptr for fence data
+		gFenceList = (FenceDefType *)AllocPtrTagged(sizeof(FenceDefType) * gNumFences, kMemTag_Terrain);	// alloc new ptr for fence data
 		if (gFenceList == nil)
 			DoFatalAlert("ReadDataFromPlayfieldFile: AllocPtr failed");
 
@@ -892,7 +906,7 @@ Ptr						tempBuffer16 = nil;
    			FencePointType *fileFencePoints = (FencePointType *)*hand;
 			BYTESWAP_HANDLE(">ii", FencePointType, gFenceList[i].numNubs, hand);
 
-			gFenceList[i].nubList = (OGLPoint3D *)AllocPtr(sizeof(FenceDefType) * gFenceList[i].numNubs);	// alloc new ptr for nub array
+			gFenceList[i].nubList = (OGLPoint3D *)AllocPtrTagged(sizeof(FenceDefType) * gFenceList[i].numNubs, kMemTag_Terrain);	// alloc new ptr for nub array
 			if (gFenceList[i].nubList == nil)
 				DoFatalAlert("ReadDataFromPlayfieldFile: AllocPtr failed");
 		
@@ -986,7 +1000,7 @@ Ptr						tempBuffer16 = nil;
 				/* ALLOC BUFFERS */
 		
 	size = SUPERTILE_TEXMAP_SIZE * SUPERTILE_TEXMAP_SIZE * 2;						// calc size of supertile 16-bit texture
-	tempBuffer16 = AllocPtr(size);
+	tempBuffer16 = AllocPtrTagged(size, kMemTag_Terrain);
 	if (tempBuffer16 == nil)
 		DoFatalAlert("ReadDataFromPlayfieldFile: AllocPtr failed!");
 
@@ -165,6 +165,14 @@ static KeyState		gNeedStates[NUM_CONTROL_NEEDS];
 Boolean				gMouseMotionNow = false;
 char				gTextInput[64];
 
+static InputOverrideProc	gInputOverrideProc = NULL;
+static InputSnapshot		gInputOverride;
+static InputRecorderProc	gInputRecorderProc = NULL;
+
+static Boolean		gCarryMouseDeltas = false;		// last maintenance pass didn't update the needs, so nobody has seen its mouse deltas yet
+
+static void DoSDLMaintenance_Internal(Boolean updateNeeds);
+static void RecordInputSnapshot(void);
 static void OnJoystickRemoved(SDL_JoystickID which);
 static SDL_Gamepad* TryOpenGamepadFromJoystick(SDL_JoystickID joystickID);
 static SDL_Gamepad* TryOpenAnyGamepad(bool showMessage);
@@ -190,10 +198,28 @@ void ReadKeyboard(void)
 	DoSDLMaintenance();
 }
 
+/**************** READ KEYBOARD: NO SIM TICK *************/
+//
+// For rendered frames that don't run any fixed-timestep sim tick (see NextSimTick).
+// We still pump events and refresh the raw key states (F8 etc. are read while drawing),
+// but the need states are left alone so the next sim tick still sees any new press,
+// and the mouse/wheel deltas carry over to the next sim tick.
+//
+
+void ReadKeyboard_NoSimTick(void)
+{
+	DoSDLMaintenance_Internal(false);
+}
+
 /***************** GET MOUSE COORD *****************/
 
 OGLPoint2D GetLogicalMouseCoord(void)
 {
+	if (gInputOverrideProc)
+	{
+		return gInputOverride.mouseCoord;
+	}
+
 	float windowX = 0;
 	float windowY = 0;
 	GetMousePixelCoord(&windowX, &windowY);
@@ -208,6 +234,13 @@ OGLPoint2D GetLogicalMouseCoord(void)
 
 void GetMousePixelCoord(float *x, float *y)
 {
+	if (gInputOverrideProc)						// overridden input has no real cursor, so keep it off the window edges
+	{
+		*x = gGameWindowWidth * 0.5f;
+		*y = gGameWindowHeight * 0.5f;
+		return;
+	}
+
 	float windowX = 0;
 	float windowY = 0;
 	SDL_GetMouseState(&windowX, &windowY);
@@ -288,7 +321,9 @@ static void ParseAltEnter(void)
 
 static void UpdateMouseButtonStates(int mouseWheelDelta)
 {
-	uint32_t mouseButtons = SDL_GetMouseState(NULL, NULL);
+	uint32_t mouseButtons = gInputOverrideProc
+							? gInputOverride.mouseButtonBits
+							: SDL_GetMouseState(NULL, NULL);
 
 	for (int i = 1; i < NUM_SUPPORTED_MOUSE_BUTTONS_PURESDL; i++)	// SDL buttons start at 1!
 	{
@@ -309,6 +344,19 @@ static void UpdateInputNeeds(void)
 
 		bool downNow = false;
 
+		if (gInputOverrideProc)
+		{
+			downNow = 0 != (gInputOverride.needBits & (1u << i));
+
+			if (!gInputOverride.exactNeedEdges)
+				UpdateKeyState(&gNeedStates[i], downNow);
+			else if (gInputOverride.newNeedBits & (1u << i))				// replaying a recording: take the states as they were,
+				gNeedStates[i] = KEYSTATE_PRESSED;								// regardless of any InvalidateAllInputs in between
+			else
+				gNeedStates[i] = downNow ? KEYSTATE_HELD : KEYSTATE_OFF;
+			continue;
+		}
+
 		for (int j = 0; j < MAX_BINDINGS_PER_NEED; j++)
 		{
 			int16_t scancode = kb->key[j];
@@ -326,7 +374,7 @@ static void UpdateInputNeeds(void)
 
 static void UpdateGamepadSpecificInputNeeds(int gamepadNum)
 {
-	if (!gGamepads[gamepadNum].open)
+	if (!gGamepads[gamepadNum].open || gInputOverrideProc)
 	{
 		return;
 	}
@@ -377,15 +425,28 @@ static void UpdateGamepadSpecificInputNeeds(int gamepadNum)
 /**********************/
 
 void DoSDLMaintenance(void)
+{
+	DoSDLMaintenance_Internal(true);
+}
+
+static void DoSDLMaintenance_Internal(Boolean updateNeeds)
 {
 	gTextInput[0] = '\0';
-	gMouseMotionNow = false;
-	gMouseDeltaX = 0;
-	gMouseDeltaY = 0;
 
 	int mouseWheelDeltaX = 0;
 	int mouseWheelDeltaY = 0;
 
+	if (gCarryMouseDeltas)
+	{
+		mouseWheelDeltaY = -gScrollWheelDelta;
+	}
+	else
+	{
+		gMouseMotionNow = false;
+		gMouseDeltaX = 0;
+		gMouseDeltaY = 0;
+	}
+
 	// Update mouse DPI scale
 	{
 		int windowW = 1;
@@ -456,16 +517,40 @@ void DoSDLMaintenance(void)
 	}
 
 
+	// Let the override proc supply this tick's gameplay input
+	if (gInputOverrideProc && updateNeeds)
+	{
+		SDL_zero(gInputOverride);
+		gInputOverrideProc(&gInputOverride);
+
+		gMouseMotionNow = gInputOverride.mouseDeltaX != 0 || gInputOverride.mouseDeltaY != 0;
+		gMouseDeltaX = gInputOverride.mouseDeltaX;
+		gMouseDeltaY = gInputOverride.mouseDeltaY;
+		mouseWheelDeltaX = 0;
+		mouseWheelDeltaY = -gInputOverride.scrollWheelDelta;
+
+		if (gInputOverride.framesPerSecond > 0)					// replay the recorded timestep
+		{
+			gFramesPerSecond = gInputOverride.framesPerSecond;
+			gFramesPerSecondFrac = 1.0f / gFramesPerSecond;
+		}
+	}
+
 	// Refresh the state of each individual keyboard key
 	UpdateRawKeyboardStates();
 
 	// On ALT+ENTER, toggle fullscreen, and ignore ENTER until keyup
 	ParseAltEnter();
 
-	// Refresh the state of each mouse button
-	UpdateMouseButtonStates(mouseWheelDeltaY);
+	// Refresh the state of each mouse button (overridden buttons only change on sim ticks)
+	if (!gInputOverrideProc || updateNeeds)
+		UpdateMouseButtonStates(mouseWheelDeltaY);
 	gScrollWheelDelta = mouseWheelDeltaX - mouseWheelDeltaY;	// for edge scrolling in-game
 
+	gCarryMouseDeltas = !updateNeeds;
+	if (!updateNeeds)
+		return;
+
 	// Refresh the state of each input need
 	UpdateInputNeeds();
 
@@ -477,6 +562,49 @@ void DoSDLMaintenance(void)
 	{
 		UpdateGamepadSpecificInputNeeds(gamepadNum);
 	}
+
+	// Hand the final state of this tick to the recorder
+	if (gInputRecorderProc)
+	{
+		RecordInputSnapshot();
+	}
+}
+
+/********************** RECORD INPUT SNAPSHOT **************************/
+//
+// Gathers everything the sim reads from the input devices this tick,
+// in the form an override proc would need to reproduce it.
+//
+
+static void RecordInputSnapshot(void)
+{
+	InputSnapshot snapshot;
+	SDL_zero(snapshot);
+
+	for (int i = 0; i < NUM_CONTROL_NEEDS; i++)
+	{
+		if (GetNeedState(i))
+			snapshot.needBits |= 1u << i;
+		if (GetNewNeedState(i))
+			snapshot.newNeedBits |= 1u << i;
+	}
+	snapshot.exactNeedEdges = true;
+
+	snapshot.mouseCoord = GetLogicalMouseCoord();
+	snapshot.mouseDeltaX = gMouseDeltaX;
+	snapshot.mouseDeltaY = gMouseDeltaY;
+	snapshot.scrollWheelDelta = gScrollWheelDelta;
+
+	for (int i = 1; i < NUM_SUPPORTED_MOUSE_BUTTONS_PURESDL; i++)
+	{
+		if (gMouseButtonStates[i] & KEYSTATE_ACTIVE_BIT)
+			snapshot.mouseButtonBits |= SDL_BUTTON_MASK(i);
+	}
+
+	snapshot.analogSteering = GetAnalogSteering(0);
+	snapshot.framesPerSecond = gFramesPerSecond;
+
+	gInputRecorderProc(&snapshot);
 }
 
 #pragma mark -
@@ -598,6 +726,35 @@ Boolean UserWantsOut(void)
 		;
 }
 
+/********************** SET INPUT OVERRIDE **************************/
+//
+// While an override proc is installed, it is called once per sim tick (DoSDLMaintenance)
+// and its snapshot replaces the keyboard/mouse/gamepad state of every need.
+// Raw key states (F8 debug toggle etc.) still come from the real keyboard.
+// Pass NULL to go back to the real devices.
+//
+
+void SetInputOverride(InputOverrideProc proc)
+{
+	_Static_assert(NUM_CONTROL_NEEDS <= 32, "InputSnapshot.needBits is too small");
+
+	gInputOverrideProc = proc;
+	SDL_zero(gInputOverride);
+	InvalidateAllInputs();
+}
+
+/********************** SET INPUT RECORDER **************************/
+//
+// While a recorder proc is installed, it gets a snapshot of the input
+// at the end of every DoSDLMaintenance that runs a sim tick.
+// Pass NULL to stop recording.
+//
+
+void SetInputRecorder(InputRecorderProc proc)
+{
+	gInputRecorderProc = proc;
+}
+
 Boolean IsCheatKeyComboDown(void)
 {
 	return (GetKeyState(SDL_SCANCODE_LGUI) || GetKeyState(SDL_SCANCODE_RGUI))
@@ -660,6 +817,12 @@ OGLVector2D GetAnalogSteering(int playerID)
 
 			/* FIRST CHECK ANALOG AXES */
 
+	if (gInputOverrideProc)
+	{
+		if (playerID == 0)
+			steer = gInputOverride.analogSteering;
+	}
+	else
 	if (sdlGamepad)
 	{
 		steer.x = GetGamepadAnalogSteeringAxis(sdlGamepad, SDL_GAMEPAD_AXIS_LEFTX);
@@ -58,6 +58,8 @@ void LoadDuelArt(void)
 {
 FSSpec	spec;
 
+	LoadTime_BeginReport(gCurrentArea);
+
 
 
 			/*********************/
@@ -135,6 +137,7 @@ FSSpec	spec;
 	
 	LoadPlayfield(&spec);
 
+	LoadTime_EndReport();
 }
 
 
@@ -144,6 +147,8 @@ void LoadShootoutArt(void)
 {
 FSSpec	spec;
 
+	LoadTime_BeginReport(gCurrentArea);
+
 
 
 			/*********************/
@@ -230,6 +235,8 @@ FSSpec	spec;
 	
 	BG3D_SphereMapGeomteryMaterial(MODEL_GROUP_GLOBAL, GLOBAL_ObjType_PesoPOW,
 								0, MULTI_TEXTURE_COMBINE_ADD, SPHEREMAP_SObjType_Sheen);			
+
+	LoadTime_EndReport();
 }
 
 
@@ -239,6 +246,8 @@ void LoadStampedeArt(void)
 {
 FSSpec	spec;
 
+	LoadTime_BeginReport(gCurrentArea);
+
 
 
 			/*********************/
@@ -323,6 +332,8 @@ FSSpec	spec;
 
 	BG3D_SphereMapGeomteryMaterial(MODEL_GROUP_GLOBAL, GLOBAL_ObjType_Boost,
 								0, MULTI_TEXTURE_COMBINE_ADD, SPHEREMAP_SObjType_Sheen);			
+
+	LoadTime_EndReport();
 }
 
 
@@ -334,6 +345,8 @@ void LoadTargetPracticeArt(void)
 {
 FSSpec	spec;
 
+	LoadTime_BeginReport(gCurrentArea);
+
 
 
 			/*********************/
@@ -384,6 +397,8 @@ FSSpec	spec;
 
 	BG3D_SphereMapGeomteryMaterial(MODEL_GROUP_LEVELSPECIFIC, PRACTICE_ObjType_DeathSkull,
 								0, MULTI_TEXTURE_COMBINE_ADD, SPHEREMAP_SObjType_Satin);
+
+	LoadTime_EndReport();
 }
 
 
@@ -0,0 +1,264 @@
+/****************************/
+/*        LOAD TIME.C       */
+/****************************/
+//
+// Asset load-time accounting.
+//
+// The expensive loaders are bracketed with LoadTime_Begin/LoadTime_End.
+// Steps nest (e.g. ImportBG3D uploads textures, LoadSkeletonFile imports a
+// BG3D), so each step gets both its inclusive time and its self time, i.e.
+// minus the nested steps. Nothing is recorded outside of a report, and a
+// report covers one area's Load*Art call, or the startup loads.
+//
+// Every report is logged, and also appended to the --loadreport file as a
+// line of JSON so that load times can be tracked from run to run.
+//
+// Main thread only.
+//
+
+/***************/
+/* EXTERNALS   */
+/***************/
+
+#include "game.h"
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+static void LoadTime_WriteReport(double totalMs);
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+#define	LOADTIME_MAX_DEPTH		16
+
+static const char* kLoadStepNames[NUM_LOAD_STEPS] =
+{
+	[kLoad_ImportBG3D]			= "ImportBG3D",
+	[kLoad_BuildMeshBVHs]		= "BuildMeshBVHs",
+	[kLoad_LoadSkeletonFile]	= "LoadSkeletonFile",
+	[kLoad_PrimeBoneData]		= "PrimeBoneData",
+	[kLoad_LoadPlayfield]		= "LoadPlayfield",
+	[kLoad_ReadPlayfieldFile]	= "ReadDataFromPlayfieldFile",
+	[kLoad_ItemShadowCasting]	= "DoItemShadowCasting",
+	[kLoad_LoadSoundBank]		= "LoadSoundBank",
+	[kLoad_LoadSpriteGroup]		= "LoadSpriteGroup",
+	[kLoad_TextureMapLoad]		= "OGL_TextureMap_Load",
+};
+
+
+/*********************/
+/*    VARIABLES      */
+/*********************/
+
+typedef struct
+{
+	Uint64		ticks;									// inclusive
+	Uint64		selfTicks;								// minus nested steps
+	uint32_t	calls;
+} LoadStepStats;
+
+typedef struct
+{
+	int16_t		step;
+	Uint64		start;
+	Uint64		childTicks;
+} LoadStackEntry;
+
+float					gLastLoadTimeMS = 0;			// total of the last report, for the debug overlay
+
+static Boolean			gLoadReportActive = false;
+static int				gLoadReportArea = 0;
+static Uint64			gLoadReportStart = 0;
+
+static LoadStepStats	gLoadSteps[NUM_LOAD_STEPS];
+static LoadStackEntry	gLoadStack[LOADTIME_MAX_DEPTH];
+static int				gLoadStackDepth = 0;
+
+static SDL_IOStream*	gLoadReportFile = NULL;
+
+
+/********************** LOADTIME: BEGIN REPORT ***************************/
+//
+// area = AREA_* or LOADTIME_BOOT
+//
+
+void LoadTime_BeginReport(int area)
+{
+	GAME_ASSERT(!gLoadReportActive);
+
+	SDL_zeroa(gLoadSteps);
+	gLoadStackDepth = 0;
+
+	gLoadReportArea = area;
+	gLoadReportActive = true;
+	gLoadReportStart = SDL_GetPerformanceCounter();
+}
+
+
+/********************** LOADTIME: END REPORT ***************************/
+
+void LoadTime_EndReport(void)
+{
+	GAME_ASSERT(gLoadReportActive);
+	GAME_ASSERT_MESSAGE(gLoadStackDepth == 0, "LoadTime_EndReport: a load step was left open");
+
+	double totalMs = (SDL_GetPerformanceCounter() - gLoadReportStart) * 1000.0 / SDL_GetPerformanceFrequency();
+
+	gLoadReportActive = false;
+	gLastLoadTimeMS = (float) totalMs;
+
+	LoadTime_WriteReport(totalMs);
+}
+
+
+/********************** LOADTIME: BEGIN ***************************/
+
+void LoadTime_Begin(int step)
+{
+	GAME_ASSERT(step >= 0 && step < NUM_LOAD_STEPS);
+
+	if (!gLoadReportActive)
+		return;
+
+	GAME_ASSERT(gLoadStackDepth < LOADTIME_MAX_DEPTH);
+
+	LoadStackEntry* entry = &gLoadStack[gLoadStackDepth++];
+	entry->step			= step;
+	entry->childTicks	= 0;
+	entry->start		= SDL_GetPerformanceCounter();
+}
+
+
+/********************** LOADTIME: END ***************************/
+
+void LoadTime_End(int step)
+{
+	Uint64 now = SDL_GetPerformanceCounter();
+
+	if (!gLoadReportActive)
+		return;
+
+	GAME_ASSERT(gLoadStackDepth > 0);
+
+	LoadStackEntry* entry = &gLoadStack[--gLoadStackDepth];
+	if (entry->step != step)
+		DoFatalAlert("LoadTime_End: expected %s, got %s", kLoadStepNames[entry->step], kLoadStepNames[step]);
+
+	Uint64 elapsed = now - entry->start;
+
+	gLoadSteps[step].ticks		+= elapsed;
+	gLoadSteps[step].selfTicks	+= elapsed - entry->childTicks;
+	gLoadSteps[step].calls++;
+
+	if (gLoadStackDepth > 0)
+		gLoadStack[gLoadStackDepth - 1].childTicks += elapsed;
+}
+
+
+#pragma mark -
+
+/********************** LOADTIME: OPEN REPORT FILE ***************************/
+//
+// Every report from now on also gets appended to this file, one JSON object per line.
+//
+
+Boolean LoadTime_OpenReportFile(const char* path)
+{
+	GAME_ASSERT(!gLoadReportFile);
+
+	gLoadReportFile = SDL_IOFromFile(path, "a");
+	if (!gLoadReportFile)
+	{
+		SDL_Log("LoadTime: can't open %s: %s", path, SDL_GetError());
+		return false;
+	}
+
+	return true;
+}
+
+
+/********************** LOADTIME: CLOSE REPORT FILE ***************************/
+
+void LoadTime_CloseReportFile(void)
+{
+	if (!gLoadReportFile)
+		return;
+
+	SDL_CloseIO(gLoadReportFile);
+	gLoadReportFile = NULL;
+}
+
+
+/********************** LOADTIME: WRITE REPORT ***************************/
+//
+// "Untracked" is whatever the report's time wasn't spent in any step.
+//
+
+static void LoadTime_WriteReport(double totalMs)
+{
+	const double	msPerTick = 1000.0 / SDL_GetPerformanceFrequency();
+	double			trackedMs = 0;
+	char			label[16];
+
+	for (int i = 0; i < NUM_LOAD_STEPS; i++)
+		trackedMs += gLoadSteps[i].selfTicks * msPerTick;
+
+	if (gLoadReportArea == LOADTIME_BOOT)
+		SDL_strlcpy(label, "boot", sizeof(label));
+	else
+		SDL_snprintf(label, sizeof(label), "area %d", gLoadReportArea);
+
+
+			/* LOG IT */
+
+	SDL_Log("LoadTime: %s: %.1f ms (untracked %.1f ms)", label, totalMs, totalMs - trackedMs);
+
+	for (int i = 0; i < NUM_LOAD_STEPS; i++)
+	{
+		if (gLoadSteps[i].calls == 0)
+			continue;
+
+		SDL_Log("LoadTime: %s:   %-26s %4u calls  %8.1f ms  self %8.1f ms",
+				label,
+				kLoadStepNames[i],
+				gLoadSteps[i].calls,
+				gLoadSteps[i].ticks * msPerTick,
+				gLoadSteps[i].selfTicks * msPerTick);
+	}
+
+
+			/* APPEND IT TO THE REPORT FILE */
+
+	if (!gLoadReportFile)
+		return;
+
+	if (gLoadReportArea == LOADTIME_BOOT)
+		SDL_IOprintf(gLoadReportFile, "{\"report\":\"boot\"");
+	else
+		SDL_IOprintf(gLoadReportFile, "{\"report\":\"area\",\"area\":%d", gLoadReportArea);
+
+	SDL_IOprintf(gLoadReportFile, ",\"total_ms\":%.3f,\"untracked_ms\":%.3f,\"steps\":{", totalMs, totalMs - trackedMs);
+
+	Boolean first = true;
+	for (int i = 0; i < NUM_LOAD_STEPS; i++)
+	{
+		if (gLoadSteps[i].calls == 0)
+			continue;
+
+		SDL_IOprintf(gLoadReportFile, "%s\"%s\":{\"calls\":%u,\"ms\":%.3f,\"self_ms\":%.3f}",
+				first ? "" : ",",
+				kLoadStepNames[i],
+				gLoadSteps[i].calls,
+				gLoadSteps[i].ticks * msPerTick,
+				gLoadSteps[i].selfTicks * msPerTick);
+		first = false;
+	}
+
+	SDL_IOprintf(gLoadReportFile, "}}\n");
+	SDL_FlushIO(gLoadReportFile);
+}
@@ -251,6 +251,51 @@ next:;
 }
 
 
+/******************** PLAY AREA ************************/
+//
+// Plays a single area by itself, outside of the arcade progression.
+// Used for direct launch and by the benchmark.
+//
+
+void PlayArea(int area)
+{
+	gCurrentArea = area;
+
+	switch(gCurrentArea)
+	{
+		case AREA_TOWN_DUEL1:
+		case AREA_TOWN_DUEL2:
+		case AREA_TOWN_DUEL3:
+		case AREA_SWAMP_DUEL1:
+		case AREA_SWAMP_DUEL2:
+		case AREA_SWAMP_DUEL3:
+			// PlayDuel takes a difficulty index equal to half the area number.
+			// Duel areas are defined at even offsets (0, 2, 4, 6, 8, 10) in the
+			// area enum, so dividing by 2 gives the difficulty/duel index.
+			PlayDuel(gCurrentArea / 2);
+			break;
+
+		case AREA_TOWN_SHOOTOUT:
+		case AREA_SWAMP_SHOOTOUT:
+			PlayShootout();
+			break;
+
+		case AREA_TOWN_STAMPEDE:
+		case AREA_SWAMP_STAMPEDE:
+			PlayStampede();
+			break;
+
+		case AREA_TARGETPRACTICE1:
+		case AREA_TARGETPRACTICE2:
+			PlayTargetPractice();
+			break;
+
+		default:
+			break;
+	}
+}
+
+
 #pragma mark -
 
  
@@ -339,6 +384,9 @@ unsigned long	someLong;
 	ToolBoxInit();
 
 	LoadPrefs();
+#if BENCHMARK
+	gGamePrefs.fullscreen = false;			// stay in the hidden window
+#endif
 	MoveToPreferredDisplay();
 	SetFullscreenMode(true);
 
@@ -361,6 +409,8 @@ unsigned long	someLong;
 
 
 
+	LoadTime_BeginReport(LOADTIME_BOOT);
+
 	InitTerrainManager();
 	InitSkeletonManager();
 	InitSoundTools();
@@ -374,47 +424,23 @@ unsigned long	someLong;
 	LoadSpriteGroup(SPRITE_GROUP_SPHEREMAPS);
 	LoadSpriteGroup(SPRITE_GROUP_INFOBAR);
 
+	LoadTime_EndReport();
+
+#if BENCHMARK
+	RunBenchmark();
+	return;
+#endif
+
 
 		/* DIRECT LEVEL LAUNCH (e.g. from level editor via WebAssembly) */
 
 	if (gDirectLaunchLevel >= 0)
 	{
 		InitPlayerInfo_Game();
-		gCurrentArea = gDirectLaunchLevel;
-
-		switch(gCurrentArea)
-		{
-			case AREA_TOWN_DUEL1:
-			case AREA_TOWN_DUEL2:
-			case AREA_TOWN_DUEL3:
-			case AREA_SWAMP_DUEL1:
-			case AREA_SWAMP_DUEL2:
-			case AREA_SWAMP_DUEL3:
-				// PlayDuel takes a difficulty index equal to half the area number.
-				// Duel areas are defined at even offsets (0, 2, 4, 6, 8, 10) in the
-				// area enum, so dividing by 2 gives the difficulty/duel index.
-				PlayDuel(gCurrentArea / 2);
-				break;
-
-			case AREA_TOWN_SHOOTOUT:
-			case AREA_SWAMP_SHOOTOUT:
-				PlayShootout();
-				break;
-
-			case AREA_TOWN_STAMPEDE:
-			case AREA_SWAMP_STAMPEDE:
-				PlayStampede();
-				break;
-
-			case AREA_TARGETPRACTICE1:
-			case AREA_TARGETPRACTICE2:
-				PlayTargetPractice();
-				break;
-
-			default:
-				break;
-		}
-
+		Boolean replay = Replay_BeginArea(gDirectLaunchLevel);		// if --record/--replay was given
+		PlayArea(gDirectLaunchLevel);
+		if (replay)
+			Replay_EndArea();
 		return;
 	}
 
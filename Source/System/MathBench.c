@@ -0,0 +1,741 @@
+/****************************/
+/*       MATH BENCH.C       */
+/****************************/
+//
+// Micro-benchmark for the 3DMath.c kernels that dominate our profiles.
+//
+// This is the only game file in the BillyFrontierMathBench target besides
+// 3DMath.c itself, so it provides the handful of game globals that 3DMath.c
+// references. Every kernel is timed over a realistic batch size and its
+// output is checked against a straightforward double-precision reference
+// that's written independently of 3DMath.c, so that any reworking of the
+// math layer (e.g. SIMD) can be validated against it.
+//
+// Usage: BillyFrontierMathBench [--quick]
+// Exits with status 1 if any kernel disagrees with its reference.
+//
+
+#if MATHBENCH
+
+/***************/
+/* EXTERNALS   */
+/***************/
+
+#include "game.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+typedef struct
+{
+	const char*	name;
+	int			opsPerRun;							// # of kernel calls (or array elements) per run
+	void		(*setup)(int n);
+	void		(*run)(int n);
+	int			(*verify)(int n);					// returns # of mismatching results
+} MathKernel;
+
+static void MathBench_TimeKernel(const MathKernel* kernel);
+static float MathBench_RandomRange(float lo, float hi);
+static void MathBench_RandomAffineMatrix(OGLMatrix4x4* m);
+static Boolean MathBench_CloseEnough(double got, double want, double tolerance);
+static int MathBench_CompareDoubles(const void* a, const void* b);
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+#define	MAX_BATCH				16384
+
+#define	NUM_TRIALS				7
+#define	TRIAL_SECONDS			0.05						// each trial runs the kernel at least this long
+#define	TRIAL_SECONDS_QUICK		0.005
+
+
+/*********************/
+/*    VARIABLES      */
+/*********************/
+
+		/* GAME GLOBALS REFERENCED BY 3DMATH.C */
+
+OGLMatrix4x4		gWorldToFrustumMatrix;
+PlayerInfoType		gPlayerInfo;
+float				gFramesPerSecondFrac = 1.0f / 60.0f;
+
+
+static uint32_t		gBenchSeed = 0x2b1f6a03;
+static double		gTrialSeconds = TRIAL_SECONDS;
+static volatile float gSink;									// keeps the optimizer from discarding results
+static int			gNumFailures = 0;
+
+static OGLMatrix4x4		gMatricesA[MAX_BATCH];
+static OGLMatrix4x4		gMatricesB[MAX_BATCH];
+static OGLMatrix4x4		gMatricesOut[MAX_BATCH];
+static OGLPoint3D		gPointsIn[MAX_BATCH * 3];					// *3 so it can hold a triangle list
+static OGLPoint3D		gPointsOut[MAX_BATCH];
+static OGLVector3D		gVectorsIn[MAX_BATCH];
+static OGLVector3D		gVectorsOut[MAX_BATCH];
+static OGLVector3D		gAngles[MAX_BATCH];
+static OGLBoundingBox	gBoxes[MAX_BATCH];
+static Boolean			gVisible[MAX_BATCH];
+static OGLPlaneEquation	gPlanes[MAX_BATCH];
+
+
+
+#pragma mark -
+
+/******************* STUBS FOR THE REST OF THE GAME ************************/
+//
+// Not exercised by any of the kernels we time.
+//
+
+float RandomFloat2(void)
+{
+	return MathBench_RandomRange(-1.0f, 1.0f);
+}
+
+Boolean IsPointInTriangle(float pt_x, float pt_y, float x0, float y0, float x1, float y1, float x2, float y2)
+{
+	(void) pt_x; (void) pt_y; (void) x0; (void) y0; (void) x1; (void) y1; (void) x2; (void) y2;
+	return false;
+}
+
+void OGL_GetCurrentViewport(int *x, int *y, int *w, int *h)
+{
+	*x = 0;
+	*y = 0;
+	*w = 640;
+	*h = 480;
+}
+
+
+#pragma mark -
+
+/******************** REFERENCE HELPERS ***********************/
+//
+// value[] is column-major: element (row r, column c) lives at value[c*4 + r].
+//
+
+#define	ELEM(m, r, c)	((m)->value[(c) * 4 + (r)])
+
+
+/*********************** MATRIX MULTIPLY *****************************/
+//
+// OGLMatrix4x4_Multiply(A, B, out) applies A first, then B, i.e. out = B * A.
+//
+
+static void Setup_MatrixMultiply(int n)
+{
+	for (int i = 0; i < n; i++)
+	{
+		MathBench_RandomAffineMatrix(&gMatricesA[i]);
+		MathBench_RandomAffineMatrix(&gMatricesB[i]);
+	}
+}
+
+static void Run_MatrixMultiply(int n)
+{
+	for (int i = 0; i < n; i++)
+		OGLMatrix4x4_Multiply(&gMatricesA[i], &gMatricesB[i], &gMatricesOut[i]);
+
+	gSink += gMatricesOut[n - 1].value[M03];
+}
+
+static int Verify_MatrixMultiply(int n)
+{
+	int bad = 0;
+
+	for (int i = 0; i < n; i++)
+	{
+		for (int r = 0; r < 4; r++)
+		for (int c = 0; c < 4; c++)
+		{
+			double want = 0;
+			for (int k = 0; k < 4; k++)
+				want += (double) ELEM(&gMatricesB[i], r, k) * (double) ELEM(&gMatricesA[i], k, c);
+
+			if (!MathBench_CloseEnough(ELEM(&gMatricesOut[i], r, c), want, 1e-4))
+			{
+				bad++;
+				goto next;
+			}
+		}
+next:;
+	}
+
+	return bad;
+}
+
+
+/*********************** POINT 3D TRANSFORM ARRAY *****************************/
+
+static void Setup_PointTransform(int n)
+{
+	MathBench_RandomAffineMatrix(&gMatricesA[0]);
+
+	for (int i = 0; i < n; i++)
+	{
+		gPointsIn[i].x = MathBench_RandomRange(-500, 500);
+		gPointsIn[i].y = MathBench_RandomRange(-500, 500);
+		gPointsIn[i].z = MathBench_RandomRange(-500, 500);
+	}
+}
+
+static void Run_PointTransform(int n)
+{
+	OGLPoint3D_TransformArray(gPointsIn, &gMatricesA[0], gPointsOut, n);
+	gSink += gPointsOut[n - 1].x;
+}
+
+static int Verify_PointTransform(int n)
+{
+	const OGLMatrix4x4* m = &gMatricesA[0];
+	int bad = 0;
+
+	for (int i = 0; i < n; i++)
+	{
+		const double in[3] = { gPointsIn[i].x, gPointsIn[i].y, gPointsIn[i].z };
+		const float out[3] = { gPointsOut[i].x, gPointsOut[i].y, gPointsOut[i].z };
+
+		for (int r = 0; r < 3; r++)
+		{
+			double want = ELEM(m, r, 0) * in[0] + ELEM(m, r, 1) * in[1] + ELEM(m, r, 2) * in[2] + ELEM(m, r, 3);
+
+			if (!MathBench_CloseEnough(out[r], want, 1e-4))
+			{
+				bad++;
+				break;
+			}
+		}
+	}
+
+	return bad;
+}
+
+
+/*********************** VECTOR 3D TRANSFORM ARRAY *****************************/
+//
+// Transforms by the upper 3x3 and normalizes the result.
+//
+
+static void Setup_VectorTransform(int n)
+{
+	MathBench_RandomAffineMatrix(&gMatricesA[0]);
+
+	for (int i = 0; i < n; i++)
+	{
+		gVectorsIn[i].x = MathBench_RandomRange(-1, 1);
+		gVectorsIn[i].y = MathBench_RandomRange(-1, 1);
+		gVectorsIn[i].z = MathBench_RandomRange(-1, 1);
+		OGLVector3D_Normalize(&gVectorsIn[i], &gVectorsIn[i]);
+	}
+}
+
+static void Run_VectorTransform(int n)
+{
+	OGLVector3D_TransformArray(gVectorsIn, &gMatricesA[0], gVectorsOut, n);
+	gSink += gVectorsOut[n - 1].x;
+}
+
+static int Verify_VectorTransform(int n)
+{
+	const OGLMatrix4x4* m = &gMatricesA[0];
+	int bad = 0;
+
+	for (int i = 0; i < n; i++)
+	{
+		const double in[3] = { gVectorsIn[i].x, gVectorsIn[i].y, gVectorsIn[i].z };
+		const float out[3] = { gVectorsOut[i].x, gVectorsOut[i].y, gVectorsOut[i].z };
+		double want[3];
+
+		for (int r = 0; r < 3; r++)
+			want[r] = ELEM(m, r, 0) * in[0] + ELEM(m, r, 1) * in[1] + ELEM(m, r, 2) * in[2];
+
+		double length = sqrt(want[0] * want[0] + want[1] * want[1] + want[2] * want[2]);
+
+		for (int r = 0; r < 3; r++)
+		{
+			if (!MathBench_CloseEnough(out[r], want[r] / length, 1e-4))		// FastNormalizeVector is an approximation
+			{
+				bad++;
+				break;
+			}
+		}
+	}
+
+	return bad;
+}
+
+
+/*********************** BBOX VISIBILITY *****************************/
+//
+// Random boxes scattered around a perspective camera so that roughly half
+// of them are culled. Boxes that straddle a frustum plane within rounding
+// distance are skipped by the check, since float and double can
+// legitimately disagree on those.
+//
+
+static void Setup_BBoxVisible(int n)
+{
+	const float fov		= 1.0f;
+	const float aspect	= 16.0f / 9.0f;
+	const float hither	= 10.0f;
+	const float yon		= 4000.0f;
+	const float f		= 1.0f / tanf(fov * 0.5f);
+
+	OGLMatrix4x4 view, proj;
+
+	OGLMatrix4x4_SetRotate_XYZ(&view, 0.2f, 0.6f, 0.0f);				// a camera tilted down and turned a bit
+	view.value[M13] = -300;
+	view.value[M23] = -200;
+
+	memset(&proj, 0, sizeof(proj));
+	ELEM(&proj, 0, 0) = f / aspect;
+	ELEM(&proj, 1, 1) = f;
+	ELEM(&proj, 2, 2) = -yon / (yon - hither);							// clip z: 0 at hither, w at yon
+	ELEM(&proj, 2, 3) = -yon * hither / (yon - hither);
+	ELEM(&proj, 3, 2) = -1;
+
+	OGLMatrix4x4_Multiply(&view, &proj, &gWorldToFrustumMatrix);
+
+	for (int i = 0; i < n; i++)
+	{
+		float x = MathBench_RandomRange(-4000, 4000);
+		float y = MathBench_RandomRange(-100, 600);
+		float z = MathBench_RandomRange(-4000, 4000);
+		float size = MathBench_RandomRange(10, 300);
+
+		gBoxes[i].min.x = x;			gBoxes[i].max.x = x + size;
+		gBoxes[i].min.y = y;			gBoxes[i].max.y = y + size;
+		gBoxes[i].min.z = z;			gBoxes[i].max.z = z + size;
+		gBoxes[i].isEmpty = false;
+	}
+}
+
+static void Run_BBoxVisible(int n)
+{
+	int numVisible = 0;
+
+	for (int i = 0; i < n; i++)
+	{
+		gVisible[i] = OGL_IsBBoxVisible(&gBoxes[i], NULL);
+		numVisible += gVisible[i];
+	}
+
+	gSink += numVisible;
+}
+
+static int Verify_BBoxVisible(int n)
+{
+	const OGLMatrix4x4* m = &gWorldToFrustumMatrix;
+	int bad = 0;
+
+	for (int i = 0; i < n; i++)
+	{
+		uint32_t	outcodeAND = 0x3f;
+		Boolean		ambiguous = false;
+
+		for (int corner = 0; corner < 8; corner++)
+		{
+			double p[3] =
+			{
+				(corner & 4) ? gBoxes[i].max.x : gBoxes[i].min.x,
+				(corner & 2) ? gBoxes[i].max.y : gBoxes[i].min.y,
+				(corner & 1) ? gBoxes[i].max.z : gBoxes[i].min.z,
+			};
+			double h[4];
+
+			for (int r = 0; r < 4; r++)
+				h[r] = ELEM(m, r, 0) * p[0] + ELEM(m, r, 1) * p[1] + ELEM(m, r, 2) * p[2] + ELEM(m, r, 3);
+
+			const double w = h[3];
+			const double slop = 1e-4 * (fabs(w) + 1.0);
+			const double dist[6] = { w - h[0], h[0] + w, w - h[1], h[1] + w, h[2], w - h[2] };	// >= 0 means inside
+
+			uint32_t outcode = 0;
+			for (int plane = 0; plane < 6; plane++)
+			{
+				if (dist[plane] < 0)
+					outcode |= 1u << plane;
+				if (fabs(dist[plane]) < slop)
+					ambiguous = true;
+			}
+
+			outcodeAND &= outcode;
+		}
+
+		if (!ambiguous && gVisible[i] != (outcodeAND == 0))
+			bad++;
+	}
+
+	return bad;
+}
+
+
+/*********************** MATRIX INVERT *****************************/
+
+static void Setup_MatrixInvert(int n)
+{
+	for (int i = 0; i < n; i++)
+		MathBench_RandomAffineMatrix(&gMatricesA[i]);
+}
+
+static void Run_MatrixInvert(int n)
+{
+	for (int i = 0; i < n; i++)
+		OGLMatrix4x4_Invert(&gMatricesA[i], &gMatricesOut[i]);
+
+	gSink += gMatricesOut[n - 1].value[M03];
+}
+
+static int Verify_MatrixInvert(int n)
+{
+	int bad = 0;
+
+	for (int i = 0; i < n; i++)
+	{
+				/* A * A^-1 SHOULD BE THE IDENTITY */
+
+		for (int r = 0; r < 4; r++)
+		for (int c = 0; c < 4; c++)
+		{
+			double sum = 0, magnitude = 0;
+			for (int k = 0; k < 4; k++)
+			{
+				double term = (double) ELEM(&gMatricesA[i], r, k) * (double) ELEM(&gMatricesOut[i], k, c);
+				sum += term;
+				magnitude += fabs(term);
+			}
+
+			if (fabs(sum - (r == c ? 1.0 : 0.0)) > 1e-5 * fmax(1.0, magnitude))		// the translation column cancels big terms
+			{
+				bad++;
+				goto next;
+			}
+		}
+next:;
+	}
+
+	return bad;
+}
+
+
+/*********************** SET ROTATE XYZ *****************************/
+//
+// The result is Rz * Ry * Rx, i.e. X is applied first.
+//
+
+static void Setup_SetRotateXYZ(int n)
+{
+	for (int i = 0; i < n; i++)
+	{
+		gAngles[i].x = MathBench_RandomRange(-PI2, PI2);
+		gAngles[i].y = MathBench_RandomRange(-PI2, PI2);
+		gAngles[i].z = MathBench_RandomRange(-PI2, PI2);
+	}
+}
+
+static void Run_SetRotateXYZ(int n)
+{
+	for (int i = 0; i < n; i++)
+		OGLMatrix4x4_SetRotate_XYZ(&gMatricesOut[i], gAngles[i].x, gAngles[i].y, gAngles[i].z);
+
+	gSink += gMatricesOut[n - 1].value[M00];
+}
+
+static int Verify_SetRotateXYZ(int n)
+{
+	int bad = 0;
+
+	for (int i = 0; i < n; i++)
+	{
+		const double sx = sin(gAngles[i].x), cx = cos(gAngles[i].x);
+		const double sy = sin(gAngles[i].y), cy = cos(gAngles[i].y);
+		const double sz = sin(gAngles[i].z), cz = cos(gAngles[i].z);
+
+		const double rx[3][3] = { {1, 0, 0}, {0, cx, -sx}, {0, sx, cx} };
+		const double ry[3][3] = { {cy, 0, sy}, {0, 1, 0}, {-sy, 0, cy} };
+		const double rz[3][3] = { {cz, -sz, 0}, {sz, cz, 0}, {0, 0, 1} };
+		double ryx[3][3];
+
+		for (int r = 0; r < 3; r++)
+		for (int c = 0; c < 3; c++)
+			ryx[r][c] = ry[r][0] * rx[0][c] + ry[r][1] * rx[1][c] + ry[r][2] * rx[2][c];
+
+		for (int r = 0; r < 4; r++)
+		for (int c = 0; c < 4; c++)
+		{
+			double want;
+
+			if (r < 3 && c < 3)
+				want = rz[r][0] * ryx[0][c] + rz[r][1] * ryx[1][c] + rz[r][2] * ryx[2][c];
+			else
+				want = (r == c) ? 1.0 : 0.0;
+
+			if (!MathBench_CloseEnough(ELEM(&gMatricesOut[i], r, c), want, 1e-5))
+			{
+				bad++;
+				goto next;
+			}
+		}
+next:;
+	}
+
+	return bad;
+}
+
+
+/*********************** TRIANGLE PLANE EQUATION *****************************/
+
+static void Setup_TrianglePlane(int n)
+{
+	for (int i = 0; i < n; i++)
+	{
+		OGLPoint3D* tri = &gPointsIn[i * 3];
+		float area2;
+
+		do													// no slivers: the plane of a degenerate triangle is undefined
+		{
+			for (int v = 0; v < 3; v++)
+			{
+				tri[v].x = MathBench_RandomRange(-2000, 2000);
+				tri[v].y = MathBench_RandomRange(-200, 200);
+				tri[v].z = MathBench_RandomRange(-2000, 2000);
+			}
+
+			OGLVector3D e1 = { tri[1].x - tri[0].x, tri[1].y - tri[0].y, tri[1].z - tri[0].z };
+			OGLVector3D e2 = { tri[2].x - tri[0].x, tri[2].y - tri[0].y, tri[2].z - tri[0].z };
+			OGLVector3D cross =											// not OGLVector3D_Cross, which normalizes
+			{
+				e1.y * e2.z - e1.z * e2.y,
+				e1.z * e2.x - e1.x * e2.z,
+				e1.x * e2.y - e1.y * e2.x,
+			};
+			area2 = CalcVectorLength(&cross);
+		} while (area2 < 2000.0f);
+	}
+}
+
+static void Run_TrianglePlane(int n)
+{
+	for (int i = 0; i < n; i++)
+		OGL_ComputeTrianglePlaneEquation(&gPointsIn[i * 3], &gPlanes[i]);
+
+	gSink += gPlanes[n - 1].constant;
+}
+
+static int Verify_TrianglePlane(int n)
+{
+	int bad = 0;
+
+	for (int i = 0; i < n; i++)
+	{
+		const OGLPoint3D* tri = &gPointsIn[i * 3];
+
+				/* NORMAL FOLLOWS THE WINDING 0->1->2, AND ALL 3 POINTS LIE ON THE PLANE */
+
+		double e1[3] = { tri[1].x - tri[0].x, tri[1].y - tri[0].y, tri[1].z - tri[0].z };
+		double e2[3] = { tri[2].x - tri[0].x, tri[2].y - tri[0].y, tri[2].z - tri[0].z };
+		double nrm[3] =
+		{
+			e1[1] * e2[2] - e1[2] * e2[1],
+			e1[2] * e2[0] - e1[0] * e2[2],
+			e1[0] * e2[1] - e1[1] * e2[0],
+		};
+		double length = sqrt(nrm[0] * nrm[0] + nrm[1] * nrm[1] + nrm[2] * nrm[2]);
+		double want = -(nrm[0] * tri[0].x + nrm[1] * tri[0].y + nrm[2] * tri[0].z) / length;
+
+		if (!MathBench_CloseEnough(gPlanes[i].normal.x, nrm[0] / length, 1e-4)
+			|| !MathBench_CloseEnough(gPlanes[i].normal.y, nrm[1] / length, 1e-4)
+			|| !MathBench_CloseEnough(gPlanes[i].normal.z, nrm[2] / length, 1e-4)
+			|| !MathBench_CloseEnough(gPlanes[i].constant, want, 1e-4))
+		{
+			bad++;
+		}
+	}
+
+	return bad;
+}
+
+
+#pragma mark -
+
+/************************** KERNEL TABLE ***************************/
+//
+// Batch sizes follow what the game actually feeds these: a skinned
+// character or a terrain supertile for the array transforms, the number of
+// objects culled per frame for the bbox test, a skeleton's worth of bones
+// for the matrix ops, and a collision mesh for the plane equations.
+//
+
+static const MathKernel kMathKernels[] =
+{
+	{ "OGLMatrix4x4_Multiply",			 64,	Setup_MatrixMultiply,	Run_MatrixMultiply,		Verify_MatrixMultiply },
+	{ "OGLPoint3D_TransformArray",		 64,	Setup_PointTransform,	Run_PointTransform,		Verify_PointTransform },
+	{ "OGLPoint3D_TransformArray",		 1024,	Setup_PointTransform,	Run_PointTransform,		Verify_PointTransform },
+	{ "OGLPoint3D_TransformArray",		 16384,	Setup_PointTransform,	Run_PointTransform,		Verify_PointTransform },
+	{ "OGLVector3D_TransformArray",		 1024,	Setup_VectorTransform,	Run_VectorTransform,	Verify_VectorTransform },
+	{ "OGLVector3D_TransformArray",		 16384,	Setup_VectorTransform,	Run_VectorTransform,	Verify_VectorTransform },
+	{ "OGL_IsBBoxVisible",				 512,	Setup_BBoxVisible,		Run_BBoxVisible,		Verify_BBoxVisible },
+	{ "OGLMatrix4x4_Invert",			 64,	Setup_MatrixInvert,		Run_MatrixInvert,		Verify_MatrixInvert },
+	{ "OGLMatrix4x4_SetRotate_XYZ",		 64,	Setup_SetRotateXYZ,		Run_SetRotateXYZ,		Verify_SetRotateXYZ },
+	{ "OGL_ComputeTrianglePlaneEquation", 2048,	Setup_TrianglePlane,	Run_TrianglePlane,		Verify_TrianglePlane },
+};
+
+
+/************************** MAIN ***************************/
+
+int main(int argc, char** argv)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (0 == strcmp(argv[i], "--quick"))
+			gTrialSeconds = TRIAL_SECONDS_QUICK;
+		else
+		{
+			fprintf(stderr, "usage: %s [--quick]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	printf("%-34s %6s %10s %10s  %s\n", "kernel", "batch", "min ns/op", "med ns/op", "check");
+
+	for (size_t i = 0; i < sizeof(kMathKernels) / sizeof(kMathKernels[0]); i++)
+		MathBench_TimeKernel(&kMathKernels[i]);
+
+	if (gNumFailures)
+	{
+		printf("%d kernel(s) disagree with the reference\n", gNumFailures);
+		return 1;
+	}
+
+	return 0;
+}
+
+
+/********************** TIME KERNEL ***********************/
+//
+// Calibrates a repeat count that makes one trial last at least gTrialSeconds,
+// then reports the fastest and the median trial.
+//
+
+static void MathBench_TimeKernel(const MathKernel* kernel)
+{
+	const int		n = kernel->opsPerRun;
+	const double	ticksPerNs = SDL_GetPerformanceFrequency() / 1e9;
+	double			trialNs[NUM_TRIALS];
+	int				reps = 1;
+
+	GAME_ASSERT(n <= MAX_BATCH);
+
+	kernel->setup(n);
+
+			/* CHECK IT FIRST */
+
+	kernel->run(n);
+	int bad = kernel->verify(n);
+
+			/* CALIBRATE */
+
+	for (;;)
+	{
+		Uint64 start = SDL_GetPerformanceCounter();
+		for (int r = 0; r < reps; r++)
+			kernel->run(n);
+		double ns = (SDL_GetPerformanceCounter() - start) / ticksPerNs;
+
+		if (ns >= gTrialSeconds * 1e9 || reps >= (1 << 24))
+			break;
+
+		reps *= 2;
+	}
+
+			/* TIME IT */
+
+	for (int t = 0; t < NUM_TRIALS; t++)
+	{
+		Uint64 start = SDL_GetPerformanceCounter();
+		for (int r = 0; r < reps; r++)
+			kernel->run(n);
+		trialNs[t] = (SDL_GetPerformanceCounter() - start) / ticksPerNs / ((double) reps * n);
+	}
+
+	qsort(trialNs, NUM_TRIALS, sizeof(double), MathBench_CompareDoubles);
+
+	if (bad)
+		gNumFailures++;
+
+	printf("%-34s %6d %10.2f %10.2f  %s",
+			kernel->name, n, trialNs[0], trialNs[NUM_TRIALS / 2], bad ? "FAIL" : "ok");
+	if (bad)
+		printf(" (%d of %d wrong)", bad, n);
+	printf("\n");
+}
+
+
+#pragma mark -
+
+/********************** RANDOM RANGE ***********************/
+//
+// Own xorshift so that the inputs are the same on every platform and
+// don't depend on Misc.c.
+//
+
+static float MathBench_RandomRange(float lo, float hi)
+{
+	gBenchSeed ^= gBenchSeed << 13;
+	gBenchSeed ^= gBenchSeed >> 17;
+	gBenchSeed ^= gBenchSeed << 5;
+
+	return lo + (hi - lo) * ((gBenchSeed >> 8) * (1.0f / 16777216.0f));
+}
+
+
+/********************** RANDOM AFFINE MATRIX ***********************/
+//
+// Rotate + scale + translate, like an object's BaseTransformMatrix.
+//
+
+static void MathBench_RandomAffineMatrix(OGLMatrix4x4* m)
+{
+	OGLMatrix4x4 scale, rotate;
+
+	float s = MathBench_RandomRange(0.5f, 2.0f);
+
+	OGLMatrix4x4_SetScale(&scale, s, s, s);
+	OGLMatrix4x4_SetRotate_XYZ(&rotate,
+			MathBench_RandomRange(-PI, PI), MathBench_RandomRange(-PI, PI), MathBench_RandomRange(-PI, PI));
+
+	OGLMatrix4x4_Multiply(&scale, &rotate, m);
+	m->value[M03] = MathBench_RandomRange(-1000, 1000);
+	m->value[M13] = MathBench_RandomRange(-1000, 1000);
+	m->value[M23] = MathBench_RandomRange(-1000, 1000);
+}
+
+
+/********************** CLOSE ENOUGH ***********************/
+//
+// Relative tolerance for big values, absolute for values around 1.
+//
+
+static Boolean MathBench_CloseEnough(double got, double want, double tolerance)
+{
+	return fabs(got - want) <= tolerance * fmax(1.0, fabs(want));
+}
+
+
+static int MathBench_CompareDoubles(const void* a, const void* b)
+{
+	double da = *(const double*) a;
+	double db = *(const double*) b;
+	return (da > db) - (da < db);
+}
+
+
+#endif // MATHBENCH
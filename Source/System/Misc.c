@@ -18,6 +18,8 @@
 
 #define	PTRCOOKIE_SIZE		16
 
+#define	MAX_SIM_TICKS_PER_FRAME	8				// if we fall further behind than this, let the sim slow down rather than spiral
+
 
 
 /**********************/
@@ -29,14 +31,38 @@ uint32_t 	gSeed0 = 0, gSeed1 = 0, gSeed2 = 0;
 
 float	gFramesPerSecond, gFramesPerSecondFrac;
 
+float	gSimTickRate = 0;						// fixed sim rate in Hz; 0 = one variable-length sim tick per rendered frame
+float	gSimInterpolation = 1;					// where to draw objects between OldCoord (0) and Coord (1)
+
+static int		gSimTicksLeft = -1;				// -1 = NextSimTick hasn't been called yet this frame
+static int		gSimTicksThisFrame = 0;
+static float	gSimAccumulator = 0;			// leftover real time not yet simulated, in seconds
+static float	gRealFramesPerSecond, gRealFramesPerSecondFrac;
+
 int		gNumPointers = 0;
 long	gRAMAlloced = 0;
 
+MemoryTagStats	gMemoryTagStats[NUM_MEMORY_TAGS];
+
+static const char* kMemoryTagNames[NUM_MEMORY_TAGS] =
+{
+	[kMemTag_Misc]			= "misc",
+	[kMemTag_Terrain]		= "terrain",
+	[kMemTag_Skeleton]		= "skeleton",
+	[kMemTag_BG3D]			= "bg3d",
+	[kMemTag_Particles]		= "particles",
+	[kMemTag_MetaObjects]	= "metaobjs",
+	[kMemTag_Sound]			= "sound",
+	[kMemTag_ObjNodes]		= "objnodes",
+};
+
 
 /**********************/
 /*     PROTOTYPES     */
 /**********************/
 
+static void TrackTaggedAlloc(int tag, long deltaBytes, int deltaBlocks, Boolean isAlloc);
+
 
 /*********************** DO ALERT *******************/
 
@@ -99,6 +125,7 @@ static Boolean	beenHere = false;
 		OGL_Shutdown();
 
 		ShutdownSound();								// cleanup sound stuff
+		ShutdownSuperTileBuilders();
 	}
 
 	MyFlushEvents();
@@ -225,11 +252,26 @@ Handle	AllocHandle(long size)
 
 
 /****************** ALLOC PTR ********************/
+//
+// Untagged allocations are counted as kMemTag_Misc.
+//
+// The cookie in front of each block holds:
+//		[0]	'FACE'
+//		[1]	size including cookie
+//		[2]	memory tag
+//		[3]	how the block was made ('PTR4', 'PTC4' or 'REA4')
+//
 
 void *AllocPtr(long size)
+{
+	return AllocPtrTagged(size, kMemTag_Misc);
+}
+
+void *AllocPtrTagged(long size, int tag)
 {
 	GAME_ASSERT(size >= 0);
 	GAME_ASSERT(size <= 0x7FFFFFFF);
+	GAME_ASSERT(tag >= 0 && tag < NUM_MEMORY_TAGS);
 
 	size += PTRCOOKIE_SIZE;						// make room for our cookie & whatever else (also keep to 16-byte alignment!)
 	Ptr p = SDL_malloc(size);
@@ -238,11 +280,12 @@ void *AllocPtr(long size)
 	uint32_t* cookiePtr = (uint32_t *)p;
 	cookiePtr[0] = 'FACE';
 	cookiePtr[1] = (uint32_t) size;
-	cookiePtr[2] = 'PTR3';
+	cookiePtr[2] = (uint32_t) tag;
 	cookiePtr[3] = 'PTR4';
 
 	gNumPointers++;
 	gRAMAlloced += size;
+	TrackTaggedAlloc(tag, size, 1, true);
 
 	return p + PTRCOOKIE_SIZE;
 }
@@ -251,9 +294,15 @@ void *AllocPtr(long size)
 /****************** ALLOC PTR CLEAR ********************/
 
 void *AllocPtrClear(long size)
+{
+	return AllocPtrClearTagged(size, kMemTag_Misc);
+}
+
+void *AllocPtrClearTagged(long size, int tag)
 {
 	GAME_ASSERT(size >= 0);
 	GAME_ASSERT(size <= 0x7FFFFFFF);
+	GAME_ASSERT(tag >= 0 && tag < NUM_MEMORY_TAGS);
 
 	size += PTRCOOKIE_SIZE;						// make room for our cookie & whatever else (also keep to 16-byte alignment!)
 	Ptr p = SDL_calloc(1, size);
@@ -262,17 +311,21 @@ void *AllocPtrClear(long size)
 	uint32_t* cookiePtr = (uint32_t *)p;
 	cookiePtr[0] = 'FACE';
 	cookiePtr[1] = (uint32_t) size;
-	cookiePtr[2] = 'PTC3';
+	cookiePtr[2] = (uint32_t) tag;
 	cookiePtr[3] = 'PTC4';
 
 	gNumPointers++;
 	gRAMAlloced += size;
+	TrackTaggedAlloc(tag, size, 1, true);
 
 	return p + PTRCOOKIE_SIZE;
 }
 
 
 /****************** REALLOC PTR ********************/
+//
+// The block keeps its tag.
+//
 
 void* ReallocPtr(void* initialPtr, long newSize)
 {
@@ -294,11 +347,13 @@ void* ReallocPtr(void* initialPtr, long newSize)
 	GAME_ASSERT(cookiePtr[0] == 'FACE');		// realloc shouldn't have touched our cookie
 
 	uint32_t initialSize = cookiePtr[1];		// update heap size metric
+	int tag = (int) cookiePtr[2];
+	GAME_ASSERT(tag >= 0 && tag < NUM_MEMORY_TAGS);
 	gRAMAlloced += newSize - initialSize;
+	TrackTaggedAlloc(tag, newSize - (long) initialSize, 0, true);
 
 	cookiePtr[0] = 'FACE';						// rewrite cookie
 	cookiePtr[1] = (uint32_t) newSize;
-	cookiePtr[2] = 'REA3';
 	cookiePtr[3] = 'REA4';
 
 	return p + PTRCOOKIE_SIZE;
@@ -319,6 +374,8 @@ void SafeDisposePtr(void *ptr)
 	uint32_t* cookiePtr = (uint32_t *)p;
 	GAME_ASSERT(cookiePtr[0] == 'FACE');
 	gRAMAlloced -= cookiePtr[1];					// deduct ptr size from heap size
+	GAME_ASSERT(cookiePtr[2] < NUM_MEMORY_TAGS);
+	TrackTaggedAlloc(cookiePtr[2], -(long) cookiePtr[1], -1, false);
 
 	cookiePtr[0] = 'DEAD';							// zap cookie
 
@@ -328,6 +385,74 @@ void SafeDisposePtr(void *ptr)
 }
 
 
+/***************** TRACK TAGGED ALLOC ***********************/
+
+static void TrackTaggedAlloc(int tag, long deltaBytes, int deltaBlocks, Boolean isAlloc)
+{
+	MemoryTagStats* stats = &gMemoryTagStats[tag];
+
+	stats->liveBytes += deltaBytes;
+	stats->numLive += deltaBlocks;
+
+	if (stats->liveBytes > stats->peakBytes)
+		stats->peakBytes = stats->liveBytes;
+
+	if (isAlloc)
+	{
+		stats->allocsThisFrame++;
+		stats->totalAllocs++;
+	}
+}
+
+
+/***************** TRACK EXTERNAL MEMORY ***********************/
+//
+// For memory that a subsystem owns but that doesn't come from AllocPtr
+// (e.g. sound handles loaded by Pomme).
+//
+
+void TrackExternalMemory(int tag, long deltaBytes)
+{
+	GAME_ASSERT(tag >= 0 && tag < NUM_MEMORY_TAGS);
+	TrackTaggedAlloc(tag, deltaBytes, deltaBytes > 0 ? 1 : -1, deltaBytes > 0);
+}
+
+
+/***************** GET MEMORY TAG NAME ***********************/
+
+const char* GetMemoryTagName(int tag)
+{
+	GAME_ASSERT(tag >= 0 && tag < NUM_MEMORY_TAGS);
+	return kMemoryTagNames[tag];
+}
+
+
+/***************** END FRAME MEMORY TAG STATS ***********************/
+//
+// Called once per frame after the buffer swap.
+//
+
+void EndFrameMemoryTagStats(void)
+{
+	for (int i = 0; i < NUM_MEMORY_TAGS; i++)
+	{
+		gMemoryTagStats[i].allocsLastFrame = gMemoryTagStats[i].allocsThisFrame;
+		gMemoryTagStats[i].allocsThisFrame = 0;
+	}
+}
+
+
+/***************** RESET MEMORY TAG PEAKS ***********************/
+
+void ResetMemoryTagPeaks(void)
+{
+	for (int i = 0; i < NUM_MEMORY_TAGS; i++)
+	{
+		gMemoryTagStats[i].peakBytes = gMemoryTagStats[i].liveBytes;
+	}
+}
+
+
 
 #pragma mark -
 
@@ -357,12 +482,103 @@ unsigned long deltaTime;
 		gFramesPerSecond = MIN_FPS;
 #endif
 
+#if BENCHMARK
+	gFramesPerSecond = gBenchmarkTickRate;		// fixed timestep so that runs are repeatable
+#endif
+
 	gFramesPerSecondFrac = 1.0f/gFramesPerSecond;		// calc fractional for multiplication
 
 	time = currTime;	// reset for next time interval
 }
 
 
+/******************** NEXT SIM TICK ***********************/
+//
+// Drives the sim half of an area's main loop:
+//
+//		while (NextSimTick())
+//		{
+//			ReadKeyboard();
+//			MoveEverything_Foo();
+//		}
+//		OGL_DrawScene(...);
+//
+// By default, this runs exactly one tick per frame, with the frame time from CalcFramesPerSecond.
+//
+// If gSimTickRate is set, it runs as many fixed-length ticks as the real frame time calls for
+// (possibly none) and sets gSimInterpolation so that the frame is drawn between the last two ticks.
+// While the ticks run, gFramesPerSecond/Frac hold the tick length; afterwards, they go back to
+// the real frame time.
+//
+
+Boolean NextSimTick(void)
+{
+	Boolean fixedStep = gSimTickRate > 0.0f;
+
+			/* FIRST CALL THIS FRAME: HOW MANY TICKS? */
+
+	if (gSimTicksLeft < 0)
+	{
+		gSimTicksThisFrame = 0;
+
+		if (!fixedStep)
+		{
+			gSimTicksLeft = 1;
+		}
+		else
+		{
+			gRealFramesPerSecond = gFramesPerSecond;
+			gRealFramesPerSecondFrac = gFramesPerSecondFrac;
+
+			gSimAccumulator += gFramesPerSecondFrac;
+			gSimTicksLeft = (int) (gSimAccumulator * gSimTickRate);
+			if (gSimTicksLeft > MAX_SIM_TICKS_PER_FRAME)
+			{
+				gSimTicksLeft = MAX_SIM_TICKS_PER_FRAME;
+				gSimAccumulator = MAX_SIM_TICKS_PER_FRAME / gSimTickRate;	// drop the time we can't catch up on
+			}
+			gSimAccumulator -= gSimTicksLeft / gSimTickRate;
+		}
+	}
+
+			/* ALL DONE FOR THIS FRAME? */
+
+	if (gSimTicksLeft == 0 || gGameOver)
+	{
+		gSimTicksLeft = -1;
+
+		if (fixedStep)
+		{
+			gFramesPerSecond = gRealFramesPerSecond;
+			gFramesPerSecondFrac = gRealFramesPerSecondFrac;
+
+			gSimInterpolation = GAME_CLAMP(gSimAccumulator * gSimTickRate, 0.0f, 1.0f);
+
+			if (gSimTicksThisFrame == 0)							// keep events flowing even though no sim tick read the keyboard
+				ReadKeyboard_NoSimTick();
+		}
+
+		return false;
+	}
+
+			/* RUN ANOTHER TICK */
+
+	gSimTicksLeft--;
+	gSimTicksThisFrame++;
+
+	if (fixedStep)
+	{
+		gFramesPerSecond = gSimTickRate;						// (set every tick since DoPaused may have changed it)
+		gFramesPerSecondFrac = 1.0f / gSimTickRate;
+
+		SaveObjectCoordsForInterpolation();						// remember where everything was before this tick
+		SaveCameraForInterpolation();
+	}
+
+	return true;
+}
+
+
 /********************* IS POWER OF 2 ****************************/
 
 Boolean IsPowerOf2(int num)
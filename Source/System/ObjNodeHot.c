@@ -0,0 +1,196 @@
+/****************************/
+/*     OBJNODE HOT.C        */
+/****************************/
+//
+// Dense copies of the few ObjNode fields that CullTestAllObjects & the
+// autofade in DrawObjects need, so that those passes run over packed
+// arrays instead of dragging each whole ObjNode through the cache.
+//
+// Every attached node gets an entry (ObjNode.HotIndex) in AttachObject,
+// and gives it back in DeleteObject. Entries stay packed: removing one
+// moves the last entry into the hole.
+//
+// The copies are refreshed by UpdateObjNodeHotEntry, which is called
+// wherever the matrix or bbox get set: UpdateObjectTransforms,
+// SetObjectTransformMatrix, CreateBaseGroup, the bbox setup for display
+// group objects, and UpdateSkinnedGeometry for skeletons. That also refits
+// the node's leaf in the ray tree (see RayTree.c). So set Coord & BBox
+// before those calls, not after; debug builds check this every frame.
+//
+
+/***************/
+/* EXTERNALS   */
+/***************/
+
+#include "game.h"
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+static void GrowObjNodeHotTable(void);
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+#define	OBJHOT_INITIAL_CAPACITY		256
+
+
+/*********************/
+/*    VARIABLES      */
+/*********************/
+
+ObjNodeHotTable		gObjNodeHot;
+
+
+
+/********************** ADD OBJNODE HOT ENTRY ***************************/
+
+void AddObjNodeHotEntry(ObjNode* node)
+{
+	GAME_ASSERT(node->HotIndex < 0);
+
+	if (gObjNodeHot.count >= gObjNodeHot.capacity)
+		GrowObjNodeHotTable();
+
+	int i = gObjNodeHot.count++;
+
+	node->HotIndex = i;
+	gObjNodeHot.node[i]		= node;
+	gObjNodeHot.isOut[i]	= false;
+	gObjNodeHot.fadeDist[i]	= 0;
+
+	UpdateObjNodeHotEntry(node);
+}
+
+
+/********************** REMOVE OBJNODE HOT ENTRY ***************************/
+
+void RemoveObjNodeHotEntry(ObjNode* node)
+{
+	int i = node->HotIndex;
+
+	if (i < 0)											// never attached
+		return;
+
+	GAME_ASSERT(i < gObjNodeHot.count && gObjNodeHot.node[i] == node);
+
+	int last = --gObjNodeHot.count;
+
+	if (i != last)										// move last entry into the hole
+	{
+		ObjNode* moved = gObjNodeHot.node[last];
+
+		gObjNodeHot.node[i]			= moved;
+		gObjNodeHot.localToWorld[i]	= gObjNodeHot.localToWorld[last];
+		gObjNodeHot.bBox[i]			= gObjNodeHot.bBox[last];
+		gObjNodeHot.coordXZ[i]		= gObjNodeHot.coordXZ[last];
+		gObjNodeHot.isOut[i]		= gObjNodeHot.isOut[last];
+		gObjNodeHot.fadeDist[i]		= gObjNodeHot.fadeDist[last];
+
+		moved->HotIndex = i;
+	}
+
+	node->HotIndex = -1;
+}
+
+
+/********************** UPDATE OBJNODE HOT ENTRY ***************************/
+
+void UpdateObjNodeHotEntry(ObjNode* node)
+{
+	int i = node->HotIndex;
+
+	if (i < 0)
+		return;
+
+	if (node->Genre == SKELETON_GENRE)					// skeletons are already oriented, just need translation
+		OGLMatrix4x4_SetTranslate(&gObjNodeHot.localToWorld[i], node->Coord.x, node->Coord.y, node->Coord.z);
+	else
+		gObjNodeHot.localToWorld[i] = node->BaseTransformMatrix;
+
+	gObjNodeHot.bBox[i] = node->BBox;
+
+	gObjNodeHot.coordXZ[i].x = node->Coord.x;
+	gObjNodeHot.coordXZ[i].y = node->Coord.z;
+
+	UpdateRayTreeNode(node);							// the ray tree wants to know about moves too
+}
+
+
+/********************** VERIFY OBJNODE HOT ENTRY ***************************/
+//
+// Catches code that moves an object or changes its bbox without going thru
+// one of the calls that refresh its entry -- e.g. setting Coord after
+// SetObjectTransformMatrix instead of before. Release builds would cull &
+// autofade such an object where it was, so stop right here.
+//
+
+#if _DEBUG
+void VerifyObjNodeHotEntry(ObjNode* node)
+{
+OGLMatrix4x4	m;
+
+	int i = node->HotIndex;
+
+	GAME_ASSERT(i >= 0 && i < gObjNodeHot.count && gObjNodeHot.node[i] == node);
+
+	if (node->Genre == SKELETON_GENRE)
+		OGLMatrix4x4_SetTranslate(&m, node->Coord.x, node->Coord.y, node->Coord.z);
+	else
+		m = node->BaseTransformMatrix;
+
+	Boolean stale = SDL_memcmp(&m, &gObjNodeHot.localToWorld[i], sizeof(m)) != 0
+				|| SDL_memcmp(&node->BBox, &gObjNodeHot.bBox[i], sizeof(OGLBoundingBox)) != 0;
+
+	if ((node->StatusBits & STATUS_BIT_AUTOFADE)						// only autofade looks at the coord
+		&& (gObjNodeHot.coordXZ[i].x != node->Coord.x || gObjNodeHot.coordXZ[i].y != node->Coord.z))
+	{
+		stale = true;
+	}
+
+	if (stale)
+	{
+		DoFatalAlert("VerifyObjNodeHotEntry: stale entry for genre %d group %d type %d slot %d",
+					node->Genre, node->Group, node->Type, node->Slot);
+	}
+}
+#endif
+
+
+/********************** GROW OBJNODE HOT TABLE ***************************/
+
+static void GrowObjNodeHotTable(void)
+{
+	ObjNodeHotTable	old = gObjNodeHot;
+	int				n = old.count;
+	int				capacity = old.capacity ? old.capacity * 2 : OBJHOT_INITIAL_CAPACITY;
+
+	gObjNodeHot.capacity		= capacity;
+	gObjNodeHot.node			= (ObjNode **)		 AllocPtrTagged(sizeof(ObjNode*) * capacity, kMemTag_ObjNodes);
+	gObjNodeHot.localToWorld	= (OGLMatrix4x4 *)	 AllocPtrTagged(sizeof(OGLMatrix4x4) * capacity, kMemTag_ObjNodes);
+	gObjNodeHot.bBox			= (OGLBoundingBox *) AllocPtrTagged(sizeof(OGLBoundingBox) * capacity, kMemTag_ObjNodes);
+	gObjNodeHot.coordXZ			= (OGLVector2D *)	 AllocPtrTagged(sizeof(OGLVector2D) * capacity, kMemTag_ObjNodes);
+	gObjNodeHot.isOut			= (Byte *)			 AllocPtrTagged(sizeof(Byte) * capacity, kMemTag_ObjNodes);
+	gObjNodeHot.fadeDist		= (float *)			 AllocPtrTagged(sizeof(float) * capacity, kMemTag_ObjNodes);
+
+	if (old.capacity == 0)
+		return;
+
+	SDL_memcpy(gObjNodeHot.node,			old.node,			sizeof(ObjNode*) * n);
+	SDL_memcpy(gObjNodeHot.localToWorld,	old.localToWorld,	sizeof(OGLMatrix4x4) * n);
+	SDL_memcpy(gObjNodeHot.bBox,			old.bBox,			sizeof(OGLBoundingBox) * n);
+	SDL_memcpy(gObjNodeHot.coordXZ,			old.coordXZ,		sizeof(OGLVector2D) * n);
+	SDL_memcpy(gObjNodeHot.isOut,			old.isOut,			sizeof(Byte) * n);
+	SDL_memcpy(gObjNodeHot.fadeDist,		old.fadeDist,		sizeof(float) * n);
+
+	SafeDisposePtr((Ptr) old.node);
+	SafeDisposePtr((Ptr) old.localToWorld);
+	SafeDisposePtr((Ptr) old.bBox);
+	SafeDisposePtr((Ptr) old.coordXZ);
+	SafeDisposePtr((Ptr) old.isOut);
+	SafeDisposePtr((Ptr) old.fadeDist);
+}
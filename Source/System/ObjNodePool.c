@@ -0,0 +1,173 @@
+/****************************/
+/*     OBJNODE POOL.C       */
+/****************************/
+//
+// Slab allocator for ObjNodes.
+//
+// Bullets, puffs, debris and shadows come and go every frame, so rather
+// than hitting the heap for each one, ObjNodes are carved out of slabs of
+// OBJPOOL_NODES_PER_SLAB nodes and recycled through a free list. Slabs are
+// only allocated as needed, up to OBJPOOL_MAX_SLABS, and are kept for the
+// rest of the run. If the pool is full, we fall back to the heap.
+//
+// Each node carries a generation counter that's bumped when the node is
+// handed out and again when it's freed, so it's odd while the node is live.
+// Code that holds on to an ObjNode* across frames can remember the
+// generation along with the pointer and check it with GetLiveObjNode
+// before using the node, since the node may have been recycled since.
+//
+
+/***************/
+/* EXTERNALS   */
+/***************/
+
+#include "game.h"
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+static void AddObjNodeSlab(void);
+static Boolean IsObjNodeFromPool(const ObjNode* node);
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+#define	OBJPOOL_NODES_PER_SLAB		64
+#define	OBJPOOL_MAX_SLABS			32
+
+
+/*********************/
+/*    VARIABLES      */
+/*********************/
+
+ObjNodePoolStats	gObjNodePoolStats;
+
+static ObjNode*		gObjNodeSlabs[OBJPOOL_MAX_SLABS];
+static int			gNumObjNodeSlabs = 0;
+static ObjNode*		gFirstFreeObjNode = nil;				// linked thru NextNode
+
+
+
+/********************** ALLOC OBJNODE ***************************/
+//
+// Returns a node cleared to 0's, except for its generation.
+//
+
+ObjNode* AllocObjNode(void)
+{
+ObjNode*	node;
+uint32_t	generation;
+
+	if (!gFirstFreeObjNode && gNumObjNodeSlabs < OBJPOOL_MAX_SLABS)
+		AddObjNodeSlab();
+
+	if (gFirstFreeObjNode)
+	{
+		node = gFirstFreeObjNode;
+		gFirstFreeObjNode = node->NextNode;
+
+		GAME_ASSERT_MESSAGE(!(node->PoolGeneration & 1), "AllocObjNode: free list is corrupt");
+		generation = node->PoolGeneration;
+
+		SDL_memset(node, 0, sizeof(ObjNode));
+	}
+	else
+	{
+		node = (ObjNode *)AllocPtrClearTagged(sizeof(ObjNode), kMemTag_ObjNodes);	// pool is full
+		generation = 0;
+		gObjNodePoolStats.numOverflowAllocs++;
+	}
+
+	node->PoolGeneration = generation + 1;					// odd = live
+
+	gObjNodePoolStats.numLive++;
+	gObjNodePoolStats.numAllocs++;
+	if (gObjNodePoolStats.numLive > gObjNodePoolStats.peakLive)
+		gObjNodePoolStats.peakLive = gObjNodePoolStats.numLive;
+
+	return node;
+}
+
+
+/********************** FREE OBJNODE ***************************/
+
+void FreeObjNode(ObjNode* node)
+{
+	GAME_ASSERT_MESSAGE(node->PoolGeneration & 1, "FreeObjNode: node was already freed");
+
+	gObjNodePoolStats.numLive--;
+
+	if (!IsObjNodeFromPool(node))
+	{
+		SafeDisposePtr((Ptr) node);
+		return;
+	}
+
+	node->PoolGeneration++;									// even = free, so stale refs don't match anymore
+	node->NextNode = gFirstFreeObjNode;
+	gFirstFreeObjNode = node;
+}
+
+
+/********************** GET LIVE OBJNODE ***************************/
+//
+// Returns node if it's still the same object that it was when its
+// generation was remembered, otherwise nil.
+//
+// Deleted nodes sit in the delete queue until the end of the frame and
+// are still "live" until then, so callers should also check the CType for
+// INVALID_NODE_FLAG as usual.
+//
+
+ObjNode* GetLiveObjNode(ObjNode* node, uint32_t generation)
+{
+	if (node == nil || node->PoolGeneration != generation)
+	{
+		if (node)
+			gObjNodePoolStats.numStaleRefs++;
+		return nil;
+	}
+
+	return node;
+}
+
+
+/********************** ADD OBJNODE SLAB ***************************/
+
+static void AddObjNodeSlab(void)
+{
+	GAME_ASSERT(gNumObjNodeSlabs < OBJPOOL_MAX_SLABS);
+
+	ObjNode* slab = (ObjNode *)AllocPtrClearTagged(sizeof(ObjNode) * OBJPOOL_NODES_PER_SLAB, kMemTag_ObjNodes);
+
+	gObjNodeSlabs[gNumObjNodeSlabs++] = slab;
+
+	for (int i = OBJPOOL_NODES_PER_SLAB - 1; i >= 0; i--)		// so that they're handed out in address order
+	{
+		slab[i].NextNode = gFirstFreeObjNode;
+		gFirstFreeObjNode = &slab[i];
+	}
+
+	gObjNodePoolStats.numSlabs = gNumObjNodeSlabs;
+	gObjNodePoolStats.capacity = gNumObjNodeSlabs * OBJPOOL_NODES_PER_SLAB;
+}
+
+
+/********************** IS OBJNODE FROM POOL ***************************/
+
+static Boolean IsObjNodeFromPool(const ObjNode* node)
+{
+	for (int i = 0; i < gNumObjNodeSlabs; i++)
+	{
+		const ObjNode* slab = gObjNodeSlabs[i];
+
+		if (node >= slab && node < slab + OBJPOOL_NODES_PER_SLAB)
+			return true;
+	}
+
+	return false;
+}
@@ -16,10 +16,13 @@
 /*    PROTOTYPES            */
 /****************************/
 
-static void FlushObjectDeleteQueue(void);
 static void DrawCollisionBoxes(ObjNode *theNode, Boolean old);
 static void DrawBoundingBoxes(ObjNode *theNode);
 static void DrawBoundingSpheres(ObjNode *theNode);
+static Boolean BeginInterpolatedTransform(ObjNode *theNode, OGLPoint3D realTranslation[2]);
+static void EndInterpolatedTransform(ObjNode *theNode, const OGLPoint3D realTranslation[2]);
+static int FindLastUsedSlotAtOrBelow(int slot);
+static void SetSlotUsed(int slot, Boolean used);
 
 
 /****************************/
@@ -28,6 +31,8 @@ static void DrawBoundingSpheres(ObjNode *theNode);
 
 #define	OBJ_DEL_Q_SIZE	200
 
+#define	MAX_OBJ_SLOTS	8192					// slots must be less than this
+
 
 /**********************/
 /*     VARIABLES      */
@@ -37,6 +42,12 @@ static void DrawBoundingSpheres(ObjNode *theNode);
 ObjNode		*gFirstNodePtr = nil;
 					
 ObjNode		*gCurrentNode,*gMostRecentlyAddedNode,*gNextNode;
+
+											// SLOT INDEX INTO THE OBJECT LIST
+static ObjNode	*gSlotTail[MAX_OBJ_SLOTS];				// last node in the list with each slot, or nil
+static uint32_t	gSlotUsed[MAX_OBJ_SLOTS / 32];			// bit set for each slot that has nodes
+static uint32_t	gSlotUsedSummary[MAX_OBJ_SLOTS / 32 / 32];	// bit set for each gSlotUsed word that's != 0
+static uint32_t	gObjectAttachSeq = 0;
 			
 										
 NewObjectDefinitionType	gNewObjectDefinition;
@@ -73,6 +84,10 @@ void InitObjectManager(void)
 		
 	gFirstNodePtr = nil;									// no node yet
 
+	SDL_zeroa(gSlotTail);
+	SDL_zeroa(gSlotUsed);
+	SDL_zeroa(gSlotUsedSummary);
+
 	gNumObjectNodes = 0;
 }
 
@@ -92,9 +107,9 @@ uint32_t flags = newObjDef->flags;
 
 				/* ALLOCATE NEW NODE(CLEARED TO 0'S) */
 					
-	newNodePtr = (ObjNode *)AllocPtrClear(sizeof(ObjNode));
+	newNodePtr = AllocObjNode();
 	if (newNodePtr == nil)
-		DoFatalAlert("MakeNewObject: Alloc Ptr failed!");
+		DoFatalAlert("MakeNewObject: AllocObjNode failed!");
 
 
 
@@ -102,6 +117,7 @@ uint32_t flags = newObjDef->flags;
 			/* INITIALIZE ALL OF THE FIELDS */
 			
 	slot = newObjDef->slot;
+	GAME_ASSERT_MESSAGE(slot >= 0 && slot < MAX_OBJ_SLOTS, "MakeNewObject: slot out of range");
 
 	newNodePtr->Slot 		= slot;
 	newNodePtr->Type 		= newObjDef->type;
@@ -116,6 +132,7 @@ uint32_t flags = newObjDef->flags;
 	newNodePtr->Genre = newObjDef->genre;
 	newNodePtr->Coord = newNodePtr->InitCoord = newNodePtr->OldCoord = newObjDef->coord;		// save coords
 	newNodePtr->StatusBits = flags;
+	newNodePtr->HotIndex = -1;											// gets one when attached
 
 	for (i = 0; i < MAX_NODE_SPARKLES; i++)								// no sparkles
 		newNodePtr->Sparkles[i] = -1;
@@ -211,8 +228,8 @@ Byte	group,type;
 			/* SET BOUNDING BOX */	
 
 	newObj->BBox = gObjectGroupBBoxList[group][type];	// get this model's local bounding box
-
 	newObj->BoundingSphereRadius = gObjectGroupBSphereList[newObj->Group][newObj->Type] * newObj->Scale.x;
+	UpdateObjNodeHotEntry(newObj);
 	
 	
 	
@@ -252,6 +269,8 @@ float	max,n;
 		max *= theNode->Scale.x;				// scale to object's scale (skeleton's are already scaled)
 			
 	theNode->BoundingSphereRadius = max;
+
+	UpdateRayTreeNode(theNode);
 }
 
 
@@ -263,8 +282,6 @@ float	max,n;
 
 void ResetDisplayGroupObject(ObjNode *theNode)
 {
-int		i;
-
 	DisposeObjectBaseGroup(theNode);									// dispose of old group
 	CreateBaseGroup(theNode);											// create new group object
 
@@ -277,25 +294,12 @@ int		i;
 
 	theNode->BBox = gObjectGroupBBoxList[theNode->Group][theNode->Type];
 	theNode->BoundingSphereRadius = gObjectGroupBSphereList[theNode->Group][theNode->Type] * theNode->Scale.x;
+	UpdateObjNodeHotEntry(theNode);
 
 
 			/* IF HAD WORLD DATA, NUKE IT */
 			
-	for (i = 0; i < MAX_OBJECTS_IN_GROUP; i++)		// delete the arrays since the sizes may have changed with new object
-	{
-		if (theNode->WorldMeshes[i].points)
-		{
-			SafeDisposePtr(theNode->WorldMeshes[i].points);
-			theNode->WorldMeshes[i].points = nil;	
-		}
-		
-		if (theNode->WorldPlaneEQs[i])
-		{
-			SafeDisposePtr(theNode->WorldPlaneEQs[i]);
-			theNode->WorldPlaneEQs[i] = nil;	
-		}			
-	}
-	theNode->HasWorldPoints = false;
+	DisposeObjectWorldData(theNode);				// the meshes may have changed with new object
 }
 
 
@@ -366,6 +370,8 @@ MOMatrixObject			*transObject;
 
 	MO_AttachToGroupStart(theNode->BaseGroup, transObject);						// add to base group		
 	theNode->BaseTransformObject = transObject;									// keep extra LEGAL ref (remember to dispose later)
+
+	UpdateObjNodeHotEntry(theNode);
 }
 
 
@@ -388,6 +394,8 @@ ObjNode		*thisNodePtr;
 	if (gFirstNodePtr == nil)								// see if there are any objects
 		return;
 
+	PROF_BEGIN(kProf_MoveObjects);
+
 	thisNodePtr = gFirstNodePtr;
 	
 	do
@@ -425,6 +433,86 @@ ObjNode		*thisNodePtr;
 			/* FLUSH THE DELETE QUEUE */
 			
 	FlushObjectDeleteQueue();
+
+	PROF_END(kProf_MoveObjects);
+}
+
+
+
+/****************** SAVE OBJECT COORDS FOR INTERPOLATION ********************/
+//
+// Called by NextSimTick before each fixed-timestep sim tick, so that OldCoord
+// is where every object was at the start of the tick, even objects without a
+// MoveCall (attachments, shadows) which get moved along by their parents.
+//
+
+void SaveObjectCoordsForInterpolation(void)
+{
+ObjNode	*theNode;
+
+	for (theNode = gFirstNodePtr; theNode != nil; theNode = theNode->NextNode)
+		theNode->OldCoord = theNode->Coord;
+}
+
+
+/****************** BEGIN INTERPOLATED TRANSFORM ********************/
+//
+// If the frame is drawn between two sim ticks, temporarily slide the object's
+// matrices back toward OldCoord.  Only the translation is interpolated.
+// Returns false if the object doesn't need it.
+//
+
+static Boolean BeginInterpolatedTransform(ObjNode *theNode, OGLPoint3D realTranslation[2])
+{
+OGLMatrix4x4	*m = &theNode->BaseTransformMatrix;
+MOMatrixObject	*mo = theNode->BaseTransformObject;
+float			b = 1.0f - gSimInterpolation;
+float			dx,dy,dz;
+
+	dx = (theNode->OldCoord.x - theNode->Coord.x) * b;
+	dy = (theNode->OldCoord.y - theNode->Coord.y) * b;
+	dz = (theNode->OldCoord.z - theNode->Coord.z) * b;
+
+	if ((dx == 0.0f) && (dy == 0.0f) && (dz == 0.0f))			// didn't move during the last tick
+		return(false);
+
+	realTranslation[0] = (OGLPoint3D) { m->value[M03], m->value[M13], m->value[M23] };
+	m->value[M03] += dx;
+	m->value[M13] += dy;
+	m->value[M23] += dz;
+
+	if (mo)
+	{
+		realTranslation[1] = (OGLPoint3D) { mo->matrix.value[M03], mo->matrix.value[M13], mo->matrix.value[M23] };
+		mo->matrix.value[M03] += dx;
+		mo->matrix.value[M13] += dy;
+		mo->matrix.value[M23] += dz;
+	}
+
+	return(true);
+}
+
+
+/****************** END INTERPOLATED TRANSFORM ********************/
+
+static void EndInterpolatedTransform(ObjNode *theNode, const OGLPoint3D realTranslation[2])
+{
+OGLMatrix4x4	*m = &theNode->BaseTransformMatrix;
+MOMatrixObject	*mo = theNode->BaseTransformObject;
+
+	if (theNode->CType == INVALID_NODE_FLAG)					// custom draw functions shouldn't delete, but just in case
+		return;
+
+	m->value[M03] = realTranslation[0].x;
+	m->value[M13] = realTranslation[0].y;
+	m->value[M23] = realTranslation[0].z;
+
+	if (mo)
+	{
+		mo->matrix.value[M03] = realTranslation[1].x;
+		mo->matrix.value[M13] = realTranslation[1].y;
+		mo->matrix.value[M23] = realTranslation[1].z;
+	}
 }
 
 
@@ -445,12 +533,16 @@ Boolean			clipAlpha= false;
 const Boolean 	isPicking = gIsPicking;
 float			cameraX, cameraZ;
 int				i;
+Boolean			interpolated;
+OGLPoint3D		realTranslation[2];
 
 
 	if (gFirstNodePtr == nil)									// see if there are any objects
 		return;
 
 
+	PROF_BEGIN(kProf_DrawObjects);
+
 				/* FIRST DO OUR CULLING */
 				
 	CullTestAllObjects();
@@ -512,10 +604,7 @@ int				i;
 			{
 				float		dist;
 				
-				dist = CalcQuickDistance(cameraX, cameraZ, theNode->Coord.x, theNode->Coord.z);			// see if in fade zone
-				
-				if (!theNode->BBox.isEmpty)
-					dist += (theNode->BBox.max.x - theNode->BBox.min.x) * .2f;		// adjust dist based on size of object in order to fade big objects closer
+				dist = gObjNodeHot.fadeDist[theNode->HotIndex];			// see if in fade zone (calc'd by CullTestAllObjects)
 				
 				if (dist >= gAutoFadeStartDist)
 				{				
@@ -733,6 +822,8 @@ int				i;
 			/* SUBMIT THE GEOMETRY */
 			/***********************/
 
+		interpolated = (gSimInterpolation < 1.0f) && BeginInterpolatedTransform(theNode, realTranslation);
+
 		gCurrentObjMatrix = &theNode->BaseTransformMatrix;			// get global pointer to our matrix
 
  		if (noLighting || (theNode->Scale.y == 1.0f))				// if scale == 1 or no lighting, then dont need to normalize vectors
@@ -816,6 +907,9 @@ custom_draw:
 			glMatrixMode(GL_MODELVIEW);
 		}
 
+		if (interpolated)
+			EndInterpolatedTransform(theNode, realTranslation);
+
 
 
 			/* NEXT NODE */		
@@ -868,6 +962,8 @@ next:
     gGlobalMaterialFlags &= ~(BG3D_MATERIALFLAG_CLAMP_U|BG3D_MATERIALFLAG_CLAMP_V);	// wrapping ON
 
 	glEnable(GL_NORMALIZE);
+
+	PROF_END(kProf_DrawObjects);
 }
 
 
@@ -915,7 +1011,7 @@ float				left,right,top,bottom,front,back;
 
 			/* DRAW TOP */
 
-		glBegin(GL_LINE_LOOP);
+		OGL_Begin(GL_LINE_LOOP);
 		glColor3f(1,0,0);
 		glVertex3f(left, top, back);
 		glColor3f(1,1,0);
@@ -927,7 +1023,7 @@ float				left,right,top,bottom,front,back;
 
 			/* DRAW BOTTOM */
 
-		glBegin(GL_LINE_LOOP);
+		OGL_Begin(GL_LINE_LOOP);
 		glColor3f(1,0,0);
 		glVertex3f(left, bottom, back);
 		glColor3f(1,1,0);
@@ -940,7 +1036,7 @@ float				left,right,top,bottom,front,back;
 
 			/* DRAW LEFT */
 
-		glBegin(GL_LINE_LOOP);
+		OGL_Begin(GL_LINE_LOOP);
 		glColor3f(1,0,0);
 		glVertex3f(left, top, back);
 		glColor3f(1,0,0);
@@ -953,7 +1049,7 @@ float				left,right,top,bottom,front,back;
 
 			/* DRAW RIGHT */
 
-		glBegin(GL_LINE_LOOP);
+		OGL_Begin(GL_LINE_LOOP);
 		glColor3f(1,0,0);
 		glVertex3f(right, top, back);
 		glVertex3f(right, bottom, back);
@@ -1067,7 +1163,7 @@ int		i;
 
 		/* DRAW TOP */
 
-	glBegin(GL_LINE_LOOP);
+	OGL_Begin(GL_LINE_LOOP);
 	glColor3f(1,0,0);
 	glVertex3f(left, top, back);
 	glColor3f(1,1,0);
@@ -1079,7 +1175,7 @@ int		i;
 
 		/* DRAW BOTTOM */
 
-	glBegin(GL_LINE_LOOP);
+	OGL_Begin(GL_LINE_LOOP);
 	glColor3f(1,0,0);
 	glVertex3f(left, bottom, back);
 	glColor3f(1,1,0);
@@ -1092,7 +1188,7 @@ int		i;
 
 		/* DRAW LEFT */
 
-	glBegin(GL_LINE_LOOP);
+	OGL_Begin(GL_LINE_LOOP);
 	glColor3f(1,0,0);
 	glVertex3f(left, top, back);
 	glColor3f(1,0,0);
@@ -1105,7 +1201,7 @@ int		i;
 
 		/* DRAW RIGHT */
 
-	glBegin(GL_LINE_LOOP);
+	OGL_Begin(GL_LINE_LOOP);
 	glColor3f(1,0,0);
 	glVertex3f(right, top, back);
 	glVertex3f(right, bottom, back);
@@ -1141,15 +1237,15 @@ float	x,y,z,r;
 	else
 		glColor3f(0,0,0);
 
-	glBegin(GL_LINES);
+	OGL_Begin(GL_LINES);
 	glVertex3f(x,y + r,z);	glVertex3f(x,y - r,z);
 	glEnd();
 
-	glBegin(GL_LINES);
+	OGL_Begin(GL_LINES);
 	glVertex3f(x-r,y,z);	glVertex3f(x+r,y,z);
 	glEnd();
 
-	glBegin(GL_LINES);
+	OGL_Begin(GL_LINES);
 	glVertex3f(x,y,z-r);	glVertex3f(x,y,z+r);
 	glEnd();
 	
@@ -1288,6 +1384,9 @@ int		i;
 		case	FONTSTRING_GENRE:
 				for (i = 0; i < theNode->NumStringSprites; i++)
 					MO_DisposeObjectReference(theNode->StringCharacters[i]);	// dispose reference to sprite meta objects
+				SafeDisposePtr((Ptr) theNode->StringCharacters);
+				theNode->StringCharacters = nil;
+				theNode->NumStringSprites = 0;
 				break;			
 	}
 	
@@ -1309,27 +1408,15 @@ int		i;
 	
 	DisposeObjectBaseGroup(theNode);					// dispose BG3D base group
 
-	for (i = 0; i < MAX_OBJECTS_IN_GROUP; i++)			// delete world point arrays
-	{
-		if (theNode->WorldMeshes[i].points)
-		{
-			SafeDisposePtr(theNode->WorldMeshes[i].points);
-			theNode->WorldMeshes[i].points = nil;	
-		}			
-		
-		if (theNode->WorldPlaneEQs[i])
-		{
-			SafeDisposePtr(theNode->WorldPlaneEQs[i]);
-			theNode->WorldPlaneEQs[i] = nil;	
-		}			
-		
-	}
-	theNode->HasWorldPoints = false;
+	DisposeObjectWorldData(theNode);					// delete world transforms
 
 
 			/* REMOVE NODE FROM LINKED LIST */
 
 	DetachObject(theNode, false);
+	RemoveObjNodeHotEntry(theNode);
+	RemoveCollisionGridNode(theNode);
+	RemoveRayTreeNode(theNode);
 
 
 			/* SEE IF MARK AS NOT-IN-USE IN ITEM LIST */
@@ -1376,6 +1463,17 @@ void DetachObject(ObjNode *theNode, Boolean subrecurse)
 	if (theNode == gNextNode)						// if its the next node to be moved, then fix things
 		gNextNode = theNode->NextNode;
 
+	if (gSlotTail[theNode->Slot] == theNode)		// if we're the last of our slot, update the slot index
+	{
+		if (theNode->PrevNode && (theNode->PrevNode->Slot == theNode->Slot))
+			gSlotTail[theNode->Slot] = theNode->PrevNode;
+		else
+		{
+			gSlotTail[theNode->Slot] = nil;
+			SetSlotUsed(theNode->Slot, false);
+		}
+	}
+
 	if (theNode->PrevNode == nil)					// special case 1st node
 	{
 		gFirstNodePtr = theNode->NextNode;	
@@ -1412,10 +1510,16 @@ void DetachObject(ObjNode *theNode, Boolean subrecurse)
 
 
 /****************** ATTACH OBJECT ***************************/
+//
+// The list is sorted by slot, and a node goes after any nodes
+// already in the list with the same slot. Rather than scanning the
+// list for that spot, we look up the last node of the nearest used slot
+// at or below ours in the slot index.
+//
 
 void AttachObject(ObjNode *theNode, Boolean recurse)
 {
-short	slot;
+int		slot,prevSlot;
 
 	if (theNode == nil)
 		return;
@@ -1424,53 +1528,40 @@ short	slot;
 		return;
 
 	slot = theNode->Slot;
+	prevSlot = FindLastUsedSlotAtOrBelow(slot);
 
-	if (gFirstNodePtr == nil)						// special case only entry
-	{
-		gFirstNodePtr = theNode;
-		theNode->PrevNode = nil;
-		theNode->NextNode = nil;
-	}
-	
 			/* INSERT AS FIRST NODE */
-	else
-	if (slot < gFirstNodePtr->Slot)					
+
+	if (prevSlot < 0)
 	{
 		theNode->PrevNode = nil;					// no prev
 		theNode->NextNode = gFirstNodePtr; 			// next pts to old 1st
-		gFirstNodePtr->PrevNode = theNode; 			// old pts to new 1st
+		if (gFirstNodePtr)
+			gFirstNodePtr->PrevNode = theNode; 		// old pts to new 1st
 		gFirstNodePtr = theNode;
 	}
-		/* SCAN FOR INSERTION PLACE */
+
+			/* INSERT AFTER THE LAST NODE OF THAT SLOT */
 	else
 	{
-		ObjNode	 *reNodePtr, *scanNodePtr;
-		
-		reNodePtr = gFirstNodePtr;
-		scanNodePtr = gFirstNodePtr->NextNode;		// start scanning for insertion slot on 2nd node
-			
-		while (scanNodePtr != nil)
-		{
-			if (slot < scanNodePtr->Slot)					// INSERT IN MIDDLE HERE
-			{
-				theNode->NextNode = scanNodePtr;
-				theNode->PrevNode = reNodePtr;
-				reNodePtr->NextNode = theNode;
-				scanNodePtr->PrevNode = theNode;			
-				goto out;
-			}
-			reNodePtr = scanNodePtr;
-			scanNodePtr = scanNodePtr->NextNode;			// try next node
-		} 
-	
-		theNode->NextNode = nil;							// TAG TO END
+		ObjNode	*reNodePtr = gSlotTail[prevSlot];
+
 		theNode->PrevNode = reNodePtr;
-		reNodePtr->NextNode = theNode;		
+		theNode->NextNode = reNodePtr->NextNode;
+		if (reNodePtr->NextNode)
+			reNodePtr->NextNode->PrevNode = theNode;
+		reNodePtr->NextNode = theNode;
 	}
-out:	
-	
+
+	gSlotTail[slot] = theNode;						// we're the new last node of our slot
+	SetSlotUsed(slot, true);
+
 	
 	theNode->StatusBits &= ~STATUS_BIT_DETACHED;	
+	theNode->AttachSeq = ++gObjectAttachSeq;
+
+	if (theNode->HotIndex < 0)								// give it an entry in the cull table
+		AddObjNodeHotEntry(theNode);
 	
 	
 	
@@ -1488,9 +1579,66 @@ out:
 }
 
 
+/***************** FIND LAST USED SLOT AT OR BELOW ****************/
+//
+// Returns the highest slot <= slot that has nodes in the list, or -1.
+//
+
+static int FindLastUsedSlotAtOrBelow(int slot)
+{
+int			w,sw;
+uint32_t	bits;
+
+	w = slot >> 5;
+	bits = gSlotUsed[w] & (0xffffffffu >> (31 - (slot & 31)));		// our word, ignoring slots above ours
+
+	if (!bits)
+	{
+		if (w == 0)
+			return(-1);
+
+		w--;														// look for the nearest non-empty word below ours
+		sw = w >> 5;
+		bits = gSlotUsedSummary[sw] & (0xffffffffu >> (31 - (w & 31)));
+
+		while (!bits)
+		{
+			if (--sw < 0)
+				return(-1);
+			bits = gSlotUsedSummary[sw];
+		}
+
+		w = (sw << 5) + SDL_MostSignificantBitIndex32(bits);
+		bits = gSlotUsed[w];
+	}
+
+	return((w << 5) + SDL_MostSignificantBitIndex32(bits));
+}
+
+
+/***************** SET SLOT USED ****************/
+
+static void SetSlotUsed(int slot, Boolean used)
+{
+int	w = slot >> 5;
+
+	if (used)
+	{
+		gSlotUsed[w] |= 1u << (slot & 31);
+		gSlotUsedSummary[w >> 5] |= 1u << (w & 31);
+	}
+	else
+	{
+		gSlotUsed[w] &= ~(1u << (slot & 31));
+		if (gSlotUsed[w] == 0)
+			gSlotUsedSummary[w >> 5] &= ~(1u << (w & 31));
+	}
+}
+
+
 /***************** FLUSH OBJECT DELETE QUEUE ****************/
 
-static void FlushObjectDeleteQueue(void)
+void FlushObjectDeleteQueue(void)
 {
 long	i,num;
 
@@ -1500,7 +1648,7 @@ long	i,num;
 
 	
 	for (i = 0; i < num; i++)
-		SafeDisposePtr((Ptr)gObjectDeleteQueue[i]);					
+		FreeObjNode(gObjectDeleteQueue[i]);					
 
 	gNumObjsInDeleteQueue = 0;
 }
@@ -1677,8 +1825,7 @@ MOMatrixObject	*mo = theNode->BaseTransformObject;
 		mo->matrix =  theNode->BaseTransformMatrix;
 	}
 
-
-	theNode->HasWorldPoints = false;				// these need to be recalculated now that we've updated the matrix
+	UpdateObjNodeHotEntry(theNode);
 }
 
 
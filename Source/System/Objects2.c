@@ -18,10 +18,11 @@
 
 static void DrawShadow(ObjNode *theNode);
 
-static void MO_CalcWorldPoints_Object(ObjNode *theNode, const MetaObjectPtr object);
-static void MO_CalcWorldPoints_Group(ObjNode *theNode, const MOGroupObject *object);
-static void MO_CalcWorldPoints_Matrix(const MOMatrixObject *matObj);
-static void MO_CalcWorldPoints_VertexArray(ObjNode *theNode, MOVertexArrayData *data);
+static void MO_CalcWorldTransforms_Object(ObjNode *theNode, const MetaObjectPtr object, OGLMatrix4x4 *m);
+static void MO_CalcWorldTransforms_Group(ObjNode *theNode, const MOGroupObject *object, const OGLMatrix4x4 *m);
+static void MO_CalcWorldTransforms_Matrix(ObjNode *theNode, const MOMatrixObject *matObj, OGLMatrix4x4 *m);
+static void MO_CalcWorldTransforms_VertexArray(ObjNode *theNode, MOVertexArrayObject *mo, const OGLMatrix4x4 *m);
+static void CullTestObjNodeHotTable(void);
 
 
 /****************************/
@@ -35,8 +36,6 @@ static void MO_CalcWorldPoints_VertexArray(ObjNode *theNode, MOVertexArrayData *
 /**********************/
 
 
-static	int		gMeshNum;
-
 int		gNumWorldCalcsThisFrame;
 
 
@@ -63,7 +62,7 @@ CollisionBoxType *boxPtr = &theNode->CollisionBoxes[0];
 	boxPtr[i].back 		= theNode->Coord.z + back;
 	boxPtr[i].front 	= theNode->Coord.z + front;
 
-	KeepOldCollisionBoxes(theNode);
+	KeepOldCollisionBoxes(theNode);					// also updates the collision grid & ray tree
 }
 
 
@@ -260,6 +259,9 @@ long	i;
 
 
 	theNode->OldCoord = theNode->Coord;			// remember coord also
+
+	UpdateCollisionGridNode(theNode);
+	UpdateRayTreeNode(theNode);
 }
 
 
@@ -284,6 +286,9 @@ CollisionBoxType *boxPtr;
 		boxPtr->bottom 	= theNode->Coord.y + theNode->BottomOff;
 		boxPtr->back 	= theNode->Coord.z + theNode->BackOff;
 		boxPtr->front 	= theNode->Coord.z + theNode->FrontOff;
+
+		UpdateCollisionGridNode(theNode);
+		UpdateRayTreeNode(theNode);
 	}
 }
 
@@ -310,6 +315,9 @@ CollisionBoxType *boxPtr;
 	boxPtr->front 	= gCoord.z  + theNode->FrontOff;
 	boxPtr->top 	= gCoord.y  + theNode->TopOff;
 	boxPtr->bottom 	= gCoord.y  + theNode->BottomOff;
+
+	UpdateCollisionGridNode(theNode);
+	UpdateRayTreeNode(theNode);
 }
 
 
@@ -583,7 +591,7 @@ int	shadowType = theNode->Kind;
 			/* DRAW THE SHADOW */
 			
 	glDisable(GL_CULL_FACE);	
-	glBegin(GL_QUADS);				
+	OGL_Begin(GL_QUADS);				
 	glTexCoord2f(0,0);	glVertex3f(-20, 0, 20);
 	glTexCoord2f(1,0);	glVertex3f(20, 0, 20);
 	glTexCoord2f(1,1);	glVertex3f(20, 0, -20);
@@ -604,89 +612,61 @@ int	shadowType = theNode->Kind;
 #pragma mark ----- OBJECT CULLING ------
 
 
-/**************** CULL TEST ALL OBJECTS *******************/
-
+/**************** CULL TEST OBJNODE HOT TABLE *******************/
+//
+// Does the frustum test for every entry in gObjNodeHot, and the autofade
+// distance if this level has autofade. This only looks at the packed
+// arrays, so CullTestAllObjects & DrawObjects just look up the results.
+//
 
-void CullTestAllObjects(void)
+static void CullTestObjNodeHotTable(void)
 {
-int			i;
-ObjNode		*theNode;
+int			i,n;
 float		m00,m01,m02,m03;
 float		m10,m11,m12,m13;
 float		m20,m21,m22,m23;
 float		m30,m31,m32,m33;
 float		minX,minY,minZ,maxX,maxY,maxZ;
-OGLBoundingBox		*bBox;
+const OGLBoundingBox	*bBox;
 uint32_t		clipFlags;				// Clip in/out tests for point
 uint32_t		clipCodeAND; //,clipCodeOR;	// Clip test for entire object
+const Boolean	doAutoFade = (gAutoFadeStartDist != 0.0f);
+const float		cameraX = gGameViewInfoPtr->cameraPlacement.cameraLocation.x;
+const float		cameraZ = gGameViewInfoPtr->cameraPlacement.cameraLocation.z;
 
+	for (n = 0; n < gObjNodeHot.count; n++)
+	{
+		bBox = &gObjNodeHot.bBox[n];
 
-	theNode = gFirstNodePtr;														// get & verify 1st node
-	if (theNode == nil)
-		return;
+				/* AUTOFADE DISTANCE */
 
-					/* PROCESS EACH OBJECT */
-					
-	do
-	{
-		if (theNode->StatusBits & STATUS_BIT_ALWAYSCULL)
-			goto try_cull;
-			
-		if (theNode->StatusBits & STATUS_BIT_HIDDEN)			// if hidden then skip
-			goto next;
-		
-		if (theNode->StatusBits & STATUS_BIT_DONTCULL)			// see if dont want to use our culling
-			goto draw_on;
+		if (doAutoFade)
+		{
+			float dist = CalcQuickDistance(cameraX, cameraZ, gObjNodeHot.coordXZ[n].x, gObjNodeHot.coordXZ[n].y);
 
-try_cull:
+			if (!bBox->isEmpty)
+				dist += (bBox->max.x - bBox->min.x) * .2f;		// adjust dist based on size of object in order to fade big objects closer
+
+			gObjNodeHot.fadeDist[n] = dist;
+		}
 
-		bBox = &theNode->BBox;
 		if (bBox->isEmpty)											// skip culling if no bbox
-			goto draw_on;
+		{
+			gObjNodeHot.isOut[n] = false;
+			continue;
+		}
 			
 				/*******************************************************/
 				/* CALCULATE THE LOCAL->FRUSTUM MATRIX FOR THIS OBJECT */
 				/*******************************************************/
 				//
-				// NOTE: 	I load the matrices into registers inside the "if" statements instead
-				// 			of at the end because this tricks CodeWarrior into really pre-loading 
-				//			the registers.  Otherwise, CodeWarrior loads them each pass in the loop
-				//			below.
+				// Skeletons are already oriented, so their entry only has the translation.
 				//
-				
-						/* MATRIX FOR SKELETON OBJECT */
-						
-		if (theNode->Genre == SKELETON_GENRE)			// skeletons are already oriented, just need translation
-		{
-			OGLMatrix4x4	m,m2;
-			OGLMatrix4x4_SetTranslate(&m2, theNode->Coord.x, theNode->Coord.y, theNode->Coord.z);
-			OGLMatrix4x4_Multiply(&m2, &gWorldToFrustumMatrix, &m);
 
-			m00 = m.value[M00];							// load matrix into registers
-			m01 = m.value[M01];
-			m02 = m.value[M02];
-			m03 = m.value[M03];
-			m10 = m.value[M10];
-			m11 = m.value[M11];
-			m12 = m.value[M12];
-			m13 = m.value[M13];
-			m20 = m.value[M20];
-			m21 = m.value[M21];
-			m22 = m.value[M22];
-			m23 = m.value[M23];
-			m30 = m.value[M30];
-			m31 = m.value[M31];
-			m32 = m.value[M32];
-			m33 = m.value[M33];
-		}
-		
-				/* MATRIX FOR NON-SKELETON OBJECT */
-				
-		else											// non-skeletons need full transform
 		{
 			OGLMatrix4x4	m;
-		
-			OGLMatrix4x4_Multiply(&theNode->BaseTransformMatrix, &gWorldToFrustumMatrix, &m);
+
+			OGLMatrix4x4_Multiply(&gObjNodeHot.localToWorld[n], &gWorldToFrustumMatrix, &m);
 
 			m00 = m.value[M00];							// load matrix into registers
 			m01 = m.value[M01];
@@ -778,24 +758,54 @@ try_cull:
 //			clipCodeOR |= clipFlags;		
 		}			
 
-		/****************************/
-		/* SEE IF WAS CULLED OR NOT */
-		/****************************/
-		//
-		//  We have one of 3 cases:
-		//
-		//	1. completely in bounds - no clipping
-		//	2. completely out of bounds - no need to render
-		//	3. some clipping is needed
-		//
-
-	//	if (clipCodeOR == 0)														// check for case #1
-	//	{
-	//		theNode->StatusBits |= STATUS_BIT_NOCLIPTEST;	
-	//	}
+		gObjNodeHot.isOut[n] = (clipCodeAND != 0);
+	}
+}
 
-				
-		if (clipCodeAND)															// check for case #2
+
+/**************** CULL TEST ALL OBJECTS *******************/
+//
+// The frustum tests themselves are done up front over the hot table,
+// this just applies the results according to each object's status bits.
+// Since it visits every object once a frame anyway, it also refits the
+// objects' leaves in the ray tree.
+//
+
+void CullTestAllObjects(void)
+{
+ObjNode		*theNode;
+
+
+	theNode = gFirstNodePtr;														// get & verify 1st node
+	if (theNode == nil)
+		return;
+
+	PROF_BEGIN(kProf_CullTestAllObjects);
+
+	CullTestObjNodeHotTable();
+
+					/* PROCESS EACH OBJECT */
+					
+	do
+	{
+		UpdateRayTreeNode(theNode);								// catch anything that moved without telling the ray tree
+
+		if (theNode->StatusBits & STATUS_BIT_ALWAYSCULL)
+			goto try_cull;
+			
+		if (theNode->StatusBits & STATUS_BIT_HIDDEN)			// if hidden then skip
+			goto next;
+		
+		if (theNode->StatusBits & STATUS_BIT_DONTCULL)			// see if dont want to use our culling
+			goto draw_on;
+
+try_cull:
+
+#if _DEBUG
+		VerifyObjNodeHotEntry(theNode);
+#endif
+
+		if (gObjNodeHot.isOut[theNode->HotIndex])								// completely out of bounds - no need to render
 		{
 			theNode->StatusBits |= STATUS_BIT_ISCULLED;								// set cull bit
 		}
@@ -805,13 +815,14 @@ draw_on:
 			theNode->StatusBits &= ~STATUS_BIT_ISCULLED;							// clear cull bit
 		}
 
-
 	
 				/* NEXT NODE */
 next:			
 		theNode = theNode->NextNode;		// next node
 	}
 	while (theNode != nil);	
+
+	PROF_END(kProf_CullTestAllObjects);
 }
 
 
@@ -880,36 +891,61 @@ float	x,z;
 #pragma mark -
 
 
-/********************* CALC DISPLAY GROUP WORLD POINTS *******************************/
+/********************* GET DISPLAY GROUP WORLD DATA *******************************/
+//
+// Returns where each of the meshes in the object's BaseGroup is in the world,
+// for the picking & line segment tests in Pick.c. The meshes themselves stay
+// in model space.
+//
+// This is kept along with the BaseTransformMatrix that it was worked out for,
+// and is only worked out again once the object has moved. It's all done with
+// our own matrix math rather than the GL matrix stack, so there's no reading
+// matrices back from GL.
+//
 
-void CalcDisplayGroupWorldPoints(ObjNode *theNode)
+const ObjNodeWorldData *GetDisplayGroupWorldData(ObjNode *theNode)
 {
-	glMatrixMode(GL_MODELVIEW);
-	glPushMatrix();
-	glLoadIdentity();
+ObjNodeWorldData	*worldData = theNode->WorldData;
+OGLMatrix4x4		m;
+
+	if (!worldData)
+	{
+		worldData = (ObjNodeWorldData *)AllocPtrClearTagged(sizeof(ObjNodeWorldData), kMemTag_ObjNodes);
+		theNode->WorldData = worldData;
+	}
+	else
+	if (worldData->isValid
+		&& SDL_memcmp(&worldData->baseTransform, &theNode->BaseTransformMatrix, sizeof(OGLMatrix4x4)) == 0)
+	{
+		return worldData;											// hasn't moved
+	}
 
-	gMeshNum = 0;
+	worldData->numMeshes = 0;
+
+	OGLMatrix4x4_SetIdentity(&m);
+	MO_CalcWorldTransforms_Object(theNode, theNode->BaseGroup, &m);
+
+	worldData->baseTransform = theNode->BaseTransformMatrix;
+	worldData->isValid = true;
 
-	MO_CalcWorldPoints_Object(theNode, theNode->BaseGroup);
-	
-	glPopMatrix();
-	
-	theNode->HasWorldPoints = true;
 	gNumWorldCalcsThisFrame++;
+	return worldData;
 }
 
 
-/******************** MO: CALC WORLD POINTS: OBJECT ***********************/
+/******************** MO: CALC WORLD TRANSFORMS: OBJECT ***********************/
+//
+// m is the current matrix, like the GL modelview matrix when the object is drawn.
+//
 
-static void MO_CalcWorldPoints_Object(ObjNode *theNode, const MetaObjectPtr object)
+static void MO_CalcWorldTransforms_Object(ObjNode *theNode, const MetaObjectPtr object, OGLMatrix4x4 *m)
 {
 MetaObjectHeader	*objHead = object;
-MOVertexArrayObject	*vObj;
 
 			/* VERIFY COOKIE */
 
 	if (objHead->cookie != MO_COOKIE)
-		DoFatalAlert("MO_CalcWorldPoints_Object: cookie is invalid!");
+		DoFatalAlert("MO_CalcWorldTransforms_Object: cookie is invalid!");
 
 
 			/* HANDLE TYPE */
@@ -917,31 +953,25 @@ MOVertexArrayObject	*vObj;
 	switch(objHead->type)
 	{
 		case	MO_TYPE_GEOMETRY:
-				vObj = object;
-				MO_CalcWorldPoints_VertexArray(theNode, &vObj->objectData);				
+				MO_CalcWorldTransforms_VertexArray(theNode, object, m);
 				break;
 	
 		case	MO_TYPE_GROUP:
-				MO_CalcWorldPoints_Group(theNode, object);	
+				MO_CalcWorldTransforms_Group(theNode, object, m);	
 				break;
 				
 		case	MO_TYPE_MATRIX:
-				MO_CalcWorldPoints_Matrix(object);
+				MO_CalcWorldTransforms_Matrix(theNode, object, m);
 				break;				
 	}
 }
 
-/******************** MO_CALC WORLD POINTS GROUP *************************/
+/******************** MO_CALC WORLD TRANSFORMS GROUP *************************/
 
-static void MO_CalcWorldPoints_Group(ObjNode *theNode, const MOGroupObject *object)
+static void MO_CalcWorldTransforms_Group(ObjNode *theNode, const MOGroupObject *object, const OGLMatrix4x4 *m)
 {
-int	numChildren,i;
-
-
-		/* PUSH MATRIES WITH OPENGL */
-
-	glMatrixMode(GL_MODELVIEW);
-	glPushMatrix();
+int				numChildren,i;
+OGLMatrix4x4	groupMatrix = *m;						// matrices in the group don't affect anything after it
 
 
 				/***************/
@@ -952,102 +982,57 @@ int	numChildren,i;
 	
 	for (i = 0; i < numChildren; i++)
 	{
-		MO_CalcWorldPoints_Object(theNode, object->objectData.groupContents[i]);
+		MO_CalcWorldTransforms_Object(theNode, object->objectData.groupContents[i], &groupMatrix);
 	}
-
-
-		/* RETREIVE OPENGL MATRICES */
-		
-	glMatrixMode(GL_MODELVIEW);
-	glPopMatrix();
 }
 
 
-/************************ OGL CALC WORLD POINTS MATRIX **************************/
+/************************ OGL CALC WORLD TRANSFORMS MATRIX **************************/
+//
+// The object's own transform comes from its BaseTransformMatrix, which is what
+// the cache is keyed on, in case its BaseTransformObject hasn't caught up yet.
+//
 
-static void MO_CalcWorldPoints_Matrix(const MOMatrixObject *matObj)
+static void MO_CalcWorldTransforms_Matrix(ObjNode *theNode, const MOMatrixObject *matObj, OGLMatrix4x4 *m)
 {
-const OGLMatrix4x4		*m;
+const OGLMatrix4x4		*matrix;
 
-	m = &matObj->matrix;							// point to matrix
+	if (matObj == theNode->BaseTransformObject)
+		matrix = &theNode->BaseTransformMatrix;
+	else
+		matrix = &matObj->matrix;							// point to matrix
 
 				/* MULTIPLY CURRENT MATRIX BY THIS */
 	
-	glMultMatrixf((GLfloat *)m);
+	OGLMatrix4x4_Multiply(matrix, m, m);
 }
 
 
-/******************** MO: CALC WORLD POINTS - VERTEX ARRAY *************************/
+/******************** MO: CALC WORLD TRANSFORMS - VERTEX ARRAY *************************/
 
-static void MO_CalcWorldPoints_VertexArray(ObjNode *theNode, MOVertexArrayData *data)
+static void MO_CalcWorldTransforms_VertexArray(ObjNode *theNode, MOVertexArrayObject *mo, const OGLMatrix4x4 *m)
 {
-int				numPoints,meshNum;
-OGLPoint3D		*worldBuffer;
-OGLMatrix4x4	localToWorld;
-int				t, numTriangles ,i;
-MOTriangleIndecies	*tris;
-
-	numPoints = data->numPoints;									// get # points in this mesh
-	meshNum = gMeshNum;
-	
-	if (meshNum >= MAX_OBJECTS_IN_GROUP)
-		DoFatalAlert("MO_CalcWorldPoints_VertexArray: meshNum >= MAX_OBJECTS_IN_GROUP");
-
-
-			/*  SEE IF NEED TO INIT THIS MESH COPY */
-			
-	if (theNode->WorldMeshes[meshNum].points == nil)
-	{
-		theNode->WorldMeshes[meshNum] = *data;												// copy the entire vertex array data struct
-		theNode->WorldMeshes[meshNum].points = AllocPtr(sizeof(OGLPoint3D) * numPoints);	// assign a new points array, however
-	}
+ObjNodeWorldData	*worldData = theNode->WorldData;
+int					meshNum = worldData->numMeshes;
 
-	worldBuffer = theNode->WorldMeshes[meshNum].points;				// get ptr to the world-space point buffer
-
-
-			/************************************************/	
-			/* TRANSFORM ALL OF THESE POINTS TO WORLD-SPACE */
-			/************************************************/	
-
-				/* GET THE TRANSFORM MATRIX WE'VE BUILT */
-
-	glGetFloatv(GL_MODELVIEW_MATRIX, localToWorld.value);
+	if (meshNum >= MAX_OBJECTS_IN_GROUP)
+		DoFatalAlert("MO_CalcWorldTransforms_VertexArray: meshNum >= MAX_OBJECTS_IN_GROUP");
 
-				/* TRANSFORM EACH POINT INTO THE BUFFER */
-	
-	OGLPoint3D_TransformArray(&data->points[0], &localToWorld,	worldBuffer,  numPoints);
-	
-	
-	
-			/***************************************************/
-			/* CALCULATE THE PLANE EQ FOR ALL OF THE TRIANGLES */
-			/***************************************************/
+	worldData->meshes[meshNum] = mo;
+	worldData->localToWorld[meshNum] = *m;
+	worldData->numMeshes++;
+}
 
-	numTriangles = data->numTriangles;									// get # triangles
-	tris = data->triangles;												// get ptr to triangle array
 
+/******************** DISPOSE OBJECT WORLD DATA *************************/
 
-	if( theNode->WorldPlaneEQs[meshNum] )
-		SafeDisposePtr( theNode->WorldPlaneEQs[meshNum] );
+void DisposeObjectWorldData(ObjNode *theNode)
+{
+	if (!theNode->WorldData)
+		return;
 
-	theNode->WorldPlaneEQs[meshNum] = AllocPtr(sizeof(OGLPlaneEquation) * numTriangles);	// alloc array for plane eq's
-	
-	for (t = 0; t < numTriangles; t++)
-	{
-		OGLPoint3D	pts[3];
-		
-		i = tris[t].vertexIndices[0];													// get the vertex world-coords
-		pts[0] = worldBuffer[i];
-		i = tris[t].vertexIndices[1];
-		pts[1] = worldBuffer[i];
-		i = tris[t].vertexIndices[2];
-		pts[2] = worldBuffer[i];
-
-		OGL_ComputeTrianglePlaneEquation(pts, &theNode->WorldPlaneEQs[meshNum][t]);	// calc plane eq
-	
-	}
-	
-	gMeshNum++;
+	SafeDisposePtr((Ptr) theNode->WorldData);
+	theNode->WorldData = nil;
 }
 
 
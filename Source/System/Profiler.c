@@ -0,0 +1,451 @@
+/****************************/
+/*        PROFILER.C        */
+/****************************/
+//
+// Hierarchical frame profiler.
+//
+// Hot paths are bracketed with PROF_BEGIN/PROF_END. Zones nest, and each
+// distinct call path gets its own node in a tree, so the same zone reached
+// from two different parents is timed separately. The tree persists across
+// frames; only the per-frame counts are reset.
+//
+// F9 toggles an overlay with the last frame's timings, and --trace FILE
+// streams every zone to a Chrome trace_event JSON file that can be opened
+// in chrome://tracing or https://ui.perfetto.dev.
+//
+// Main thread only.
+//
+
+/***************/
+/* EXTERNALS   */
+/***************/
+
+#include "game.h"
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+static void Prof_UpdateActive(void);
+static int Prof_FindOrAddNode(int parent, int zone);
+static void Prof_AddTraceEvent(int zone, Uint64 start, Uint64 end);
+static void Prof_FlushTrace(Uint64 frameStart, Uint64 frameEnd);
+static int Prof_DrawNode(int node, int depth, int y);
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+#define	PROF_MAX_NODES			128
+#define	PROF_MAX_DEPTH			32
+#define	PROF_MAX_TRACE_EVENTS	16384					// per frame
+
+#define	PROF_OVERLAY_X			220
+#define	PROF_OVERLAY_Y			100
+
+static const char* kProfZoneNames[NUM_PROF_ZONES] =
+{
+	[kProf_DrawScene]				= "OGL_DrawScene",
+	[kProf_SwapWindow]				= "SwapWindow",
+	[kProf_MoveObjects]				= "MoveObjects",
+	[kProf_CullTestAllObjects]		= "CullTestAllObjects",
+	[kProf_DrawObjects]				= "DrawObjects",
+	[kProf_DrawTerrain]				= "DrawTerrain",
+	[kProf_BuildTerrainSuperTile]	= "BuildTerrainSuperTile",
+	[kProf_UpdateSkinnedGeometry]	= "UpdateSkinnedGeometry",
+	[kProf_MoveParticleGroups]		= "MoveParticleGroups",
+	[kProf_DrawParticleGroup]		= "DrawParticleGroup",
+	[kProf_CollisionDetect]			= "CollisionDetect",
+	[kProf_OGL_DoRayCollision]		= "OGL_DoRayCollision",
+};
+
+
+/*********************/
+/*    VARIABLES      */
+/*********************/
+
+typedef struct
+{
+	int16_t		zone;
+	int16_t		parent;									// -1 if top level
+	int16_t		firstChild;
+	int16_t		nextSibling;
+
+	Uint64		ticks;									// accumulated this frame
+	uint32_t	calls;
+
+	float		ms;										// last completed frame
+	uint32_t	lastCalls;
+	float		peakMs;									// peak over the current second
+	float		lastPeakMs;								// peak over the previous second
+} ProfNode;
+
+typedef struct
+{
+	int16_t		node;									// -1 if we ran out of nodes
+	int16_t		zone;
+	Uint64		start;
+} ProfStackEntry;
+
+typedef struct
+{
+	int16_t		zone;
+	Uint64		start;
+	Uint64		end;
+} ProfTraceEvent;
+
+Boolean					gProfilerActive = false;		// true while anybody wants the timings (overlay or trace)
+Boolean					gProfilerOverlay = false;
+
+static ProfNode			gProfNodes[PROF_MAX_NODES];
+static int				gNumProfNodes = 0;
+static int16_t			gProfFirstRootNode = -1;
+
+static ProfStackEntry	gProfStack[PROF_MAX_DEPTH];
+static int				gProfStackDepth = 0;
+
+static Uint64			gProfFrameStart = 0;
+static float			gProfFrameMs = 0;
+static Uint64			gProfPeakResetTime = 0;
+
+static SDL_IOStream*	gTraceFile = NULL;
+static Uint64			gTraceStartTicks = 0;
+static uint32_t			gTraceNumFrames = 0;
+static uint32_t			gTraceNumDropped = 0;
+static ProfTraceEvent*	gTraceEvents = NULL;
+static int				gNumTraceEvents = 0;
+
+
+/********************** PROF: BEGIN ZONE ***************************/
+
+void Prof_BeginZone(int zone)
+{
+	int node;
+
+	GAME_ASSERT(zone >= 0 && zone < NUM_PROF_ZONES);
+
+	if (gProfStackDepth >= PROF_MAX_DEPTH)				// too deep, just ignore it (its PROF_END will too)
+		return;
+
+	if (gProfStackDepth == 0)
+		node = Prof_FindOrAddNode(-1, zone);
+	else
+	if (gProfStack[gProfStackDepth - 1].node >= 0)
+		node = Prof_FindOrAddNode(gProfStack[gProfStackDepth - 1].node, zone);
+	else
+		node = -1;										// parent didn't fit in the tree, so neither does this
+
+	ProfStackEntry* entry = &gProfStack[gProfStackDepth++];
+	entry->node		= node;
+	entry->zone		= zone;
+	entry->start	= SDL_GetPerformanceCounter();
+}
+
+
+/********************** PROF: END ZONE ***************************/
+
+void Prof_EndZone(int zone)
+{
+	Uint64 now = SDL_GetPerformanceCounter();
+
+	if (gProfStackDepth == 0)							// zone was opened before the profiler was turned on
+		return;
+
+	ProfStackEntry* entry = &gProfStack[gProfStackDepth - 1];
+
+	if (entry->zone != zone)
+	{
+		if (gProfStackDepth >= PROF_MAX_DEPTH)			// matching begin was ignored
+			return;
+		DoFatalAlert("Prof_EndZone: expected end of %s, got %s", kProfZoneNames[entry->zone], kProfZoneNames[zone]);
+	}
+
+	gProfStackDepth--;
+
+	if (entry->node >= 0)
+	{
+		gProfNodes[entry->node].ticks += now - entry->start;
+		gProfNodes[entry->node].calls++;
+	}
+
+	if (gTraceFile)
+		Prof_AddTraceEvent(zone, entry->start, now);
+}
+
+
+/******************** PROF: FIND OR ADD NODE **********************/
+//
+// Returns the node for this zone under the given parent node (-1 for the top level),
+// or -1 if the tree is full.
+//
+
+static int Prof_FindOrAddNode(int parent, int zone)
+{
+	int16_t* link = (parent < 0) ? &gProfFirstRootNode : &gProfNodes[parent].firstChild;
+	int n;
+
+	for (n = *link; n >= 0; n = gProfNodes[n].nextSibling)
+	{
+		if (gProfNodes[n].zone == zone)
+			return n;
+	}
+
+	if (gNumProfNodes >= PROF_MAX_NODES)
+		return -1;
+
+	n = gNumProfNodes++;
+	SDL_zero(gProfNodes[n]);
+	gProfNodes[n].zone			= zone;
+	gProfNodes[n].parent		= parent;
+	gProfNodes[n].firstChild	= -1;
+
+	gProfNodes[n].nextSibling	= *link;				// prepend to sibling list
+	*link = n;
+
+	return n;
+}
+
+
+/********************** PROF: END FRAME ***************************/
+//
+// Called by OGL_DrawScene right after the buffer swap.
+//
+
+void Prof_EndFrame(void)
+{
+	Uint64 now = SDL_GetPerformanceCounter();
+	double msPerTick = 1000.0 / SDL_GetPerformanceFrequency();
+
+	if (gProfilerActive)
+	{
+				/* SPLIT ZONES THAT SPAN FRAMES */
+
+		for (int i = 0; i < gProfStackDepth; i++)
+		{
+			ProfStackEntry* entry = &gProfStack[i];
+
+			if (entry->node >= 0)
+				gProfNodes[entry->node].ticks += now - entry->start;
+			if (gTraceFile)
+				Prof_AddTraceEvent(entry->zone, entry->start, now);
+
+			entry->start = now;
+		}
+
+				/* LATCH THIS FRAME'S COUNTS */
+
+		Boolean resetPeaks = (now - gProfPeakResetTime) * msPerTick >= 1000.0;
+
+		for (int i = 0; i < gNumProfNodes; i++)
+		{
+			ProfNode* node = &gProfNodes[i];
+
+			node->ms		= (float) (node->ticks * msPerTick);
+			node->lastCalls	= node->calls;
+			node->peakMs	= SDL_max(node->peakMs, node->ms);
+
+			if (resetPeaks)
+			{
+				node->lastPeakMs = node->peakMs;
+				node->peakMs = 0;
+			}
+
+			node->ticks = 0;
+			node->calls = 0;
+		}
+
+		if (resetPeaks)
+			gProfPeakResetTime = now;
+
+		if (gProfFrameStart != 0)
+			gProfFrameMs = (float) ((now - gProfFrameStart) * msPerTick);
+
+		if (gTraceFile && gProfFrameStart != 0)
+			Prof_FlushTrace(gProfFrameStart, now);
+
+		gNumTraceEvents = 0;
+	}
+
+	gProfFrameStart = now;
+
+	Prof_UpdateActive();
+}
+
+
+/********************** PROF: UPDATE ACTIVE ***************************/
+//
+// Only done between frames so that the zones stay balanced.
+//
+
+static void Prof_UpdateActive(void)
+{
+	Boolean active = gProfilerOverlay || (gTraceFile != NULL);
+
+	if (!active)
+		gProfStackDepth = 0;							// the PROF_ENDs of any open zones won't run
+
+	gProfilerActive = active;
+}
+
+
+/********************** PROF: TOGGLE OVERLAY ***************************/
+
+void Prof_ToggleOverlay(void)
+{
+	gProfilerOverlay = !gProfilerOverlay;				// takes effect on the next frame
+}
+
+
+/********************** PROF: DRAW OVERLAY ***************************/
+//
+// Shows last frame's timings next to the F8 debug stats.
+//
+
+void Prof_DrawOverlay(void)
+{
+	char	s[64];
+	int		y = PROF_OVERLAY_Y;
+
+	if (!gProfilerActive)
+		return;
+
+	SDL_snprintf(s, sizeof(s), "frame %.2f ms", gProfFrameMs);
+	OGL_DrawString(s, PROF_OVERLAY_X, y);
+	y += 15;
+
+	OGL_DrawString("ms", PROF_OVERLAY_X + 220, y);
+	OGL_DrawString("calls", PROF_OVERLAY_X + 270, y);
+	OGL_DrawString("peak", PROF_OVERLAY_X + 330, y);
+	y += 15;
+
+	for (int n = gProfFirstRootNode; n >= 0; n = gProfNodes[n].nextSibling)
+		y = Prof_DrawNode(n, 0, y);
+}
+
+
+static int Prof_DrawNode(int n, int depth, int y)
+{
+	const ProfNode* node = &gProfNodes[n];
+	char s[32];
+
+	OGL_DrawString(kProfZoneNames[node->zone], PROF_OVERLAY_X + depth * 10, y);
+
+	SDL_snprintf(s, sizeof(s), "%.2f", node->ms);
+	OGL_DrawString(s, PROF_OVERLAY_X + 220, y);
+
+	OGL_DrawInt(node->lastCalls, PROF_OVERLAY_X + 270, y);
+
+	SDL_snprintf(s, sizeof(s), "%.2f", node->lastPeakMs);
+	OGL_DrawString(s, PROF_OVERLAY_X + 330, y);
+
+	y += 15;
+
+	for (int child = node->firstChild; child >= 0; child = gProfNodes[child].nextSibling)
+		y = Prof_DrawNode(child, depth + 1, y);
+
+	return y;
+}
+
+
+#pragma mark -
+
+/********************** PROF: START TRACE ***************************/
+//
+// Streams every zone of every frame to a Chrome trace_event JSON file
+// until Prof_StopTrace.
+//
+
+Boolean Prof_StartTrace(const char* path)
+{
+	GAME_ASSERT(!gTraceFile);
+
+	gTraceFile = SDL_IOFromFile(path, "w");
+	if (!gTraceFile)
+	{
+		SDL_Log("Profiler: can't create %s: %s", path, SDL_GetError());
+		return false;
+	}
+
+	gTraceEvents = AllocPtrClear(sizeof(ProfTraceEvent) * PROF_MAX_TRACE_EVENTS);
+	gNumTraceEvents = 0;
+	gTraceNumFrames = 0;
+	gTraceNumDropped = 0;
+	gTraceStartTicks = SDL_GetPerformanceCounter();
+
+	SDL_IOprintf(gTraceFile, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	SDL_IOprintf(gTraceFile, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"main\"}}");
+
+	Prof_UpdateActive();
+
+	SDL_Log("Profiler: tracing to %s", path);
+	return true;
+}
+
+
+/********************** PROF: STOP TRACE ***************************/
+
+void Prof_StopTrace(void)
+{
+	if (!gTraceFile)
+		return;
+
+	SDL_IOprintf(gTraceFile, "\n]}\n");
+	SDL_CloseIO(gTraceFile);
+	gTraceFile = NULL;
+
+	SafeDisposePtr(gTraceEvents);
+	gTraceEvents = NULL;
+
+	SDL_Log("Profiler: traced %u frames", gTraceNumFrames);
+	if (gTraceNumDropped)
+		SDL_Log("Profiler: dropped %u events, more than %d in a frame", gTraceNumDropped, PROF_MAX_TRACE_EVENTS);
+
+	Prof_UpdateActive();
+}
+
+
+/********************** PROF: ADD TRACE EVENT ***************************/
+
+static void Prof_AddTraceEvent(int zone, Uint64 start, Uint64 end)
+{
+	if (gNumTraceEvents >= PROF_MAX_TRACE_EVENTS)
+	{
+		gTraceNumDropped++;
+		return;
+	}
+
+	ProfTraceEvent* event = &gTraceEvents[gNumTraceEvents++];
+	event->zone		= zone;
+	event->start	= start;
+	event->end		= end;
+}
+
+
+/********************** PROF: FLUSH TRACE ***************************/
+//
+// Writes out the frame's events as "complete" (ph X) events, in microseconds.
+//
+
+static void Prof_FlushTrace(Uint64 frameStart, Uint64 frameEnd)
+{
+	double usPerTick = 1000000.0 / SDL_GetPerformanceFrequency();
+
+#define	TS(t)	(((t) - gTraceStartTicks) * usPerTick)
+
+	SDL_IOprintf(gTraceFile, ",\n{\"name\":\"Frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%u}}",
+				TS(frameStart), (frameEnd - frameStart) * usPerTick, gGameFrameNum);
+
+	for (int i = 0; i < gNumTraceEvents; i++)
+	{
+		const ProfTraceEvent* event = &gTraceEvents[i];
+
+		SDL_IOprintf(gTraceFile, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+					kProfZoneNames[event->zone], TS(event->start), (event->end - event->start) * usPerTick);
+	}
+
+#undef TS
+
+	gTraceNumFrames++;
+}
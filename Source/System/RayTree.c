@@ -0,0 +1,752 @@
+/****************************/
+/*   	  RAY TREE.C        */
+/****************************/
+//
+// Broadphase for the ray & line segment queries against ObjNodes:
+// OGL_DoRayCollision, OGL_DoLineSegmentCollision, SeeIfLineSegmentHitsAnything
+// and SeeIfLineSegmentHitsWhat.
+//
+// It's a dynamic AABB tree. Each object in the cull table (see ObjNodeHot.c)
+// with a slot below SLOT_OF_DUMB has a leaf whose box holds both its bounding
+// sphere and its 1st collision box, which is what those queries test. The
+// leaf boxes are padded by RAYTREE_MARGIN, so that an object only needs to be
+// re-inserted once it has moved out of its padded box.
+//
+// Leaves are refit by UpdateRayTreeNode, which is called along with
+// UpdateObjNodeHotEntry (whenever the matrix or bbox get set) and
+// UpdateCollisionGridNode (whenever the collision boxes get set), and by
+// CalcObjectRadiusFromBBox. CullTestAllObjects also runs every object thru it
+// once a frame to catch anything that was moved some other way.
+//
+// The candidates are returned in object list order, i.e. by slot and then
+// by the order in which they were attached, so that the callers' "first or
+// closest hit" logic picks the same object as a scan of the object list.
+//
+
+/***************/
+/* EXTERNALS   */
+/***************/
+
+#include "game.h"
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+typedef struct
+{
+	float		lo[3];
+	float		hi[3];
+} RayTreeBox;
+
+static Boolean CalcRayTreeBox(const ObjNode* node, RayTreeBox* box);
+static Boolean IsRayTreeBoxBounded(const RayTreeBox* box);
+static int AllocRayTreeNode(void);
+static void FreeRayTreeNode(int i);
+static void InsertRayTreeLeaf(int leaf);
+static void RemoveRayTreeLeaf(int leaf);
+static int BalanceRayTreeNode(int iA);
+static void CombineRayTreeBoxes(RayTreeBox* out, const RayTreeBox* a, const RayTreeBox* b);
+static float CalcRayTreeBoxArea(const RayTreeBox* box);
+static Boolean DoesRayHitRayTreeBox(const RayTreeBox* box, const float origin[3], const float invDir[3], float maxT);
+static void AddRayTreeCandidate(ObjNode* node, int* n);
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+#define	RAYTREE_MARGIN				25.0f						// padding around the leaf boxes
+#define	RAYTREE_MAX_COORD			1.0e8f						// boxes must be within this to be bounded
+#define	RAYTREE_UNBOUNDED			1.0e30f						// box for objects that aren't, so that every query finds them
+
+#define	RAYTREE_INITIAL_NODES		512
+#define	RAYTREE_MAX_DEPTH			256
+
+
+/*********************/
+/*    VARIABLES      */
+/*********************/
+
+typedef struct
+{
+	RayTreeBox	box;
+	ObjNode*	node;										// leaves only
+	int			parent;										// or next free node (0 = none)
+	int			child1,child2;								// 0 if leaf
+	int			height;										// 0 = leaf, -1 = free
+} RayTreeNode;
+
+RayTreeStats				gRayTreeStats;
+Boolean						gVerifyRayTree = false;			// compare every query against the brute force scan
+Boolean						gRayTreeDisabled = false;		// use the brute force scan instead (for timing it)
+
+static RayTreeNode*			gRayTreeNodes = NULL;			// node 0 is never used, so that 0 can mean "none"
+static int					gNumRayTreeNodes = 0;
+static int					gFirstFreeRayTreeNode = 0;
+static int					gRayTreeRoot = 0;
+static int					gNumRayTreeLeaves = 0;
+
+static ObjNode**			gRayTreeCandidates = NULL;
+static int					gMaxRayTreeCandidates = 0;
+
+
+#pragma mark -
+
+/********************** UPDATE RAY TREE NODE ***************************/
+//
+// Gives the node a leaf if it needs one, or moves its leaf if the node has
+// gotten out of it.
+//
+
+void UpdateRayTreeNode(ObjNode* node)
+{
+RayTreeBox	box;
+Boolean		bounded;
+int			leaf;
+
+	if (node->HotIndex < 0)											// not attached yet, or being deleted
+		return;
+
+	if (node->Slot >= SLOT_OF_DUMB)									// the queries never look at these
+	{
+		RemoveRayTreeNode(node);
+		return;
+	}
+
+	bounded = CalcRayTreeBox(node, &box);
+
+	leaf = node->RayTreeLeaf;
+
+	if (leaf)
+	{
+		const RayTreeBox* fat = &gRayTreeNodes[leaf].box;
+		Boolean wasBounded = fat->lo[0] > -RAYTREE_UNBOUNDED;
+
+		if (!bounded)
+		{
+			if (!wasBounded)
+				return;
+		}
+		else
+		if (wasBounded
+			&& box.lo[0] >= fat->lo[0] && box.hi[0] <= fat->hi[0]
+			&& box.lo[1] >= fat->lo[1] && box.hi[1] <= fat->hi[1]
+			&& box.lo[2] >= fat->lo[2] && box.hi[2] <= fat->hi[2])
+		{
+			return;													// still inside its leaf
+		}
+
+		RemoveRayTreeLeaf(leaf);
+	}
+	else
+	{
+		leaf = AllocRayTreeNode();
+		gRayTreeNodes[leaf].node = node;
+		node->RayTreeLeaf = leaf;
+		gNumRayTreeLeaves++;
+	}
+
+			/* PAD IT & INSERT IT */
+
+	for (int i = 0; i < 3; i++)
+	{
+		if (bounded)
+		{
+			box.lo[i] -= RAYTREE_MARGIN;
+			box.hi[i] += RAYTREE_MARGIN;
+		}
+		else
+		{
+			box.lo[i] = -RAYTREE_UNBOUNDED;
+			box.hi[i] = RAYTREE_UNBOUNDED;
+		}
+	}
+
+	gRayTreeNodes[leaf].box = box;
+	InsertRayTreeLeaf(leaf);
+
+	gRayTreeStats.numReinserts++;
+}
+
+
+/********************** REMOVE RAY TREE NODE ***************************/
+
+void RemoveRayTreeNode(ObjNode* node)
+{
+	int leaf = node->RayTreeLeaf;
+
+	if (!leaf)
+		return;
+
+	GAME_ASSERT(gRayTreeNodes[leaf].node == node);
+
+	RemoveRayTreeLeaf(leaf);
+	FreeRayTreeNode(leaf);
+
+	node->RayTreeLeaf = 0;
+	gNumRayTreeLeaves--;
+}
+
+
+/********************** GET RAY TREE NUM LEAVES ***************************/
+
+int GetRayTreeNumLeaves(void)
+{
+	return gNumRayTreeLeaves;
+}
+
+
+/********************** GATHER RAY TREE CANDIDATES ***************************/
+//
+// Gets every object whose leaf the ray from origin along dir, up to
+// origin + dir * maxT, passes thru, sorted in object list order.
+// For a line segment, dir = p2 - p1 and maxT = 1.
+//
+// Objects that are detached, have any of the statusFilter bits set, or
+// don't have any of the cTypes bits (if cTypes isn't 0) are left out.
+// The callers still do all of their own checks on the candidates.
+//
+
+int GatherRayTreeCandidates(const OGLPoint3D* origin, const OGLVector3D* dir, float maxT,
+							uint32_t cTypes, uint32_t statusFilter, ObjNode*** candidates)
+{
+int		stack[RAYTREE_MAX_DEPTH];
+int		sp = 0;
+int		n = 0;
+float	o[3], d[3], invD[3];
+
+	o[0] = origin->x;	o[1] = origin->y;	o[2] = origin->z;
+	d[0] = dir->x;		d[1] = dir->y;		d[2] = dir->z;
+
+	for (int i = 0; i < 3; i++)
+		invD[i] = (fabsf(d[i]) < 1e-20f) ? 0.0f : 1.0f / d[i];		// 0 = parallel to that axis
+
+	statusFilter |= STATUS_BIT_DETACHED;							// not in the object list, so a scan wouldn't see it
+
+	gRayTreeStats.numQueries++;
+
+	if (gRayTreeRoot)
+		stack[sp++] = gRayTreeRoot;
+
+	while (sp > 0)
+	{
+		const RayTreeNode* treeNode = &gRayTreeNodes[stack[--sp]];
+
+		gRayTreeStats.numNodesVisited++;
+
+		if (!DoesRayHitRayTreeBox(&treeNode->box, o, invD, maxT))
+			continue;
+
+		if (treeNode->height == 0)									// leaf
+		{
+			ObjNode* node = treeNode->node;
+
+			if (node->StatusBits & statusFilter)
+				continue;
+
+			if (cTypes && !(node->CType & cTypes))
+				continue;
+
+			AddRayTreeCandidate(node, &n);
+		}
+		else
+		{
+			GAME_ASSERT(sp + 2 <= RAYTREE_MAX_DEPTH);
+			stack[sp++] = treeNode->child1;
+			stack[sp++] = treeNode->child2;
+		}
+	}
+
+			/* SORT IN OBJECT LIST ORDER */
+
+	for (int i = 1; i < n; i++)
+	{
+		ObjNode* node = gRayTreeCandidates[i];
+		int j = i - 1;
+
+		while (j >= 0 && IsCollisionGridCandidateBefore(node, gRayTreeCandidates[j]))
+		{
+			gRayTreeCandidates[j + 1] = gRayTreeCandidates[j];
+			j--;
+		}
+		gRayTreeCandidates[j + 1] = node;
+	}
+
+	gRayTreeStats.numCandidates += n;
+
+	*candidates = gRayTreeCandidates;
+	return n;
+}
+
+
+#pragma mark -
+
+/********************** CALC RAY TREE BOX ***************************/
+//
+// Bounds the node's bounding sphere & its 1st collision box.
+// Returns false if that isn't finite.
+//
+
+static Boolean CalcRayTreeBox(const ObjNode* node, RayTreeBox* box)
+{
+	float r = fabsf(node->BoundingSphereRadius);
+
+	box->lo[0] = node->Coord.x - r;		box->hi[0] = node->Coord.x + r;
+	box->lo[1] = node->Coord.y - r;		box->hi[1] = node->Coord.y + r;
+	box->lo[2] = node->Coord.z - r;		box->hi[2] = node->Coord.z + r;
+
+	if (!IsRayTreeBoxBounded(box))
+		return false;
+
+	if (node->NumCollisionBoxes > 0)
+	{
+		const CollisionBoxType* c = &node->CollisionBoxes[0];
+		RayTreeBox cb;
+
+		cb.lo[0] = GAME_MIN(c->left, c->right);		cb.hi[0] = GAME_MAX(c->left, c->right);
+		cb.lo[1] = GAME_MIN(c->bottom, c->top);		cb.hi[1] = GAME_MAX(c->bottom, c->top);
+		cb.lo[2] = GAME_MIN(c->back, c->front);		cb.hi[2] = GAME_MAX(c->back, c->front);
+
+		if (!IsRayTreeBoxBounded(&cb))
+			return false;
+
+		CombineRayTreeBoxes(box, box, &cb);
+	}
+
+	return true;
+}
+
+
+/********************** IS RAY TREE BOX BOUNDED ***************************/
+//
+// Checked before combining boxes, since GAME_MIN/GAME_MAX would lose NaN's.
+//
+
+static Boolean IsRayTreeBoxBounded(const RayTreeBox* box)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		if (!(box->lo[i] > -RAYTREE_MAX_COORD && box->hi[i] < RAYTREE_MAX_COORD))
+			return false;
+	}
+
+	return true;
+}
+
+
+/********************** ALLOC RAY TREE NODE ***************************/
+
+static int AllocRayTreeNode(void)
+{
+	if (!gFirstFreeRayTreeNode)
+	{
+		int oldNum = gNumRayTreeNodes;
+		int newNum = oldNum ? oldNum * 2 : RAYTREE_INITIAL_NODES;
+
+		RayTreeNode* nodes = (RayTreeNode*) AllocPtrClearTagged(sizeof(RayTreeNode) * newNum, kMemTag_ObjNodes);
+
+		if (gRayTreeNodes)
+		{
+			SDL_memcpy(nodes, gRayTreeNodes, sizeof(RayTreeNode) * oldNum);
+			SafeDisposePtr((Ptr) gRayTreeNodes);
+		}
+
+		gRayTreeNodes = nodes;
+		gNumRayTreeNodes = newNum;
+
+		for (int i = newNum - 1; i >= GAME_MAX(oldNum, 1); i--)
+			FreeRayTreeNode(i);
+	}
+
+	int i = gFirstFreeRayTreeNode;
+	RayTreeNode* treeNode = &gRayTreeNodes[i];
+
+	gFirstFreeRayTreeNode = treeNode->parent;
+
+	SDL_zerop(treeNode);
+	return i;
+}
+
+
+/********************** FREE RAY TREE NODE ***************************/
+
+static void FreeRayTreeNode(int i)
+{
+	RayTreeNode* treeNode = &gRayTreeNodes[i];
+
+	treeNode->node = NULL;
+	treeNode->height = -1;
+	treeNode->parent = gFirstFreeRayTreeNode;
+	gFirstFreeRayTreeNode = i;
+}
+
+
+/********************** INSERT RAY TREE LEAF ***************************/
+//
+// Walks down to the cheapest sibling by surface area, pairs the leaf up with it,
+// then refits & rebalances on the way back up.
+//
+
+static void InsertRayTreeLeaf(int leaf)
+{
+RayTreeNode*	nodes = gRayTreeNodes;
+RayTreeBox		combined;
+
+	if (!gRayTreeRoot)
+	{
+		gRayTreeRoot = leaf;
+		nodes[leaf].parent = 0;
+		return;
+	}
+
+			/* FIND THE BEST SIBLING */
+
+	const RayTreeBox* leafBox = &nodes[leaf].box;
+	int index = gRayTreeRoot;
+
+	while (nodes[index].height > 0)
+	{
+		int child1 = nodes[index].child1;
+		int child2 = nodes[index].child2;
+
+		float area = CalcRayTreeBoxArea(&nodes[index].box);
+
+		CombineRayTreeBoxes(&combined, &nodes[index].box, leafBox);
+		float combinedArea = CalcRayTreeBoxArea(&combined);
+
+		float cost = 2.0f * combinedArea;							// cost of making a new parent for this node & the leaf
+		float inheritanceCost = 2.0f * (combinedArea - area);		// minimum cost of pushing the leaf further down
+
+		float childCost[2];
+		int children[2] = { child1, child2 };
+
+		for (int c = 0; c < 2; c++)
+		{
+			const RayTreeNode* child = &nodes[children[c]];
+
+			CombineRayTreeBoxes(&combined, &child->box, leafBox);
+
+			if (child->height == 0)
+				childCost[c] = CalcRayTreeBoxArea(&combined) + inheritanceCost;
+			else
+				childCost[c] = CalcRayTreeBoxArea(&combined) - CalcRayTreeBoxArea(&child->box) + inheritanceCost;
+		}
+
+		if (cost < childCost[0] && cost < childCost[1])
+			break;
+
+		index = (childCost[0] < childCost[1]) ? child1 : child2;
+	}
+
+	int sibling = index;
+
+			/* MAKE A NEW PARENT FOR THE SIBLING & THE LEAF */
+
+	int oldParent = nodes[sibling].parent;
+	int newParent = AllocRayTreeNode();
+	nodes = gRayTreeNodes;											// may have moved
+
+	nodes[newParent].parent = oldParent;
+	CombineRayTreeBoxes(&nodes[newParent].box, &nodes[leaf].box, &nodes[sibling].box);
+	nodes[newParent].height = nodes[sibling].height + 1;
+	nodes[newParent].child1 = sibling;
+	nodes[newParent].child2 = leaf;
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+
+	if (oldParent)
+	{
+		if (nodes[oldParent].child1 == sibling)
+			nodes[oldParent].child1 = newParent;
+		else
+			nodes[oldParent].child2 = newParent;
+	}
+	else
+		gRayTreeRoot = newParent;
+
+			/* REFIT THE ANCESTORS */
+
+	index = nodes[leaf].parent;
+	while (index)
+	{
+		index = BalanceRayTreeNode(index);
+
+		int child1 = nodes[index].child1;
+		int child2 = nodes[index].child2;
+
+		nodes[index].height = 1 + GAME_MAX(nodes[child1].height, nodes[child2].height);
+		CombineRayTreeBoxes(&nodes[index].box, &nodes[child1].box, &nodes[child2].box);
+
+		index = nodes[index].parent;
+	}
+}
+
+
+/********************** REMOVE RAY TREE LEAF ***************************/
+//
+// Unlinks the leaf from the tree, but leaves it allocated.
+//
+
+static void RemoveRayTreeLeaf(int leaf)
+{
+RayTreeNode*	nodes = gRayTreeNodes;
+
+	if (leaf == gRayTreeRoot)
+	{
+		gRayTreeRoot = 0;
+		return;
+	}
+
+	int parent = nodes[leaf].parent;
+	int grandParent = nodes[parent].parent;
+	int sibling = (nodes[parent].child1 == leaf) ? nodes[parent].child2 : nodes[parent].child1;
+
+	if (!grandParent)
+	{
+		gRayTreeRoot = sibling;
+		nodes[sibling].parent = 0;
+		FreeRayTreeNode(parent);
+		return;
+	}
+
+			/* PUT THE SIBLING WHERE THE PARENT WAS */
+
+	if (nodes[grandParent].child1 == parent)
+		nodes[grandParent].child1 = sibling;
+	else
+		nodes[grandParent].child2 = sibling;
+
+	nodes[sibling].parent = grandParent;
+	FreeRayTreeNode(parent);
+
+			/* REFIT THE ANCESTORS */
+
+	int index = grandParent;
+	while (index)
+	{
+		index = BalanceRayTreeNode(index);
+
+		int child1 = nodes[index].child1;
+		int child2 = nodes[index].child2;
+
+		CombineRayTreeBoxes(&nodes[index].box, &nodes[child1].box, &nodes[child2].box);
+		nodes[index].height = 1 + GAME_MAX(nodes[child1].height, nodes[child2].height);
+
+		index = nodes[index].parent;
+	}
+}
+
+
+/********************** BALANCE RAY TREE NODE ***************************/
+//
+// If one of A's subtrees is more than 1 level taller than the other, rotates
+// that subtree's root up into A's place. Returns the index of whichever node
+// is in A's place now.
+//
+
+static int BalanceRayTreeNode(int iA)
+{
+RayTreeNode*	nodes = gRayTreeNodes;
+RayTreeNode*	A = &nodes[iA];
+
+	if (A->height < 2)
+		return iA;
+
+	int iB = A->child1;
+	int iC = A->child2;
+	RayTreeNode* B = &nodes[iB];
+	RayTreeNode* C = &nodes[iC];
+
+	int balance = C->height - B->height;
+
+			/* ROTATE C UP */
+
+	if (balance > 1)
+	{
+		int iF = C->child1;
+		int iG = C->child2;
+		RayTreeNode* F = &nodes[iF];
+		RayTreeNode* G = &nodes[iG];
+
+		C->child1 = iA;
+		C->parent = A->parent;
+		A->parent = iC;
+
+		if (C->parent)
+		{
+			if (nodes[C->parent].child1 == iA)
+				nodes[C->parent].child1 = iC;
+			else
+				nodes[C->parent].child2 = iC;
+		}
+		else
+			gRayTreeRoot = iC;
+
+		if (F->height > G->height)
+		{
+			C->child2 = iF;
+			A->child2 = iG;
+			G->parent = iA;
+			CombineRayTreeBoxes(&A->box, &B->box, &G->box);
+			CombineRayTreeBoxes(&C->box, &A->box, &F->box);
+			A->height = 1 + GAME_MAX(B->height, G->height);
+			C->height = 1 + GAME_MAX(A->height, F->height);
+		}
+		else
+		{
+			C->child2 = iG;
+			A->child2 = iF;
+			F->parent = iA;
+			CombineRayTreeBoxes(&A->box, &B->box, &F->box);
+			CombineRayTreeBoxes(&C->box, &A->box, &G->box);
+			A->height = 1 + GAME_MAX(B->height, F->height);
+			C->height = 1 + GAME_MAX(A->height, G->height);
+		}
+
+		return iC;
+	}
+
+			/* ROTATE B UP */
+
+	if (balance < -1)
+	{
+		int iD = B->child1;
+		int iE = B->child2;
+		RayTreeNode* D = &nodes[iD];
+		RayTreeNode* E = &nodes[iE];
+
+		B->child1 = iA;
+		B->parent = A->parent;
+		A->parent = iB;
+
+		if (B->parent)
+		{
+			if (nodes[B->parent].child1 == iA)
+				nodes[B->parent].child1 = iB;
+			else
+				nodes[B->parent].child2 = iB;
+		}
+		else
+			gRayTreeRoot = iB;
+
+		if (D->height > E->height)
+		{
+			B->child2 = iD;
+			A->child1 = iE;
+			E->parent = iA;
+			CombineRayTreeBoxes(&A->box, &C->box, &E->box);
+			CombineRayTreeBoxes(&B->box, &A->box, &D->box);
+			A->height = 1 + GAME_MAX(C->height, E->height);
+			B->height = 1 + GAME_MAX(A->height, D->height);
+		}
+		else
+		{
+			B->child2 = iE;
+			A->child1 = iD;
+			D->parent = iA;
+			CombineRayTreeBoxes(&A->box, &C->box, &D->box);
+			CombineRayTreeBoxes(&B->box, &A->box, &E->box);
+			A->height = 1 + GAME_MAX(C->height, D->height);
+			B->height = 1 + GAME_MAX(A->height, E->height);
+		}
+
+		return iB;
+	}
+
+	return iA;
+}
+
+
+/********************** COMBINE RAY TREE BOXES ***************************/
+
+static void CombineRayTreeBoxes(RayTreeBox* out, const RayTreeBox* a, const RayTreeBox* b)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		out->lo[i] = GAME_MIN(a->lo[i], b->lo[i]);
+		out->hi[i] = GAME_MAX(a->hi[i], b->hi[i]);
+	}
+}
+
+
+/********************** CALC RAY TREE BOX AREA ***************************/
+//
+// Half the surface area, which is all that the insertion cost needs.
+//
+
+static float CalcRayTreeBoxArea(const RayTreeBox* box)
+{
+	float dx = box->hi[0] - box->lo[0];
+	float dy = box->hi[1] - box->lo[1];
+	float dz = box->hi[2] - box->lo[2];
+
+	return dx * dy + dy * dz + dz * dx;
+}
+
+
+/********************** DOES RAY HIT RAY TREE BOX ***************************/
+//
+// Slab test. If the ray has NaN's in it, every comparison fails and so this
+// says it's a hit, which is what the sphere tests do too.
+//
+
+static Boolean DoesRayHitRayTreeBox(const RayTreeBox* box, const float origin[3], const float invDir[3], float maxT)
+{
+	float tMin = 0.0f;
+	float tMax = maxT;
+
+	for (int i = 0; i < 3; i++)
+	{
+		if (invDir[i] == 0.0f)										// parallel to this slab
+		{
+			if (origin[i] < box->lo[i] || origin[i] > box->hi[i])
+				return false;
+			continue;
+		}
+
+		float t1 = (box->lo[i] - origin[i]) * invDir[i];
+		float t2 = (box->hi[i] - origin[i]) * invDir[i];
+
+		if (t1 > t2)
+		{
+			float t = t1;
+			t1 = t2;
+			t2 = t;
+		}
+
+		if (t1 > tMin)
+			tMin = t1;
+		if (t2 < tMax)
+			tMax = t2;
+
+		if (tMin > tMax)
+			return false;
+	}
+
+	return true;
+}
+
+
+/********************** ADD RAY TREE CANDIDATE ***************************/
+
+static void AddRayTreeCandidate(ObjNode* node, int* n)
+{
+	if (*n >= gMaxRayTreeCandidates)
+	{
+		int newMax = gMaxRayTreeCandidates ? gMaxRayTreeCandidates * 2 : 64;
+		ObjNode** list = (ObjNode**) AllocPtrTagged(sizeof(ObjNode*) * newMax, kMemTag_ObjNodes);
+
+		if (gRayTreeCandidates)
+		{
+			SDL_memcpy(list, gRayTreeCandidates, sizeof(ObjNode*) * (*n));
+			SafeDisposePtr((Ptr) gRayTreeCandidates);
+		}
+
+		gRayTreeCandidates = list;
+		gMaxRayTreeCandidates = newMax;
+	}
+
+	gRayTreeCandidates[(*n)++] = node;
+}
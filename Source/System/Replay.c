@@ -0,0 +1,368 @@
+/****************************/
+/*         REPLAY.C         */
+/****************************/
+//
+// Records the input of a direct-launched area to a file, and plays it back.
+//
+// The recorder taps Input.c right after the devices are read for a sim tick
+// (see SetInputRecorder), and playback feeds the same snapshots back in as
+// an input override. Along with the RNG seed and each tick's timestep,
+// that's enough to replay the sim exactly, which gives us repeatable runs
+// to profile against.
+//
+// File layout (little-endian):
+//
+//		'BFIR'
+//		u16		version
+//		u16		area
+//		u32		RNG seed
+//		f32		sim tick rate at record time (0 = variable timestep); informational
+//		u32		# of ticks (0 if the recording wasn't closed properly)
+//
+//	followed by one record per tick: a u8 mask of the fields that changed
+//	since the previous tick, then only those fields, in mask bit order.
+//
+
+/***************/
+/* EXTERNALS   */
+/***************/
+
+#include "game.h"
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+static void Replay_RecordProc(const InputSnapshot* snapshot);
+static void Replay_PlaybackProc(InputSnapshot* snapshot);
+static Boolean Replay_WriteFloat(float f);
+static Boolean Replay_ReadFloat(float* f);
+static void Replay_Close(void);
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+#define	REPLAY_MAGIC				"BFIR"
+#define	REPLAY_NUMTICKS_OFFSET		16				// where to patch the tick count when we're done recording
+
+enum
+{
+	REPLAY_MODE_OFF,
+	REPLAY_MODE_RECORD,
+	REPLAY_MODE_PLAYBACK
+};
+
+enum
+{
+	kReplayField_NeedBits		= 1 << 0,
+	kReplayField_NewNeedBits	= 1 << 1,
+	kReplayField_MouseCoord		= 1 << 2,
+	kReplayField_MouseDelta		= 1 << 3,
+	kReplayField_ScrollWheel	= 1 << 4,
+	kReplayField_MouseButtons	= 1 << 5,
+	kReplayField_Analog			= 1 << 6,
+	kReplayField_FPS			= 1 << 7,
+};
+
+
+/*********************/
+/*    VARIABLES      */
+/*********************/
+
+static int				gReplayMode = REPLAY_MODE_OFF;
+static SDL_IOStream*	gReplayFile = NULL;
+static char				gReplayPath[256];
+
+static uint16_t			gReplayArea = 0;
+static uint32_t			gReplaySeed = 0;
+static float			gReplaySimTickRate = 0;
+static uint32_t			gReplayNumTicks = 0;					// from the header when playing back
+
+static uint32_t			gReplayTick = 0;						// # of ticks recorded/played so far
+static Boolean			gReplayEOF = false;
+static InputSnapshot	gReplayPrevSnapshot;					// fields are delta-coded against the previous tick
+
+
+/******************** REPLAY: OPEN FOR RECORDING ***********************/
+//
+// Opens the file now so that a bad path is caught at boot.
+// The header is written by Replay_BeginArea once we know the area.
+//
+
+Boolean Replay_OpenForRecording(const char* path)
+{
+	GAME_ASSERT(gReplayMode == REPLAY_MODE_OFF);
+
+	gReplayFile = SDL_IOFromFile(path, "wb");
+	if (!gReplayFile)
+	{
+		SDL_Log("Replay: can't create %s: %s", path, SDL_GetError());
+		return false;
+	}
+
+	SDL_strlcpy(gReplayPath, path, sizeof(gReplayPath));
+	gReplayMode = REPLAY_MODE_RECORD;
+	return true;
+}
+
+
+/******************** REPLAY: OPEN FOR PLAYBACK ***********************/
+//
+// Reads the header. The caller should then launch the area
+// returned by Replay_GetPlaybackArea.
+//
+
+Boolean Replay_OpenForPlayback(const char* path)
+{
+	char		magic[4];
+	uint16_t	version = 0;
+
+	GAME_ASSERT(gReplayMode == REPLAY_MODE_OFF);
+
+	gReplayFile = SDL_IOFromFile(path, "rb");
+	if (!gReplayFile)
+	{
+		SDL_Log("Replay: can't open %s: %s", path, SDL_GetError());
+		return false;
+	}
+
+	if (sizeof(magic) != SDL_ReadIO(gReplayFile, magic, sizeof(magic))
+		|| 0 != SDL_memcmp(magic, REPLAY_MAGIC, sizeof(magic))
+		|| !SDL_ReadU16LE(gReplayFile, &version)
+		|| version != REPLAY_FILE_VERSION
+		|| !SDL_ReadU16LE(gReplayFile, &gReplayArea)
+		|| !SDL_ReadU32LE(gReplayFile, &gReplaySeed)
+		|| !Replay_ReadFloat(&gReplaySimTickRate)
+		|| !SDL_ReadU32LE(gReplayFile, &gReplayNumTicks))
+	{
+		SDL_Log("Replay: %s isn't a version %d recording", path, REPLAY_FILE_VERSION);
+		SDL_CloseIO(gReplayFile);
+		gReplayFile = NULL;
+		return false;
+	}
+
+	if (gReplayArea > AREA_TARGETPRACTICE2)
+	{
+		SDL_Log("Replay: %s has a bad area %d", path, gReplayArea);
+		SDL_CloseIO(gReplayFile);
+		gReplayFile = NULL;
+		return false;
+	}
+
+	SDL_strlcpy(gReplayPath, path, sizeof(gReplayPath));
+	gReplayMode = REPLAY_MODE_PLAYBACK;
+	return true;
+}
+
+
+/******************** REPLAY: GET PLAYBACK AREA/TICKS ***********************/
+
+int Replay_GetPlaybackArea(void)
+{
+	return gReplayMode == REPLAY_MODE_PLAYBACK ? gReplayArea : -1;
+}
+
+uint32_t Replay_GetPlaybackNumTicks(void)
+{
+	return gReplayMode == REPLAY_MODE_PLAYBACK ? gReplayNumTicks : 0;
+}
+
+
+/*********************** REPLAY: BEGIN AREA ***************************/
+//
+// Call right before PlayArea. Seeds the RNG and hooks up the input.
+// Returns false if there's nothing to record or play back.
+//
+
+Boolean Replay_BeginArea(int area)
+{
+	SDL_zero(gReplayPrevSnapshot);
+	gReplayTick = 0;
+	gReplayEOF = false;
+
+	switch (gReplayMode)
+	{
+		case	REPLAY_MODE_RECORD:
+				gReplayArea = area;
+				gReplaySeed = MyRandomLong();
+				gReplaySimTickRate = gSimTickRate;
+
+				SDL_WriteIO(gReplayFile, REPLAY_MAGIC, 4);
+				SDL_WriteU16LE(gReplayFile, REPLAY_FILE_VERSION);
+				SDL_WriteU16LE(gReplayFile, gReplayArea);
+				SDL_WriteU32LE(gReplayFile, gReplaySeed);
+				Replay_WriteFloat(gReplaySimTickRate);
+				SDL_WriteU32LE(gReplayFile, 0);							// # ticks gets patched in Replay_EndArea
+
+				SetMyRandomSeed(gReplaySeed);
+				SetInputRecorder(Replay_RecordProc);
+
+				SDL_Log("Replay: recording area %d to %s, seed 0x%08x", area, gReplayPath, gReplaySeed);
+				return true;
+
+		case	REPLAY_MODE_PLAYBACK:
+				GAME_ASSERT(area == gReplayArea);
+
+				SetMyRandomSeed(gReplaySeed);
+				SetInputOverride(Replay_PlaybackProc);
+
+				SDL_Log("Replay: playing back %s, area %d, %u ticks, recorded at %s %.0f Hz",
+						gReplayPath, area, gReplayNumTicks,
+						gReplaySimTickRate > 0 ? "fixed" : "variable", gReplaySimTickRate);
+				return true;
+
+		default:
+				return false;
+	}
+}
+
+
+/*********************** REPLAY: END AREA ***************************/
+
+void Replay_EndArea(void)
+{
+	switch (gReplayMode)
+	{
+		case	REPLAY_MODE_RECORD:
+				SetInputRecorder(NULL);
+
+				if (SDL_SeekIO(gReplayFile, REPLAY_NUMTICKS_OFFSET, SDL_IO_SEEK_SET) >= 0)
+					SDL_WriteU32LE(gReplayFile, gReplayTick);
+
+				SDL_Log("Replay: recorded %u ticks (%lld bytes)", gReplayTick, (long long) SDL_GetIOSize(gReplayFile));
+				break;
+
+		case	REPLAY_MODE_PLAYBACK:
+				SetInputOverride(NULL);
+				SDL_Log("Replay: played back %u ticks%s", gReplayTick, gReplayEOF ? "" : " (area ended before the recording did)");
+				break;
+
+		default:
+				return;
+	}
+
+	Replay_Close();
+}
+
+
+static void Replay_Close(void)
+{
+	if (gReplayFile)
+	{
+		SDL_CloseIO(gReplayFile);
+		gReplayFile = NULL;
+	}
+
+	gReplayMode = REPLAY_MODE_OFF;
+}
+
+
+#pragma mark -
+
+/*********************** REPLAY: RECORD PROC ***************************/
+
+static void Replay_RecordProc(const InputSnapshot* snapshot)
+{
+	const InputSnapshot* prev = &gReplayPrevSnapshot;
+	uint8_t mask = 0;
+
+	if (snapshot->needBits != prev->needBits)						mask |= kReplayField_NeedBits;
+	if (snapshot->newNeedBits != prev->newNeedBits)					mask |= kReplayField_NewNeedBits;
+	if (snapshot->mouseCoord.x != prev->mouseCoord.x
+		|| snapshot->mouseCoord.y != prev->mouseCoord.y)			mask |= kReplayField_MouseCoord;
+	if (snapshot->mouseDeltaX != prev->mouseDeltaX
+		|| snapshot->mouseDeltaY != prev->mouseDeltaY)				mask |= kReplayField_MouseDelta;
+	if (snapshot->scrollWheelDelta != prev->scrollWheelDelta)		mask |= kReplayField_ScrollWheel;
+	if (snapshot->mouseButtonBits != prev->mouseButtonBits)			mask |= kReplayField_MouseButtons;
+	if (snapshot->analogSteering.x != prev->analogSteering.x
+		|| snapshot->analogSteering.y != prev->analogSteering.y)	mask |= kReplayField_Analog;
+	if (snapshot->framesPerSecond != prev->framesPerSecond)			mask |= kReplayField_FPS;
+
+	SDL_WriteU8(gReplayFile, mask);
+
+	if (mask & kReplayField_NeedBits)		SDL_WriteU32LE(gReplayFile, snapshot->needBits);
+	if (mask & kReplayField_NewNeedBits)	SDL_WriteU32LE(gReplayFile, snapshot->newNeedBits);
+	if (mask & kReplayField_MouseCoord)		{ Replay_WriteFloat(snapshot->mouseCoord.x); Replay_WriteFloat(snapshot->mouseCoord.y); }
+	if (mask & kReplayField_MouseDelta)		{ Replay_WriteFloat(snapshot->mouseDeltaX); Replay_WriteFloat(snapshot->mouseDeltaY); }
+	if (mask & kReplayField_ScrollWheel)	SDL_WriteS32LE(gReplayFile, snapshot->scrollWheelDelta);
+	if (mask & kReplayField_MouseButtons)	SDL_WriteU32LE(gReplayFile, snapshot->mouseButtonBits);
+	if (mask & kReplayField_Analog)			{ Replay_WriteFloat(snapshot->analogSteering.x); Replay_WriteFloat(snapshot->analogSteering.y); }
+	if (mask & kReplayField_FPS)			Replay_WriteFloat(snapshot->framesPerSecond);
+
+	gReplayPrevSnapshot = *snapshot;
+	gReplayTick++;
+}
+
+
+/*********************** REPLAY: PLAYBACK PROC ***************************/
+//
+// Once the recording runs out, we abort the area.
+//
+
+static void Replay_PlaybackProc(InputSnapshot* snapshot)
+{
+	InputSnapshot*	s = &gReplayPrevSnapshot;
+	uint8_t			mask = 0;
+	Boolean			ok = true;
+
+	if (gReplayEOF)
+		return;
+
+	if ((gReplayNumTicks != 0 && gReplayTick >= gReplayNumTicks)
+		|| !SDL_ReadU8(gReplayFile, &mask))
+	{
+		SDL_Log("Replay: end of recording after %u ticks", gReplayTick);
+		gReplayEOF = true;
+		gGameOver = true;
+		return;
+	}
+
+	if (mask & kReplayField_NeedBits)		ok &= SDL_ReadU32LE(gReplayFile, &s->needBits);
+	if (mask & kReplayField_NewNeedBits)	ok &= SDL_ReadU32LE(gReplayFile, &s->newNeedBits);
+	if (mask & kReplayField_MouseCoord)		ok &= Replay_ReadFloat(&s->mouseCoord.x) && Replay_ReadFloat(&s->mouseCoord.y);
+	if (mask & kReplayField_MouseDelta)		ok &= Replay_ReadFloat(&s->mouseDeltaX) && Replay_ReadFloat(&s->mouseDeltaY);
+	if (mask & kReplayField_ScrollWheel)	ok &= SDL_ReadS32LE(gReplayFile, &s->scrollWheelDelta);
+	if (mask & kReplayField_MouseButtons)	ok &= SDL_ReadU32LE(gReplayFile, &s->mouseButtonBits);
+	if (mask & kReplayField_Analog)			ok &= Replay_ReadFloat(&s->analogSteering.x) && Replay_ReadFloat(&s->analogSteering.y);
+	if (mask & kReplayField_FPS)			ok &= Replay_ReadFloat(&s->framesPerSecond);
+
+	if (!ok)
+	{
+		SDL_Log("Replay: recording is truncated at tick %u", gReplayTick);
+		gReplayEOF = true;
+		gGameOver = true;
+		return;
+	}
+
+	s->exactNeedEdges = true;
+	*snapshot = *s;
+	gReplayTick++;
+}
+
+
+#pragma mark -
+
+/*********************** REPLAY: READ/WRITE FLOAT ***************************/
+//
+// Floats are stored by their bit pattern so that playback is exact.
+//
+
+static Boolean Replay_WriteFloat(float f)
+{
+	uint32_t bits;
+	_Static_assert(sizeof(bits) == sizeof(f), "float isn't 32 bits");
+	SDL_memcpy(&bits, &f, sizeof(bits));
+	return SDL_WriteU32LE(gReplayFile, bits);
+}
+
+static Boolean Replay_ReadFloat(float* f)
+{
+	uint32_t bits;
+	if (!SDL_ReadU32LE(gReplayFile, &bits))
+		return false;
+	SDL_memcpy(f, &bits, sizeof(bits));
+	return true;
+}
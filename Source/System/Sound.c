@@ -203,6 +203,8 @@ int	i;
 
 void LoadSoundBank(void)
 {
+	LoadTime_Begin(kLoad_LoadSoundBank);
+
 	StopAllEffectChannels();
 
 			/* DISPOSE OF EXISTING BANK */
@@ -240,11 +242,15 @@ void LoadSoundBank(void)
 
 		Pomme_DecompressSoundResource(&gSndHandles[i], &gSndOffsets[i]);
 
+		TrackExternalMemory(kMemTag_Sound, GetHandleSize((Handle)gSndHandles[i]));
+
 
 		FSClose(refNum);
 	}
 
 	gNumSndsInBank = NUM_EFFECTS;					// remember how many sounds we've got
+
+	LoadTime_End(kLoad_LoadSoundBank);
 }
 
 
@@ -258,6 +264,7 @@ void DisposeSoundBank()
 			
 	for (int i = 0; i < gNumSndsInBank; i++)
 	{
+		TrackExternalMemory(kMemTag_Sound, -GetHandleSize((Handle)gSndHandles[i]));
 		DisposeHandle((Handle)gSndHandles[i]);
 		gSndHandles[i] = nil;
 	}
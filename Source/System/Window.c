@@ -214,7 +214,7 @@ static void DrawFadePane(ObjNode* theNode)
 	SetColor4f(0, 0, 0, 1.0f - gGammaFadeFrac);// (GLfloat*)&theNode->ColorFilter);
 	glEnable(GL_BLEND);
 
-	glBegin(GL_QUADS);
+	OGL_Begin(GL_QUADS);
 	glVertex3f(-1000, -1000, 0);
 	glVertex3f( 1000, -1000, 0);
 	glVertex3f( 1000,  1000, 0);
@@ -16,6 +16,19 @@ static void DrawFences(ObjNode *theNode);
 static void SubmitFence(int f, const float camX, float camZ);
 static void MakeFenceGeometry(void);
 static void DrawFenceNormals(short f);
+static void BuildFenceGrid(void);
+static void DisposeFenceGrid(void);
+static void GetFenceGridCells(float minX, float minZ, float maxX, float maxZ, int cells[4]);
+static void StartFenceGridQuery(void);
+static Boolean IsFenceNearMotion(long f, double oldX, double oldZ, double newX, double newZ, float r2);
+static Boolean DoesSectionHitSphere(long f, long i, double radius);
+static Boolean DoFenceCollision_Scan(ObjNode *theNode);
+static int DoFenceCollision_Grid(ObjNode *theNode);
+static Boolean DoFenceCollision_Verify(ObjNode *theNode);
+static Boolean LineSegmentHitsFence_Scan(float fromX, float fromZ, float toX, float toZ, long *hitFence, float *ix, float *iz);
+static int LineSegmentHitsFence_Grid(float fromX, float fromZ, float toX, float toZ, long *hitFence, float *ix, float *iz);
+static void LineSegmentHitsFence_GridRow(int cz, int cx0, int cx1, float fromX, float fromZ, float toX, float toZ,
+										int *best, float *ix, float *iz);
 
 
 /****************************/
@@ -28,6 +41,11 @@ static void DrawFenceNormals(short f);
 
 #define	FENCE_SINK_FACTOR	10.0f
 
+#define	FENCE_GRID_CELL_SIZE	512.0f
+#define	FENCE_GRID_MAX_CELLS	(256*256)				// the cells get bigger on maps that would need more than this
+#define	FENCE_GRID_PAD			16.0f					// slop when working out which cells a line segment crosses (see LineSegmentHitsFence_GridRow)
+#define	FENCE_GRID_MAX_COORD	1.0e8f					// queries must be within this to use the grid
+
 enum
 {
 	FENCE_TYPE_WOOD,
@@ -51,6 +69,10 @@ short			gNumFencesDrawn;
 FenceDefType	*gFenceList = nil;
 Boolean			gFenceCollisionDisabled = false;
 
+FenceGridStats	gFenceGridStats;
+Boolean			gFenceGridDisabled = false;			// use the old scans of every fence instead of the grid
+Boolean			gVerifyFenceGrid = false;			// compare every fence query against the old scans
+
 
 static const short			gFenceTexture[NUM_FENCE_TYPES][2] =
 {
@@ -106,6 +128,32 @@ static OGLTextureCoord			gFenceUVs[MAX_FENCES][MAX_NUBS_IN_FENCE*2];
 static OGLColorRGBA_Byte		gFenceColors[MAX_FENCES][MAX_NUBS_IN_FENCE*2];
 
 
+		/* FENCE GRID */
+		//
+		// Every fence section is filed in the x/z cells that its bbox overlaps.
+		// Sections are numbered fence by fence, so that the lowest number is
+		// the one that the old scan would have found first.
+		//
+
+typedef struct
+{
+	short		fence;
+	short		section;
+}FenceGridSection;
+
+static Boolean					gFenceGridBuilt = false;
+static float					gFenceGridMinX, gFenceGridMinZ;
+static float					gFenceGridMaxX, gFenceGridMaxZ;
+static float					gFenceGridCellSize, gFenceGridOneOverCellSize;
+static int						gFenceGridWidth, gFenceGridDepth;
+static int						gFenceGridNumSections;
+static int						*gFenceGridCellStart = nil;			// cell c's sections are gFenceGridCellList[cellStart[c] .. cellStart[c+1]-1]
+static int						*gFenceGridCellList = nil;
+static FenceGridSection			*gFenceGridSections = nil;
+static uint32_t					*gFenceGridSectionStamp = nil;		// so that a section in several cells is only tested once per query
+static uint32_t					gFenceGridQueryStamp = 0;
+
+
 /********************** DISPOSE FENCES *********************/
 
 void DisposeFences(void)
@@ -133,6 +181,8 @@ int		i;
 	SafeDisposePtr((Ptr)gFenceList);
 	gFenceList = nil;
 	gNumFences = 0;
+
+	DisposeFenceGrid();
 }
 
 
@@ -188,7 +238,7 @@ float					sink;
 		
 		/* CALCULATE VECTOR FOR EACH SECTION */
 		
-		fence->sectionVectors = (OGLVector2D *)AllocPtr(sizeof(OGLVector2D) * (numNubs-1));		// alloc array to hold vectors
+		fence->sectionVectors = (OGLVector2D *)AllocPtrTagged(sizeof(OGLVector2D) * (numNubs-1), kMemTag_Terrain);		// alloc array to hold vectors
 		if (fence->sectionVectors == nil)
 			DoFatalAlert("PrimeFences: AllocPtr failed!");
 
@@ -203,7 +253,7 @@ float					sink;
 
 		/* CALCULATE NORMALS FOR EACH SECTION */
 		
-		fence->sectionNormals = (OGLVector2D *)AllocPtr(sizeof(OGLVector2D) * (numNubs-1));		// alloc array to hold vectors
+		fence->sectionNormals = (OGLVector2D *)AllocPtrTagged(sizeof(OGLVector2D) * (numNubs-1), kMemTag_Terrain);		// alloc array to hold vectors
 		if (fence->sectionNormals == nil)
 			DoFatalAlert("PrimeFences: AllocPtr failed!");
 
@@ -227,6 +277,8 @@ float					sink;
 
 	MakeFenceGeometry();			
 
+	BuildFenceGrid();
+
 		/*************************************************************************/
 		/* CREATE DUMMY CUSTOM OBJECT TO CAUSE FENCE DRAWING AT THE DESIRED TIME */
 		/*************************************************************************/
@@ -473,7 +525,7 @@ float			x,y,z,nx,nz;
 	
 	for (i = 0; i < numNubs; i++)
 	{
-		glBegin(GL_LINES);
+		OGL_Begin(GL_LINES);
 
 		x = nubs[i].x;
 		y = nubs[i].y + 200.0f;			// show normal up a ways
@@ -583,19 +635,42 @@ Boolean					overrideAlphaFunc = false;
 //
 // returns True if hit a fence
 //
+// The sections to test come from the fence grid. With gVerifyFenceGrid,
+// we also scan every fence and make sure that we get the same answer.
+//
 
 Boolean DoFenceCollision(ObjNode *theNode)
 {
-long			numFenceSegments;
-OGLPoint3D		*nubs;
-OGLVector2D		*vectors;
-double			radius;
-double			oldX,oldZ,newX,newZ;
-Boolean			hit = false;
+int		hit;
 
 	if (gFenceCollisionDisabled)
 		return false;
 
+	if (gFenceGridDisabled)
+		return(DoFenceCollision_Scan(theNode));
+
+	if (gVerifyFenceGrid)
+		return(DoFenceCollision_Verify(theNode));
+
+	hit = DoFenceCollision_Grid(theNode);
+	if (hit < 0)
+		return(DoFenceCollision_Scan(theNode));
+
+	return(hit);
+}
+
+
+/******************** DO FENCE COLLISION: SCAN **************************/
+//
+// Brute force: tests every section of every fence near the motion.
+//
+
+static Boolean DoFenceCollision_Scan(ObjNode *theNode)
+{
+double			radius;
+double			oldX,oldZ,newX,newZ;
+Boolean			hit = false;
+
 			/* CALC MY MOTION LINE SEGMENT */
 			
 	oldX = theNode->OldCoord.x;						// from old coord
@@ -611,65 +686,22 @@ Boolean			hit = false;
 			
 	for (long f = 0; f < gNumFences; f++)
 	{
-		float	temp;
 		float	r2 = radius + 20.0f;								// tweak a little to be safe
 
 		if ((oldX == newX) && (oldZ == newZ))						// if no movement, then don't check anything
 			break;
 
-
-		/* QUICK CHECK TO SEE IF OLD & NEW COORDS (PLUS RADIUS) ARE OUTSIDE OF FENCE'S BBOX */
-
-		temp = gFenceList[f].bBox.min.x - r2;
-		if ((oldX < temp) && (newX < temp))
+		if (!IsFenceNearMotion(f, oldX, oldZ, newX, newZ, r2))
 			continue;
-		temp = gFenceList[f].bBox.max.x + r2;
-		if ((oldX > temp) && (newX > temp))
-			continue;
-			
-		temp = gFenceList[f].bBox.min.z - r2;
-		if ((oldZ < temp) && (newZ < temp))
-			continue;
-		temp = gFenceList[f].bBox.max.z + r2;
-		if ((oldZ > temp) && (newZ > temp))
-			continue;
-			
-		nubs = gFenceList[f].nubList;				// point to nub list
-		numFenceSegments = gFenceList[f].numNubs-1;	// get # line segments in fence
-		vectors = gFenceList[f].sectionVectors;		// point to segment vector array
 
 
 				/**********************************/
 				/* SCAN EACH SECTION OF THE FENCE */
 				/**********************************/
 
-		for (long i = 0; i < numFenceSegments; i++)
+		for (long i = 0; i < (gFenceList[f].numNubs-1); i++)
 		{
-			OGLPoint3D		p1,p2, sphereCenter, intersectPt;
-			OGLVector3D		segVector;
-			
-					/* GET LINE SEG ENDPOINTS & SPHERE */
-					
-			p1.x = nubs[i].x;
-			p1.y = 0;
-			p1.z = nubs[i].z;
-			
-			p2.x = nubs[i+1].x;
-			p2.y = 0;
-			p2.z = nubs[i+1].z;				
-	
-			segVector.x = vectors[i].x;
-			segVector.z = vectors[i].y;
-			segVector.y = 0;
-	
-			sphereCenter.x = gCoord.x;
-			sphereCenter.z = gCoord.z;
-			sphereCenter.y = 0;
-	
-	
-					/* SEE IF THIS FENCE SEGMENT INTERSECTS THE BOUNDING SPHERE IN THE Y=0 PLANE */
-						
-			if (OGL_DoesLineSegmentIntersectSphere(&p1, &p2, &segVector, &sphereCenter, radius, &intersectPt))
+			if (DoesSectionHitSphere(f, i, radius))
 			{
 				gCoord.x = theNode->OldCoord.x;
 				gCoord.z = theNode->OldCoord.z;
@@ -681,18 +713,199 @@ Boolean			hit = false;
 	return(hit);
 }
 
+
+/******************** DO FENCE COLLISION: GRID **************************/
+//
+// Only the new coord gets tested against the sections, so we only need the
+// sections in the cells around it.
+//
+// Once a section has been hit we're back at the old coord, and testing the
+// rest there can't change anything, so unlike the scan we can stop.
+//
+// Returns -1 if the grid can't help, in which case the caller should scan.
+//
+
+static int DoFenceCollision_Grid(ObjNode *theNode)
+{
+double		radius;
+double		oldX,oldZ,newX,newZ;
+float		r2;
+int			cells[4];
+
+	if (!gFenceGridBuilt)
+		return(-1);
+
+	oldX = theNode->OldCoord.x;
+	oldZ = theNode->OldCoord.z;
+	newX = gCoord.x;
+	newZ = gCoord.z;
+	radius = theNode->BoundingSphereRadius;
+	r2 = radius + 20.0f;
+
+	if ((oldX == newX) && (oldZ == newZ))							// if no movement, then don't check anything
+		return(false);
+
+	if (!(fabs(newX) < FENCE_GRID_MAX_COORD && fabs(newZ) < FENCE_GRID_MAX_COORD		// also catches NaN, which hits everything in the scan
+		&& r2 > 0.0f && r2 < FENCE_GRID_MAX_COORD))
+	{
+		gFenceGridStats.numFallbacks++;
+		return(-1);
+	}
+
+	gFenceGridStats.numQueries++;
+
+	if (newX + r2 < gFenceGridMinX || newX - r2 > gFenceGridMaxX		// nowhere near any fences
+		|| newZ + r2 < gFenceGridMinZ || newZ - r2 > gFenceGridMaxZ)
+	{
+		return(false);
+	}
+
+	GetFenceGridCells(newX - r2, newZ - r2, newX + r2, newZ + r2, cells);
+	StartFenceGridQuery();
+
+	for (int cz = cells[1]; cz <= cells[3]; cz++)
+	{
+		for (int cx = cells[0]; cx <= cells[2]; cx++)
+		{
+			int c = cz * gFenceGridWidth + cx;
+
+			for (int j = gFenceGridCellStart[c]; j < gFenceGridCellStart[c+1]; j++)
+			{
+				int						n = gFenceGridCellList[j];
+				const FenceGridSection	*section = &gFenceGridSections[n];
+
+				if (gFenceGridSectionStamp[n] == gFenceGridQueryStamp)		// already got it from another cell
+					continue;
+				gFenceGridSectionStamp[n] = gFenceGridQueryStamp;
+
+				if (!IsFenceNearMotion(section->fence, oldX, oldZ, newX, newZ, r2))	// same cull as the scan
+					continue;
+
+				gFenceGridStats.numSectionsTested++;
+
+				if (DoesSectionHitSphere(section->fence, section->section, radius))
+				{
+					gCoord.x = theNode->OldCoord.x;
+					gCoord.z = theNode->OldCoord.z;
+					return(true);
+				}
+			}
+		}
+	}
+
+	return(false);
+}
+
+
+/******************** DO FENCE COLLISION: VERIFY **************************/
+
+static Boolean DoFenceCollision_Verify(ObjNode *theNode)
+{
+OGLPoint3D	coord = gCoord;
+OGLPoint3D	scanCoord;
+Boolean		scanHit;
+int			gridHit;
+
+	scanHit = DoFenceCollision_Scan(theNode);
+	scanCoord = gCoord;
+
+	gCoord = coord;												// do it again with the grid
+
+	gridHit = DoFenceCollision_Grid(theNode);
+	if (gridHit < 0)
+	{
+		gCoord = scanCoord;										// use the scan's results
+		return(scanHit);
+	}
+
+	if (gridHit != scanHit || SDL_memcmp(&gCoord, &scanCoord, sizeof(OGLPoint3D)) != 0)
+	{
+		DoFatalAlert("DoFenceCollision: grid says %d (%f, %f), scan says %d (%f, %f)",
+					gridHit, gCoord.x, gCoord.z, scanHit, scanCoord.x, scanCoord.z);
+	}
+
+	gFenceGridStats.numVerified++;
+	return(scanHit);
+}
+
+
+/******************** IS FENCE NEAR MOTION **************************/
+//
+// Quick check to see if old & new coords (plus radius) are outside of fence's bbox
+//
+
+static Boolean IsFenceNearMotion(long f, double oldX, double oldZ, double newX, double newZ, float r2)
+{
+float	temp;
+
+	temp = gFenceList[f].bBox.min.x - r2;
+	if ((oldX < temp) && (newX < temp))
+		return(false);
+	temp = gFenceList[f].bBox.max.x + r2;
+	if ((oldX > temp) && (newX > temp))
+		return(false);
+		
+	temp = gFenceList[f].bBox.min.z - r2;
+	if ((oldZ < temp) && (newZ < temp))
+		return(false);
+	temp = gFenceList[f].bBox.max.z + r2;
+	if ((oldZ > temp) && (newZ > temp))
+		return(false);
+
+	return(true);
+}
+
+
+/******************** DOES SECTION HIT SPHERE **************************/
+//
+// See if this fence section intersects the bounding sphere at gCoord in the y=0 plane.
+//
+
+static Boolean DoesSectionHitSphere(long f, long i, double radius)
+{
+OGLPoint3D		p1,p2, sphereCenter, intersectPt;
+OGLVector3D		segVector;
+const OGLPoint3D	*nubs = gFenceList[f].nubList;				// point to nub list
+const OGLVector2D	*vectors = gFenceList[f].sectionVectors;	// point to segment vector array
+	
+			/* GET LINE SEG ENDPOINTS & SPHERE */
+			
+	p1.x = nubs[i].x;
+	p1.y = 0;
+	p1.z = nubs[i].z;
+	
+	p2.x = nubs[i+1].x;
+	p2.y = 0;
+	p2.z = nubs[i+1].z;				
+
+	segVector.x = vectors[i].x;
+	segVector.z = vectors[i].y;
+	segVector.y = 0;
+
+	sphereCenter.x = gCoord.x;
+	sphereCenter.z = gCoord.z;
+	sphereCenter.y = 0;
+
+	return(OGL_DoesLineSegmentIntersectSphere(&p1, &p2, &segVector, &sphereCenter, radius, &intersectPt));
+}
+
+
+#pragma mark -
+
 /******************** SEE IF LINE SEGMENT HITS FENCE **************************/
 //
 // returns True if hit a fence
 //
+// Finds the same section that the old scan of every fence would have, i.e.
+// the 1st one in fence order, not the nearest one.
+//
 
 Boolean SeeIfLineSegmentHitsFence(const OGLPoint3D *endPoint1, const OGLPoint3D *endPoint2, OGLPoint3D *intersect, Boolean *overTop, float *fenceTopY)
 {
 float			fromX,fromZ,toX,toZ;
-long			f,numFenceSegments,i;
-float			segFromX,segFromZ,segToX,segToZ;
-OGLPoint3D		*nubs;
-Boolean			intersected;
+long			f = -1;
+float			ix = 0, iz = 0;
+int				intersected = -1;
 
 
 	fromX = endPoint1->x;
@@ -700,6 +913,85 @@ Boolean			intersected;
 	toX = endPoint2->x;
 	toZ = endPoint2->z;
 
+	if (!gFenceGridDisabled)
+		intersected = LineSegmentHitsFence_Grid(fromX, fromZ, toX, toZ, &f, &ix, &iz);
+
+	if (gVerifyFenceGrid && intersected >= 0)
+	{
+		long	scanFence = -1;
+		float	scanX = 0, scanZ = 0;
+		Boolean	scanHit = LineSegmentHitsFence_Scan(fromX, fromZ, toX, toZ, &scanFence, &scanX, &scanZ);
+
+		if (scanHit != intersected
+			|| (scanHit && (scanFence != f
+							|| SDL_memcmp(&scanX, &ix, sizeof(float)) != 0
+							|| SDL_memcmp(&scanZ, &iz, sizeof(float)) != 0)))
+		{
+			DoFatalAlert("SeeIfLineSegmentHitsFence: grid says %d (fence %ld at %f, %f), scan says %d (fence %ld at %f, %f)",
+						intersected, f, ix, iz, scanHit, scanFence, scanX, scanZ);
+		}
+
+		gFenceGridStats.numVerified++;
+	}
+
+	if (intersected < 0)
+		intersected = LineSegmentHitsFence_Scan(fromX, fromZ, toX, toZ, &f, &ix, &iz);
+
+	if (!intersected)
+		return(false);
+
+
+			/* SEE IF INTERSECT OCCURS OVER THE TOP OF THE FENCE */
+
+	if (overTop || intersect || fenceTopY)
+	{			
+		float	fenceTop,dy,d1,d2,ratio,iy;
+
+		fenceTop = GetTerrainY(ix, iz) + gFenceHeight[gFenceList[f].type];		// calc y coord @ top of fence here
+		
+		dy = endPoint2->y - endPoint1->y;					// get dy of line segment
+		
+		d1 = CalcDistance(fromX, fromZ, toX, toZ);
+		d2 = CalcDistance(fromX, fromZ, ix, iz);
+		
+		ratio = d2/d1;
+		
+		iy = endPoint1->y + (dy * ratio);					// calc intersect y coord
+		
+		if (overTop)
+		{
+			if (iy >= fenceTop)
+				*overTop = true;
+			else
+				*overTop = false;
+		}
+		
+		if (intersect)
+		{
+			intersect->x = ix;						// pass back intersect coords
+			intersect->y = iy;			
+			intersect->z = iz;		
+		}
+		
+		if (fenceTopY)
+			*fenceTopY = fenceTop;	
+	}
+				
+	return(true);			
+}
+
+
+/******************** LINE SEGMENT HITS FENCE: SCAN **************************/
+//
+// Brute force: tests every section of every fence, and stops at the 1st hit.
+//
+
+static Boolean LineSegmentHitsFence_Scan(float fromX, float fromZ, float toX, float toZ, long *hitFence, float *ix, float *iz)
+{
+long			f,numFenceSegments,i;
+float			segFromX,segFromZ,segToX,segToZ;
+OGLPoint3D		*nubs;
+
 			/****************************************/
 			/* SCAN THRU ALL FENCES FOR A COLLISION */
 			/****************************************/
@@ -741,8 +1033,6 @@ Boolean			intersected;
 			
 		for (i = 0; i < numFenceSegments; i++)
 		{
-			float	ix,iz;
-			
 					/* GET LINE SEG ENDPOINTS */
 					
 			segFromX = nubs[i].x;
@@ -753,58 +1043,339 @@ Boolean			intersected;
 	
 					/* SEE IF THE LINES INTERSECT */
 					
-			intersected = IntersectLineSegments(fromX,  fromZ, toX, toZ,
+			if (IntersectLineSegments(fromX,  fromZ, toX, toZ,
 						                     segFromX, segFromZ, segToX, segToZ,
-				                             &ix, &iz);
+				                             ix, iz))
+			{
+				*hitFence = f;
+				return(true);
+			}
+		}
+	}
 	
-			if (intersected)
+	return(false);
+}
+
+
+/******************** LINE SEGMENT HITS FENCE: GRID **************************/
+//
+// Tests the sections in the cells that the line segment crosses, and keeps
+// the lowest numbered one that it hits.
+//
+// The fence bbox check that the scan does isn't needed here, because
+// IntersectLineSegments does the same check with each section's own bbox,
+// which is inside the fence's.
+//
+// Returns -1 if the grid can't help, in which case the caller should scan.
+//
+
+static int LineSegmentHitsFence_Grid(float fromX, float fromZ, float toX, float toZ, long *hitFence, float *ix, float *iz)
+{
+float		minX = GAME_MIN(fromX, toX), maxX = GAME_MAX(fromX, toX);
+float		minZ = GAME_MIN(fromZ, toZ), maxZ = GAME_MAX(fromZ, toZ);
+int			cells[4];
+int			best = -1;
+
+	if (!gFenceGridBuilt)
+		return(-1);
+
+	if (!(minX > -FENCE_GRID_MAX_COORD && maxX < FENCE_GRID_MAX_COORD		// also catches NaN
+		&& minZ > -FENCE_GRID_MAX_COORD && maxZ < FENCE_GRID_MAX_COORD))
+	{
+		gFenceGridStats.numFallbacks++;
+		return(-1);
+	}
+
+	gFenceGridStats.numQueries++;
+
+	if (maxX < gFenceGridMinX || minX > gFenceGridMaxX					// nowhere near any fences
+		|| maxZ < gFenceGridMinZ || minZ > gFenceGridMaxZ)
+	{
+		return(false);
+	}
+
+	GetFenceGridCells(minX, minZ, maxX, maxZ, cells);
+	StartFenceGridQuery();
+
+	for (int cz = cells[1]; cz <= cells[3]; cz++)
+		LineSegmentHitsFence_GridRow(cz, cells[0], cells[2], fromX, fromZ, toX, toZ, &best, ix, iz);
+
+	if (best < 0)
+		return(false);
+
+	*hitFence = gFenceGridSections[best].fence;
+	return(true);
+}
+
+
+/******************** LINE SEGMENT HITS FENCE: GRID ROW **************************/
+//
+// Tests the sections in the cells of row cz that the line segment crosses.
+//
+// The row is widened a little, so that rounding can't make us miss a cell.
+// IntersectLineSegments also counts some near misses as hits (its side tests
+// are truncated to integers), so the slop needs to cover those too.
+//
+
+static void LineSegmentHitsFence_GridRow(int cz, int cx0, int cx1, float fromX, float fromZ, float toX, float toZ,
+										int *best, float *ix, float *iz)
+{
+float	dz = toZ - fromZ;
+
+			/* FIND WHERE THE SEGMENT IS IN THIS ROW */
+
+	if (dz != 0.0f)
+	{
+		float	rowZ0 = gFenceGridMinZ + cz * gFenceGridCellSize - FENCE_GRID_PAD;
+		float	rowZ1 = rowZ0 + gFenceGridCellSize + 2.0f * FENCE_GRID_PAD;
+		float	t0 = (rowZ0 - fromZ) / dz;
+		float	t1 = (rowZ1 - fromZ) / dz;
+		float	x0, x1;
+		int		rowCells[4];
+
+		t0 = GAME_MIN(GAME_MAX(t0, 0.0f), 1.0f);
+		t1 = GAME_MIN(GAME_MAX(t1, 0.0f), 1.0f);
+
+		x0 = fromX + (toX - fromX) * t0;
+		x1 = fromX + (toX - fromX) * t1;
+
+		GetFenceGridCells(GAME_MIN(x0, x1) - FENCE_GRID_PAD, 0, GAME_MAX(x0, x1) + FENCE_GRID_PAD, 0, rowCells);
+
+		cx0 = GAME_MAX(cx0, rowCells[0]);
+		cx1 = GAME_MIN(cx1, rowCells[2]);
+	}
+
+			/* TEST THE SECTIONS IN THOSE CELLS */
+
+	for (int cx = cx0; cx <= cx1; cx++)
+	{
+		int c = cz * gFenceGridWidth + cx;
+
+		for (int j = gFenceGridCellStart[c]; j < gFenceGridCellStart[c+1]; j++)
+		{
+			int						n = gFenceGridCellList[j];
+			const FenceGridSection	*section;
+			const OGLPoint3D		*nubs;
+			float					x, z;
+
+			if (*best >= 0 && n > *best)									// cells are sorted, so nothing else in this one can beat it
+				break;
+
+			if (gFenceGridSectionStamp[n] == gFenceGridQueryStamp)			// already got it from another cell
+				continue;
+			gFenceGridSectionStamp[n] = gFenceGridQueryStamp;
+
+			gFenceGridStats.numSectionsTested++;
+
+			section = &gFenceGridSections[n];
+			nubs = &gFenceList[section->fence].nubList[section->section];
+
+			if (IntersectLineSegments(fromX, fromZ, toX, toZ,
+									nubs[0].x, nubs[0].z, nubs[1].x, nubs[1].z,
+									&x, &z))
 			{
-				float	fenceTop,dy,d1,d2,ratio,iy;
-				
-				
-						/* SEE IF INTERSECT OCCURS OVER THE TOP OF THE FENCE */
-			
-				if (overTop || intersect || fenceTopY)
-				{			
-					fenceTop = GetTerrainY(ix, iz) + gFenceHeight[gFenceList[f].type];		// calc y coord @ top of fence here
-					
-					dy = endPoint2->y - endPoint1->y;					// get dy of line segment
-					
-					d1 = CalcDistance(fromX, fromZ, toX, toZ);
-					d2 = CalcDistance(fromX, fromZ, ix, iz);
-					
-					ratio = d2/d1;
-					
-					iy = endPoint1->y + (dy * ratio);					// calc intersect y coord
-					
-					if (overTop)
+				*best = n;
+				*ix = x;
+				*iz = z;
+				break;
+			}
+		}
+	}
+}
+
+
+#pragma mark -
+
+/******************** BUILD FENCE GRID **************************/
+//
+// Called from PrimeFences once the nubs are in game coordinates.
+// Fences never move, so the grid never changes after this.
+//
+
+static void BuildFenceGrid(void)
+{
+float	minX = 0, minZ = 0, maxX = 0, maxZ = 0;
+float	cellSize;
+int		n, numCells;
+
+	DisposeFenceGrid();
+
+			/* COUNT THE SECTIONS & FIND THEIR BOUNDS */
+
+	n = 0;
+	for (int f = 0; f < gNumFences; f++)
+	{
+		const OGLPoint3D *nubs = gFenceList[f].nubList;
+
+		for (int i = 0; i < gFenceList[f].numNubs; i++)
+		{
+			if (!(fabsf(nubs[i].x) < FENCE_GRID_MAX_COORD && fabsf(nubs[i].z) < FENCE_GRID_MAX_COORD))
+			{
+				SDL_Log("BuildFenceGrid: fence %d has a bad nub, so it'll be scanned instead", f);
+				return;
+			}
+
+			if (f == 0 && i == 0)
+			{
+				minX = maxX = nubs[i].x;
+				minZ = maxZ = nubs[i].z;
+			}
+			else
+			{
+				minX = GAME_MIN(minX, nubs[i].x);	maxX = GAME_MAX(maxX, nubs[i].x);
+				minZ = GAME_MIN(minZ, nubs[i].z);	maxZ = GAME_MAX(maxZ, nubs[i].z);
+			}
+		}
+
+		n += GAME_MAX(gFenceList[f].numNubs - 1, 0);
+	}
+
+	if (n == 0)
+		return;
+
+	cellSize = FENCE_GRID_CELL_SIZE;
+	while (((maxX - minX) / cellSize + 1) * ((maxZ - minZ) / cellSize + 1) > FENCE_GRID_MAX_CELLS)
+		cellSize *= 2.0f;
+
+	gFenceGridMinX				= minX;
+	gFenceGridMinZ				= minZ;
+	gFenceGridMaxX				= maxX;
+	gFenceGridMaxZ				= maxZ;
+	gFenceGridCellSize			= cellSize;
+	gFenceGridOneOverCellSize	= 1.0f / cellSize;
+	gFenceGridWidth				= (int) ((maxX - minX) * gFenceGridOneOverCellSize) + 1;
+	gFenceGridDepth				= (int) ((maxZ - minZ) * gFenceGridOneOverCellSize) + 1;
+	gFenceGridNumSections		= n;
+	numCells					= gFenceGridWidth * gFenceGridDepth;
+
+	gFenceGridSections		= (FenceGridSection *) AllocPtrTagged(sizeof(FenceGridSection) * n, kMemTag_Terrain);
+	gFenceGridSectionStamp	= (uint32_t *) AllocPtrClearTagged(sizeof(uint32_t) * n, kMemTag_Terrain);
+	gFenceGridCellStart		= (int *) AllocPtrClearTagged(sizeof(int) * (numCells + 1), kMemTag_Terrain);
+	gFenceGridQueryStamp	= 0;
+
+
+			/* COUNT THE SECTIONS IN EACH CELL */
+			//
+			// cellStart[c+1] gets cell c's count, then becomes where cell c+1 starts
+			//
+
+	for (int pass = 0; pass < 2; pass++)
+	{
+		int	*fill = nil;
+
+		if (pass == 1)
+		{
+			for (int c = 0; c < numCells; c++)
+				gFenceGridCellStart[c+1] += gFenceGridCellStart[c];
+
+			gFenceGridCellList = (int *) AllocPtrTagged(sizeof(int) * GAME_MAX(gFenceGridCellStart[numCells], 1), kMemTag_Terrain);
+
+			fill = (int *) AllocPtrTagged(sizeof(int) * numCells, kMemTag_Terrain);
+			SDL_memcpy(fill, gFenceGridCellStart, sizeof(int) * numCells);
+		}
+
+		n = 0;
+		for (int f = 0; f < gNumFences; f++)
+		{
+			const OGLPoint3D *nubs = gFenceList[f].nubList;
+
+			for (int i = 0; i < gFenceList[f].numNubs - 1; i++, n++)
+			{
+				int	cells[4];
+
+				GetFenceGridCells(GAME_MIN(nubs[i].x, nubs[i+1].x), GAME_MIN(nubs[i].z, nubs[i+1].z),
+								GAME_MAX(nubs[i].x, nubs[i+1].x), GAME_MAX(nubs[i].z, nubs[i+1].z),
+								cells);
+
+				gFenceGridSections[n].fence = f;
+				gFenceGridSections[n].section = i;
+
+				for (int cz = cells[1]; cz <= cells[3]; cz++)
+				{
+					for (int cx = cells[0]; cx <= cells[2]; cx++)
 					{
-						if (iy >= fenceTop)
-							*overTop = true;
+						int c = cz * gFenceGridWidth + cx;
+
+						if (pass == 0)
+							gFenceGridCellStart[c+1]++;
 						else
-							*overTop = false;
-					}
-					
-					if (intersect)
-					{
-						intersect->x = ix;						// pass back intersect coords
-						intersect->y = iy;			
-						intersect->z = iz;		
+							gFenceGridCellList[fill[c]++] = n;				// in section order, so each cell's list is sorted
 					}
-					
-					if (fenceTopY)
-						*fenceTopY = fenceTop;	
 				}
-							
-				return(true);			
 			}
-			
 		}
+
+		if (pass == 1)
+			SafeDisposePtr((Ptr) fill);
 	}
-	
-	return(false);
+
+	gFenceGridBuilt = true;
+}
+
+
+/******************** DISPOSE FENCE GRID **************************/
+
+static void DisposeFenceGrid(void)
+{
+	if (gFenceGridCellStart)
+		SafeDisposePtr((Ptr) gFenceGridCellStart);
+	gFenceGridCellStart = nil;
+
+	if (gFenceGridCellList)
+		SafeDisposePtr((Ptr) gFenceGridCellList);
+	gFenceGridCellList = nil;
+
+	if (gFenceGridSections)
+		SafeDisposePtr((Ptr) gFenceGridSections);
+	gFenceGridSections = nil;
+
+	if (gFenceGridSectionStamp)
+		SafeDisposePtr((Ptr) gFenceGridSectionStamp);
+	gFenceGridSectionStamp = nil;
+
+	gFenceGridNumSections = 0;
+	gFenceGridBuilt = false;
+}
+
+
+/******************** GET FENCE GRID CELLS **************************/
+//
+// Gets the range of cells covered by the box: minX, minZ, maxX, maxZ.
+// Anything off the edge of the grid goes in the edge cells.
+//
+
+static void GetFenceGridCells(float minX, float minZ, float maxX, float maxZ, int cells[4])
+{
+	cells[0] = (int) floorf((minX - gFenceGridMinX) * gFenceGridOneOverCellSize);
+	cells[1] = (int) floorf((minZ - gFenceGridMinZ) * gFenceGridOneOverCellSize);
+	cells[2] = (int) floorf((maxX - gFenceGridMinX) * gFenceGridOneOverCellSize);
+	cells[3] = (int) floorf((maxZ - gFenceGridMinZ) * gFenceGridOneOverCellSize);
+
+	cells[0] = GAME_MIN(GAME_MAX(cells[0], 0), gFenceGridWidth - 1);
+	cells[2] = GAME_MIN(GAME_MAX(cells[2], 0), gFenceGridWidth - 1);
+	cells[1] = GAME_MIN(GAME_MAX(cells[1], 0), gFenceGridDepth - 1);
+	cells[3] = GAME_MIN(GAME_MAX(cells[3], 0), gFenceGridDepth - 1);
 }
 
 
+/******************** START FENCE GRID QUERY **************************/
 
+static void StartFenceGridQuery(void)
+{
+	gFenceGridQueryStamp++;
+
+	if (gFenceGridQueryStamp == 0)									// wrapped, so old stamps could look current
+	{
+		SDL_memset(gFenceGridSectionStamp, 0, sizeof(uint32_t) * gFenceGridNumSections);
+		gFenceGridQueryStamp = 1;
+	}
+}
+
+
+/******************** GET FENCE GRID NUM SECTIONS **************************/
+
+int GetFenceGridNumSections(void)
+{
+	return gFenceGridNumSections;
+}
 
@@ -0,0 +1,516 @@
+/****************************/
+/*   SUPERTILE BUFFERS.C    */
+/****************************/
+//
+// Keeps the supertile geometry in GPU buffer objects, so that drawing the
+// terrain doesn't make the driver copy every visible supertile's arrays each
+// frame. The geometry only changes when a supertile is built or deformed.
+//
+// All supertile memory blocks share one vertex buffer, laid out like the
+// master arrays in CreateSuperTileMemoryList: the points of every block,
+// then the normals of every block, then the colors of every block, then one
+// set of UVs which all of them use. A block is uploaded whole when it's built
+// (UploadSuperTileBuffers), and a deformation only resends the points &
+// normals that actually moved (UpdateSuperTileBuffers). Cached supertiles
+// keep their block, so they don't need anything sent when they come back.
+//
+// The triangles only depend on gMapSplitMode, which doesn't change after the
+// level has loaded, so the index buffer is built once in CreateSuperTileBuffers.
+// It holds each distinct triangle layout on the map once, and
+// gSuperTileIndexPattern says which one each supertile uses. After those
+// come the coarser levels' variants from SuperTileLOD.c.
+//
+// If there are no buffer objects, or gSuperTileBuffersDisabled is set,
+// DrawTerrain draws from the client-side arrays like before.
+//
+
+/***************/
+/* EXTERNALS   */
+/***************/
+
+#include "game.h"
+#include "ogl_functions.h"
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+static void SendSuperTileRange(size_t offset, size_t size, const void *data);
+static void VerifySuperTileBuffers(int superTileNum, int indexSlot, const MOTriangleIndecies *triangles, int numTriangles);
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+#define	POINTS_SIZE			(sizeof(OGLPoint3D) * NUM_VERTICES_IN_SUPERTILE)
+#define	NORMALS_SIZE		(sizeof(OGLVector3D) * NUM_VERTICES_IN_SUPERTILE)
+#define	COLORS_SIZE			(sizeof(OGLColorRGBA_Byte) * NUM_VERTICES_IN_SUPERTILE)
+#define	UVS_SIZE			(sizeof(OGLTextureCoord) * NUM_VERTICES_IN_SUPERTILE)
+#define	PATTERN_SIZE		(sizeof(uint16_t) * NUM_TRIS_IN_SUPERTILE * 3)			// each layout or LOD variant gets a slot this big
+
+#define	POINTS_START		0
+#define	NORMALS_START		(POINTS_START + POINTS_SIZE * NUM_SUPERTILE_BLOCKS)
+#define	COLORS_START		(NORMALS_START + NORMALS_SIZE * NUM_SUPERTILE_BLOCKS)
+#define	UVS_START			(COLORS_START + COLORS_SIZE * NUM_SUPERTILE_BLOCKS)
+#define	VERTEX_BUFFER_SIZE	(UVS_START + UVS_SIZE)
+
+#define	BUFFER_OFFSET(n)	((const void *) (uintptr_t) (n))
+
+_Static_assert(SUPERTILE_SIZE * SUPERTILE_SIZE <= 64, "a supertile's split modes must fit in a uint64_t");
+_Static_assert(NUM_VERTICES_IN_SUPERTILE <= 0x10000, "supertile vertex indices must fit in a uint16_t");
+
+
+/*********************/
+/*    VARIABLES      */
+/*********************/
+
+static GLuint		gSuperTileVertexBuffer = 0;
+static GLuint		gSuperTileIndexBuffer = 0;
+static Boolean		gDrawingFromBuffers = false;					// buffers are bound for the rest of DrawTerrain
+
+static uint16_t		**gSuperTileIndexPattern = nil;					// [superRow][superCol] = # of its layout in the index buffer
+int					gNumSuperTileIndexPatterns = 0;
+
+static Byte			*gSuperTileVertexShadow = nil;					// with gVerifySuperTileBuffers, a copy of what we sent...
+static uint16_t		*gSuperTileIndexShadow = nil;					// ...to each buffer
+
+SuperTileBufferStats	gSuperTileBufferStats;
+Boolean					gSuperTileBuffersDisabled = false;
+Boolean					gVerifySuperTileBuffers = false;
+
+
+/*************** CREATE SUPERTILE BUFFERS ***********************/
+//
+// Called from LoadPlayfield after CreateSuperTileMemoryList & CalculateSplitModeMatrix.
+//
+
+void CreateSuperTileBuffers(void)
+{
+int					numSuperTiles = gNumSuperTilesDeep * gNumSuperTilesWide;
+int					hashBits, hashSize, i;
+int					*hashTable;
+uint64_t			*patternMasks;
+uint16_t			*indices;
+MOTriangleIndecies	triangles[NUM_TRIS_IN_SUPERTILE];
+OGLTextureCoord		uvs[NUM_VERTICES_IN_SUPERTILE];
+
+	DisposeSuperTileBuffers();
+
+	if (!gOGLHaveBufferObjects || numSuperTiles <= 0)
+		return;
+
+	Alloc_2d_array(uint16_t, gSuperTileIndexPattern, gNumSuperTilesDeep, gNumSuperTilesWide);
+
+
+			/**************************************/
+			/* FIND THE DISTINCT TRIANGLE LAYOUTS */
+			/**************************************/
+			//
+			// A supertile's layout is just the split mode of each of its tiles, so
+			// we hash those bits to find the supertiles that can share indices.
+			//
+
+	for (hashBits = 4; (1 << hashBits) < numSuperTiles * 2; hashBits++)
+		;
+	hashSize = 1 << hashBits;
+
+	hashTable		= AllocPtrTagged(sizeof(int) * hashSize, kMemTag_Terrain);
+	patternMasks	= AllocPtrTagged(sizeof(uint64_t) * numSuperTiles, kMemTag_Terrain);
+	indices			= AllocPtrTagged(PATTERN_SIZE * (numSuperTiles + NUM_SUPERTILE_LOD_VARIANTS), kMemTag_Terrain);
+	GAME_ASSERT(hashTable && patternMasks && indices);
+
+	for (i = 0; i < hashSize; i++)
+		hashTable[i] = -1;
+
+	gNumSuperTileIndexPatterns = 0;
+
+	for (int superRow = 0; superRow < gNumSuperTilesDeep; superRow++)
+	{
+		for (int superCol = 0; superCol < gNumSuperTilesWide; superCol++)
+		{
+			uint64_t	mask = 0;
+			int			startRow = superRow * SUPERTILE_SIZE;
+			int			startCol = superCol * SUPERTILE_SIZE;
+
+			for (int row = 0; row < SUPERTILE_SIZE; row++)
+				for (int col = 0; col < SUPERTILE_SIZE; col++)
+					if (gMapSplitMode[startRow + row][startCol + col] == SPLIT_BACKWARD)
+						mask |= (uint64_t) 1 << (row * SUPERTILE_SIZE + col);
+
+					/* LOOK IT UP */
+
+			int	h = (int) ((mask * 0x9E3779B97F4A7C15ull) >> (64 - hashBits));
+
+			while (hashTable[h] >= 0 && patternMasks[hashTable[h]] != mask)
+				h = (h + 1) & (hashSize - 1);
+
+					/* NEW LAYOUT, SO ADD ITS INDICES */
+
+			if (hashTable[h] < 0)
+			{
+				int			p = gNumSuperTileIndexPatterns++;
+				uint16_t	*out = &indices[p * NUM_TRIS_IN_SUPERTILE * 3];
+
+				hashTable[h] = p;
+				patternMasks[p] = mask;
+
+				BuildSuperTileTriangles(startCol, startRow, triangles);
+				for (int t = 0; t < NUM_TRIS_IN_SUPERTILE; t++)
+				{
+					*out++ = (uint16_t) triangles[t].vertexIndices[0];
+					*out++ = (uint16_t) triangles[t].vertexIndices[1];
+					*out++ = (uint16_t) triangles[t].vertexIndices[2];
+				}
+			}
+
+			gSuperTileIndexPattern[superRow][superCol] = (uint16_t) hashTable[h];
+		}
+	}
+
+
+			/* APPEND THE LOD VARIANTS */
+
+	for (int variant = 0; variant < NUM_SUPERTILE_LOD_VARIANTS; variant++)
+	{
+		int					numLODTriangles;
+		MOTriangleIndecies	*lodTriangles = GetSuperTileLODTriangles(variant, &numLODTriangles);
+		uint16_t			*out = &indices[(gNumSuperTileIndexPatterns + variant) * NUM_TRIS_IN_SUPERTILE * 3];
+
+		SDL_memset(out, 0, PATTERN_SIZE);
+		for (int t = 0; t < numLODTriangles; t++)
+		{
+			*out++ = (uint16_t) lodTriangles[t].vertexIndices[0];
+			*out++ = (uint16_t) lodTriangles[t].vertexIndices[1];
+			*out++ = (uint16_t) lodTriangles[t].vertexIndices[2];
+		}
+	}
+
+
+			/*****************************/
+			/* CREATE THE INDEX BUFFER   */
+			/*****************************/
+
+	glGenBuffersARB(1, &gSuperTileIndexBuffer);
+	glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, gSuperTileIndexBuffer);
+	glBufferDataARB(GL_ELEMENT_ARRAY_BUFFER_ARB, PATTERN_SIZE * (gNumSuperTileIndexPatterns + NUM_SUPERTILE_LOD_VARIANTS), indices, GL_STATIC_DRAW_ARB);
+	glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
+
+
+			/*****************************/
+			/* CREATE THE VERTEX BUFFER  */
+			/*****************************/
+			//
+			// The blocks get filled in as the supertiles are built, only the
+			// shared UVs go in now.
+			//
+
+	i = 0;
+	for (int v = 0; v <= SUPERTILE_SIZE; v++)
+	{
+		for (int u = 0; u <= SUPERTILE_SIZE; u++)
+		{
+			uvs[i].u = (float)u / (float)SUPERTILE_SIZE;				// same as CreateSuperTileMemoryList
+			uvs[i].v = (float)v / (float)SUPERTILE_SIZE;
+			i++;
+		}
+	}
+
+	glGenBuffersARB(1, &gSuperTileVertexBuffer);
+	glBindBufferARB(GL_ARRAY_BUFFER_ARB, gSuperTileVertexBuffer);
+	glBufferDataARB(GL_ARRAY_BUFFER_ARB, VERTEX_BUFFER_SIZE, NULL, GL_DYNAMIC_DRAW_ARB);
+	glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, UVS_START, UVS_SIZE, uvs);
+	glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+
+	if (OGL_CheckError())
+		DoFatalAlert("CreateSuperTileBuffers: couldn't create the buffers");
+
+
+			/* KEEP A COPY TO CHECK AGAINST */
+
+	if (gVerifySuperTileBuffers)
+	{
+		gSuperTileVertexShadow = AllocPtrTagged(VERTEX_BUFFER_SIZE, kMemTag_Terrain);
+		gSuperTileIndexShadow = AllocPtrTagged(PATTERN_SIZE * (gNumSuperTileIndexPatterns + NUM_SUPERTILE_LOD_VARIANTS), kMemTag_Terrain);
+		GAME_ASSERT(gSuperTileVertexShadow && gSuperTileIndexShadow);
+
+		SDL_memset(gSuperTileVertexShadow, 0, VERTEX_BUFFER_SIZE);
+		SDL_memcpy(gSuperTileVertexShadow + UVS_START, uvs, UVS_SIZE);
+		SDL_memcpy(gSuperTileIndexShadow, indices, PATTERN_SIZE * (gNumSuperTileIndexPatterns + NUM_SUPERTILE_LOD_VARIANTS));
+	}
+
+	SafeDisposePtr((Ptr) hashTable);
+	SafeDisposePtr((Ptr) patternMasks);
+	SafeDisposePtr((Ptr) indices);
+}
+
+
+/*************** DISPOSE SUPERTILE BUFFERS ***********************/
+//
+// Called from DisposeSuperTileMemoryList.
+//
+
+void DisposeSuperTileBuffers(void)
+{
+	if (gSuperTileVertexBuffer)
+	{
+		glDeleteBuffersARB(1, &gSuperTileVertexBuffer);
+		gSuperTileVertexBuffer = 0;
+	}
+
+	if (gSuperTileIndexBuffer)
+	{
+		glDeleteBuffersARB(1, &gSuperTileIndexBuffer);
+		gSuperTileIndexBuffer = 0;
+	}
+
+	if (gSuperTileIndexPattern)
+	{
+		Free_2d_array(gSuperTileIndexPattern);
+		gSuperTileIndexPattern = nil;
+	}
+	gNumSuperTileIndexPatterns = 0;
+
+	if (gSuperTileVertexShadow)
+	{
+		SafeDisposePtr((Ptr) gSuperTileVertexShadow);
+		gSuperTileVertexShadow = nil;
+	}
+
+	if (gSuperTileIndexShadow)
+	{
+		SafeDisposePtr((Ptr) gSuperTileIndexShadow);
+		gSuperTileIndexShadow = nil;
+	}
+
+	gDrawingFromBuffers = false;
+}
+
+#pragma mark -
+
+
+/*************** SEND SUPERTILE RANGE ***********************/
+//
+// The vertex buffer must be bound.
+//
+
+static void SendSuperTileRange(size_t offset, size_t size, const void *data)
+{
+	glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, offset, size, data);
+
+	if (gSuperTileVertexShadow)
+		SDL_memcpy(gSuperTileVertexShadow + offset, data, size);
+
+	gSuperTileBufferStats.numBytesUploaded += (uint32_t) size;
+}
+
+
+/*************** UPLOAD SUPERTILE BUFFERS ***********************/
+//
+// Sends a supertile that's just been built to its block of the vertex buffer.
+//
+
+void UploadSuperTileBuffers(int superTileNum)
+{
+const MOVertexArrayData	*meshData = gSuperTileMemoryList[superTileNum].meshData;
+
+	if (!gSuperTileVertexBuffer)
+		return;
+
+	glBindBufferARB(GL_ARRAY_BUFFER_ARB, gSuperTileVertexBuffer);
+
+	SendSuperTileRange(POINTS_START + POINTS_SIZE * superTileNum, POINTS_SIZE, meshData->points);
+	SendSuperTileRange(NORMALS_START + NORMALS_SIZE * superTileNum, NORMALS_SIZE, meshData->normals);
+	SendSuperTileRange(COLORS_START + COLORS_SIZE * superTileNum, COLORS_SIZE, meshData->colorsByte);
+
+	if (!gDrawingFromBuffers)
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+
+	gSuperTileBufferStats.numFullUploads++;
+}
+
+
+/*************** UPDATE SUPERTILE BUFFERS ***********************/
+//
+// Called by DoSuperTileDeformation with the first & last points and normals
+// that it changed (last < first if none did). Deformations don't touch the
+// vertex colors.
+//
+
+void UpdateSuperTileBuffers(int superTileNum, int firstPoint, int lastPoint, int firstNormal, int lastNormal)
+{
+const MOVertexArrayData	*meshData = gSuperTileMemoryList[superTileNum].meshData;
+
+	if (!gSuperTileVertexBuffer)
+		return;
+
+	if (lastPoint < firstPoint && lastNormal < firstNormal)
+		return;
+
+	glBindBufferARB(GL_ARRAY_BUFFER_ARB, gSuperTileVertexBuffer);
+
+	if (lastPoint >= firstPoint)
+	{
+		SendSuperTileRange(POINTS_START + POINTS_SIZE * superTileNum + sizeof(OGLPoint3D) * firstPoint,
+							sizeof(OGLPoint3D) * (lastPoint - firstPoint + 1),
+							&meshData->points[firstPoint]);
+		gSuperTileBufferStats.numPartialUploads++;
+	}
+
+	if (lastNormal >= firstNormal)
+	{
+		SendSuperTileRange(NORMALS_START + NORMALS_SIZE * superTileNum + sizeof(OGLVector3D) * firstNormal,
+							sizeof(OGLVector3D) * (lastNormal - firstNormal + 1),
+							&meshData->normals[firstNormal]);
+		gSuperTileBufferStats.numPartialUploads++;
+	}
+
+	if (!gDrawingFromBuffers)
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+}
+
+#pragma mark -
+
+
+/*************** DRAW SUPERTILE FROM BUFFERS ***********************/
+//
+// The buffer version of MO_DrawGeometry_VertexArray for a supertile, whose
+// texture has already been submitted. lodVariant is from GetSuperTileLODVariant.
+// Returns false if the caller has to draw it from its arrays instead.
+//
+// The buffers stay bound until FinishSuperTileBufferDraws.
+//
+
+Boolean DrawSuperTileFromBuffers(int superTileNum, int lodVariant)
+{
+const SuperTileMemoryType	*superTile = &gSuperTileMemoryList[superTileNum];
+const MOTriangleIndecies	*triangles;
+int							indexSlot, numTriangles;
+
+	if (!gSuperTileVertexBuffer || gSuperTileBuffersDisabled)
+		return(false);
+
+	if (lodVariant >= 0)
+	{
+		triangles = GetSuperTileLODTriangles(lodVariant, &numTriangles);
+		indexSlot = gNumSuperTileIndexPatterns + lodVariant;
+	}
+	else
+	{
+		triangles = superTile->meshData->triangles;
+		numTriangles = NUM_TRIS_IN_SUPERTILE;
+		indexSlot = gSuperTileIndexPattern[superTile->tileRow / SUPERTILE_SIZE][superTile->tileCol / SUPERTILE_SIZE];
+	}
+
+	if (gVerifySuperTileBuffers)
+		VerifySuperTileBuffers(superTileNum, indexSlot, triangles, numTriangles);
+
+	if (!gDrawingFromBuffers)
+	{
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB, gSuperTileVertexBuffer);
+		glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, gSuperTileIndexBuffer);
+		gDrawingFromBuffers = true;
+	}
+
+
+			/* POINTS & COLORS */
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(3, GL_FLOAT, 0, BUFFER_OFFSET(POINTS_START + POINTS_SIZE * superTileNum));
+
+	glColorPointer(4, GL_UNSIGNED_BYTE, 0, BUFFER_OFFSET(COLORS_START + COLORS_SIZE * superTileNum));	// supertiles only have byte colors
+	glEnableClientState(GL_COLOR_ARRAY);
+
+
+			/* UVS, IF TEXTURED */
+			//
+			// Supertile textures are never multi-textured (see ReadDataFromPlayfieldFile).
+			//
+
+	if (gMostRecentMaterial->objectData.flags & BG3D_MATERIALFLAG_TEXTURED)
+	{
+		glTexCoordPointer(2, GL_FLOAT, 0, BUFFER_OFFSET(UVS_START));
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	}
+	else
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+
+
+			/* NORMALS, IF LIT */
+
+	if (gMyState_Lighting)
+	{
+		glNormalPointer(GL_FLOAT, 0, BUFFER_OFFSET(NORMALS_START + NORMALS_SIZE * superTileNum));
+		glEnableClientState(GL_NORMAL_ARRAY);
+	}
+	else
+		glDisableClientState(GL_NORMAL_ARRAY);
+
+
+			/* DRAW IT */
+
+	glDrawElements(GL_TRIANGLES, numTriangles * 3, GL_UNSIGNED_SHORT, BUFFER_OFFSET(PATTERN_SIZE * indexSlot));
+
+	if (OGL_CheckError())
+		DoFatalAlert("DrawSuperTileFromBuffers: glDrawElements");
+
+	gPolysThisFrame += numTriangles;
+	gDrawCallsThisFrame++;
+	gSuperTileBufferStats.numDraws++;
+	gSuperTileLODStats.numTriangles += numTriangles;
+
+	return(true);
+}
+
+
+/*************** FINISH SUPERTILE BUFFER DRAWS ***********************/
+//
+// Unbinds the buffers so that everything else goes back to client-side arrays.
+//
+
+void FinishSuperTileBufferDraws(void)
+{
+	if (!gDrawingFromBuffers)
+		return;
+
+	glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+	glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
+	gDrawingFromBuffers = false;
+}
+
+
+/*************** VERIFY SUPERTILE BUFFERS ***********************/
+//
+// Checks that what we've sent for this supertile matches its arrays, i.e.
+// that no build or deformation was missed, and that the index slot we're
+// about to draw holds the given triangles.
+//
+
+static void VerifySuperTileBuffers(int superTileNum, int indexSlot, const MOTriangleIndecies *triangles, int numTriangles)
+{
+const SuperTileMemoryType	*superTile = &gSuperTileMemoryList[superTileNum];
+const MOVertexArrayData		*meshData = superTile->meshData;
+const uint16_t				*indices = &gSuperTileIndexShadow[indexSlot * NUM_TRIS_IN_SUPERTILE * 3];
+
+	if (!gSuperTileVertexShadow)									// turned on after the level loaded
+		return;
+
+	if (SDL_memcmp(gSuperTileVertexShadow + POINTS_START + POINTS_SIZE * superTileNum, meshData->points, POINTS_SIZE)
+		|| SDL_memcmp(gSuperTileVertexShadow + NORMALS_START + NORMALS_SIZE * superTileNum, meshData->normals, NORMALS_SIZE)
+		|| SDL_memcmp(gSuperTileVertexShadow + COLORS_START + COLORS_SIZE * superTileNum, meshData->colorsByte, COLORS_SIZE)
+		|| SDL_memcmp(gSuperTileVertexShadow + UVS_START, meshData->uvs[0], UVS_SIZE))
+	{
+		DoFatalAlert("VerifySuperTileBuffers: supertile %d,%d's vertex buffer is stale",
+					superTile->tileRow / SUPERTILE_SIZE, superTile->tileCol / SUPERTILE_SIZE);
+	}
+
+	for (int t = 0; t < numTriangles * 3; t++)
+	{
+		if (indices[t] != triangles[t / 3].vertexIndices[t % 3])
+		{
+			DoFatalAlert("VerifySuperTileBuffers: supertile %d,%d's index slot %d doesn't match its triangles",
+						superTile->tileRow / SUPERTILE_SIZE, superTile->tileCol / SUPERTILE_SIZE, indexSlot);
+		}
+	}
+}
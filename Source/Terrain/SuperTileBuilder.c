@@ -0,0 +1,631 @@
+/****************************/
+/*   SUPERTILE BUILDER.C    */
+/****************************/
+//
+// Builds supertile geometry on worker threads before DoPlayerTerrainUpdate
+// asks for it, so that crossing a supertile boundary doesn't stall the frame.
+//
+// Each frame, PrefetchSuperTiles guesses where the camera will be in
+// SUPERTILE_PREFETCH_LOOKAHEAD seconds (from its velocity, or from a hint
+// such as the Stampede camera's spline), and queues the supertiles around
+// there that aren't built yet. The workers build them into the prefetch
+// slots' own arrays with BuildSuperTileGeometry.
+//
+// When BuildTerrainSuperTile then needs one of them, AdoptPrefetchedSuperTile
+// swaps the slot's arrays with the supertile's, so that the main thread never
+// copies or builds anything. A slot still waiting in the queue is dropped
+// & built on the main thread, and one being built is waited on, so the
+// geometry is the same no matter how far along the workers are.
+//
+// All slot state is guarded by gPrefetchMutex. The workers only ever touch
+// a slot while it's PREFETCH_BUILDING.
+//
+
+/***************/
+/* EXTERNALS   */
+/***************/
+
+#include "game.h"
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+static int SDLCALL SuperTileBuilderThread(void *unused);
+static void QueueSuperTilePrefetch(int superRow, int superCol);
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+#define	MAX_SUPERTILE_BUILDERS		3
+#define	MAX_SUPERTILE_PREFETCHES	48
+
+enum
+{
+	PREFETCH_FREE,
+	PREFETCH_QUEUED,
+	PREFETCH_BUILDING,
+	PREFETCH_DONE
+};
+
+#define	PREFETCH_SPEED_SMOOTHING	.25f				// how much of this frame's camera velocity goes into the estimate
+
+
+/*********************/
+/*    VARIABLES      */
+/*********************/
+
+typedef struct
+{
+	Byte				state;
+	int					superRow, superCol;
+	uint32_t			queueSeq;						// builders take the oldest first
+	uint32_t			lastWanted;						// PrefetchSuperTiles call # that last asked for it
+	OGLLightDefType		lights;							// copy of the lights when it was queued
+	MOVertexArrayData	meshData;						// its own arrays, until they're swapped into a supertile
+	float				minY, maxY;
+	void				*memory;						// block that the arrays started out in
+}SuperTilePrefetch;
+
+static SuperTileBuildStats	gSuperTileBuildStats;				// the builders update it too, read it with GetSuperTileBuildStats
+Boolean					gVerifySuperTilePrefetch = false;		// rebuild every adopted supertile on the main thread & compare
+
+static SDL_Thread			*gSuperTileBuilders[MAX_SUPERTILE_BUILDERS];
+static int					gNumSuperTileBuilders = 0;
+static SDL_Mutex			*gPrefetchMutex = nil;
+static SDL_Condition		*gPrefetchQueued = nil;				// signaled when a slot is queued, or on shutdown
+static SDL_Condition		*gPrefetchBuilt = nil;				// signaled when a slot is done
+static Boolean				gQuitSuperTileBuilders = false;
+
+static SuperTilePrefetch	gPrefetches[MAX_SUPERTILE_PREFETCHES];
+static int					gNumPrefetchSlots = 0;				// 0 when there's no level or no builders
+static uint32_t				gPrefetchQueueSeq = 0;
+static uint32_t				gPrefetchPass = 0;
+
+static Boolean				gPrefetchHaveLastCoord = false;
+static float				gPrefetchLastX, gPrefetchLastZ;
+static OGLVector2D			gPrefetchVelocity;					// smoothed camera velocity, units per second
+
+static Boolean				gPrefetchHaveHint = false;
+static float				gPrefetchHintX, gPrefetchHintZ;
+
+
+
+/********************** INIT SUPERTILE BUILDERS ***************************/
+//
+// Called once at boot by InitTerrainManager. Starts a few worker threads,
+// leaving a core for the main thread. If we can't have threads (e.g. single
+// core, or a web build without them) supertiles are just built on demand.
+//
+
+void InitSuperTileBuilders(void)
+{
+int	numBuilders = SDL_GetNumLogicalCPUCores() - 1;
+
+	numBuilders = GAME_MIN(numBuilders, MAX_SUPERTILE_BUILDERS);
+	if (numBuilders <= 0)
+		return;
+
+	gPrefetchMutex	= SDL_CreateMutex();
+	gPrefetchQueued	= SDL_CreateCondition();
+	gPrefetchBuilt	= SDL_CreateCondition();
+	if (!gPrefetchMutex || !gPrefetchQueued || !gPrefetchBuilt)
+	{
+		SDL_Log("InitSuperTileBuilders: no threads (%s), building supertiles on demand", SDL_GetError());
+		return;
+	}
+
+	for (int i = 0; i < numBuilders; i++)
+	{
+		char	name[32];
+
+		SDL_snprintf(name, sizeof(name), "SuperTileBuilder%d", i);
+
+		gSuperTileBuilders[i] = SDL_CreateThread(SuperTileBuilderThread, name, nil);
+		if (!gSuperTileBuilders[i])
+		{
+			SDL_Log("InitSuperTileBuilders: couldn't start %s: %s", name, SDL_GetError());
+			break;
+		}
+
+		gNumSuperTileBuilders++;
+	}
+}
+
+
+/********************** SHUTDOWN SUPERTILE BUILDERS ***************************/
+
+void ShutdownSuperTileBuilders(void)
+{
+	if (gNumSuperTileBuilders == 0)
+		return;
+
+	SDL_LockMutex(gPrefetchMutex);
+	gQuitSuperTileBuilders = true;
+	SDL_BroadcastCondition(gPrefetchQueued);
+	SDL_UnlockMutex(gPrefetchMutex);
+
+	for (int i = 0; i < gNumSuperTileBuilders; i++)
+	{
+		SDL_WaitThread(gSuperTileBuilders[i], nil);
+		gSuperTileBuilders[i] = nil;
+	}
+
+	gNumSuperTileBuilders = 0;
+	gNumPrefetchSlots = 0;									// we're quitting, so the slots' memory can go with everything else
+
+	SDL_DestroyCondition(gPrefetchBuilt);
+	SDL_DestroyCondition(gPrefetchQueued);
+	SDL_DestroyMutex(gPrefetchMutex);
+	gPrefetchBuilt = gPrefetchQueued = nil;
+	gPrefetchMutex = nil;
+}
+
+
+/********************** SUPERTILE BUILDER THREAD ***************************/
+
+static int SDLCALL SuperTileBuilderThread(void *unused)
+{
+	(void) unused;
+
+	SDL_LockMutex(gPrefetchMutex);
+
+	while (!gQuitSuperTileBuilders)
+	{
+		SuperTilePrefetch	*slot = nil;
+
+				/* TAKE THE OLDEST QUEUED SLOT */
+
+		for (int i = 0; i < gNumPrefetchSlots; i++)
+		{
+			if (gPrefetches[i].state == PREFETCH_QUEUED
+				&& (!slot || (int32_t) (gPrefetches[i].queueSeq - slot->queueSeq) < 0))
+			{
+				slot = &gPrefetches[i];
+			}
+		}
+
+		if (!slot)
+		{
+			SDL_WaitCondition(gPrefetchQueued, gPrefetchMutex);
+			continue;
+		}
+
+		slot->state = PREFETCH_BUILDING;
+
+		SDL_UnlockMutex(gPrefetchMutex);
+
+		BuildSuperTileGeometry(slot->superCol * SUPERTILE_SIZE, slot->superRow * SUPERTILE_SIZE,
+								&slot->meshData, &slot->lights, &slot->minY, &slot->maxY);
+
+		SDL_LockMutex(gPrefetchMutex);
+
+		slot->state = PREFETCH_DONE;
+		gSuperTileBuildStats.numPrefetched++;
+		SDL_BroadcastCondition(gPrefetchBuilt);
+	}
+
+	SDL_UnlockMutex(gPrefetchMutex);
+	return 0;
+}
+
+
+#pragma mark -
+
+/********************** CREATE SUPERTILE PREFETCH SLOTS ***************************/
+//
+// Called from CreateSuperTileMemoryList. The slots' arrays get swapped with
+// the supertiles' as they're adopted, so they have to be freed along with them.
+//
+
+void CreateSuperTilePrefetchSlots(void)
+{
+	if (gNumSuperTileBuilders == 0)
+		return;
+
+	GAME_ASSERT(gNumPrefetchSlots == 0);
+
+	size_t	pointsSize		= sizeof(OGLPoint3D) * NUM_VERTICES_IN_SUPERTILE;
+	size_t	normalsSize		= sizeof(OGLVector3D) * NUM_VERTICES_IN_SUPERTILE;
+	size_t	colorsSize		= sizeof(OGLColorRGBA_Byte) * NUM_VERTICES_IN_SUPERTILE;
+	size_t	trianglesSize	= sizeof(MOTriangleIndecies) * NUM_TRIS_IN_SUPERTILE;
+
+	for (int i = 0; i < MAX_SUPERTILE_PREFETCHES; i++)
+	{
+		SuperTilePrefetch	*slot = &gPrefetches[i];
+		Byte				*memory = AllocPtrTagged(pointsSize + normalsSize + colorsSize + trianglesSize, kMemTag_Terrain);
+
+		SDL_zerop(slot);
+		slot->state					= PREFETCH_FREE;
+		slot->memory				= memory;
+		slot->meshData.points		= (OGLPoint3D *) memory;
+		slot->meshData.normals		= (OGLVector3D *) (memory + pointsSize);
+		slot->meshData.triangles	= (MOTriangleIndecies *) (memory + pointsSize + normalsSize);
+		slot->meshData.colorsByte	= (OGLColorRGBA_Byte *) (memory + pointsSize + normalsSize + trianglesSize);
+		slot->meshData.numPoints	= NUM_VERTICES_IN_SUPERTILE;
+		slot->meshData.numTriangles	= NUM_TRIS_IN_SUPERTILE;
+	}
+
+	gPrefetchHaveLastCoord = false;
+	gPrefetchHaveHint = false;
+	gPrefetchVelocity.x = gPrefetchVelocity.y = 0;
+
+	SDL_LockMutex(gPrefetchMutex);
+	gNumPrefetchSlots = MAX_SUPERTILE_PREFETCHES;
+	SDL_UnlockMutex(gPrefetchMutex);
+}
+
+
+/********************** DISPOSE SUPERTILE PREFETCH SLOTS ***************************/
+//
+// Called from DisposeSuperTileMemoryList.
+//
+
+void DisposeSuperTilePrefetchSlots(void)
+{
+	if (gNumPrefetchSlots == 0)
+		return;
+
+	CancelSuperTilePrefetches();							// the builders are idle after this
+
+	SDL_LockMutex(gPrefetchMutex);
+	gNumPrefetchSlots = 0;
+	SDL_UnlockMutex(gPrefetchMutex);
+
+	for (int i = 0; i < MAX_SUPERTILE_PREFETCHES; i++)
+	{
+		SafeDisposePtr(gPrefetches[i].memory);
+		gPrefetches[i].memory = nil;
+	}
+}
+
+
+/********************** CANCEL SUPERTILE PREFETCHES ***************************/
+//
+// Drops everything that's queued or built, after waiting for the builders
+// to finish what they're on. Call this before changing gMapYCoords.
+//
+
+void CancelSuperTilePrefetches(void)
+{
+	if (gNumPrefetchSlots == 0)
+		return;
+
+	SDL_LockMutex(gPrefetchMutex);
+
+	for (int i = 0; i < gNumPrefetchSlots; i++)
+	{
+		SuperTilePrefetch *slot = &gPrefetches[i];
+
+		while (slot->state == PREFETCH_BUILDING)
+			SDL_WaitCondition(gPrefetchBuilt, gPrefetchMutex);
+
+		if (slot->state == PREFETCH_DONE)
+			gSuperTileBuildStats.numDiscarded++;
+
+		slot->state = PREFETCH_FREE;
+	}
+
+	SDL_UnlockMutex(gPrefetchMutex);
+}
+
+
+#pragma mark -
+
+/********************** SET SUPERTILE PREFETCH HINT ***************************/
+//
+// Tells the next PrefetchSuperTiles where the camera will be
+// SUPERTILE_PREFETCH_LOOKAHEAD seconds from now, when we know better
+// than its velocity (e.g. it's on a spline).
+//
+
+void SetSuperTilePrefetchHint(float x, float z)
+{
+	gPrefetchHaveHint = true;
+	gPrefetchHintX = x;
+	gPrefetchHintZ = z;
+}
+
+
+/********************** PREFETCH SUPERTILES ***************************/
+//
+// Called by DoPlayerTerrainUpdate with the camera's x/z, after it has
+// built what it needs for this frame. Not while there are deformations,
+// since those change gMapYCoords under the builders.
+//
+
+void PrefetchSuperTiles(float x, float z)
+{
+float	predictX, predictZ;
+float	fps = gFramesPerSecondFrac;
+
+	if (gNumPrefetchSlots == 0)
+		return;
+
+			/* UPDATE THE CAMERA'S VELOCITY */
+
+	if (gPrefetchHaveLastCoord && fps > 0.0f)
+	{
+		float	dx = x - gPrefetchLastX;
+		float	dz = z - gPrefetchLastZ;
+
+		if (fabsf(dx) > gTerrainSuperTileUnitSize || fabsf(dz) > gTerrainSuperTileUnitSize)	// jumped, so start over
+		{
+			gPrefetchVelocity.x = gPrefetchVelocity.y = 0;
+		}
+		else
+		{
+			gPrefetchVelocity.x += (dx / fps - gPrefetchVelocity.x) * PREFETCH_SPEED_SMOOTHING;
+			gPrefetchVelocity.y += (dz / fps - gPrefetchVelocity.y) * PREFETCH_SPEED_SMOOTHING;
+		}
+	}
+
+	gPrefetchHaveLastCoord = true;
+	gPrefetchLastX = x;
+	gPrefetchLastZ = z;
+
+			/* PREDICT WHERE IT'LL BE */
+
+	if (gPrefetchHaveHint)
+	{
+		predictX = gPrefetchHintX;
+		predictZ = gPrefetchHintZ;
+		gPrefetchHaveHint = false;
+	}
+	else
+	{
+		predictX = x + gPrefetchVelocity.x * SUPERTILE_PREFETCH_LOOKAHEAD;
+		predictZ = z + gPrefetchVelocity.y * SUPERTILE_PREFETCH_LOOKAHEAD;
+	}
+
+	float	maxDist = gSuperTileActiveRange * gTerrainSuperTileUnitSize;		// don't go past the next window over
+
+	predictX = x + SDL_clamp(predictX - x, -maxDist, maxDist);
+	predictZ = z + SDL_clamp(predictZ - z, -maxDist, maxDist);
+
+			/* QUEUE THE SUPERTILES AROUND THERE */
+			//
+			// The same window as DoPlayerTerrainUpdate's, with a circle
+			// standing in for its masks.
+			//
+
+	int		range = gSuperTileActiveRange;
+	int		firstCol = ((predictX - range * gTerrainSuperTileUnitSize) * gTerrainSuperTileUnitSizeFrac) + .5f;
+	int		firstRow = ((predictZ - range * gTerrainSuperTileUnitSize) * gTerrainSuperTileUnitSizeFrac) + .5f;
+
+	gPrefetchPass++;
+
+	SDL_LockMutex(gPrefetchMutex);
+
+	for (int r = 0; r < range*2; r++)
+	{
+		int	row = firstRow + r;
+
+		if (row < 0 || row >= gNumSuperTilesDeep)
+			continue;
+
+		for (int c = 0; c < range*2; c++)
+		{
+			int		col = firstCol + c;
+			float	dr = r - range + .5f;
+			float	dc = c - range + .5f;
+
+			if (col < 0 || col >= gNumSuperTilesWide)
+				continue;
+
+			if (dr*dr + dc*dc > range*range)
+				continue;
+
+			if (gSuperTileStatusGrid[row][col].statusFlags & (SUPERTILE_IS_DEFINED | SUPERTILE_IS_CACHED))		// already built
+				continue;
+
+			if (gSuperTileTextureGrid[row][col] == -1)									// blank
+				continue;
+
+			QueueSuperTilePrefetch(row, col);
+		}
+	}
+
+	SDL_UnlockMutex(gPrefetchMutex);
+}
+
+
+/********************** QUEUE SUPERTILE PREFETCH ***************************/
+//
+// gPrefetchMutex must be locked.
+//
+
+static void QueueSuperTilePrefetch(int superRow, int superCol)
+{
+SuperTilePrefetch	*freeSlot = nil;
+SuperTilePrefetch	*staleSlot = nil;
+
+	for (int i = 0; i < gNumPrefetchSlots; i++)
+	{
+		SuperTilePrefetch *slot = &gPrefetches[i];
+
+		if (slot->state == PREFETCH_FREE)
+		{
+			if (!freeSlot)
+				freeSlot = slot;
+			continue;
+		}
+
+		if (slot->superRow == superRow && slot->superCol == superCol)	// already on it
+		{
+			slot->lastWanted = gPrefetchPass;
+			return;
+		}
+
+		if (slot->state != PREFETCH_BUILDING && slot->lastWanted != gPrefetchPass		// not wanted by this pass, so can go
+			&& (!staleSlot || (int32_t) (slot->lastWanted - staleSlot->lastWanted) < 0))
+		{
+			staleSlot = slot;
+		}
+	}
+
+	if (!freeSlot)
+	{
+		if (!staleSlot)													// all full of things we want
+			return;
+
+		if (staleSlot->state == PREFETCH_DONE)
+			gSuperTileBuildStats.numDiscarded++;
+
+		freeSlot = staleSlot;
+	}
+
+	freeSlot->state			= PREFETCH_QUEUED;
+	freeSlot->superRow		= superRow;
+	freeSlot->superCol		= superCol;
+	freeSlot->queueSeq		= gPrefetchQueueSeq++;
+	freeSlot->lastWanted	= gPrefetchPass;
+	freeSlot->lights		= gGameViewInfoPtr->lightList;
+
+	SDL_SignalCondition(gPrefetchQueued);
+}
+
+
+/********************** ADOPT PREFETCHED SUPERTILE ***************************/
+//
+// Called by BuildTerrainSuperTile. If the builders made (or are making) this
+// supertile, swaps its arrays into meshData and returns true.
+//
+
+Boolean AdoptPrefetchedSuperTile(int superCol, int superRow, MOVertexArrayData *meshData, float *minY, float *maxY)
+{
+SuperTilePrefetch	*slot = nil;
+
+	if (gNumPrefetchSlots == 0)
+	{
+		gSuperTileBuildStats.numBuiltOnMainThread++;
+		return(false);
+	}
+
+	SDL_LockMutex(gPrefetchMutex);
+
+	for (int i = 0; i < gNumPrefetchSlots; i++)
+	{
+		if (gPrefetches[i].state != PREFETCH_FREE
+			&& gPrefetches[i].superRow == superRow && gPrefetches[i].superCol == superCol)
+		{
+			slot = &gPrefetches[i];
+			break;
+		}
+	}
+
+	if (!slot)
+	{
+		SDL_UnlockMutex(gPrefetchMutex);
+		gSuperTileBuildStats.numBuiltOnMainThread++;
+		return(false);
+	}
+
+	if (slot->state == PREFETCH_QUEUED)									// quicker to just build it here
+	{
+		slot->state = PREFETCH_FREE;
+		SDL_UnlockMutex(gPrefetchMutex);
+		gSuperTileBuildStats.numBuiltOnMainThread++;
+		return(false);
+	}
+
+	if (slot->state == PREFETCH_BUILDING)
+	{
+		gSuperTileBuildStats.numWaits++;
+
+		while (slot->state == PREFETCH_BUILDING)
+			SDL_WaitCondition(gPrefetchBuilt, gPrefetchMutex);
+	}
+
+	GAME_ASSERT(slot->state == PREFETCH_DONE);
+
+			/* SWAP ARRAYS */
+
+	OGLPoint3D			*points		= meshData->points;
+	OGLVector3D			*normals	= meshData->normals;
+	OGLColorRGBA_Byte	*colors		= meshData->colorsByte;
+	MOTriangleIndecies	*triangles	= meshData->triangles;
+
+	meshData->points		= slot->meshData.points;
+	meshData->normals		= slot->meshData.normals;
+	meshData->colorsByte	= slot->meshData.colorsByte;
+	meshData->triangles		= slot->meshData.triangles;
+
+	slot->meshData.points		= points;
+	slot->meshData.normals		= normals;
+	slot->meshData.colorsByte	= colors;
+	slot->meshData.triangles	= triangles;
+
+	*minY = slot->minY;
+	*maxY = slot->maxY;
+
+	slot->state = PREFETCH_FREE;
+	gSuperTileBuildStats.numPrefetchHits++;
+
+	SDL_UnlockMutex(gPrefetchMutex);
+
+	if (gVerifySuperTilePrefetch)
+		VerifySuperTileGeometry(superCol, superRow, meshData, *minY, *maxY, "AdoptPrefetchedSuperTile");
+
+	return(true);
+}
+
+
+/********************** GET SUPERTILE BUILD STATS ***************************/
+//
+// The builders bump the counters while we're running, so take a copy
+// with gPrefetchMutex locked.
+//
+
+void GetSuperTileBuildStats(SuperTileBuildStats *stats)
+{
+	SDL_LockMutex(gPrefetchMutex);
+	*stats = gSuperTileBuildStats;
+	SDL_UnlockMutex(gPrefetchMutex);
+}
+
+
+/********************** RESET SUPERTILE BUILD STATS ***************************/
+
+void ResetSuperTileBuildStats(void)
+{
+	SDL_LockMutex(gPrefetchMutex);
+	SDL_zero(gSuperTileBuildStats);
+	SDL_UnlockMutex(gPrefetchMutex);
+}
+
+
+/********************** VERIFY SUPERTILE GEOMETRY ***************************/
+//
+// Rebuilds a supertile on the main thread & stops if it doesn't match what
+// we got from the builders or the cache.
+//
+
+void VerifySuperTileGeometry(int superCol, int superRow, const MOVertexArrayData *meshData, float minY, float maxY, const char *where)
+{
+static OGLPoint3D			points[NUM_VERTICES_IN_SUPERTILE];
+static OGLVector3D			normals[NUM_VERTICES_IN_SUPERTILE];
+static OGLColorRGBA_Byte	colors[NUM_VERTICES_IN_SUPERTILE];
+static MOTriangleIndecies	triangles[NUM_TRIS_IN_SUPERTILE];
+MOVertexArrayData			check = *meshData;
+float						checkMinY, checkMaxY;
+
+	check.points		= points;
+	check.normals		= normals;
+	check.colorsByte	= colors;
+	check.triangles		= triangles;
+
+	BuildSuperTileGeometry(superCol * SUPERTILE_SIZE, superRow * SUPERTILE_SIZE, &check, &gGameViewInfoPtr->lightList, &checkMinY, &checkMaxY);
+
+	if (SDL_memcmp(points, meshData->points, sizeof(points)) != 0
+		|| SDL_memcmp(normals, meshData->normals, sizeof(normals)) != 0
+		|| SDL_memcmp(colors, meshData->colorsByte, sizeof(colors)) != 0
+		|| SDL_memcmp(triangles, meshData->triangles, sizeof(triangles)) != 0
+		|| checkMinY != minY || checkMaxY != maxY)
+	{
+		DoFatalAlert("%s: supertile %d,%d doesn't match a fresh build", where, superRow, superCol);
+	}
+}
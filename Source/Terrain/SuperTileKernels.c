@@ -0,0 +1,519 @@
+/****************************/
+/*   SUPERTILE KERNELS.C    */
+/****************************/
+//
+// The per-vertex passes of a supertile build: the vertex normals and the
+// vertex lighting. Both run over the regular 9x9 vertex grid, so besides the
+// original scalar loops there are 4-wide versions for SSE2, NEON and wasm
+// SIMD128, used unless gSuperTileSIMDDisabled is set.
+//
+// The 4-wide versions must give the very same bytes as the scalar ones (the
+// bench checks this on every supertile of the map, see --terrain), so they
+// do the same float operations in the same order: no reciprocal estimates,
+// no min/max where the scalar code compares, and __frsqrte & the float to
+// byte conversions are done one lane at a time. FP contraction is turned off
+// for this file so that the compiler can't fuse a multiply & add in one
+// version but not the other.
+//
+// Build with -DVEC4_SIMD=0 to leave the 4-wide versions out (see vec4.h).
+//
+
+#pragma STDC FP_CONTRACT OFF
+
+/***************/
+/* EXTERNALS   */
+/***************/
+
+#include "game.h"
+#include "vec4.h"
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+typedef struct
+{
+	float		ambientR, ambientG, ambientB;
+	float		fillR[2], fillG[2], fillB[2];
+	OGLVector3D	fillDir[2];						// pointing towards the lights
+	int			numFillLights;
+}SuperTileLights;
+
+static void GetSuperTileLights(const OGLLightDefType *lights, SuperTileLights *out);
+static void CalculateSupertileVertexNormals_Scalar(MOVertexArrayData *meshData, long startRow, long startCol);
+static void LightSuperTileVertices_Scalar(const OGLVector3D *vertexNormals, OGLColorRGBA_Byte *vertexColorList,
+											int startRow, int startCol, const SuperTileLights *l);
+#if VEC4_SIMD
+static void CalculateSupertileVertexNormals_SIMD(MOVertexArrayData *meshData, long startRow, long startCol);
+static void LightSuperTileVertices_SIMD(const OGLVector3D *vertexNormals, OGLColorRGBA_Byte *vertexColorList,
+											int startRow, int startCol, const SuperTileLights *l);
+#endif
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+#define	SUPERTILE_VERTS_WIDE			(SUPERTILE_SIZE+1)
+#define	NUM_VERTICES_IN_SUPERTILE_4		((NUM_VERTICES_IN_SUPERTILE + 3) & ~3)		// rounded up to a whole # of Vec4's
+#define	SUPERTILE_VERTS_WIDE_4			((SUPERTILE_VERTS_WIDE + 3) & ~3)
+
+
+/*********************/
+/*    VARIABLES      */
+/*********************/
+
+const Boolean	gSuperTileSIMDAvailable = VEC4_SIMD;
+Boolean			gSuperTileSIMDDisabled = false;				// use the scalar loops even if we have the 4-wide ones
+
+
+
+/******************** CALCULATE SUPERTILE VERTEX NORMALS **********************/
+
+void CalculateSupertileVertexNormals(MOVertexArrayData	*meshData, long	startRow, long startCol)
+{
+#if VEC4_SIMD
+	if (!gSuperTileSIMDDisabled)
+	{
+		CalculateSupertileVertexNormals_SIMD(meshData, startRow, startCol);
+		return;
+	}
+#endif
+
+	CalculateSupertileVertexNormals_Scalar(meshData, startRow, startCol);
+}
+
+
+/******************** LIGHT SUPERTILE VERTICES **********************/
+//
+// Sets the vertex colors from the ambient & fill lights, the vertex normals
+// and the shading grid.
+//
+
+void LightSuperTileVertices(const OGLVector3D *vertexNormals, OGLColorRGBA_Byte *vertexColorList,
+							int startRow, int startCol, const OGLLightDefType *lights)
+{
+SuperTileLights	l;
+
+	GetSuperTileLights(lights, &l);
+
+#if VEC4_SIMD
+	if (!gSuperTileSIMDDisabled)
+	{
+		LightSuperTileVertices_SIMD(vertexNormals, vertexColorList, startRow, startCol, &l);
+		return;
+	}
+#endif
+
+	LightSuperTileVertices_Scalar(vertexNormals, vertexColorList, startRow, startCol, &l);
+}
+
+
+/******************** GET SUPERTILE LIGHTS **********************/
+
+static void GetSuperTileLights(const OGLLightDefType *lights, SuperTileLights *out)
+{
+	out->ambientR = lights->ambientColor.r;								// get ambient color
+	out->ambientG = lights->ambientColor.g;
+	out->ambientB = lights->ambientColor.b;
+
+	out->numFillLights = lights->numFillLights;
+
+	for (int i = 0; i < 2; i++)
+	{
+		int	light = (i < out->numFillLights) ? i : 0;				// unused one just copies #0
+
+		out->fillR[i] = lights->fillColor[light].r;					// get fill color
+		out->fillG[i] = lights->fillColor[light].g;
+		out->fillB[i] = lights->fillColor[light].b;
+		out->fillDir[i].x = -lights->fillDirection[light].x;			// get fill direction
+		out->fillDir[i].y = -lights->fillDirection[light].y;
+		out->fillDir[i].z = -lights->fillDirection[light].z;
+	}
+}
+
+
+#pragma mark -
+
+/******************** CALCULATE SUPERTILE VERTEX NORMALS: SCALAR **********************/
+
+static void CalculateSupertileVertexNormals_Scalar(MOVertexArrayData *meshData, long startRow, long startCol)
+{
+OGLPoint3D			*vertexPointList;
+OGLVector3D			*vertexNormals;
+int					i,row,col;
+MOTriangleIndecies	*triangleList;
+OGLVector3D			faceNormal[NUM_TRIS_IN_SUPERTILE];
+OGLVector3D			*n1,*n2;
+float				avX,avY,avZ;
+OGLVector3D			nA,nB;
+long				ro,co;
+
+	vertexPointList 		= meshData->points;									// get ptr to points list
+	vertexNormals			= meshData->normals;								// get ptr to vertex normals
+	triangleList 			= meshData->triangles;								// get ptr to triangle index list
+
+
+						/* CALC FACE NORMALS */
+
+	for (i = 0; i < NUM_TRIS_IN_SUPERTILE; i++)
+	{
+		CalcFaceNormal_NotNormalized(&vertexPointList[triangleList[i].vertexIndices[0]],
+									&vertexPointList[triangleList[i].vertexIndices[1]],
+									&vertexPointList[triangleList[i].vertexIndices[2]],
+									&faceNormal[i]);
+	}
+
+
+			/******************************/
+			/* CALCULATE VERTEX NORMALS   */
+			/******************************/
+
+	i = 0;
+	for (row = 0; row <= SUPERTILE_SIZE; row++)
+	{
+		for (col = 0; col <= SUPERTILE_SIZE; col++)
+		{
+
+			/* SCAN 4 TILES AROUND THIS TILE TO CALC AVERAGE NORMAL FOR THIS VERTEX */
+			//
+			// We use the face normal already calculated for triangles inside the supertile,
+			// but for tiles/tris outside the supertile (on the borders), we need to calculate
+			// the face normals there.
+			//
+
+			avX = avY = avZ = 0;									// init the normal
+
+			for (ro = -1; ro <= 0; ro++)
+			{
+				for (co = -1; co <= 0; co++)
+				{
+					long	cc = col + co;
+					long	rr = row + ro;
+
+					if ((cc >= 0) && (cc < SUPERTILE_SIZE) && (rr >= 0) && (rr < SUPERTILE_SIZE)) // see if this vertex is in supertile bounds
+					{
+						n1 = &faceNormal[rr * (SUPERTILE_SIZE*2) + (cc*2)];				// average 2 triangles...
+						n2 = n1+1;
+						avX += n1->x + n2->x;											// ...and average with current average
+						avY += n1->y + n2->y;
+						avZ += n1->z + n2->z;
+					}
+					else																// tile is out of supertile, so calc face normal & average
+					{
+						CalcTileNormals_NotNormalized(startRow + rr, startCol + cc, &nA,&nB);		// calculate the 2 face normals for this tile
+						avX += nA.x + nB.x;												// average with current average
+						avY += nA.y + nB.y;
+						avZ += nA.z + nB.z;
+					}
+				}
+			}
+
+			FastNormalizeVector(avX, avY, avZ, &vertexNormals[i]);						// normalize the vertex normal
+			i++;
+		}
+	}
+}
+
+
+/******************** LIGHT SUPERTILE VERTICES: SCALAR **********************/
+
+static void LightSuperTileVertices_Scalar(const OGLVector3D *vertexNormals, OGLColorRGBA_Byte *vertexColorList,
+											int startRow, int startCol, const SuperTileLights *l)
+{
+int	i = 0;
+
+	for (int row = 0; row <= SUPERTILE_SIZE; row++)
+	{
+		for (int col = 0; col <= SUPERTILE_SIZE; col++)
+		{
+			float	shade = gVertexShading[row+startRow][col+startCol] * 255.0f;		// get value from shading grid
+			float	r,g,b,dot;
+
+
+					/* APPLY LIGHTING TO THE VERTEX */
+
+			r = l->ambientR;												// factor in the ambient
+			g = l->ambientG;
+			b = l->ambientB;
+
+
+			if (l->numFillLights > 0)
+			{
+				dot = OGLVector3D_Dot(&vertexNormals[i], &l->fillDir[0]);
+				if (dot > 0.0f)
+				{
+					r += l->fillR[0] * dot;
+					g += l->fillG[0] * dot;
+					b += l->fillB[0] * dot;
+				}
+
+				if (l->numFillLights > 1)
+				{
+					dot = OGLVector3D_Dot(&vertexNormals[i], &l->fillDir[1]);
+					if (dot > 0.0f)
+					{
+						r += l->fillR[1] * dot;
+						g += l->fillG[1] * dot;
+						b += l->fillB[1] * dot;
+					}
+				}
+
+				if (r > 1.0f)
+					r = 1.0f;
+				if (g > 1.0f)
+					g = 1.0f;
+				if (b > 1.0f)
+					b = 1.0f;
+			}
+
+					/* SAVE COLOR INTO LIST */
+
+			vertexColorList[i].r = r * shade;		// convert to Byte values & apply shade
+			vertexColorList[i].g = g * shade;
+			vertexColorList[i].b = b * shade;
+			vertexColorList[i].a = 0xff;
+			i++;
+		}
+	}
+}
+
+
+#pragma mark -
+
+#if VEC4_SIMD
+
+/******************** CALCULATE SUPERTILE VERTEX NORMALS: SIMD **********************/
+//
+// Same math as the scalar version, reorganized so that each step runs over
+// contiguous arrays: the face normals 4 triangles at a time, then the sum of
+// each tile's 2 face normals into a grid that has a ring of border tiles
+// around the supertile, then each row of vertices sums its 4 tiles & gets
+// normalized 4 vertices at a time.
+//
+
+static void CalculateSupertileVertexNormals_SIMD(MOVertexArrayData *meshData, long startRow, long startCol)
+{
+const OGLPoint3D			*points = meshData->points;
+const MOTriangleIndecies	*triangles = meshData->triangles;
+OGLVector3D					*vertexNormals = meshData->normals;
+float						p[9][NUM_TRIS_IN_SUPERTILE];			// x,y,z of each triangle's 3 points
+float						faceX[NUM_TRIS_IN_SUPERTILE], faceY[NUM_TRIS_IN_SUPERTILE], faceZ[NUM_TRIS_IN_SUPERTILE];
+float						tileX[SUPERTILE_SIZE+2][SUPERTILE_VERTS_WIDE_4+4];	// tile (row-1, col-1) is at [row][col]
+float						tileY[SUPERTILE_SIZE+2][SUPERTILE_VERTS_WIDE_4+4];
+float						tileZ[SUPERTILE_SIZE+2][SUPERTILE_VERTS_WIDE_4+4];
+float						outX[SUPERTILE_VERTS_WIDE_4], outY[SUPERTILE_VERTS_WIDE_4], outZ[SUPERTILE_VERTS_WIDE_4];
+
+			/* GATHER THE TRIANGLES' POINTS */
+
+	for (int t = 0; t < NUM_TRIS_IN_SUPERTILE; t++)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			const OGLPoint3D *pt = &points[triangles[t].vertexIndices[k]];
+
+			p[k*3+0][t] = pt->x;
+			p[k*3+1][t] = pt->y;
+			p[k*3+2][t] = pt->z;
+		}
+	}
+
+			/* CALC FACE NORMALS */
+
+	for (int t = 0; t < NUM_TRIS_IN_SUPERTILE; t += 4)
+	{
+		Vec4	dx1 = Vec4_Sub(Vec4_Load(&p[0][t]), Vec4_Load(&p[6][t]));
+		Vec4	dy1 = Vec4_Sub(Vec4_Load(&p[1][t]), Vec4_Load(&p[7][t]));
+		Vec4	dz1 = Vec4_Sub(Vec4_Load(&p[2][t]), Vec4_Load(&p[8][t]));
+		Vec4	dx2 = Vec4_Sub(Vec4_Load(&p[3][t]), Vec4_Load(&p[6][t]));
+		Vec4	dy2 = Vec4_Sub(Vec4_Load(&p[4][t]), Vec4_Load(&p[7][t]));
+		Vec4	dz2 = Vec4_Sub(Vec4_Load(&p[5][t]), Vec4_Load(&p[8][t]));
+
+		Vec4_Store(&faceX[t], Vec4_Sub(Vec4_Mul(dy1, dz2), Vec4_Mul(dy2, dz1)));
+		Vec4_Store(&faceY[t], Vec4_Sub(Vec4_Mul(dx2, dz1), Vec4_Mul(dx1, dz2)));
+		Vec4_Store(&faceZ[t], Vec4_Sub(Vec4_Mul(dx1, dy2), Vec4_Mul(dx2, dy1)));
+	}
+
+			/* SUM EACH TILE'S 2 FACE NORMALS */
+			//
+			// Tiles on the ring around the supertile come from the terrain, like the scalar version.
+			//
+
+	SDL_zeroa(tileX);
+	SDL_zeroa(tileY);
+	SDL_zeroa(tileZ);
+
+	for (int rr = -1; rr <= SUPERTILE_SIZE; rr++)
+	{
+		for (int cc = -1; cc <= SUPERTILE_SIZE; cc++)
+		{
+			if ((cc >= 0) && (cc < SUPERTILE_SIZE) && (rr >= 0) && (rr < SUPERTILE_SIZE))
+			{
+				int	f = rr * (SUPERTILE_SIZE*2) + (cc*2);
+
+				tileX[rr+1][cc+1] = faceX[f] + faceX[f+1];
+				tileY[rr+1][cc+1] = faceY[f] + faceY[f+1];
+				tileZ[rr+1][cc+1] = faceZ[f] + faceZ[f+1];
+			}
+			else
+			{
+				OGLVector3D	nA,nB;
+
+				CalcTileNormals_NotNormalized(startRow + rr, startCol + cc, &nA,&nB);
+				tileX[rr+1][cc+1] = nA.x + nB.x;
+				tileY[rr+1][cc+1] = nA.y + nB.y;
+				tileZ[rr+1][cc+1] = nA.z + nB.z;
+			}
+		}
+	}
+
+			/* SUM & NORMALIZE EACH ROW OF VERTICES */
+
+	const Vec4	zero = Vec4_Set1(0.0f);
+	const Vec4	eps = Vec4_Set1(EPS);
+	const Vec4	minusHalf = Vec4_Set1((float)(-.5));
+	const Vec4	threeHalves = Vec4_Set1((float)(3.0/2.0));
+
+	for (int row = 0; row <= SUPERTILE_SIZE; row++)
+	{
+		for (int col = 0; col < SUPERTILE_VERTS_WIDE_4; col += 4)
+		{
+			float	lengthSquared[4], isqrt[4];
+
+					/* SUM THE 4 TILES AROUND THE VERTEX, IN THE SCALAR VERSION'S ORDER */
+
+			Vec4	x = Vec4_Add(zero, Vec4_Load(&tileX[row][col]));
+			Vec4	y = Vec4_Add(zero, Vec4_Load(&tileY[row][col]));
+			Vec4	z = Vec4_Add(zero, Vec4_Load(&tileZ[row][col]));
+
+			x = Vec4_Add(x, Vec4_Load(&tileX[row][col+1]));
+			y = Vec4_Add(y, Vec4_Load(&tileY[row][col+1]));
+			z = Vec4_Add(z, Vec4_Load(&tileZ[row][col+1]));
+			x = Vec4_Add(x, Vec4_Load(&tileX[row+1][col]));
+			y = Vec4_Add(y, Vec4_Load(&tileY[row+1][col]));
+			z = Vec4_Add(z, Vec4_Load(&tileZ[row+1][col]));
+			x = Vec4_Add(x, Vec4_Load(&tileX[row+1][col+1]));
+			y = Vec4_Add(y, Vec4_Load(&tileY[row+1][col+1]));
+			z = Vec4_Add(z, Vec4_Load(&tileZ[row+1][col+1]));
+
+					/* NORMALIZE LIKE FastNormalizeVector */
+
+			Mask4	isZero = Mask4_And(Mask4_And(Vec4_LessEqual(Vec4_Abs(x), eps), Vec4_LessEqual(Vec4_Abs(y), eps)),
+										Vec4_LessEqual(Vec4_Abs(z), eps));
+
+			Vec4	temp = Vec4_Mul(x, x);
+			temp = Vec4_Add(temp, Vec4_Mul(y, y));
+			temp = Vec4_Add(temp, Vec4_Mul(z, z));
+
+			Vec4_Store(lengthSquared, temp);
+			for (int k = 0; k < 4; k++)
+				isqrt[k] = __frsqrte(lengthSquared[k]);
+
+			Vec4	is = Vec4_Load(isqrt);
+			Vec4	temp1 = Vec4_Mul(temp, minusHalf);
+			Vec4	temp2 = Vec4_Mul(is, is);
+			temp1 = Vec4_Mul(temp1, is);
+			is = Vec4_Mul(is, threeHalves);
+			temp = Vec4_Add(is, Vec4_Mul(temp1, temp2));
+
+			Vec4_Store(&outX[col], Vec4_Select(isZero, zero, Vec4_Mul(x, temp)));
+			Vec4_Store(&outY[col], Vec4_Select(isZero, zero, Vec4_Mul(y, temp)));
+			Vec4_Store(&outZ[col], Vec4_Select(isZero, zero, Vec4_Mul(z, temp)));
+		}
+
+		OGLVector3D	*n = &vertexNormals[row * SUPERTILE_VERTS_WIDE];
+
+		for (int col = 0; col <= SUPERTILE_SIZE; col++)
+		{
+			n[col].x = outX[col];
+			n[col].y = outY[col];
+			n[col].z = outZ[col];
+		}
+	}
+}
+
+
+/******************** LIGHT SUPERTILE VERTICES: SIMD **********************/
+
+static void LightSuperTileVertices_SIMD(const OGLVector3D *vertexNormals, OGLColorRGBA_Byte *vertexColorList,
+											int startRow, int startCol, const SuperTileLights *l)
+{
+float	nx[NUM_VERTICES_IN_SUPERTILE_4], ny[NUM_VERTICES_IN_SUPERTILE_4], nz[NUM_VERTICES_IN_SUPERTILE_4];
+float	shade[NUM_VERTICES_IN_SUPERTILE_4];
+float	outR[NUM_VERTICES_IN_SUPERTILE_4], outG[NUM_VERTICES_IN_SUPERTILE_4], outB[NUM_VERTICES_IN_SUPERTILE_4];
+int		i = 0;
+
+			/* GATHER NORMALS & SHADING */
+
+	for (int row = 0; row <= SUPERTILE_SIZE; row++)
+	{
+		const float	*shadingRow = &gVertexShading[row+startRow][startCol];
+
+		for (int col = 0; col <= SUPERTILE_SIZE; col++, i++)
+		{
+			nx[i] = vertexNormals[i].x;
+			ny[i] = vertexNormals[i].y;
+			nz[i] = vertexNormals[i].z;
+			shade[i] = shadingRow[col];
+		}
+	}
+
+	for ( ; i < NUM_VERTICES_IN_SUPERTILE_4; i++)
+		nx[i] = ny[i] = nz[i] = shade[i] = 0;
+
+			/* LIGHT 4 VERTICES AT A TIME */
+
+	const Vec4	zero = Vec4_Set1(0.0f);
+	const Vec4	one = Vec4_Set1(1.0f);
+	const Vec4	s255 = Vec4_Set1(255.0f);
+
+	for (i = 0; i < NUM_VERTICES_IN_SUPERTILE_4; i += 4)
+	{
+		Vec4	x = Vec4_Load(&nx[i]);
+		Vec4	y = Vec4_Load(&ny[i]);
+		Vec4	z = Vec4_Load(&nz[i]);
+		Vec4	r = Vec4_Set1(l->ambientR);
+		Vec4	g = Vec4_Set1(l->ambientG);
+		Vec4	b = Vec4_Set1(l->ambientB);
+
+		for (int light = 0; light < l->numFillLights && light < 2; light++)
+		{
+			const OGLVector3D	*d = &l->fillDir[light];
+
+			Vec4	dot = Vec4_Add(Vec4_Add(Vec4_Mul(x, Vec4_Set1(d->x)), Vec4_Mul(y, Vec4_Set1(d->y))), Vec4_Mul(z, Vec4_Set1(d->z)));
+			dot = Vec4_Select(Vec4_Greater(dot, one), one, dot);				// OGLVector3D_Dot pins it (the low end doesn't matter here)
+
+			Mask4	lit = Vec4_Greater(dot, zero);
+
+			r = Vec4_Select(lit, Vec4_Add(r, Vec4_Mul(Vec4_Set1(l->fillR[light]), dot)), r);
+			g = Vec4_Select(lit, Vec4_Add(g, Vec4_Mul(Vec4_Set1(l->fillG[light]), dot)), g);
+			b = Vec4_Select(lit, Vec4_Add(b, Vec4_Mul(Vec4_Set1(l->fillB[light]), dot)), b);
+		}
+
+		if (l->numFillLights > 0)
+		{
+			r = Vec4_Select(Vec4_Greater(r, one), one, r);
+			g = Vec4_Select(Vec4_Greater(g, one), one, g);
+			b = Vec4_Select(Vec4_Greater(b, one), one, b);
+		}
+
+		Vec4	s = Vec4_Mul(Vec4_Load(&shade[i]), s255);
+
+		Vec4_Store(&outR[i], Vec4_Mul(r, s));
+		Vec4_Store(&outG[i], Vec4_Mul(g, s));
+		Vec4_Store(&outB[i], Vec4_Mul(b, s));
+	}
+
+			/* CONVERT TO BYTES, THE SAME WAY AS THE SCALAR VERSION */
+
+	for (i = 0; i < NUM_VERTICES_IN_SUPERTILE; i++)
+	{
+		vertexColorList[i].r = outR[i];
+		vertexColorList[i].g = outG[i];
+		vertexColorList[i].b = outB[i];
+		vertexColorList[i].a = 0xff;
+	}
+}
+
+#endif // VEC4_SIMD
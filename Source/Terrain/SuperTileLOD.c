@@ -0,0 +1,440 @@
+/****************************/
+/*   SUPERTILE LOD.C        */
+/****************************/
+//
+// Geomipmapping for the terrain: far supertiles are drawn with 4x4 or 2x2
+// quads instead of 8x8. The coarser levels just skip vertices of the same
+// 9x9 grid, so only the triangle indices change & the supertile's vertex
+// arrays and buffers are used as they are.
+//
+// Each frame, ChooseSuperTileLODs picks the coarsest level whose geometric
+// error (the most any skipped vertex is off the coarse surface, precalculated
+// per supertile by CreateSuperTileLODErrors) would project to at most
+// SUPERTILE_LOD_PIXEL_ERROR pixels on screen.
+//
+// To avoid cracks, the coarser of two neighbors puts the finer one's edge
+// vertices on their shared edge: its border quads on that side become a fan
+// around the quad's center. So each level has a variant for every mix of
+// finer edges, all built at boot by InitSuperTileLODs. Full detail supertiles
+// never change, so they keep their own split modes.
+//
+
+/***************/
+/* EXTERNALS   */
+/***************/
+
+#include "game.h"
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+static void BuildSuperTileLODVariant(int lod, const Byte edgeLOD[4], MOTriangleIndecies *triangles, int *numTriangles);
+static void AddLODTriangle(MOTriangleIndecies *triangles, int *numTriangles, int r0, int c0, int r1, int c1, int r2, int c2);
+static void CheckSuperTileLODVariant(int lod, const Byte edgeLOD[4], const MOTriangleIndecies *triangles, int numTriangles);
+static inline float GetLODVertexHeight(int row, int col);
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+enum												// sides of a supertile, in the order we walk around a quad
+{
+	LOD_SIDE_BACK,									// row 0
+	LOD_SIDE_RIGHT,									// col SUPERTILE_SIZE
+	LOD_SIDE_FRONT,									// row SUPERTILE_SIZE
+	LOD_SIDE_LEFT,									// col 0
+	NUM_LOD_SIDES
+};
+
+#define	VERTEX_INDEX(row, col)		((row) * (SUPERTILE_SIZE+1) + (col))
+
+
+/*********************/
+/*    VARIABLES      */
+/*********************/
+
+typedef struct
+{
+	float	error[NUM_SUPERTILE_LODS];				// world units
+}SuperTileLODError;
+
+static SuperTileLODError	**gSuperTileLODErrorGrid = nil;
+
+static MOTriangleIndecies	gLODTriangles[NUM_SUPERTILE_LOD_VARIANTS][NUM_TRIS_IN_SUPERTILE];
+static int					gLODNumTriangles[NUM_SUPERTILE_LOD_VARIANTS];
+static int					gLODVariantBase[NUM_SUPERTILE_LODS];
+
+SuperTileLODStats			gSuperTileLODStats;
+Boolean						gSuperTileLODDisabled = false;
+
+
+/*************** INIT SUPERTILE LODS ***********************/
+//
+// Builds the triangles of every variant of every coarse level.
+// Only called at boot by InitTerrainManager.
+//
+
+void InitSuperTileLODs(void)
+{
+int	variant = 0;
+
+	gLODVariantBase[0] = -1;								// full detail uses the supertile's own triangles
+
+	for (int lod = 1; lod < NUM_SUPERTILE_LODS; lod++)
+	{
+		int	numEdgeLODs = lod + 1;							// each side can be this level or any finer one
+		int	numVariants = numEdgeLODs * numEdgeLODs * numEdgeLODs * numEdgeLODs;
+
+		gLODVariantBase[lod] = variant;
+
+		for (int i = 0; i < numVariants; i++)
+		{
+			Byte	edgeLOD[NUM_LOD_SIDES];
+			int		n = i;
+
+			for (int side = 0; side < NUM_LOD_SIDES; side++)
+			{
+				edgeLOD[side] = n % numEdgeLODs;
+				n /= numEdgeLODs;
+			}
+
+			BuildSuperTileLODVariant(lod, edgeLOD, gLODTriangles[variant], &gLODNumTriangles[variant]);
+			CheckSuperTileLODVariant(lod, edgeLOD, gLODTriangles[variant], gLODNumTriangles[variant]);
+			variant++;
+		}
+	}
+
+	GAME_ASSERT(variant == NUM_SUPERTILE_LOD_VARIANTS);
+}
+
+
+/*************** BUILD SUPERTILE LOD VARIANT ***********************/
+//
+// edgeLOD[side] is the level to use along that side of the supertile, which
+// is the finer of ours & the neighbor's.
+//
+
+static void BuildSuperTileLODVariant(int lod, const Byte edgeLOD[4], MOTriangleIndecies *triangles, int *numTriangles)
+{
+int	size = 1 << lod;										// # tiles per side of a coarse quad
+int	numQuads = SUPERTILE_SIZE / size;
+
+	*numTriangles = 0;
+
+	for (int qr = 0; qr < numQuads; qr++)
+	{
+		for (int qc = 0; qc < numQuads; qc++)
+		{
+			int	back = qr * size, front = back + size;
+			int	left = qc * size, right = left + size;
+			int	step[NUM_LOD_SIDES];
+
+					/* SEE HOW FINELY EACH SIDE OF THIS QUAD IS SPLIT */
+
+			step[LOD_SIDE_BACK]		= (qr == 0) ? (1 << edgeLOD[LOD_SIDE_BACK]) : size;
+			step[LOD_SIDE_RIGHT]	= (qc == numQuads-1) ? (1 << edgeLOD[LOD_SIDE_RIGHT]) : size;
+			step[LOD_SIDE_FRONT]	= (qr == numQuads-1) ? (1 << edgeLOD[LOD_SIDE_FRONT]) : size;
+			step[LOD_SIDE_LEFT]		= (qc == 0) ? (1 << edgeLOD[LOD_SIDE_LEFT]) : size;
+
+					/* PLAIN QUAD, SO SPLIT IT \ */
+
+			if (step[LOD_SIDE_BACK] == size && step[LOD_SIDE_RIGHT] == size
+				&& step[LOD_SIDE_FRONT] == size && step[LOD_SIDE_LEFT] == size)
+			{
+				AddLODTriangle(triangles, numTriangles, front, left, front, right, back, left);
+				AddLODTriangle(triangles, numTriangles, front, right, back, right, back, left);
+				continue;
+			}
+
+					/* STITCHED QUAD, SO FAN AROUND ITS CENTER */
+
+			int	centerRow = back + size/2;
+			int	centerCol = left + size/2;
+
+			for (int c = left; c < right; c += step[LOD_SIDE_BACK])
+				AddLODTriangle(triangles, numTriangles, centerRow, centerCol, back, c, back, c + step[LOD_SIDE_BACK]);
+
+			for (int r = back; r < front; r += step[LOD_SIDE_RIGHT])
+				AddLODTriangle(triangles, numTriangles, centerRow, centerCol, r, right, r + step[LOD_SIDE_RIGHT], right);
+
+			for (int c = right; c > left; c -= step[LOD_SIDE_FRONT])
+				AddLODTriangle(triangles, numTriangles, centerRow, centerCol, front, c, front, c - step[LOD_SIDE_FRONT]);
+
+			for (int r = front; r > back; r -= step[LOD_SIDE_LEFT])
+				AddLODTriangle(triangles, numTriangles, centerRow, centerCol, r, left, r - step[LOD_SIDE_LEFT], left);
+		}
+	}
+}
+
+
+/*************** ADD LOD TRIANGLE ***********************/
+//
+// Takes grid row/col of the 3 vertices, and winds them the same way as
+// gTileTriangles1_A & co.
+//
+
+static void AddLODTriangle(MOTriangleIndecies *triangles, int *numTriangles, int r0, int c0, int r1, int c1, int r2, int c2)
+{
+int	area2 = (c1 - c0) * (r2 - r0) - (r1 - r0) * (c2 - c0);
+MOTriangleIndecies	*t;
+
+	GAME_ASSERT(area2 != 0);
+	GAME_ASSERT(*numTriangles < NUM_TRIS_IN_SUPERTILE);
+
+	t = &triangles[(*numTriangles)++];
+	t->vertexIndices[0] = VERTEX_INDEX(r0, c0);
+
+	if (area2 < 0)
+	{
+		t->vertexIndices[1] = VERTEX_INDEX(r1, c1);
+		t->vertexIndices[2] = VERTEX_INDEX(r2, c2);
+	}
+	else
+	{
+		t->vertexIndices[1] = VERTEX_INDEX(r2, c2);
+		t->vertexIndices[2] = VERTEX_INDEX(r1, c1);
+	}
+}
+
+
+/*************** CHECK SUPERTILE LOD VARIANT ***********************/
+//
+// Makes sure a variant covers the whole supertile, and uses exactly the
+// vertices along each side that the neighbor at that level would.
+//
+
+static void CheckSuperTileLODVariant(int lod, const Byte edgeLOD[4], const MOTriangleIndecies *triangles, int numTriangles)
+{
+int			totalArea2 = 0;
+uint32_t	sideVertices[NUM_LOD_SIDES] = {0};
+
+	for (int i = 0; i < numTriangles; i++)
+	{
+		int	r[3], c[3];
+
+		for (int j = 0; j < 3; j++)
+		{
+			r[j] = triangles[i].vertexIndices[j] / (SUPERTILE_SIZE+1);
+			c[j] = triangles[i].vertexIndices[j] % (SUPERTILE_SIZE+1);
+
+			if (r[j] == 0)				sideVertices[LOD_SIDE_BACK]		|= 1u << c[j];
+			if (c[j] == SUPERTILE_SIZE)	sideVertices[LOD_SIDE_RIGHT]	|= 1u << r[j];
+			if (r[j] == SUPERTILE_SIZE)	sideVertices[LOD_SIDE_FRONT]	|= 1u << c[j];
+			if (c[j] == 0)				sideVertices[LOD_SIDE_LEFT]		|= 1u << r[j];
+		}
+
+		totalArea2 -= (c[1] - c[0]) * (r[2] - r[0]) - (r[1] - r[0]) * (c[2] - c[0]);
+	}
+
+	if (totalArea2 != 2 * SUPERTILE_SIZE * SUPERTILE_SIZE)
+		DoFatalAlert("CheckSuperTileLODVariant: level %d doesn't cover the supertile", lod);
+
+	for (int side = 0; side < NUM_LOD_SIDES; side++)
+	{
+		uint32_t	expected = 0;
+
+		for (int i = 0; i <= SUPERTILE_SIZE; i += 1 << edgeLOD[side])
+			expected |= 1u << i;
+
+		if (sideVertices[side] != expected)
+			DoFatalAlert("CheckSuperTileLODVariant: level %d side %d won't match its neighbor", lod, side);
+	}
+}
+
+#pragma mark -
+
+
+/*************** GET LOD VERTEX HEIGHT ***********************/
+//
+// Same as BuildSuperTileGeometry.
+//
+
+static inline float GetLODVertexHeight(int row, int col)
+{
+	if ((row >= gTerrainTileDepth) || (col >= gTerrainTileWidth))
+		return(0);
+
+	return(gMapYCoords[row][col]);
+}
+
+
+/*************** CREATE SUPERTILE LOD ERRORS ***********************/
+//
+// For each supertile & coarse level, finds how far the skipped vertices
+// are from the \ split quads of that level.
+// Called from LoadPlayfield.
+//
+
+void CreateSuperTileLODErrors(void)
+{
+	DisposeSuperTileLODErrors();
+
+	Alloc_2d_array(SuperTileLODError, gSuperTileLODErrorGrid, gNumSuperTilesDeep, gNumSuperTilesWide);
+
+	for (int superRow = 0; superRow < gNumSuperTilesDeep; superRow++)
+	{
+		for (int superCol = 0; superCol < gNumSuperTilesWide; superCol++)
+		{
+			SuperTileLODError	*lodError = &gSuperTileLODErrorGrid[superRow][superCol];
+
+			lodError->error[0] = 0;
+
+			for (int lod = 1; lod < NUM_SUPERTILE_LODS; lod++)
+			{
+				int		size = 1 << lod;
+				float	maxError = 0;
+
+				for (int back = superRow * SUPERTILE_SIZE; back < (superRow+1) * SUPERTILE_SIZE; back += size)
+				{
+					for (int left = superCol * SUPERTILE_SIZE; left < (superCol+1) * SUPERTILE_SIZE; left += size)
+					{
+						float	yBL = GetLODVertexHeight(back, left);
+						float	yBR = GetLODVertexHeight(back, left + size);
+						float	yFL = GetLODVertexHeight(back + size, left);
+						float	yFR = GetLODVertexHeight(back + size, left + size);
+
+						for (int r = 0; r <= size; r++)
+						{
+							for (int c = 0; c <= size; c++)
+							{
+								float	v = (float) r / size;
+								float	u = (float) c / size;
+								float	y;
+
+								if (v >= u)													// front/left triangle of the \ split
+									y = yBL + v * (yFL - yBL) + u * (yFR - yFL);
+								else														// back/right one
+									y = yBL + u * (yBR - yBL) + v * (yFR - yBR);
+
+								maxError = GAME_MAX(maxError, fabsf(GetLODVertexHeight(back + r, left + c) - y));
+							}
+						}
+					}
+				}
+
+				lodError->error[lod] = GAME_MAX(maxError, lodError->error[lod-1]);	// never let a coarser level claim to be better
+			}
+		}
+	}
+}
+
+
+/*************** DISPOSE SUPERTILE LOD ERRORS ***********************/
+
+void DisposeSuperTileLODErrors(void)
+{
+	if (gSuperTileLODErrorGrid)
+	{
+		Free_2d_array(gSuperTileLODErrorGrid);
+		gSuperTileLODErrorGrid = nil;
+	}
+}
+
+#pragma mark -
+
+
+/*************** CHOOSE SUPERTILE LODS ***********************/
+//
+// Called by DrawTerrain before it draws anything, so that every used
+// supertile's level is known when its neighbors pick their variants.
+//
+
+void ChooseSuperTileLODs(void)
+{
+const OGLPoint3D	*camera = &gGameViewInfoPtr->cameraPlacement.cameraLocation;
+float				pixelsPerUnit = gGameWindowHeight / (2.0f * tanf(gGameViewInfoPtr->fov * .5f));	// on screen, at a distance of 1
+float				minDistPerError = pixelsPerUnit / SUPERTILE_LOD_PIXEL_ERROR;
+Boolean				fullDetail = gSuperTileLODDisabled || gIsPicking || !gSuperTileLODErrorGrid;
+
+	for (int r = 0; r < gNumSuperTilesDeep; r++)
+	{
+		for (int c = 0; c < gNumSuperTilesWide; c++)
+		{
+			SuperTileStatus			*status = &gSuperTileStatusGrid[r][c];
+			const SuperTileMemoryType	*superTile;
+			float					dx, dy, dz, dist;
+			int						lod;
+
+			if (!(status->statusFlags & SUPERTILE_IS_USED_THIS_FRAME))
+				continue;
+
+			superTile = &gSuperTileMemoryList[status->supertileIndex];
+
+			if (fullDetail || superTile->dontCache)								// deformations have moved its vertices, so the errors are no good
+			{
+				status->lod = 0;
+				continue;
+			}
+
+					/* GET DISTANCE TO NEAREST POINT OF ITS BBOX */
+
+			dx = GAME_MAX(GAME_MAX(superTile->bBox.min.x - camera->x, camera->x - superTile->bBox.max.x), 0.0f);
+			dy = GAME_MAX(GAME_MAX(superTile->bBox.min.y - camera->y, camera->y - superTile->bBox.max.y), 0.0f);
+			dz = GAME_MAX(GAME_MAX(superTile->bBox.min.z - camera->z, camera->z - superTile->bBox.max.z), 0.0f);
+			dist = sqrtf(dx*dx + dy*dy + dz*dz);
+
+					/* USE THE COARSEST LEVEL THAT'S CLOSE ENOUGH */
+
+			for (lod = NUM_SUPERTILE_LODS-1; lod > 0; lod--)
+			{
+				if (gSuperTileLODErrorGrid[r][c].error[lod] * minDistPerError <= dist)
+					break;
+			}
+
+			status->lod = lod;
+		}
+	}
+}
+
+
+/*************** GET SUPERTILE LOD VARIANT ***********************/
+//
+// Returns the variant to draw the supertile at row/col with, or -1 if
+// it's at full detail.
+//
+
+int GetSuperTileLODVariant(int superRow, int superCol)
+{
+static const int	dRow[NUM_LOD_SIDES] = { -1, 0, 1, 0 };
+static const int	dCol[NUM_LOD_SIDES] = { 0, 1, 0, -1 };
+int					lod = gSuperTileStatusGrid[superRow][superCol].lod;
+int					variant, scale;
+
+	if (lod == 0)
+		return(-1);
+
+	variant = 0;
+	scale = 1;
+
+	for (int side = 0; side < NUM_LOD_SIDES; side++)
+	{
+		int	r = superRow + dRow[side];
+		int	c = superCol + dCol[side];
+		int	edgeLOD = lod;
+
+		if (r >= 0 && r < gNumSuperTilesDeep && c >= 0 && c < gNumSuperTilesWide
+			&& (gSuperTileStatusGrid[r][c].statusFlags & SUPERTILE_IS_USED_THIS_FRAME))
+		{
+			edgeLOD = GAME_MIN(lod, gSuperTileStatusGrid[r][c].lod);
+		}
+
+		variant += edgeLOD * scale;
+		scale *= lod + 1;
+	}
+
+	return(gLODVariantBase[lod] + variant);
+}
+
+
+/*************** GET SUPERTILE LOD TRIANGLES ***********************/
+
+MOTriangleIndecies *GetSuperTileLODTriangles(int variant, int *numTriangles)
+{
+	GAME_ASSERT(variant >= 0 && variant < NUM_SUPERTILE_LOD_VARIANTS);
+
+	*numTriangles = gLODNumTriangles[variant];
+	return(gLODTriangles[variant]);
+}
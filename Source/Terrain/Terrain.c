@@ -4,11 +4,14 @@
 /* By Brian Greenstone      */
 /****************************/
 
+#pragma STDC FP_CONTRACT OFF									// see GetTerrainYBatch4
+
 /***************/
 /* EXTERNALS   */
 /***************/
 
 #include "game.h"
+#include "vec4.h"
 
 /****************************/
 /*  PROTOTYPES             */
@@ -16,11 +19,21 @@
 
 static short GetFreeSuperTileMemory(void);
 static inline void ReleaseSuperTileObject(short superTileNum);
+static void CacheSuperTileObject(short superTileNum);
+static void UseCachedSuperTile(int row, int col);
+static void InvalidateCachedSuperTilesAround(int superRow, int superCol);
 static void CalcNewItemDeleteWindow(void);
 static uint16_t	BuildTerrainSuperTile(int startCol, int startRow);
 static void ReleaseAllSuperTiles(void);
 static void DoSuperTileDeformation(SuperTileMemoryType *superTile);
+static void DrawSuperTileFromArrays(short superTileNum, int lodVariant);
 static void UpdateTerrainDeformationFunctions(void);
+static float GetTerrainY_PlaneEquation(float x, float z);
+static void VerifyTerrainY(float x, float z, float y, const OGLVector3D *normal);
+#if VEC4_SIMD
+static void GetTerrainYBatch4(const float *x, const float *z, float *y, OGLVector3D *normals);
+#endif
+static void CalcTerrainTilePlanes(int row, int col, TerrainTilePlanes *planes);
 
 
 /****************************/
@@ -61,7 +74,11 @@ static int		gCurrentSuperTileRow,gCurrentSuperTileCol;
 static int		gPreviousSuperTileCol,gPreviousSuperTileRow;
 
 int 			gNumFreeSupertiles = 0;
-SuperTileMemoryType	gSuperTileMemoryList[MAX_SUPERTILES];
+SuperTileMemoryType	gSuperTileMemoryList[NUM_SUPERTILE_BLOCKS];
+
+SuperTileCacheStats	gSuperTileCacheStats;
+Boolean			gVerifySuperTileCache = false;				// rebuild every supertile taken from the cache & compare
+static uint32_t	gSuperTileCacheClock = 0;
 
 
 			/* TILE SPLITTING TABLES */
@@ -75,10 +92,12 @@ static	Byte	gTileTriangles2_A[SUPERTILE_SIZE][SUPERTILE_SIZE][3];
 static	Byte	gTileTriangles1_B[SUPERTILE_SIZE][SUPERTILE_SIZE][3];
 static	Byte	gTileTriangles2_B[SUPERTILE_SIZE][SUPERTILE_SIZE][3];
 
-OGLVertex		gWorkGrid[SUPERTILE_SIZE+1][SUPERTILE_SIZE+1];
-
 OGLVector3D		gRecentTerrainNormal;							// from _Planar
 
+TerrainTilePlanes	*gTerrainTilePlanes = nil;					// gTerrainTileDepth * gTerrainTileWidth
+Boolean			gTerrainPlaneTableDisabled = false;				// build a plane equation for every query instead
+Boolean			gVerifyTerrainPlanes = false;					// compare every GetTerrainY against the plane equation
+
 
 		/* MASTER ARRAYS FOR ALL SUPERTILE DATA FOR CURRENT LEVEL */
 		
@@ -132,6 +151,14 @@ int	x,y;
 			gTileTriangles2_B[y][x][2] = (SUPERTILE_SIZE+1) * y + x;
 		}		
 	}
+
+		/* BUILD THE TRIANGLES OF THE COARSER LEVELS OF DETAIL */
+
+	InitSuperTileLODs();
+
+		/* START THE THREADS THAT BUILD SUPERTILES AHEAD OF THE CAMERA */
+
+	InitSuperTileBuilders();
 }
 
 
@@ -202,6 +229,7 @@ int		r,c,i;
 			gSuperTileStatusGrid[r][c].supertileIndex 	= 0;
 			gSuperTileStatusGrid[r][c].statusFlags 		= 0;
 			gSuperTileStatusGrid[r][c].playerHereFlag 	= false;
+			gSuperTileStatusGrid[r][c].lod			 	= 0;
 		}	
 	}
 	
@@ -285,6 +313,9 @@ int	i;
 		gMapSplitMode = nil;
 	}
 
+	DisposeTerrainPlaneTable();
+	DisposeSuperTileLODErrors();
+
 			/* NUKE SPLINE DATA */
 		
 	if (gSplineList)
@@ -300,14 +331,8 @@ int	i;
 	
 				/* NUKE WATER PATCH */
 
-	if (gWaterListHandle)
-	{
-		DisposeHandle((Handle)gWaterListHandle);
-		gWaterListHandle = nil;
-	}
-	
-	gWaterList = nil;
-	gNumWaterPatches = 0;
+	DisposeWater();
+
 	gNumSuperTilesDeep = gNumSuperTilesWide = 0;
 	
 	ReleaseAllSuperTiles();
@@ -334,45 +359,45 @@ int	u,v,i,j;
 			/* ALLOCATE ARRAYS FOR ALL THE DATA WE WILL NEED */
 			/*************************************************/
 
-	gNumFreeSupertiles = MAX_SUPERTILES;
+	gNumFreeSupertiles = NUM_SUPERTILE_BLOCKS;
 	
 			/* ALLOC BASE TRIMESH DATA FOR ALL SUPERTILES */
 			
-	gSuperTileMeshData = AllocPtr(sizeof(MOVertexArrayData) * MAX_SUPERTILES);
+	gSuperTileMeshData = AllocPtrTagged(sizeof(MOVertexArrayData) * NUM_SUPERTILE_BLOCKS, kMemTag_Terrain);
 	if (gSuperTileMeshData == nil)
 		DoFatalAlert("CreateSuperTileMemoryList: AllocPtr failed - gSuperTileMeshData");
 
 
 			/* ALLOC POINTS FOR ALL SUPERTILES */
 			
-	gSuperTileCoords = AllocPtr(sizeof(OGLPoint3D) * (NUM_VERTICES_IN_SUPERTILE * MAX_SUPERTILES));
+	gSuperTileCoords = AllocPtrTagged(sizeof(OGLPoint3D) * (NUM_VERTICES_IN_SUPERTILE * NUM_SUPERTILE_BLOCKS), kMemTag_Terrain);
 	if (gSuperTileCoords == nil)
 		DoFatalAlert("CreateSuperTileMemoryList: AllocPtr failed - gSuperTileCoords");
 
 
 			/* ALLOC VERTEX NORMALS FOR ALL SUPERTILES */
 			
-	gSuperTileNormals = AllocPtr(sizeof(OGLVector3D) * (NUM_VERTICES_IN_SUPERTILE * MAX_SUPERTILES));
+	gSuperTileNormals = AllocPtrTagged(sizeof(OGLVector3D) * (NUM_VERTICES_IN_SUPERTILE * NUM_SUPERTILE_BLOCKS), kMemTag_Terrain);
 	if (gSuperTileNormals == nil)
 		DoFatalAlert("CreateSuperTileMemoryList: AllocPtr failed - gSuperTileNormals");
 
 
 			/* ALLOC UVS FOR ALL SUPERTILES */
 			
-	gSuperTileUVs = AllocPtr(sizeof(OGLTextureCoord) * NUM_VERTICES_IN_SUPERTILE * MAX_SUPERTILES);
+	gSuperTileUVs = AllocPtrTagged(sizeof(OGLTextureCoord) * NUM_VERTICES_IN_SUPERTILE * NUM_SUPERTILE_BLOCKS, kMemTag_Terrain);
 	if (gSuperTileUVs == nil)
 		DoFatalAlert("CreateSuperTileMemoryList: AllocPtr failed - gSuperTileUVs");
 
 			/* ALLOC VERTEX COLORS FOR ALL SUPERTILES */
 			
-	gSuperTileColors = AllocPtr(sizeof(OGLColorRGBA_Byte) * NUM_VERTICES_IN_SUPERTILE * MAX_SUPERTILES);
+	gSuperTileColors = AllocPtrTagged(sizeof(OGLColorRGBA_Byte) * NUM_VERTICES_IN_SUPERTILE * NUM_SUPERTILE_BLOCKS, kMemTag_Terrain);
 	if (gSuperTileColors == nil)
 		DoFatalAlert("CreateSuperTileMemoryList: AllocPtr failed - gSuperTileColors");
 
 
 			/* ALLOC TRIANGLE ARRAYS ALL SUPERTILES */
 			
-	gSuperTileTriangles = AllocPtr(sizeof(MOTriangleIndecies) * NUM_TRIS_IN_SUPERTILE * MAX_SUPERTILES);
+	gSuperTileTriangles = AllocPtrTagged(sizeof(MOTriangleIndecies) * NUM_TRIS_IN_SUPERTILE * NUM_SUPERTILE_BLOCKS, kMemTag_Terrain);
 	if (gSuperTileTriangles == nil)
 		DoFatalAlert("CreateSuperTileMemoryList: AllocPtr failed - gSuperTileTriangles");
 		
@@ -382,7 +407,7 @@ int	u,v,i,j;
 			/****************************************/
 
 				
-	for (i = 0; i < MAX_SUPERTILES; i++)
+	for (i = 0; i < NUM_SUPERTILE_BLOCKS; i++)
 	{
 		MOVertexArrayData		*meshPtr;
 		OGLPoint3D				*coordPtr;
@@ -437,6 +462,10 @@ int	u,v,i,j;
 			}	
 		}
 	}
+
+			/* ALLOC THE PREFETCH SLOTS FOR THE SUPERTILE BUILDERS */
+
+	CreateSuperTilePrefetchSlots();
 }
 
 
@@ -444,7 +473,19 @@ int	u,v,i,j;
 
 void DisposeSuperTileMemoryList(void)
 {
-		
+
+			/* STOP THE BUILDERS & FREE THEIR SLOTS */
+			//
+			// Adopted supertiles have swapped arrays with the slots, so all
+			// of these blocks have to go together.
+			//
+
+	DisposeSuperTilePrefetchSlots();
+
+			/* AND THE GPU BUFFERS THEY WERE DRAWN FROM */
+
+	DisposeSuperTileBuffers();
+
 			/* NUKE ALL MASTER ARRAYS WHICH WILL FREE UP ALL SUPERTILE MEMORY */
 			
 	if (gSuperTileMeshData)
@@ -484,10 +525,11 @@ void DisposeSuperTileMemoryList(void)
 static short GetFreeSuperTileMemory(void)
 {
 int	i;
+int	oldestCached = -1;
 
 				/* SCAN FOR A FREE BLOCK */
 
-	for (i = 0; i < MAX_SUPERTILES; i++)
+	for (i = 0; i < NUM_SUPERTILE_BLOCKS; i++)
 	{
 		if (gSuperTileMemoryList[i].mode == SUPERTILE_MODE_FREE)
 		{
@@ -495,6 +537,27 @@ int	i;
 			gNumFreeSupertiles--;			
 			return(i);
 		}
+
+		if (gSuperTileMemoryList[i].mode == SUPERTILE_MODE_CACHED)
+		{
+			if (oldestCached < 0
+				|| (int32_t) (gSuperTileMemoryList[i].cacheStamp - gSuperTileMemoryList[oldestCached].cacheStamp) < 0)
+			{
+				oldestCached = i;
+			}
+		}
+	}
+
+				/* NONE FREE, SO EVICT THE OLDEST CACHED ONE */
+
+	if (oldestCached >= 0)
+	{
+		SuperTileMemoryType	*superTile = &gSuperTileMemoryList[oldestCached];
+
+		gSuperTileStatusGrid[superTile->tileRow / SUPERTILE_SIZE][superTile->tileCol / SUPERTILE_SIZE].statusFlags = 0;
+		superTile->mode = SUPERTILE_MODE_USED;
+		gSuperTileCacheStats.numEvicted++;
+		return(oldestCached);
 	}
 
 	DoFatalAlert("No Free Supertiles!");
@@ -508,6 +571,9 @@ int	i;
 //
 // Builds a new supertile which has scrolled on
 //
+// If one of the builder threads already made its geometry (see SuperTileBuilder.c),
+// we just swap that in. Otherwise we build it here.
+//
 // INPUT: startCol = starting tile column in map
 //		  startRow = starting tile row in map
 //
@@ -516,16 +582,9 @@ int	i;
 
 static uint16_t	BuildTerrainSuperTile(int startCol, int startRow)
 {
-long	 			row,col,row2,col2,numPoints,i;
 uint16_t				superTileNum;
-float				height,miny,maxy;
-MOVertexArrayData	*meshData;
+float				miny,maxy;
 SuperTileMemoryType	*superTilePtr;
-OGLColorRGBA_Byte	*vertexColorList;
-MOTriangleIndecies	*triangleList;
-OGLPoint3D			*vertexPointList;
-//OGLTextureCoord		*uvs;
-OGLVector3D			*vertexNormals;
 
 	superTileNum = GetFreeSuperTileMemory();						// get memory block for the data
 	superTilePtr = &gSuperTileMemoryList[superTileNum];				// get ptr to it
@@ -541,19 +600,83 @@ OGLVector3D			*vertexNormals;
 
 	superTilePtr->tileRow = startRow;								// save tile row/col
 	superTilePtr->tileCol = startCol;
+	superTilePtr->dontCache = false;
+
+	gSuperTileCacheStats.numBuilds++;
+
 
+			/* GET THE GEOMETRY */
+
+	if (!AdoptPrefetchedSuperTile(startCol / SUPERTILE_SIZE, startRow / SUPERTILE_SIZE, superTilePtr->meshData, &miny, &maxy))
+	{
+		PROF_BEGIN(kProf_BuildTerrainSuperTile);
+		BuildSuperTileGeometry(startCol, startRow, superTilePtr->meshData, &gGameViewInfoPtr->lightList, &miny, &maxy);
+		PROF_END(kProf_BuildTerrainSuperTile);
+	}
+
+	UploadSuperTileBuffers(superTileNum);							// send it to the GPU
+
+
+			/*********************/
+			/* CALC COORD & BBOX */
+			/*********************/
+			//
+			// This y coord is not used to translate since the terrain has no translation matrix
+			// instead, this is used by the culling routine for culling tests
+			//
+			
+	superTilePtr->y = (miny+maxy)*.5f;					// calc center y coord as average of top & bottom
+			
+	superTilePtr->bBox.min.x = startCol * gTerrainPolygonSize;
+	superTilePtr->bBox.max.x = superTilePtr->bBox.min.x + gTerrainSuperTileUnitSize;
+	superTilePtr->bBox.min.y = miny;
+	superTilePtr->bBox.max.y = maxy;
+	superTilePtr->bBox.min.z = startRow * gTerrainPolygonSize;
+	superTilePtr->bBox.max.z = superTilePtr->bBox.min.z + gTerrainSuperTileUnitSize;
+		
+	if (gDisableHiccupTimer)
+	{
+		superTilePtr->hiccupTimer = 0;
+	}
+	else
+	{
+		superTilePtr->hiccupTimer = gHiccupTimer++;
+		gHiccupTimer &= 0x1;							// spread over 2 frames
+	}
+										
+	return(superTileNum);
+}
+
+
+/******************* BUILD SUPERTILE GEOMETRY *******************/
+//
+// Fills in the points, triangles, normals & vertex colors of a supertile's mesh,
+// and passes back the min/max y of its points.
+//
+// This gets called from the builder threads too, so it must only read the
+// terrain & the given lights, and keep its work to the stack.
+//
+
+void BuildSuperTileGeometry(int startCol, int startRow, MOVertexArrayData *meshData, const OGLLightDefType *lights,
+							float *minY, float *maxY)
+{
+long	 			row,col,row2,col2,numPoints;
+float				height,miny,maxy;
+OGLColorRGBA_Byte	*vertexColorList;
+MOTriangleIndecies	*triangleList;
+OGLPoint3D			*vertexPointList;
+OGLVector3D			*vertexNormals;
+OGLPoint3D			workGrid[SUPERTILE_SIZE+1][SUPERTILE_SIZE+1];
 
 					
 				/*******************/
 				/* GET THE TRIMESH */
 				/*******************/
 				
-	meshData 				= gSuperTileMemoryList[superTileNum].meshData;		// get ptr to mesh data
 	triangleList 			= meshData->triangles;								// get ptr to triangle index list
 	vertexPointList 		= meshData->points;									// get ptr to points list
 	vertexColorList 		= meshData->colorsByte;								// get ptr to vertex color			
 	vertexNormals			= meshData->normals;								// get ptr to vertex normals
-//	uvs						= meshData->uvs[0];									// get ptr to uvs
 
 	miny = 10000000;													// init bbox counters
 	maxy = -miny;
@@ -579,22 +702,9 @@ OGLVector3D			*vertexNormals;
 
 					/* SET COORD */
 					
-			gWorkGrid[row2][col2].point.x = (col*gTerrainPolygonSize);
-			gWorkGrid[row2][col2].point.z = (row*gTerrainPolygonSize);
-			gWorkGrid[row2][col2].point.y = height;							// save height @ this tile's upper left corner				
-			
-					/* SET UV */
-					
-			gWorkGrid[row2][col2].uv.u = (float)col2 * (.99f / (float)SUPERTILE_SIZE);		// sets uv's 0.0 -> .99 for single texture map
-			gWorkGrid[row2][col2].uv.v = .99f - ((float)row2 * (.99f / (float)SUPERTILE_SIZE));						
-					
-					
-					/* SET COLOR */
-			
-			gWorkGrid[row2][col2].color.r = 
-			gWorkGrid[row2][col2].color.g = 
-			gWorkGrid[row2][col2].color.b = 
-			gWorkGrid[row2][col2].color.a = 1.0;
+			workGrid[row2][col2].x = (col*gTerrainPolygonSize);
+			workGrid[row2][col2].z = (row*gTerrainPolygonSize);
+			workGrid[row2][col2].y = height;								// save height @ this tile's upper left corner				
 						
 			if (height > maxy)											// keep track of min/max
 				maxy = height;
@@ -615,13 +725,45 @@ OGLVector3D			*vertexNormals;
 	{
 		for (col = 0; col < (SUPERTILE_SIZE+1); col++)
 		{
-			vertexPointList[numPoints] = gWorkGrid[row][col].point;						// copy from work grid
+			vertexPointList[numPoints] = workGrid[row][col];							// copy from work grid
 			numPoints++;
 		}
 	}
 
-				/* UPDATE TRIMESH DATA WITH NEW INFO */
-				
+				/* SET THE TRIANGLES */
+
+	BuildSuperTileTriangles(startCol, startRow, triangleList);
+
+
+			/******************************/
+			/* CALCULATE VERTEX NORMALS   */
+			/******************************/
+	
+	CalculateSupertileVertexNormals(meshData, startRow, startCol);
+
+			/*****************************/
+			/* CALCULATE VERTEX COLORS   */
+			/*****************************/
+
+	if (vertexColorList)
+		LightSuperTileVertices(vertexNormals, vertexColorList, startRow, startCol, lights);
+
+	*minY = miny;
+	*maxY = maxy;
+}
+
+
+/******************* BUILD SUPERTILE TRIANGLES *******************/
+//
+// Fills in the triangle index list of the supertile starting at the given
+// tile row/col. These only depend on gMapSplitMode, so SuperTileBuffers.c
+// also uses this to build the shared index buffer.
+//
+
+void BuildSuperTileTriangles(int startCol, int startRow, MOTriangleIndecies *triangleList)
+{
+long	row,col,row2,col2,i;
+
 	i = 0;			
 	for (row2 = 0; row2 < SUPERTILE_SIZE; row2++)
 	{
@@ -658,236 +800,90 @@ OGLVector3D			*vertexNormals;
 			}			
 		}
 	}
-	
-	
-			/******************************/
-			/* CALCULATE VERTEX NORMALS   */
-			/******************************/
-	
-	CalculateSupertileVertexNormals(meshData, startRow, startCol);
-
-			/*****************************/
-			/* CALCULATE VERTEX COLORS   */
-			/*****************************/
-
-	if (vertexColorList)
-	{
-		float				ambientR,ambientG,ambientB;
-		float				fillR0 = 1, fillG0 = 1, fillB0 = 1;
-		float				fillR1 = 1, fillG1 = 1, fillB1 = 1;
-		OGLVector3D			fillDir0,fillDir1;
-		Byte				numFillLights;
-	
-			/* GET LIGHT DATA */
-
-		ambientR = gGameViewInfoPtr->lightList.ambientColor.r;			// get ambient color
-		ambientG = gGameViewInfoPtr->lightList.ambientColor.g;		
-		ambientB = gGameViewInfoPtr->lightList.ambientColor.b;		
-			
-		fillR0 = gGameViewInfoPtr->lightList.fillColor[0].r;			// get fill color
-		fillG0 = gGameViewInfoPtr->lightList.fillColor[0].g;		
-		fillB0 = gGameViewInfoPtr->lightList.fillColor[0].b;		
-		fillDir0 = gGameViewInfoPtr->lightList.fillDirection[0];		// get fill direction
-		fillDir0.x = -fillDir0.x;
-		fillDir0.y = -fillDir0.y;
-		fillDir0.z = -fillDir0.z;
-
-		numFillLights = gGameViewInfoPtr->lightList.numFillLights;
-		if (numFillLights > 1)
-		{
-			fillR1 = gGameViewInfoPtr->lightList.fillColor[1].r;
-			fillG1 = gGameViewInfoPtr->lightList.fillColor[1].g;
-			fillB1 = gGameViewInfoPtr->lightList.fillColor[1].b;		
-			fillDir1 = gGameViewInfoPtr->lightList.fillDirection[1];
-			fillDir1.x = -fillDir1.x;
-			fillDir1.y = -fillDir1.y;
-			fillDir1.z = -fillDir1.z;
-		}
-		else
-		{
-			fillDir1 = fillDir0;										// silence compiler warning
-		}
-	
-				
-		i = 0;
-		for (row = 0; row <= SUPERTILE_SIZE; row++)
-		{
-			for (col = 0; col <= SUPERTILE_SIZE; col++)
-			{
-				float	shade = gVertexShading[row+startRow][col+startCol] * 255.0f;		// get value from shading grid
-				float	r,g,b,dot;
-				
-
-						/* APPLY LIGHTING TO THE VERTEX */
-				
-				r = ambientR;												// factor in the ambient
-				g = ambientG;
-				b = ambientB;
-
-
-				if (numFillLights > 0)
-				{
-					dot = OGLVector3D_Dot(&vertexNormals[i], &fillDir0);
-					if (dot > 0.0f)
-					{					
-						r += fillR0 * dot;
-						g += fillG0 * dot;
-						b += fillB0 * dot;					
-					}
+}
 
-					if (numFillLights > 1)
-					{
-						dot = OGLVector3D_Dot(&vertexNormals[i], &fillDir1);					
-						if (dot > 0.0f)
-						{					
-							r += fillR1 * dot;
-							g += fillG1 * dot;
-							b += fillB1 * dot;					
-						}
-					}
-					
-					if (r > 1.0f)
-						r = 1.0f;
-					if (g > 1.0f)
-						g = 1.0f;
-					if (b > 1.0f)
-						b = 1.0f;
-				}
 
-						/* SAVE COLOR INTO LIST */
-						
-				vertexColorList[i].r = r * shade;		// convert to Byte values & apply shade
-				vertexColorList[i].g = g * shade;
-				vertexColorList[i].b = b * shade;
-				vertexColorList[i].a = 0xff;
-				i++;
-			}
-		}
-	}
+/******************* RELEASE SUPERTILE OBJECT *******************/
+//
+// Deactivates the terrain object
+//
 
-			/*********************/
-			/* CALC COORD & BBOX */
-			/*********************/
-			//
-			// This y coord is not used to translate since the terrain has no translation matrix
-			// instead, this is used by the culling routine for culling tests
-			//
-			
-	superTilePtr->y = (miny+maxy)*.5f;					// calc center y coord as average of top & bottom
-			
-	superTilePtr->bBox.min.x = gWorkGrid[0][0].point.x;
-	superTilePtr->bBox.max.x = gWorkGrid[0][0].point.x + gTerrainSuperTileUnitSize;
-	superTilePtr->bBox.min.y = miny;
-	superTilePtr->bBox.max.y = maxy;
-	superTilePtr->bBox.min.z = gWorkGrid[0][0].point.z;
-	superTilePtr->bBox.max.z = gWorkGrid[0][0].point.z + gTerrainSuperTileUnitSize;
-		
-	if (gDisableHiccupTimer)
-	{
-		superTilePtr->hiccupTimer = 0;
-	}
-	else
-	{
-		superTilePtr->hiccupTimer = gHiccupTimer++;
-		gHiccupTimer &= 0x1;							// spread over 2 frames
-	}
-										
-	return(superTileNum);
+static inline void ReleaseSuperTileObject(short superTileNum)
+{
+	gSuperTileMemoryList[superTileNum].mode = SUPERTILE_MODE_FREE;		// it's free!
+	gNumFreeSupertiles++;
 }
 
 
-/******************** CALCULATE SUPERTILE VERTEX NORMALS **********************/
+/******************* CACHE SUPERTILE OBJECT *******************/
+//
+// Instead of freeing a supertile that has scrolled off, we keep it built
+// in case the camera turns back. GetFreeSuperTileMemory evicts the oldest
+// of these once it runs out of free blocks.
+//
 
-void CalculateSupertileVertexNormals(MOVertexArrayData	*meshData, long	startRow, long startCol)
+static void CacheSuperTileObject(short superTileNum)
 {
-OGLPoint3D			*vertexPointList;
-OGLVector3D			*vertexNormals;
-int					i,row,col;
-MOTriangleIndecies	*triangleList;
-OGLVector3D			faceNormal[NUM_TRIS_IN_SUPERTILE];
-OGLVector3D			*n1,*n2;
-float				avX,avY,avZ;
-OGLVector3D			nA,nB;
-long				ro,co;
+	gSuperTileMemoryList[superTileNum].mode = SUPERTILE_MODE_CACHED;
+	gSuperTileMemoryList[superTileNum].cacheStamp = gSuperTileCacheClock++;
+}
 
-	vertexPointList 		= meshData->points;									// get ptr to points list
-	vertexNormals			= meshData->normals;								// get ptr to vertex normals
-	triangleList 			= meshData->triangles;								// get ptr to triangle index list
 
+/******************* USE CACHED SUPERTILE *******************/
 
-						/* CALC FACE NORMALS */
-					
-	for (i = 0; i < NUM_TRIS_IN_SUPERTILE; i++)
-	{
-		CalcFaceNormal_NotNormalized(&vertexPointList[triangleList[i].vertexIndices[0]],			
-									&vertexPointList[triangleList[i].vertexIndices[1]],
-									&vertexPointList[triangleList[i].vertexIndices[2]],
-									&faceNormal[i]);		
-	}			
+static void UseCachedSuperTile(int row, int col)
+{
+SuperTileStatus		*status = &gSuperTileStatusGrid[row][col];
+SuperTileMemoryType	*superTile = &gSuperTileMemoryList[status->supertileIndex];
 
+	GAME_ASSERT(superTile->mode == SUPERTILE_MODE_CACHED);
+	GAME_ASSERT(superTile->tileRow == row * SUPERTILE_SIZE && superTile->tileCol == col * SUPERTILE_SIZE);
 
-			/******************************/
-			/* CALCULATE VERTEX NORMALS   */
-			/******************************/
+	superTile->mode = SUPERTILE_MODE_USED;
+	superTile->hiccupTimer = 0;											// nothing was built, so no need to spread it out
 
-	i = 0;
-	for (row = 0; row <= SUPERTILE_SIZE; row++)
-	{
-		for (col = 0; col <= SUPERTILE_SIZE; col++)
-		{
-			
-			/* SCAN 4 TILES AROUND THIS TILE TO CALC AVERAGE NORMAL FOR THIS VERTEX */
-			//
-			// We use the face normal already calculated for triangles inside the supertile,
-			// but for tiles/tris outside the supertile (on the borders), we need to calculate
-			// the face normals there.
-			//
-			
-			avX = avY = avZ = 0;									// init the normal	
-			
-			for (ro = -1; ro <= 0; ro++)
-			{
-				for (co = -1; co <= 0; co++)
-				{
-					long	cc = col + co;
-					long	rr = row + ro;
-					
-					if ((cc >= 0) && (cc < SUPERTILE_SIZE) && (rr >= 0) && (rr < SUPERTILE_SIZE)) // see if this vertex is in supertile bounds							 
-					{					
-						n1 = &faceNormal[rr * (SUPERTILE_SIZE*2) + (cc*2)];				// average 2 triangles...
-						n2 = n1+1;
-						avX += n1->x + n2->x;											// ...and average with current average
-						avY += n1->y + n2->y;
-						avZ += n1->z + n2->z;
-					}
-					else																// tile is out of supertile, so calc face normal & average
-					{
-						CalcTileNormals_NotNormalized(startRow + rr, startCol + cc, &nA,&nB);		// calculate the 2 face normals for this tile
-						avX += nA.x + nB.x;												// average with current average
-						avY += nA.y + nB.y;
-						avZ += nA.z + nB.z;
-					}
-				}
-			}
-			
-			FastNormalizeVector(avX, avY, avZ, &vertexNormals[i]);						// normalize the vertex normal	
-			i++;
-		}
-	}
+	status->statusFlags = SUPERTILE_IS_DEFINED|SUPERTILE_IS_USED_THIS_FRAME;
 
+	gSuperTileCacheStats.numHits++;
 
+	if (gVerifySuperTileCache)
+		VerifySuperTileGeometry(col, row, superTile->meshData, superTile->bBox.min.y, superTile->bBox.max.y, "UseCachedSuperTile");
 }
 
 
-/******************* RELEASE SUPERTILE OBJECT *******************/
+/*************** INVALIDATE CACHED SUPERTILES AROUND ******************/
 //
-// Deactivates the terrain object
+// Called before a deformation moves this supertile's vertices. Its cached
+// neighbors have to be rebuilt, and the defined ones won't be cached.
 //
 
-static inline void ReleaseSuperTileObject(short superTileNum)
+static void InvalidateCachedSuperTilesAround(int superRow, int superCol)
 {
-	gSuperTileMemoryList[superTileNum].mode = SUPERTILE_MODE_FREE;		// it's free!
-	gNumFreeSupertiles++;
+	for (int r = superRow - 1; r <= superRow + 1; r++)
+	{
+		if (r < 0 || r >= gNumSuperTilesDeep)
+			continue;
+
+		for (int c = superCol - 1; c <= superCol + 1; c++)
+		{
+			if (c < 0 || c >= gNumSuperTilesWide)
+				continue;
+
+			SuperTileStatus	*status = &gSuperTileStatusGrid[r][c];
+
+			if (status->statusFlags & SUPERTILE_IS_CACHED)
+			{
+				ReleaseSuperTileObject(status->supertileIndex);
+				status->statusFlags = 0;
+				gSuperTileCacheStats.numInvalidated++;
+			}
+			else
+			if (status->statusFlags & SUPERTILE_IS_DEFINED)
+			{
+				gSuperTileMemoryList[status->supertileIndex].dontCache = true;
+			}
+		}
+	}
 }
 
 /******************** RELEASE ALL SUPERTILES ************************/
@@ -896,10 +892,10 @@ static void ReleaseAllSuperTiles(void)
 {
 long	i;
 
-	for (i = 0; i < MAX_SUPERTILES; i++)
+	for (i = 0; i < NUM_SUPERTILE_BLOCKS; i++)
 		ReleaseSuperTileObject(i);
 
-	gNumFreeSupertiles = MAX_SUPERTILES;
+	gNumFreeSupertiles = NUM_SUPERTILE_BLOCKS;
 }
 
 #pragma mark -
@@ -912,7 +908,7 @@ long	i;
 void DrawTerrain(ObjNode *theNode)
 {
 int				r,c;
-int				i,unique;
+int				i,unique,lodVariant;
 Boolean			superTileVisible;
 
 	(void) theNode;
@@ -922,6 +918,8 @@ Boolean			superTileVisible;
 			/* DRAW STUFF */
 			/**************/
 
+	PROF_BEGIN(kProf_DrawTerrain);
+
 			/* SET A NICE STATE FOR TERRAIN DRAWING */
 
 	OGL_PushState();
@@ -931,6 +929,15 @@ Boolean			superTileVisible;
 
 
 	gNumSuperTilesDrawn	= 0;
+
+			/* DEFORMATIONS CHANGE gMapYCoords, SO THE BUILDERS HAVE TO STOP */
+
+	if (gNumTerrainDeformations > 0 || gCleanupDeformation)
+		CancelSuperTilePrefetches();
+
+			/* PICK EVERY SUPERTILE'S LEVEL OF DETAIL BEFORE ITS NEIGHBORS NEED IT */
+
+	ChooseSuperTileLODs();
 	
 	/******************************************************************/
 	/* SCAN THE SUPERTILE GRID AND LOOK FOR USED & VISIBLE SUPERTILES */
@@ -984,13 +991,19 @@ Boolean			superTileVisible;
 
 					/* SUBMIT THE GEOMETRY */
 
-				MO_DrawGeometry_VertexArray(gSuperTileMemoryList[i].meshData);
+				lodVariant = GetSuperTileLODVariant(r, c);						// -1 if full detail
+
+				if (!DrawSuperTileFromBuffers(i, lodVariant))					// from its GPU buffers if we can
+					DrawSuperTileFromArrays(i, lodVariant);
 				gNumSuperTilesDrawn++;
+				gSuperTileLODStats.numDrawn[gSuperTileStatusGrid[r][c].lod]++;
 			}
 		}	
 	}
 	gCleanupDeformation = false;							// reset this now
 
+	FinishSuperTileBufferDraws();
+
 
 	OGL_PopState();
 	
@@ -1005,14 +1018,24 @@ Boolean			superTileVisible;
 		{
 			for (c = 0; c < gNumSuperTilesWide; c++)
 			{
-				/* IF THIS SUPERTILE WAS NOT USED BUT IS DEFINED, THEN FREE IT */
+				/* IF THIS SUPERTILE WAS NOT USED BUT IS DEFINED, THEN CACHE OR FREE IT */
 					
 				if (gSuperTileStatusGrid[r][c].statusFlags & SUPERTILE_IS_DEFINED)					// is it defined?
 				{
 					if (!(gSuperTileStatusGrid[r][c].statusFlags & SUPERTILE_IS_USED_THIS_FRAME))	// was it used?  If not, then release the supertile definition
 					{
-						ReleaseSuperTileObject(gSuperTileStatusGrid[r][c].supertileIndex);
-						gSuperTileStatusGrid[r][c].statusFlags = 0;									// no longer defined
+						i = gSuperTileStatusGrid[r][c].supertileIndex;
+
+						if (gSuperTileMemoryList[i].dontCache)
+						{
+							ReleaseSuperTileObject(i);
+							gSuperTileStatusGrid[r][c].statusFlags = 0;								// no longer defined
+						}
+						else
+						{
+							CacheSuperTileObject(i);
+							gSuperTileStatusGrid[r][c].statusFlags = SUPERTILE_IS_CACHED;			// still built, just not in use
+						}
 					}
 				}
 			
@@ -1024,6 +1047,26 @@ Boolean			superTileVisible;
 			}
 		}
 	}
+
+	PROF_END(kProf_DrawTerrain);
+}
+
+
+/********************* DRAW SUPERTILE FROM ARRAYS **************************/
+//
+// For when DrawSuperTileFromBuffers can't. Same arrays, but maybe with
+// the triangles of a coarser level.
+//
+
+static void DrawSuperTileFromArrays(short superTileNum, int lodVariant)
+{
+MOVertexArrayData	mesh = *gSuperTileMemoryList[superTileNum].meshData;
+
+	if (lodVariant >= 0)
+		mesh.triangles = GetSuperTileLODTriangles(lodVariant, &mesh.numTriangles);
+
+	MO_DrawGeometry_VertexArray(&mesh);
+	gSuperTileLODStats.numTriangles += mesh.numTriangles;
 }
 
 #pragma mark -
@@ -1061,6 +1104,9 @@ static void DoSuperTileDeformation(SuperTileMemoryType *superTile)
 int		v,row,col,i;
 float	x,y,z, dist, decay, off, d2, originalY;
 float	oneOverWaveLength,r,rw,dampenRatio;
+int		firstPoint = NUM_VERTICES_IN_SUPERTILE, lastPoint = -1;
+int		firstNormal = NUM_VERTICES_IN_SUPERTILE, lastNormal = -1;
+OGLVector3D	oldNormals[NUM_VERTICES_IN_SUPERTILE];
 
 	if ((gNumTerrainDeformations == 0) && (!gCleanupDeformation))
 		return;
@@ -1071,6 +1117,8 @@ float	oneOverWaveLength,r,rw,dampenRatio;
 	int startRow = superTile->tileRow;													// get tile row/col of this supertile
 	int startCol = superTile->tileCol;
 
+	InvalidateCachedSuperTilesAround(startRow / SUPERTILE_SIZE, startCol / SUPERTILE_SIZE);	// they share our edge vertices & normals
+
 
 			/***************************************/
 			/* PROCESS EACH VERTEX FOR DEFORMATION */
@@ -1202,19 +1250,43 @@ float	oneOverWaveLength,r,rw,dampenRatio;
 			
 						/* SET Y COORD */
 						
+			if (superTile->meshData->points[v].y != y)						// remember which ones moved for UpdateSuperTileBuffers
+			{
+				if (v < firstPoint)
+					firstPoint = v;
+				lastPoint = v;
+			}
+
 			superTile->meshData->points[v++].y = y;							// save final y coord		
 			gMapYCoords[startRow+row][startCol+col] = y;					// also save into master grid
 		}
 	}
+
+	UpdateTerrainPlaneTable(startRow-1, startCol-1, startRow+SUPERTILE_SIZE, startCol+SUPERTILE_SIZE);	// tiles that share these vertices
 	
 		
 			/*************************/
 			/* UPDATE VERTEX NORMALS */
 			/*************************/
 		
+	SDL_memcpy(oldNormals, superTile->meshData->normals, sizeof(oldNormals));
+
 	CalculateSupertileVertexNormals(superTile->meshData, startRow, startCol);
 	
-	
+	for (v = 0; v < NUM_VERTICES_IN_SUPERTILE; v++)
+	{
+		if (SDL_memcmp(&oldNormals[v], &superTile->meshData->normals[v], sizeof(OGLVector3D)))
+		{
+			if (v < firstNormal)
+				firstNormal = v;
+			lastNormal = v;
+		}
+	}
+
+
+			/* RESEND ONLY WHAT MOVED */
+
+	UpdateSuperTileBuffers(superTile - gSuperTileMemoryList, firstPoint, lastPoint, firstNormal, lastNormal);
 }
 
 
@@ -1306,6 +1378,26 @@ void UpdateDeformationCoords(short defNum, float x, float z)
 
 #pragma mark -
 
+/***************** GET TERRAIN TRIANGLE PLANE ******************/
+//
+// Picks the plane of the triangle that xi/zi is on in the plane table.
+// xi/zi are the offsets into the tile.
+//
+
+static inline const TerrainTrianglePlane *GetTerrainTrianglePlane(int row, int col, float xi, float zi)
+{
+const TerrainTilePlanes	*planes = &gTerrainTilePlanes[row * gTerrainTileWidth + col];
+Boolean					left;
+
+	if (gMapSplitMode[row][col] == SPLIT_BACKWARD)						// if \ split
+		left = xi < zi;
+	else																// otherwise, / split
+		left = (gTerrainPolygonSize - xi) > zi;
+
+	return(&planes->tri[left ? 0 : 1]);
+}
+
+
 /***************** GET TERRAIN HEIGHT AT COORD ******************/
 //
 // Given a world x/z coord, return the y coord based on height map
@@ -1317,14 +1409,57 @@ void UpdateDeformationCoords(short defNum, float x, float z)
 
 float	GetTerrainY(float x, float z)
 {
+int							row,col;
+float						xi,zi,y;
+const TerrainTrianglePlane	*plane;
+
+	if (!gMapYCoords)													// make sure there's a terrain
+		return(ILLEGAL_TERRAIN_Y);
+
+	if (!gTerrainTilePlanes || gTerrainPlaneTableDisabled)
+		return(GetTerrainY_PlaneEquation(x, z));
+
+				/* CALC TILE ROW/COL INFO */
+				
+	col = x * gTerrainPolygonSizeFrac;								// see which tile row/col we're on
+	row = z * gTerrainPolygonSizeFrac;			
+				
+	if ((col < 0) || (col >= gTerrainTileWidth))						// check bounds
+		return(0);
+	if ((row < 0) || (row >= gTerrainTileDepth))
+		return(0);
+
+	xi = x - (col * gTerrainPolygonSize);								// calc x/z offset into the tile
+	zi = z - (row * gTerrainPolygonSize);
+
+	plane = GetTerrainTrianglePlane(row, col, xi, zi);
+
+	y = plane->y + plane->dydx * xi + plane->dydz * zi;
+
+	gRecentTerrainNormal.x = -plane->dydx * plane->normalY;				// remember the normal here
+	gRecentTerrainNormal.y = plane->normalY;
+	gRecentTerrainNormal.z = -plane->dydz * plane->normalY;
+
+	if (gVerifyTerrainPlanes)
+		VerifyTerrainY(x, z, y, &gRecentTerrainNormal);
+
+	return(y);
+}
+
+
+/***************** GET TERRAIN Y: PLANE EQUATION ******************/
+//
+// The way GetTerrainY used to work before the plane table: build the
+// tile's corners & the plane equation of the triangle that we're on.
+//
+
+static float GetTerrainY_PlaneEquation(float x, float z)
+{
 OGLPlaneEquation	planeEq;
 int					row,col;
 OGLPoint3D			p[4];
 float				xi,zi;
 
-	if (!gMapYCoords)													// make sure there's a terrain
-		return(ILLEGAL_TERRAIN_Y);
-
 				/* CALC TILE ROW/COL INFO */
 				
 	col = x * gTerrainPolygonSizeFrac;								// see which tile row/col we're on
@@ -1385,6 +1520,218 @@ float				xi,zi;
 }
 
 
+/***************** VERIFY TERRAIN Y ******************/
+//
+// The plane equation works in world coords, so it loses a few bits far
+// from the origin. The two only have to agree to within that.
+//
+
+static void VerifyTerrainY(float x, float z, float y, const OGLVector3D *normal)
+{
+OGLVector3D	tableNormal = *normal;
+OGLVector3D	savedNormal = gRecentTerrainNormal;
+float		planeY = GetTerrainY_PlaneEquation(x, z);
+float		tolerance = 0.01f + 1e-5f * (fabsf(x) + fabsf(z) + fabsf(planeY));
+
+	if (fabsf(y - planeY) > tolerance
+		|| fabsf(tableNormal.x - gRecentTerrainNormal.x) > 0.001f
+		|| fabsf(tableNormal.y - gRecentTerrainNormal.y) > 0.001f
+		|| fabsf(tableNormal.z - gRecentTerrainNormal.z) > 0.001f)
+	{
+		DoFatalAlert("GetTerrainY at (%f, %f): plane table got %f (%f, %f, %f), plane equation got %f (%f, %f, %f)",
+					x, z, y, tableNormal.x, tableNormal.y, tableNormal.z,
+					planeY, gRecentTerrainNormal.x, gRecentTerrainNormal.y, gRecentTerrainNormal.z);
+	}
+
+	gRecentTerrainNormal = savedNormal;
+}
+
+
+
+/***************** GET TERRAIN Y: BATCH ******************/
+//
+// Gets the terrain y for each of the n x/z coords, and the terrain's
+// normal there too if normals isn't nil.
+//
+// This is for loops over lots of particles etc. It's the same lookup
+// in the plane table as GetTerrainY, but it doesn't touch
+// gRecentTerrainNormal, and it does 4 coords at a time if we have
+// the Vec4 ops (see GetTerrainYBatch4).
+//
+// Like GetTerrainY, coords off the map get a y of 0. Their normal is
+// straight up.
+//
+
+void GetTerrainYBatch(int n, const float *x, const float *z, float *y, OGLVector3D *normals)
+{
+const float	size = gTerrainPolygonSize;
+const float	oneOverSize = gTerrainPolygonSizeFrac;
+
+	if (!gMapYCoords || !gTerrainTilePlanes || gTerrainPlaneTableDisabled)
+	{
+		OGLVector3D	savedNormal = gRecentTerrainNormal;
+
+		for (int i = 0; i < n; i++)										// one at a time then
+		{
+			gRecentTerrainNormal.x = gRecentTerrainNormal.z = 0;
+			gRecentTerrainNormal.y = 1;
+
+			y[i] = GetTerrainY(x[i], z[i]);
+			if (normals)
+				normals[i] = gRecentTerrainNormal;
+		}
+
+		gRecentTerrainNormal = savedNormal;
+		return;
+	}
+
+	int i = 0;
+
+#if VEC4_SIMD
+	for ( ; i + 4 <= n; i += 4)
+		GetTerrainYBatch4(&x[i], &z[i], &y[i], normals ? &normals[i] : nil);
+#endif
+
+	for ( ; i < n; i++)												// the rest one at a time
+	{
+				/* CALC TILE ROW/COL INFO */
+
+		int col = x[i] * oneOverSize;									// same rounding as GetTerrainY
+		int row = z[i] * oneOverSize;
+
+		if ((col < 0) || (col >= gTerrainTileWidth)						// check bounds
+			|| (row < 0) || (row >= gTerrainTileDepth))
+		{
+			y[i] = 0;
+			if (normals)
+			{
+				normals[i].x = normals[i].z = 0;
+				normals[i].y = 1;
+			}
+			continue;
+		}
+
+		float xi = x[i] - (col * size);									// offset into the tile
+		float zi = z[i] - (row * size);
+
+		const TerrainTrianglePlane *plane = GetTerrainTrianglePlane(row, col, xi, zi);
+
+		y[i] = plane->y + plane->dydx * xi + plane->dydz * zi;
+
+		if (normals)
+		{
+			normals[i].x = -plane->dydx * plane->normalY;
+			normals[i].y = plane->normalY;
+			normals[i].z = -plane->dydz * plane->normalY;
+		}
+
+		if (gVerifyTerrainPlanes)
+		{
+			OGLVector3D	normal = { -plane->dydx * plane->normalY, plane->normalY, -plane->dydz * plane->normalY };
+
+			VerifyTerrainY(x[i], z[i], y[i], &normal);
+		}
+	}
+}
+
+
+#if VEC4_SIMD
+
+/***************** GET TERRAIN Y: BATCH OF 4 ******************/
+//
+// GetTerrainYBatch for 4 coords. Finding each one's tile & fetching its
+// 2 planes has to be done a lane at a time, but the rest is 4-wide, even
+// which triangle of the tile each coord is on: the tile's split mode and
+// the xi/zi test turn into masks that select between the 2 planes, so
+// there's no branch per coord. Coords off the map get masked to y = 0
+// with the normal straight up.
+//
+// The y comes out bit for bit the same as GetTerrainY's as long as the
+// compiler doesn't fuse the scalar multiply-adds, which is why FP contraction
+// is off for this file (here and in CMakeLists.txt).
+//
+
+static void GetTerrainYBatch4(const float *x, const float *z, float *y, OGLVector3D *normals)
+{
+float	tileX[4], tileZ[4], backward[4], onMap[4];
+float	planeY[2][4], dydx[2][4], dydz[2][4], normalY[2][4];
+float	nx[4], ny[4], nz[4];
+
+			/* FETCH EACH COORD'S TILE */
+
+	for (int lane = 0; lane < 4; lane++)
+	{
+		int col = x[lane] * gTerrainPolygonSizeFrac;					// same rounding as GetTerrainY
+		int row = z[lane] * gTerrainPolygonSizeFrac;
+
+		if ((col < 0) || (col >= gTerrainTileWidth)
+			|| (row < 0) || (row >= gTerrainTileDepth))
+		{
+			onMap[lane] = 0;
+			col = row = 0;												// any tile will do, the lane gets masked off
+		}
+		else
+			onMap[lane] = 1;
+
+		const TerrainTilePlanes *planes = &gTerrainTilePlanes[row * gTerrainTileWidth + col];
+
+		tileX[lane]		= col * gTerrainPolygonSize;
+		tileZ[lane]		= row * gTerrainPolygonSize;
+		backward[lane]	= (gMapSplitMode[row][col] == SPLIT_BACKWARD) ? 1.0f : 0.0f;
+
+		for (int t = 0; t < 2; t++)
+		{
+			planeY[t][lane]		= planes->tri[t].y;
+			dydx[t][lane]		= planes->tri[t].dydx;
+			dydz[t][lane]		= planes->tri[t].dydz;
+			normalY[t][lane]	= planes->tri[t].normalY;
+		}
+	}
+
+			/* PICK THE TRIANGLE */
+
+	const Vec4	zero	= Vec4_Set1(0.0f);
+	const Vec4	size	= Vec4_Set1(gTerrainPolygonSize);
+	Vec4		xi		= Vec4_Sub(Vec4_Load(x), Vec4_Load(tileX));		// offset into the tile
+	Vec4		zi		= Vec4_Sub(Vec4_Load(z), Vec4_Load(tileZ));
+	Mask4		isOnMap	= Vec4_Greater(Vec4_Load(onMap), zero);
+	Mask4		left	= Mask4_Select(Vec4_Greater(Vec4_Load(backward), zero),
+									Vec4_Greater(zi, xi),						// \ split: xi < zi
+									Vec4_Greater(Vec4_Sub(size, xi), zi));		// / split: (size - xi) > zi
+
+	Vec4 py		= Vec4_Select(left, Vec4_Load(planeY[0]), Vec4_Load(planeY[1]));
+	Vec4 dx		= Vec4_Select(left, Vec4_Load(dydx[0]), Vec4_Load(dydx[1]));
+	Vec4 dz		= Vec4_Select(left, Vec4_Load(dydz[0]), Vec4_Load(dydz[1]));
+	Vec4 nY		= Vec4_Select(left, Vec4_Load(normalY[0]), Vec4_Load(normalY[1]));
+
+			/* Y & NORMAL */
+
+	Vec4 yv = Vec4_Add(Vec4_Add(py, Vec4_Mul(dx, xi)), Vec4_Mul(dz, zi));	// same order as GetTerrainY
+
+	Vec4_Store(y, Vec4_Select(isOnMap, yv, zero));
+
+	if (!normals && !gVerifyTerrainPlanes)
+		return;
+
+	Vec4_Store(nx, Vec4_Select(isOnMap, Vec4_Sub(zero, Vec4_Mul(dx, nY)), zero));
+	Vec4_Store(ny, Vec4_Select(isOnMap, nY, Vec4_Set1(1.0f)));
+	Vec4_Store(nz, Vec4_Select(isOnMap, Vec4_Sub(zero, Vec4_Mul(dz, nY)), zero));
+
+	for (int lane = 0; lane < 4; lane++)
+	{
+		OGLVector3D	normal = { nx[lane], ny[lane], nz[lane] };
+
+		if (normals)
+			normals[lane] = normal;
+
+		if (gVerifyTerrainPlanes && onMap[lane])
+			VerifyTerrainY(x[lane], z[lane], y[lane], &normal);
+	}
+}
+
+#endif // VEC4_SIMD
+
+
 
 
 
@@ -1488,6 +1835,7 @@ void DoPlayerTerrainUpdate(float x, float y)
 int			row,col,maxRow,maxCol,maskRow,maskCol,deltaRow,deltaCol;
 Boolean		fullItemScan,moved, isPicking = gIsPicking;
 Byte		mask;
+float		cameraX = x, cameraZ = y;
 
 static const Byte gridMask9[9*2][9*2] =		
 {
@@ -1723,6 +2071,11 @@ static const Byte gridMask3[3*2][3*2] =
 					
 				if (!(gSuperTileStatusGrid[row][col].statusFlags & SUPERTILE_IS_DEFINED))
 				{
+					if (gSuperTileStatusGrid[row][col].statusFlags & SUPERTILE_IS_CACHED)			// still built from last time?
+					{
+						UseCachedSuperTile(row, col);
+					}
+					else
 					if (gSuperTileTextureGrid[row][col] != -1)										// supertiles with texture ID -1 are blank, so dont build them
 					{    						
 						gSuperTileStatusGrid[row][col].supertileIndex = BuildTerrainSuperTile(col * SUPERTILE_SIZE, row * SUPERTILE_SIZE);	// build the supertile					
@@ -1759,6 +2112,12 @@ static const Byte gridMask3[3*2][3*2] =
 			/* UPDATE TERRAIN DEFORMATION FUNCTIONS */
 	
 		UpdateTerrainDeformationFunctions();
+
+
+			/* HAVE THE BUILDERS START ON WHERE WE'RE HEADED */
+
+		if (gNumTerrainDeformations == 0 && !gCleanupDeformation)
+			PrefetchSuperTiles(cameraX, cameraZ);
 	}
 }
 
@@ -1838,6 +2197,109 @@ float	y0,y1,y2,y3;
 }
 
 
+#pragma mark -
+
+/*************** BUILD TERRAIN PLANE TABLE ***********************/
+//
+// Precalcs the planes of both triangles of every tile, so that GetTerrainY
+// & CalcTileNormals just have to look them up.
+// Called from LoadPlayfield after CalculateSplitModeMatrix.
+//
+
+void BuildTerrainPlaneTable(void)
+{
+	DisposeTerrainPlaneTable();
+
+	gTerrainTilePlanes = (TerrainTilePlanes *) AllocPtrTagged(sizeof(TerrainTilePlanes) * gTerrainTileDepth * gTerrainTileWidth, kMemTag_Terrain);
+
+	UpdateTerrainPlaneTable(0, 0, gTerrainTileDepth-1, gTerrainTileWidth-1);
+}
+
+
+/*************** UPDATE TERRAIN PLANE TABLE ***********************/
+//
+// Recalcs the planes of the tiles in the given rows & cols (inclusive)
+// after their corners in gMapYCoords have moved.
+//
+
+void UpdateTerrainPlaneTable(int startRow, int startCol, int endRow, int endCol)
+{
+	if (!gTerrainTilePlanes)
+		return;
+
+	startRow	= GAME_MAX(startRow, 0);
+	startCol	= GAME_MAX(startCol, 0);
+	endRow		= GAME_MIN(endRow, gTerrainTileDepth-1);
+	endCol		= GAME_MIN(endCol, gTerrainTileWidth-1);
+
+	for (int row = startRow; row <= endRow; row++)
+	{
+		TerrainTilePlanes *planes = &gTerrainTilePlanes[row * gTerrainTileWidth];
+
+		for (int col = startCol; col <= endCol; col++)
+			CalcTerrainTilePlanes(row, col, &planes[col]);
+	}
+}
+
+
+/*************** DISPOSE TERRAIN PLANE TABLE ***********************/
+
+void DisposeTerrainPlaneTable(void)
+{
+	if (gTerrainTilePlanes)
+	{
+		SafeDisposePtr((Ptr) gTerrainTilePlanes);
+		gTerrainTilePlanes = nil;
+	}
+}
+
+
+/*************** CALC TERRAIN TILE PLANES ***********************/
+//
+// Same triangles as GetTerrainY_PlaneEquation, but as slopes off the
+// tile's corners so that the lookups can work in tile coords.
+//
+
+static void CalcTerrainTilePlanes(int row, int col, TerrainTilePlanes *planes)
+{
+float	oneOverSize = gTerrainPolygonSizeFrac;
+float	y00 = gMapYCoords[row][col];										// far left
+float	y10 = gMapYCoords[row][col+1];										// far right
+float	y11 = gMapYCoords[row+1][col+1];									// near right
+float	y01 = gMapYCoords[row+1][col];										// near left
+TerrainTrianglePlane	*left = &planes->tri[0];
+TerrainTrianglePlane	*right = &planes->tri[1];
+
+	if (gMapSplitMode[row][col] == SPLIT_BACKWARD)						// if \ split
+	{
+		left->y		= y00;
+		left->dydx	= (y11 - y01) * oneOverSize;
+		left->dydz	= (y01 - y00) * oneOverSize;
+
+		right->y	= y00;
+		right->dydx	= (y10 - y00) * oneOverSize;
+		right->dydz	= (y11 - y10) * oneOverSize;
+	}
+	else																// otherwise, / split
+	{
+		left->y		= y00;
+		left->dydx	= (y10 - y00) * oneOverSize;
+		left->dydz	= (y01 - y00) * oneOverSize;
+
+		right->y	= y01 + y10 - y11;
+		right->dydx	= (y11 - y01) * oneOverSize;
+		right->dydz	= (y11 - y10) * oneOverSize;
+	}
+
+	for (int i = 0; i < 2; i++)
+	{
+		TerrainTrianglePlane *p = &planes->tri[i];
+
+		p->normalY = 1.0f / sqrtf(p->dydx * p->dydx + 1.0f + p->dydz * p->dydz);
+	}
+}
+
+
 
 
 
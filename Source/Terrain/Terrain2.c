@@ -466,6 +466,22 @@ static OGLPoint3D	p4 = {0,0,0};
 		return;
 	}
 
+		/* LOOK THEM UP IN THE PLANE TABLE */
+
+	if (gTerrainTilePlanes && !gTerrainPlaneTableDisabled)
+	{
+		const TerrainTilePlanes *planes = &gTerrainTilePlanes[row * gTerrainTileWidth + col];
+
+		n1->x = -planes->tri[0].dydx * planes->tri[0].normalY;
+		n1->y = planes->tri[0].normalY;
+		n1->z = -planes->tri[0].dydz * planes->tri[0].normalY;
+
+		n2->x = -planes->tri[1].dydx * planes->tri[1].normalY;
+		n2->y = planes->tri[1].normalY;
+		n2->z = -planes->tri[1].dydz * planes->tri[1].normalY;
+		return;
+	}
+
 	p1.y = gMapYCoords[row][col];		// far left	
 	p2.y = gMapYCoords[row+1][col];		// near left
 	p3.y = gMapYCoords[row+1][col+1];	// near right	
@@ -494,10 +510,10 @@ static OGLPoint3D	p4 = {0,0,0};
 
 void CalcTileNormals_NotNormalized(long row, long col, OGLVector3D *n1, OGLVector3D *n2)
 {
-static OGLPoint3D	p1 = {0,0,0};
-static OGLPoint3D	p2 = {0,0,0};
-static OGLPoint3D	p3 = {0,0,0};
-static OGLPoint3D	p4 = {0,0,0};
+OGLPoint3D	p1 = {0,0,0};								// not static, since the supertile builder threads call this too
+OGLPoint3D	p2 = {0,0,0};
+OGLPoint3D	p3 = {0,0,0};
+OGLPoint3D	p4 = {0,0,0};
 //static OGLPoint3D	p2 = {0,0,gTerrainPolygonSize};
 //static OGLPoint3D	p3 = {gTerrainPolygonSize,0,gTerrainPolygonSize};
 //static OGLPoint3D	p4 = {gTerrainPolygonSize, 0, 0};
@@ -14,6 +14,13 @@
 
 static void DrawWater(ObjNode *theNode);
 static void MakeWaterGeometry(void);
+static void BuildWaterTileLookup(void);
+static void DisposeWaterTileLookup(void);
+static int GetWaterTilePatches(float x, float z, const Byte **patches);
+static int FindWaterPatch_Collision(float x, float y, float z, const Byte *patches, int numPatches);
+static int FindWaterPatch_OverXZ(float x, float z, const Byte *patches, int numPatches);
+static int FindWaterPatch_Y(float x, float z, const Byte *patches, int numPatches);
+static void VerifyWaterPatch(const char *what, int patch, int scanPatch);
 
 
 /****************************/
@@ -23,6 +30,9 @@ static void MakeWaterGeometry(void);
 #define MAX_WATER			60
 #define	MAX_NUBS_IN_WATER	80
 
+#define	WATER_TILE_MAX_CELLS	(1024*1024)				// if the water covers more tiles than this, we just scan the patches
+#define	WATER_TILE_MAX_COORD	1.0e8f
+
 
 /**********************/
 /*     VARIABLES      */
@@ -42,6 +52,23 @@ static OGLTextureCoord			gWaterUVs[MAX_WATER][MAX_NUBS_IN_WATER*2];
 static OGLTextureCoord			gWaterUVs2[MAX_WATER][MAX_NUBS_IN_WATER*2];
 OGLBoundingBox			gWaterBBox[MAX_WATER];
 
+Boolean					gVerifyWaterTiles = false;		// compare every water query against a scan of all the patches
+
+
+		/* WATER TILE LOOKUP */
+		//
+		// For each terrain tile in the area covered by the water, the patches
+		// whose bboxes touch it, in patch order. Only the bboxes are ever tested,
+		// so these are the only patches that a point in the tile could be in.
+		//
+
+static Boolean					gWaterTilesBuilt = false;
+static int						gWaterTileCol0, gWaterTileRow0;		// tile coords of the lookup's 1st cell
+static int						gWaterTileCols, gWaterTileRows;
+static float					gWaterTileOneOverSize;
+static int						*gWaterTileStart = nil;				// cell c's patches are gWaterTilePatchList[start[c] .. start[c+1]-1]
+static Byte						*gWaterTilePatchList = nil;
+
 static const float gWaterTransparency[NUM_WATER_TYPES] =
 {
 	.9,				// blue water
@@ -75,12 +102,14 @@ static const float	gWaterFixedYCoord[] =
 
 void DisposeWater(void)
 {
+	DisposeWaterTileLookup();
 
-	if (!gWaterListHandle)
-		return;
+	if (gWaterListHandle)
+	{
+		DisposeHandle((Handle)gWaterListHandle);
+		gWaterListHandle = nil;
+	}
 
-	DisposeHandle((Handle)gWaterListHandle);
-	gWaterListHandle = nil;
 	gWaterList = nil;
 	gNumWaterPatches = 0;
 }
@@ -191,6 +220,8 @@ float					y,centerX,centerZ;
 
 	MakeWaterGeometry();			
 
+	BuildWaterTileLookup();
+
 
 		/*************************************************************************/
 		/* CREATE DUMMY CUSTOM OBJECT TO CAUSE WATER DRAWING AT THE DESIRED TIME */
@@ -394,27 +425,17 @@ float	ud1, uv1, ud2, uv2;
 
 Boolean DoWaterCollisionDetect(ObjNode *theNode, float x, float y, float z, int *patchNum)
 {
-int	i;
+const Byte	*patches;
+int			numPatches, i;
 
-	for (i = 0; i < gNumWaterPatches; i++)
-	{
-				/* QUICK CHECK TO SEE IF IS IN BBOX */
-				
-		if ((x < gWaterBBox[i].min.x) || (x > gWaterBBox[i].max.x) ||
-			(z < gWaterBBox[i].min.z) || (z > gWaterBBox[i].max.z) ||
-			(y > gWaterBBox[i].max.y))
-			continue;
-	
-					/* NOW CHECK IF INSIDE THE POLYGON */
-					//
-					// note: this really isn't necessary since the bbox should
-					// 		be accurate enough
-					//
-					
-//		if (!IsPointInPoly2D(x, z, gWaterList[i].numNubs, gWaterList[i].nubList))
-//			continue;
+	numPatches = GetWaterTilePatches(x, z, &patches);
+	i = FindWaterPatch_Collision(x, y, z, patches, numPatches);
 
+	if (gVerifyWaterTiles && patches)
+		VerifyWaterPatch("DoWaterCollisionDetect", i, FindWaterPatch_Collision(x, y, z, nil, gNumWaterPatches));
 
+	if (i >= 0)
+	{
 					/* WE FOUND A HIT */
 					
 		theNode->StatusBits |= STATUS_BIT_UNDERWATER;
@@ -439,18 +460,16 @@ int	i;
 
 Boolean IsXZOverWater(float x, float z)
 {
-int	i;
+const Byte	*patches;
+int			numPatches, i;
 
-	for (i = 0; i < gNumWaterPatches; i++)
-	{
-				/* QUICK CHECK TO SEE IF IS IN BBOX */
-				
-		if ((x > gWaterBBox[i].min.x) && (x < gWaterBBox[i].max.x) &&
-			(z > gWaterBBox[i].min.z) && (z < gWaterBBox[i].max.z))
-			return(true);
-	}
+	numPatches = GetWaterTilePatches(x, z, &patches);
+	i = FindWaterPatch_OverXZ(x, z, patches, numPatches);
 
-	return(false);
+	if (gVerifyWaterTiles && patches)
+		VerifyWaterPatch("IsXZOverWater", i, FindWaterPatch_OverXZ(x, z, nil, gNumWaterPatches));
+
+	return(i >= 0);
 }
 
 
@@ -462,31 +481,280 @@ int	i;
 
 Boolean GetWaterY(float x, float z, float *y)
 {
-int	i;
+const Byte	*patches;
+int			numPatches, i;
+
+	numPatches = GetWaterTilePatches(x, z, &patches);
+	i = FindWaterPatch_Y(x, z, patches, numPatches);
+
+	if (gVerifyWaterTiles && patches)
+		VerifyWaterPatch("GetWaterY", i, FindWaterPatch_Y(x, z, nil, gNumWaterPatches));
 
-	for (i = 0; i < gNumWaterPatches; i++)
+	if (i >= 0)
 	{
+					/* WE FOUND A HIT */
+					
+		*y = gWaterBBox[i].max.y;						// return y 
+		return(true);
+	}
+	
+				/* NOT IN WATER */
+		
+	*y = 0;		
+	return(false);
+}
+
+
+#pragma mark -
+
+/**************** FIND WATER PATCH: COLLISION ********************/
+//
+// These go thru the given patches (or all of them if patches is nil), and
+// return the 1st one that the point is in, or -1.
+//
+
+static int FindWaterPatch_Collision(float x, float y, float z, const Byte *patches, int numPatches)
+{
+	for (int j = 0; j < numPatches; j++)
+	{
+		int	i = patches ? patches[j] : j;
+
 				/* QUICK CHECK TO SEE IF IS IN BBOX */
 				
 		if ((x < gWaterBBox[i].min.x) || (x > gWaterBBox[i].max.x) ||
-			(z < gWaterBBox[i].min.z) || (z > gWaterBBox[i].max.z))
+			(z < gWaterBBox[i].min.z) || (z > gWaterBBox[i].max.z) ||
+			(y > gWaterBBox[i].max.y))
 			continue;
 	
 					/* NOW CHECK IF INSIDE THE POLYGON */
+					//
+					// note: this really isn't necessary since the bbox should
+					// 		be accurate enough
+					//
 					
 //		if (!IsPointInPoly2D(x, z, gWaterList[i].numNubs, gWaterList[i].nubList))
 //			continue;
 
+		return(i);
+	}
 
-					/* WE FOUND A HIT */
-					
-		*y = gWaterBBox[i].max.y;						// return y 
-		return(true);
+	return(-1);
+}
+
+
+/**************** FIND WATER PATCH: OVER XZ ********************/
+
+static int FindWaterPatch_OverXZ(float x, float z, const Byte *patches, int numPatches)
+{
+	for (int j = 0; j < numPatches; j++)
+	{
+		int	i = patches ? patches[j] : j;
+
+				/* QUICK CHECK TO SEE IF IS IN BBOX */
+				
+		if ((x > gWaterBBox[i].min.x) && (x < gWaterBBox[i].max.x) &&
+			(z > gWaterBBox[i].min.z) && (z < gWaterBBox[i].max.z))
+			return(i);
 	}
+
+	return(-1);
+}
+
+
+/**************** FIND WATER PATCH: Y ********************/
+
+static int FindWaterPatch_Y(float x, float z, const Byte *patches, int numPatches)
+{
+	for (int j = 0; j < numPatches; j++)
+	{
+		int	i = patches ? patches[j] : j;
+
+				/* QUICK CHECK TO SEE IF IS IN BBOX */
+				
+		if ((x < gWaterBBox[i].min.x) || (x > gWaterBBox[i].max.x) ||
+			(z < gWaterBBox[i].min.z) || (z > gWaterBBox[i].max.z))
+			continue;
 	
-				/* NOT IN WATER */
-		
-	*y = 0;		
-	return(false);
+					/* NOW CHECK IF INSIDE THE POLYGON */
+					
+//		if (!IsPointInPoly2D(x, z, gWaterList[i].numNubs, gWaterList[i].nubList))
+//			continue;
+
+		return(i);
+	}
+
+	return(-1);
 }
 
+
+/**************** VERIFY WATER PATCH ********************/
+
+static void VerifyWaterPatch(const char *what, int patch, int scanPatch)
+{
+	if (patch != scanPatch)
+		DoFatalAlert("%s: tile lookup found patch %d, scan found %d", what, patch, scanPatch);
+}
+
+
+#pragma mark -
+
+/**************** BUILD WATER TILE LOOKUP ********************/
+//
+// Called from PrimeTerrainWater once the bboxes have been made.
+//
+
+static void BuildWaterTileLookup(void)
+{
+int		col0 = 0, row0 = 0, col1 = 0, row1 = 0;
+int		numCells;
+
+	DisposeWaterTileLookup();
+
+	if (gNumWaterPatches == 0)
+		return;
+
+	gWaterTileOneOverSize = 1.0f / gTerrainPolygonSize;
+
+			/* FIND THE TILES THAT THE WATER COVERS */
+
+	for (int f = 0; f < gNumWaterPatches; f++)
+	{
+		const OGLBoundingBox *b = &gWaterBBox[f];
+
+		if (!(fabsf(b->min.x) < WATER_TILE_MAX_COORD && fabsf(b->max.x) < WATER_TILE_MAX_COORD
+			&& fabsf(b->min.z) < WATER_TILE_MAX_COORD && fabsf(b->max.z) < WATER_TILE_MAX_COORD))
+		{
+			SDL_Log("BuildWaterTileLookup: water patch %d has a bad bbox, so the patches will be scanned instead", f);
+			return;
+		}
+
+		int c0 = (int) floorf(b->min.x * gWaterTileOneOverSize);
+		int r0 = (int) floorf(b->min.z * gWaterTileOneOverSize);
+		int c1 = (int) floorf(b->max.x * gWaterTileOneOverSize);
+		int r1 = (int) floorf(b->max.z * gWaterTileOneOverSize);
+
+		if (f == 0)
+		{
+			col0 = c0;	row0 = r0;
+			col1 = c1;	row1 = r1;
+		}
+		else
+		{
+			col0 = GAME_MIN(col0, c0);	row0 = GAME_MIN(row0, r0);
+			col1 = GAME_MAX(col1, c1);	row1 = GAME_MAX(row1, r1);
+		}
+	}
+
+	if ((double) (col1 - col0 + 1) * (row1 - row0 + 1) > WATER_TILE_MAX_CELLS)
+	{
+		SDL_Log("BuildWaterTileLookup: water covers too many tiles, so the patches will be scanned instead");
+		return;
+	}
+
+	gWaterTileCol0 = col0;
+	gWaterTileRow0 = row0;
+	gWaterTileCols = col1 - col0 + 1;
+	gWaterTileRows = row1 - row0 + 1;
+	numCells = gWaterTileCols * gWaterTileRows;
+
+	gWaterTileStart = (int *) AllocPtrClearTagged(sizeof(int) * (numCells + 1), kMemTag_Terrain);
+
+
+			/* FILE EACH PATCH IN THE TILES THAT ITS BBOX TOUCHES */
+			//
+			// 1st pass counts them in start[c+1], which then becomes where cell c+1 starts.
+			// Doing the patches in order keeps each tile's list in patch order.
+			//
+
+	int	*fill = nil;
+
+	for (int pass = 0; pass < 2; pass++)
+	{
+		if (pass == 1)
+		{
+			for (int c = 0; c < numCells; c++)
+				gWaterTileStart[c+1] += gWaterTileStart[c];
+
+			gWaterTilePatchList = (Byte *) AllocPtrTagged(GAME_MAX(gWaterTileStart[numCells], 1), kMemTag_Terrain);
+
+			fill = (int *) AllocPtrTagged(sizeof(int) * numCells, kMemTag_Terrain);
+			SDL_memcpy(fill, gWaterTileStart, sizeof(int) * numCells);
+		}
+
+		for (int f = 0; f < gNumWaterPatches; f++)
+		{
+			const OGLBoundingBox *b = &gWaterBBox[f];
+
+			int c0 = (int) floorf(b->min.x * gWaterTileOneOverSize) - gWaterTileCol0;
+			int r0 = (int) floorf(b->min.z * gWaterTileOneOverSize) - gWaterTileRow0;
+			int c1 = (int) floorf(b->max.x * gWaterTileOneOverSize) - gWaterTileCol0;
+			int r1 = (int) floorf(b->max.z * gWaterTileOneOverSize) - gWaterTileRow0;
+
+			for (int row = r0; row <= r1; row++)
+			{
+				for (int col = c0; col <= c1; col++)
+				{
+					int c = row * gWaterTileCols + col;
+
+					if (pass == 0)
+						gWaterTileStart[c+1]++;
+					else
+						gWaterTilePatchList[fill[c]++] = f;
+				}
+			}
+		}
+	}
+
+	SafeDisposePtr((Ptr) fill);
+
+	gWaterTilesBuilt = true;
+}
+
+
+/**************** DISPOSE WATER TILE LOOKUP ********************/
+
+static void DisposeWaterTileLookup(void)
+{
+	if (gWaterTileStart)
+		SafeDisposePtr((Ptr) gWaterTileStart);
+	gWaterTileStart = nil;
+
+	if (gWaterTilePatchList)
+		SafeDisposePtr((Ptr) gWaterTilePatchList);
+	gWaterTilePatchList = nil;
+
+	gWaterTilesBuilt = false;
+}
+
+
+/**************** GET WATER TILE PATCHES ********************/
+//
+// Gets the patches that could contain x/z.
+//
+// If there's no lookup, or x/z aren't finite (NaN passes all the bbox tests),
+// *patches is set to nil and it returns gNumWaterPatches, i.e. check them all.
+//
+
+static int GetWaterTilePatches(float x, float z, const Byte **patches)
+{
+	*patches = nil;
+
+	if (!gWaterTilesBuilt
+		|| !(fabsf(x) < WATER_TILE_MAX_COORD && fabsf(z) < WATER_TILE_MAX_COORD))
+	{
+		return(gNumWaterPatches);
+	}
+
+	int col = (int) floorf(x * gWaterTileOneOverSize) - gWaterTileCol0;
+	int row = (int) floorf(z * gWaterTileOneOverSize) - gWaterTileRow0;
+
+	*patches = gWaterTilePatchList;								// not nil, even if there aren't any
+
+	if (col < 0 || col >= gWaterTileCols || row < 0 || row >= gWaterTileRows)
+		return(0);
+
+	int c = row * gWaterTileCols + col;
+
+	*patches = &gWaterTilePatchList[gWaterTileStart[c]];
+	return(gWaterTileStart[c+1] - gWaterTileStart[c]);
+}